@@ -66,6 +66,11 @@
 	particle->velocityY += y * dt;
 }
 
+- (BOOL) allowsCoarseStep
+{
+	return YES;
+}
+
 + (PKAccelerateAction *)accelerateActionWithX:(float)x y:(float)y
 {
 	return [[[PKAccelerateAction alloc] initWithX:x y:y] autorelease];
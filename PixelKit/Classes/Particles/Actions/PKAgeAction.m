@@ -90,6 +90,11 @@
 	}
 }
 
+- (BOOL) allowsCoarseStep
+{
+	return YES;
+}
+
 + (PKAgeAction *)ageAction
 {
 	return [[[PKAgeAction alloc] init] autorelease];
@@ -94,6 +94,11 @@
 	particle->a = color.asARGB.a;
 }
 
+- (BOOL) allowsCoarseStep
+{
+	return YES;
+}
+
 + (PKColorChangeAction *)colorChangeActionWithStartColor:(unsigned int)startColor endColor:(unsigned int)endColor
 {
 	return [[[PKColorChangeAction alloc] initWithStartColor:startColor endColor:endColor] autorelease];
@@ -93,6 +93,11 @@
 	particle->a = PXMathLerp(end, start, particle->energy);
 }
 
+- (BOOL) allowsCoarseStep
+{
+	return YES;
+}
+
 + (PKFadeAction *)fadeAction
 {
 	return [[[PKFadeAction alloc] init] autorelease];
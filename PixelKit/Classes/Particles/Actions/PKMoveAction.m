@@ -48,6 +48,11 @@
 	particle->y += particle->velocityY * dt;
 }
 
+- (BOOL) allowsCoarseStep
+{
+	return YES;
+}
+
 + (PKMoveAction *)moveAction
 {
 	return [[[PKMoveAction alloc] init] autorelease];
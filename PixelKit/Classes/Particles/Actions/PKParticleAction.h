@@ -68,4 +68,10 @@
 @protocol PKParticleAction <PKParticleBehavior>
 @required
 - (void) updateParticle:(PKParticle *)particle emitter:(PKParticleEmitter *)emitter deltaTime:(float)dt;
+@optional
+// Return YES if the action gives (close to) the same result when it is stepped
+// once with a large delta time as when it is stepped many times with a small
+// one. Used by [PKParticleEmitter runAheadWithDuration:frameRate:coarseFrameRate:]
+// to decide if a larger step may be taken. Assumed NO if not implemented.
+- (BOOL) allowsCoarseStep;
 @end
@@ -49,6 +49,11 @@
 	// Override please.
 }
 
+- (BOOL) allowsCoarseStep
+{
+	return NO;
+}
+
 - (void) addedToEmitter:(PKParticleEmitter *)emitter
 {
 }
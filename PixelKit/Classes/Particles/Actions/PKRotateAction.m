@@ -48,6 +48,11 @@
 	particle->rotation += particle->angularSpeed * dt;
 }
 
+- (BOOL) allowsCoarseStep
+{
+	return YES;
+}
+
 + (PKRotateAction *)rotateAction
 {
 	return [[[PKRotateAction alloc] init] autorelease];
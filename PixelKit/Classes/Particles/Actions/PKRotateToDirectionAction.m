@@ -48,6 +48,11 @@
 	particle->rotation = atan2f(particle->velocityY, particle->velocityX);
 }
 
+- (BOOL) allowsCoarseStep
+{
+	return YES;
+}
+
 + (PKRotateToDirectionAction *)rotateToDirectionAction
 {
 	return [[[PKRotateToDirectionAction alloc] init] autorelease];
@@ -70,6 +70,11 @@
 	particle->scaleY = scale;
 }
 
+- (BOOL) allowsCoarseStep
+{
+	return YES;
+}
+
 + (PKScaleAction *)scaleActionWithStartScale:(float)startScale endScale:(float)endScale
 {
 	return [[[PKScaleAction alloc] initWithStartScale:startScale endScale:endScale] autorelease];
@@ -98,6 +98,11 @@
 	}
 }
 
+- (BOOL) allowsCoarseStep
+{
+	return YES;
+}
+
 + (PKSpeedLimitAction *)speedLimitActionWithLimit:(float)limit isMinimum:(BOOL)isMinimum
 {
 	return [[[PKSpeedLimitAction alloc] initWithLimit:limit isMinimum:isMinimum] autorelease];
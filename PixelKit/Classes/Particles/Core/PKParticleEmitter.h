@@ -175,6 +175,7 @@
 @property (nonatomic, readonly) BOOL running;
 
 - (void) removeAllParticles;
+- (void) reserveParticles:(unsigned int)count;
 
 - (void) addInitializer:(id<PKParticleInitializer>)initializer;
 - (void) removeInitializer:(id<PKParticleInitializer>)initializer;
@@ -195,11 +196,20 @@
 
 - (void) runAheadWithDuration:(float)duration;
 - (void) runAheadWithDuration:(float)duration frameRate:(float)frameRate;
+- (void) runAheadWithDuration:(float)duration frameRate:(float)frameRate coarseFrameRate:(float)coarseFrameRate;
+- (void) runAheadWithDuration:(float)duration frameRate:(float)frameRate cacheKey:(NSString *)key;
+
+- (BOOL) actionsAllowCoarseStep;
+
+- (NSData *)particleSnapshot;
+- (void) restoreParticleSnapshot:(NSData *)snapshot;
 
 - (void) updateWithDeltaTime:(float)dt;
 
 + (id<PKParticleFactory>) defaultParticleFactory;
 
++ (void) purgeRunAheadCache;
+
 + (PKParticleEmitter *)particleEmitter;
 
 @end
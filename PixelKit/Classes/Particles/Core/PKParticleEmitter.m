@@ -58,12 +58,52 @@
 
 static unsigned int pkParticleEmitterNameCount = 0;
 static id<PKParticleFactory> pkParticleEmitterDefaultFactory = nil;
+static NSMutableDictionary *pkParticleEmitterRunAheadCache = nil;
+
+// The plain state of a particle, as stored in a snapshot. The graphic and user
+// data are left out, those are re-created by the initializers on restore.
+typedef struct
+{
+	float x;
+	float y;
+
+	float velocityX;
+	float velocityY;
+
+	float lifetime;
+	float age;
+	float energy;
+
+	float scaleX;
+	float scaleY;
+
+	float rotation;
+	float angularSpeed;
+
+	float sMin;
+	float sMax;
+	float tMin;
+	float tMax;
+
+	unsigned short blendSource;
+	unsigned short blendDestination;
+
+	unsigned char r;
+	unsigned char g;
+	unsigned char b;
+	unsigned char a;
+} PKParticleSnapshotState;
 
 bool PKParticleEmitterDeleteCheckFunction(PXArrayBuffer *buffer, void *element, void *userData);
 void PKParticleUpdateFunction(PXArrayBuffer *buffer, void *element, void *userData);
 
+void PKParticleSnapshotStateSave(PKParticleSnapshotState *state, PKParticle *particle);
+void PKParticleSnapshotStateRestore(PKParticleSnapshotState *state, PKParticle *particle);
+
 @interface PKParticleEmitter(Private)
 - (void) createParticles:(unsigned int)count;
+- (void) runAheadWithDuration:(float)duration deltaTime:(float)dt coarse:(BOOL)coarse;
+- (void) updateCoarseWithDeltaTime:(float)dt;
 - (void) destroyParticle:(PKParticle *)particle;
 - (void) validateGraphicTypes;
 - (id<PKGraphicInitializer>) anyGraphicInitializer;
@@ -205,6 +245,28 @@ void PKParticleUpdateFunction(PXArrayBuffer *buffer, void *element, void *userDa
 	PXArrayBufferUpdateCount(particles, 0);
 }
 
+/**
+ * Prepares the emitter for holding `count` living particles at once, and asks
+ * the #particleFactory to have as many particles ready (if it supports
+ * [PKParticleFactory reserveParticles:]).
+ *
+ * Calling this ahead of time for emitters which create a lot of particles at
+ * once, such as ones using a #PKBlastFlow, keeps those from allocating any
+ * memory mid-frame.
+ */
+- (void) reserveParticles:(unsigned int)count
+{
+	if (particles != NULL)
+	{
+		PXArrayBufferSetMinCount(particles, count);
+	}
+
+	if ([particleFactory respondsToSelector:@selector(reserveParticles:)])
+	{
+		[particleFactory reserveParticles:count];
+	}
+}
+
 - (unsigned int) numParticles
 {
 	if (particles == NULL)
@@ -564,6 +626,99 @@ void PKParticleUpdateFunction(PXArrayBuffer *buffer, void *element, void *userDa
  * forwarding.
  */
 - (void) runAheadWithDuration:(float)duration frameRate:(float)frameRate
+{
+	[self runAheadWithDuration:duration deltaTime:1.0f / frameRate coarse:NO];
+}
+
+/**
+ * Fast forwards the emitter the specified amount of time, taking steps of
+ * `1.0 / coarseFrameRate` seconds when all of the emitter's actions allow it.
+ *
+ * Particles created within a single coarse step are spread evenly across it so
+ * that they don't clump together. If any of the actions doesn't allow a coarse
+ * step (see [PKParticleAction allowsCoarseStep]), this falls back to
+ * #runAheadWithDuration:frameRate:.
+ *
+ * @param duration The amount of time, in seconds, to fast forward the emitter
+ * @param frameRate The framerate at which to simulate the emitter if a coarse
+ * step isn't allowed.
+ * @param coarseFrameRate The framerate at which to simulate the emitter if a
+ * coarse step is allowed. Should be lower than `frameRate`.
+ */
+- (void) runAheadWithDuration:(float)duration frameRate:(float)frameRate coarseFrameRate:(float)coarseFrameRate
+{
+	if (coarseFrameRate <= 0.0f || coarseFrameRate >= frameRate || [self actionsAllowCoarseStep] == NO)
+	{
+		[self runAheadWithDuration:duration frameRate:frameRate];
+		return;
+	}
+
+	[self runAheadWithDuration:duration deltaTime:1.0f / coarseFrameRate coarse:YES];
+}
+
+/**
+ * Fast forwards the emitter the specified amount of time, reusing the result
+ * of a previous run ahead with the same key and duration if one exists.
+ *
+ * The first time a key is used the emitter runs ahead as usual and a snapshot
+ * of its particles, and of its flow's state, is stored. Any later call with
+ * the same key restores that snapshot instead of simulating, which only costs
+ * a copy per particle. The emitter's living particles are removed before
+ * restoring.
+ *
+ * The flow's state is only kept if it implements
+ * [PKParticleFlow flowState] and [PKParticleFlow restoreFlowState:], as every
+ * flow in PixelKit does.
+ *
+ * The key should uniquely identify the effect definition (for example the path
+ * of the file it was loaded from); the duration is added to it internally.
+ *
+ * @param duration The amount of time, in seconds, to fast forward the emitter
+ * @param frameRate The framerate at which to simulate the emitter while fast
+ * forwarding, if no snapshot is cached yet.
+ * @param key The key identifying the effect, or `nil` to skip the cache.
+ *
+ * @see #purgeRunAheadCache
+ */
+- (void) runAheadWithDuration:(float)duration frameRate:(float)frameRate cacheKey:(NSString *)key
+{
+	if (key == nil)
+	{
+		[self runAheadWithDuration:duration frameRate:frameRate];
+		return;
+	}
+
+	NSString *cacheKey = [NSString stringWithFormat:@"%@|%f", key, duration];
+	NSArray *snapshot = [pkParticleEmitterRunAheadCache objectForKey:cacheKey];
+
+	BOOL flowHasState = [flow respondsToSelector:@selector(flowState)] &&
+						[flow respondsToSelector:@selector(restoreFlowState:)];
+
+	if (snapshot != nil)
+	{
+		[self restoreParticleSnapshot:[snapshot objectAtIndex:0]];
+
+		if (flowHasState && [snapshot count] > 1)
+		{
+			[flow restoreFlowState:[snapshot objectAtIndex:1]];
+		}
+
+		return;
+	}
+
+	[self runAheadWithDuration:duration frameRate:frameRate];
+
+	if (pkParticleEmitterRunAheadCache == nil)
+	{
+		pkParticleEmitterRunAheadCache = [[NSMutableDictionary alloc] init];
+	}
+
+	// The flow state is left out of the array if there is none.
+	snapshot = [NSArray arrayWithObjects:[self particleSnapshot], (flowHasState ? [flow flowState] : nil), nil];
+	[pkParticleEmitterRunAheadCache setObject:snapshot forKey:cacheKey];
+}
+
+- (void) runAheadWithDuration:(float)duration deltaTime:(float)desiredDT coarse:(BOOL)coarse
 {
 	if (PXMathIsZero(duration) == YES)
 		return;
@@ -576,13 +731,14 @@ void PKParticleUpdateFunction(PXArrayBuffer *buffer, void *element, void *userDa
 		[flow resume];
 	}
 
-	float desiredDT = 1.0f / frameRate;
-
 	unsigned int updateCount = fabsf((duration < 0.0f) ? floorf(duration / desiredDT) : ceilf(duration / desiredDT));
 
 	for (unsigned int index = 0; index < updateCount; ++index)
 	{
-		[self updateWithDeltaTime:desiredDT];
+		if (coarse == YES)
+			[self updateCoarseWithDeltaTime:desiredDT];
+		else
+			[self updateWithDeltaTime:desiredDT];
 	}
 
 	if (isFlowing == NO)
@@ -591,6 +747,109 @@ void PKParticleUpdateFunction(PXArrayBuffer *buffer, void *element, void *userDa
 	}
 }
 
+/**
+ * Checks if every action in the emitter allows being stepped with a large
+ * delta time.
+ *
+ * @see [PKParticleAction allowsCoarseStep]
+ */
+- (BOOL) actionsAllowCoarseStep
+{
+	for (id<PKParticleAction> action in _actions)
+	{
+		if ([action respondsToSelector:@selector(allowsCoarseStep)] == NO)
+			return NO;
+
+		if ([action allowsCoarseStep] == NO)
+			return NO;
+	}
+
+	return YES;
+}
+
+/**
+ * Creates a snapshot of the state of every living particle in the emitter. The
+ * snapshot can later be given to #restoreParticleSnapshot: on this or any
+ * other emitter with the same initializers.
+ *
+ * The particles' graphics aren't part of the snapshot, and neither is the state
+ * of the emitter's flow.
+ */
+- (NSData *)particleSnapshot
+{
+	unsigned int count = [self numParticles];
+
+	NSMutableData *data = [NSMutableData dataWithLength:count * sizeof(PKParticleSnapshotState)];
+	PKParticleSnapshotState *state = [data mutableBytes];
+
+	PKParticle *particle;
+
+	PXArrayBufferPtrForEach(particles, particle)
+	{
+		PKParticleSnapshotStateSave(state, particle);
+		++state;
+	}
+
+	return data;
+}
+
+/**
+ * Replaces the living particles of the emitter with the ones stored in the
+ * given snapshot.
+ *
+ * Each particle is taken from the #particleFactory and run through the
+ * emitter's initializers (so that it gets a graphic) before its state is
+ * copied over from the snapshot. Actions aren't run on restored particles.
+ *
+ * @see #particleSnapshot
+ */
+- (void) restoreParticleSnapshot:(NSData *)snapshot
+{
+	[self removeAllParticles];
+
+	if (snapshot == nil)
+		return;
+
+	unsigned int count = [snapshot length] / sizeof(PKParticleSnapshotState);
+	PKParticleSnapshotState *state = (PKParticleSnapshotState *)[snapshot bytes];
+
+	PKParticle *particle;
+	id<PKParticleInitializer> initializer;
+	id *idPtr;
+
+	for (unsigned int index = 0; index < count; ++index, ++state)
+	{
+		particle = [particleFactory newParticle];
+
+		if (particle == nil)
+			break;
+
+		idPtr = PXArrayBufferNext(particles);
+
+		if (idPtr == NULL)
+		{
+			[particleFactory returnParticle:particle];
+			break;
+		}
+
+		[self initializeParticle:particle];
+
+		PXLinkedListForEach(initializers, initializer)
+		{
+			[initializer initializeParticle:particle emitter:self];
+		}
+
+		PKParticleSnapshotStateRestore(state, particle);
+		particle->isExpired = NO;
+		particle->wasJustCreated = NO;
+
+		[renderer particleEmitter:self didCreateParticle:particle];
+		[delegate particleEmitter:self didCreateParticle:particle];
+
+		*idPtr = particle;
+	}
+}
+
 - (void) createParticles:(unsigned int)count
 {
 	if (count == 0)
@@ -714,6 +973,63 @@ void PKParticleUpdateFunction(PXArrayBuffer *buffer, void *element, void *userDa
 	}
 }
 
+/*
+ * Same as updateWithDeltaTime:, except that particles created during the step
+ * are spread evenly across it instead of all being stepped by the full amount.
+ * Only used for run ahead, when all of the actions allow a coarse step.
+ */
+- (void) updateCoarseWithDeltaTime:(float)dt
+{
+	// Step the particles which already exist by the full amount first.
+	if (PXArrayBufferCount(particles) > 0)
+	{
+		_currentDT = dt;
+		PXArrayBufferListUpdate(particles, self, PKParticleEmitterDeleteCheckFunction, PKParticleUpdateFunction);
+	}
+
+	unsigned int particleCount = 0;
+	if ([flow complete] == NO)
+	{
+		particleCount = [flow updateWithEmitter:self deltaTime:dt];
+	}
+
+	unsigned int oldCount = PXArrayBufferCount(particles);
+	[self createParticles:particleCount];
+	unsigned int newCount = PXArrayBufferCount(particles) - oldCount;
+
+	if (newCount > 0)
+	{
+		// The first particle created is the oldest, so it gets the largest
+		// portion of the step.
+		PKParticle **particlePtr = ((PKParticle **)(particles->array)) + oldCount;
+		float stepDT = dt / newCount;
+
+		for (unsigned int index = 0; index < newCount; ++index, ++particlePtr)
+		{
+			_currentDT = stepDT * ((newCount - index) - 0.5f);
+			PKParticleUpdateFunction(particles, particlePtr, self);
+		}
+
+		_currentDT = dt;
+
+		// Get rid of any that expired during their portion of the step.
+		PXArrayBufferListUpdate(particles, self, PKParticleEmitterDeleteCheckFunction, NULL);
+	}
+
+	if (PXArrayBufferCount(particles) == 0)
+	{
+		[delegate particleEmitterIsEmpty:self];
+	}
+
+	[renderer particleEmitter:self didUpdateWithDeltaTime:dt];
+	[delegate particleEmitter:self didUpdateWithDeltaTime:dt];
+
+	if ([flow complete] == YES && PXArrayBufferCount(particles) == 0)
+	{
+		[delegate particleEmitter:self flowDidComplete:flow];
+	}
+}
+
 - (void) initializeParticle:(PKParticle *)particle
 {
 	particle->x = x;
@@ -778,6 +1094,16 @@ void PKParticleUpdateFunction(PXArrayBuffer *buffer, void *element, void *userDa
 	}
 }
 
+/**
+ * Removes every snapshot stored by
+ * #runAheadWithDuration:frameRate:cacheKey:.
+ */
++ (void) purgeRunAheadCache
+{
+	[pkParticleEmitterRunAheadCache release];
+	pkParticleEmitterRunAheadCache = nil;
+}
+
 /**
  * 
  */
@@ -820,3 +1146,67 @@ void PKParticleUpdateFunction(PXArrayBuffer *buffer, void *element, void *userDa
 
 	particle->wasJustCreated = NO;
 }
+
+void PKParticleSnapshotStateSave(PKParticleSnapshotState *state, PKParticle *particle)
+{
+	state->x = particle->x;
+	state->y = particle->y;
+
+	state->velocityX = particle->velocityX;
+	state->velocityY = particle->velocityY;
+
+	state->lifetime = particle->lifetime;
+	state->age = particle->age;
+	state->energy = particle->energy;
+
+	state->scaleX = particle->scaleX;
+	state->scaleY = particle->scaleY;
+
+	state->rotation = particle->rotation;
+	state->angularSpeed = particle->angularSpeed;
+
+	state->sMin = particle->sMin;
+	state->sMax = particle->sMax;
+	state->tMin = particle->tMin;
+	state->tMax = particle->tMax;
+
+	state->blendSource = particle->blendSource;
+	state->blendDestination = particle->blendDestination;
+
+	state->r = particle->r;
+	state->g = particle->g;
+	state->b = particle->b;
+	state->a = particle->a;
+}
+
+void PKParticleSnapshotStateRestore(PKParticleSnapshotState *state, PKParticle *particle)
+{
+	particle->x = state->x;
+	particle->y = state->y;
+
+	particle->velocityX = state->velocityX;
+	particle->velocityY = state->velocityY;
+
+	particle->lifetime = state->lifetime;
+	particle->age = state->age;
+	particle->energy = state->energy;
+
+	particle->scaleX = state->scaleX;
+	particle->scaleY = state->scaleY;
+
+	particle->rotation = state->rotation;
+	particle->angularSpeed = state->angularSpeed;
+
+	particle->sMin = state->sMin;
+	particle->sMax = state->sMax;
+	particle->tMin = state->tMin;
+	particle->tMax = state->tMax;
+
+	particle->blendSource = state->blendSource;
+	particle->blendDestination = state->blendDestination;
+
+	particle->r = state->r;
+	particle->g = state->g;
+	particle->b = state->b;
+	particle->a = state->a;
+}
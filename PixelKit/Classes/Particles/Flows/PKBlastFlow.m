@@ -71,6 +71,19 @@
 	return completed;
 }
 
+- (NSData *)flowState
+{
+	return [NSData dataWithBytes:&completed length:sizeof(BOOL)];
+}
+
+- (void) restoreFlowState:(NSData *)state
+{
+	if ([state length] == sizeof(BOOL))
+	{
+		[state getBytes:&completed length:sizeof(BOOL)];
+	}
+}
+
 + (PKBlastFlow *)blastFlowWithCount:(unsigned int)count
 {
 	return [[[PKBlastFlow alloc] initWithCount:count] autorelease];
@@ -67,4 +67,11 @@
 
 - (BOOL) complete;
 - (BOOL) running;
+@optional
+// Return the flow's progress (time accumulated, whether it has fired, etc.),
+// not including whether it is running. Used by
+// [PKParticleEmitter runAheadWithDuration:frameRate:cacheKey:] so that a
+// cached run ahead leaves the flow where simulating would have.
+- (NSData *)flowState;
+- (void) restoreFlowState:(NSData *)state;
 @end
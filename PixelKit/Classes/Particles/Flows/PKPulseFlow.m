@@ -86,6 +86,19 @@
 	return NO;
 }
 
+- (NSData *)flowState
+{
+	return [NSData dataWithBytes:&timeAccum length:sizeof(float)];
+}
+
+- (void) restoreFlowState:(NSData *)state
+{
+	if ([state length] == sizeof(float))
+	{
+		[state getBytes:&timeAccum length:sizeof(float)];
+	}
+}
+
 + (PKPulseFlow *)pulseFlowWithCount:(unsigned int)count period:(float)period
 {
 	return [[[PKPulseFlow alloc] initWithCount:count period:period] autorelease];
@@ -93,6 +93,19 @@
 	return count;
 }
 
+- (NSData *)flowState
+{
+	return [NSData dataWithBytes:&timeCounter length:sizeof(float)];
+}
+
+- (void) restoreFlowState:(NSData *)state
+{
+	if ([state length] == sizeof(float))
+	{
+		[state getBytes:&timeCounter length:sizeof(float)];
+	}
+}
+
 + (PKSteadyFlow *)steadyFlowWithRate:(float)rate
 {
 	return [[[PKSteadyFlow alloc] initWithRate:rate] autorelease];
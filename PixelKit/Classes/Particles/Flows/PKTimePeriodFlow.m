@@ -39,6 +39,13 @@
 
 #import "PKTimePeriodFlow.h"
 
+typedef struct
+{
+	unsigned int emitted;
+	float timeAccum;
+	BOOL completed;
+} PKTimePeriodFlowState;
+
 @implementation PKTimePeriodFlow
 
 @synthesize count;
@@ -101,6 +108,29 @@
 	return completed;
 }
 
+- (NSData *)flowState
+{
+	PKTimePeriodFlowState state;
+	state.emitted = emitted;
+	state.timeAccum = timeAccum;
+	state.completed = completed;
+
+	return [NSData dataWithBytes:&state length:sizeof(PKTimePeriodFlowState)];
+}
+
+- (void) restoreFlowState:(NSData *)data
+{
+	if ([data length] != sizeof(PKTimePeriodFlowState))
+		return;
+
+	PKTimePeriodFlowState state;
+	[data getBytes:&state length:sizeof(PKTimePeriodFlowState)];
+
+	emitted = state.emitted;
+	timeAccum = state.timeAccum;
+	completed = state.completed;
+}
+
 + (PKTimePeriodFlow *)timePeriodFlowWithCount:(unsigned int)count duration:(float)duration
 {
 	return [[[PKTimePeriodFlow alloc] initWithCount:count duration:duration] autorelease];
@@ -38,13 +38,15 @@
  */
 
 #import "PKParticleFactory.h"
-
-@class PXLinkedList;
+#import "PXArrayBuffer.h"
 
 @interface PKParticleCreator : NSObject <PKParticleFactory>
 {
 @protected
-	PXLinkedList *particles;
+	// A stack of the pooled particles. The creator owns a single reference to
+	// each of them, which is handed over as-is by newParticle and taken back
+	// by returnParticle:.
+	PXArrayBuffer *particles;
 
 	Class particleType;
 
@@ -53,6 +55,8 @@
 
 - (id) initWithParticleType:(Class)particleType;
 
+- (void) reserveParticles:(unsigned int)count;
+
 + (PKParticleCreator *)particleCreator;
 + (PKParticleCreator *)particleCreatorWithParticleType:(Class)particleType;
 
@@ -41,8 +41,15 @@
 
 #import "PKParticle.h"
 
-#import "PXObjectPool.h"
+@interface PKParticleCreator(Private)
+- (PKParticle *)allocParticle;
+@end
 
+/**
+ * The default #PKParticleFactory. Particles returned to the creator are kept
+ * on a flat stack and handed out again by #newParticle, so neither call
+ * allocates or touches reference counts once the pool is warm.
+ */
 @implementation PKParticleCreator
 
 - (id) init
@@ -56,7 +63,9 @@
 
     if (self)
 	{
-		particles = [[PXLinkedList alloc] init];
+		particles = PXArrayBufferCreate();
+		PXArrayBufferSetElementSize(particles, sizeof(PKParticle *));
+
 		particleType = _particleType;
 		identifierCount = 0;
     }
@@ -66,8 +75,10 @@
 
 - (void) dealloc
 {
-	[particles release];
-	particles = nil;
+	[self purgeCachedParticles];
+
+	PXArrayBufferRelease(particles);
+	particles = NULL;
 
 	[super dealloc];
 }
@@ -75,16 +86,17 @@
 - (PKParticle *)newParticle
 {
 	PKParticle *particle = nil;
+	unsigned int count = PXArrayBufferCount(particles);
 
-	if ([particles count] == 0)
+	if (count == 0)
 	{
-		particle = [[particleType alloc] init];
-		particle->uid = identifierCount++;
+		particle = [self allocParticle];
 	}
 	else
 	{
-		particle = [[particles firstObject] retain];
-		[particles removeFirstObject];
+		--count;
+		particle = *((PKParticle **)PXArrayBufferElementAt(particles, count));
+		PXArrayBufferUpdateCount(particles, count);
 	}
 
 	if (particle != nil)
@@ -96,13 +108,67 @@
 - (void) returnParticle:(PKParticle *)particle
 {
 	[particle reset];
-	[particles addObject:particle];
-	[particle release];
+
+	PKParticle **particlePtr = PXArrayBufferNext(particles);
+	*particlePtr = particle;
 }
 
 - (void) purgeCachedParticles
 {
-	[particles removeAllObjects];
+	PKParticle *particle;
+
+	PXArrayBufferPtrForEach(particles, particle)
+	{
+		[particle release];
+	}
+
+	PXArrayBufferSetMinCount(particles, 0);
+	PXArrayBufferUpdateCount(particles, 0);
+}
+
+/**
+ * Makes sure at least `count` particles are waiting in the pool, allocating
+ * the missing ones right away. Call this ahead of time (when loading a level,
+ * for example) for effects which create many particles at once, such as ones
+ * using a #PKBlastFlow, so that no allocation happens mid-frame.
+ *
+ * The pool is also kept from shrinking below `count` until
+ * #purgeCachedParticles is called.
+ *
+ * @param count The amount of particles to keep ready.
+ */
+- (void) reserveParticles:(unsigned int)count
+{
+	unsigned int pooledCount = PXArrayBufferCount(particles);
+
+	PXArrayBufferSetMinCount(particles, count);
+
+	if (pooledCount >= count)
+		return;
+
+	PKParticle *particle;
+	PKParticle **particlePtr;
+
+	for (; pooledCount < count; ++pooledCount)
+	{
+		particle = [self allocParticle];
+
+		if (particle == nil)
+			break;
+
+		particlePtr = PXArrayBufferNext(particles);
+		*particlePtr = particle;
+	}
+}
+
+- (PKParticle *)allocParticle
+{
+	PKParticle *particle = [[particleType alloc] init];
+
+	if (particle != nil)
+		particle->uid = identifierCount++;
+
+	return particle;
 }
 
 - (Class) particleType
@@ -47,4 +47,6 @@
 - (void) returnParticle:(PKParticle *)particle;
 - (void) purgeCachedParticles;
 - (Class) particleType;
+@optional
+- (void) reserveParticles:(unsigned int)count;
 @end
@@ -40,10 +40,61 @@
 #import "Pixelwave.h"
 #import "PKParticleRenderer.h"
 
+@class PKParticle;
+
+typedef enum
+{
+	// Particles are drawn emitter by emitter, in the order they were created.
+	PKParticleSortMode_None = 0,
+	// The oldest particles are drawn first, so the newest end up on top.
+	PKParticleSortMode_Age,
+	// Particles with the smallest y value are drawn first.
+	PKParticleSortMode_Y,
+	// Additively blended particles (those with a destination blend factor of
+	// GL_ONE) are drawn before all others.
+	PKParticleSortMode_AdditiveFirst
+} PKParticleSortMode;
+
 @interface PKParticleRendererBase : PXSprite <PKParticleRenderer>
 {
 @protected
 	PXLinkedList *emitters;
+
+	PKParticleSortMode sortMode;
+	BOOL groupByState;
+
+	// The sort buffers are kept as a structure of arrays, each allocated at
+	// twice the capacity as the radix sort scatters into the second half.
+	unsigned int *sortKeys;
+	PKParticle **sortParticles;
+	unsigned int sortCapacity;
 }
 
+/**
+ * The order in which the particles of all the renderer's emitters are drawn.
+ * Any mode other than #PKParticleSortMode_None draws the particles of every
+ * emitter together.
+ *
+ * @b Default: #PKParticleSortMode_None
+ */
+@property (nonatomic, assign) PKParticleSortMode sortMode;
+/**
+ * If `YES`, the particles of all the renderer's emitters are grouped by their
+ * graphic and blend function before being ordered by #sortMode. This creates
+ * one layer per state, cutting the amount of state changes (and thus draw
+ * calls) down to one per state when emitters with different blend functions
+ * are mixed.
+ *
+ * Note that this changes the draw order of overlapping particles from
+ * different groups.
+ *
+ * @b Default: `NO`
+ */
+@property (nonatomic, assign) BOOL groupByState;
+
+@end
+
+@interface PKParticleRendererBase (Protected)
+- (BOOL) isSorting;
+- (PKParticle **)sortedParticlesWithCount:(unsigned int *)count;
 @end
@@ -39,13 +39,39 @@
 
 #import "PKParticleRendererBase.h"
 
+#import "PKParticle.h"
+
 #import "PXLinkedList.h"
 
+#include "PXMathUtils.h"
+#include <float.h>
+
+// The largest amount of distinct states tracked when grouping by state, any
+// beyond this share the last group.
+#define PK_PARTICLE_RENDERER_MAX_STATE_GROUPS 128
+
+#define PK_PARTICLE_RENDERER_KEY_ADDITIVE_SHIFT 31
+#define PK_PARTICLE_RENDERER_KEY_GROUP_SHIFT 16
+#define PK_PARTICLE_RENDERER_KEY_VALUE_MAX 0xFFFF
+
+typedef struct
+{
+	id graphic;
+	unsigned short blendSource;
+	unsigned short blendDestination;
+} PKParticleRendererStateGroup;
+
+PXInline float PKParticleRendererSortValue(PKParticle *particle, PKParticleSortMode sortMode);
+void PKParticleRendererRadixSort(unsigned int *keys, PKParticle **particles, unsigned int count);
+
 /**
  * The base class for all particle renderers in PixelKit.
  */
 @implementation PKParticleRendererBase
 
+@synthesize sortMode;
+@synthesize groupByState;
+
 - (id) init
 {
 	self = [super init];
@@ -65,6 +91,14 @@
 	[self removeAllEmitters];
 	[emitters release];
 
+	if (sortKeys)
+		free(sortKeys);
+	sortKeys = NULL;
+
+	if (sortParticles)
+		free(sortParticles);
+	sortParticles = NULL;
+
 	[super dealloc];
 }
 
@@ -162,3 +196,219 @@
 }
 
 @end
+
+@implementation PKParticleRendererBase (Protected)
+
+- (BOOL) isSorting
+{
+	return (sortMode != PKParticleSortMode_None || groupByState == YES);
+}
+
+/*
+ * Gathers the particles of every emitter into a single list, ordered by the
+ * sort mode (and state, if grouping). The list is owned by the renderer and
+ * is only valid until the next call.
+ */
+- (PKParticle **)sortedParticlesWithCount:(unsigned int *)count
+{
+	PKParticleEmitter *emitter;
+	PKParticle *particle;
+
+	unsigned int totalCount = 0;
+
+	PXLinkedListForEach(emitters, emitter)
+	{
+		totalCount += PXArrayBufferCount(emitter.particles);
+	}
+
+	*count = totalCount;
+
+	if (totalCount == 0)
+		return NULL;
+
+	if (totalCount > sortCapacity)
+	{
+		sortCapacity = PXMathNextPowerOfTwo(totalCount);
+
+		sortKeys = realloc(sortKeys, sizeof(unsigned int) * (sortCapacity << 1));
+		sortParticles = realloc(sortParticles, sizeof(PKParticle *) * (sortCapacity << 1));
+	}
+
+	// First pass - gather the particles and find the range of the sort value,
+	// so it can be packed into the low bits of the key.
+	PKParticle **particlePtr = sortParticles;
+
+	float sortValue;
+	float minValue = FLT_MAX;
+	float maxValue = -FLT_MAX;
+
+	BOOL hasValue = (sortMode == PKParticleSortMode_Age || sortMode == PKParticleSortMode_Y);
+
+	PXLinkedListForEach(emitters, emitter)
+	{
+		PXArrayBufferPtrForEach(emitter.particles, particle)
+		{
+			*particlePtr = particle;
+			++particlePtr;
+
+			if (hasValue)
+			{
+				sortValue = PKParticleRendererSortValue(particle, sortMode);
+
+				if (sortValue < minValue)
+					minValue = sortValue;
+				if (sortValue > maxValue)
+					maxValue = sortValue;
+			}
+		}
+	}
+
+	// Second pass - build the keys.
+	float valueScale = (hasValue && maxValue > minValue) ? (PK_PARTICLE_RENDERER_KEY_VALUE_MAX / (maxValue - minValue)) : 0.0f;
+
+	PKParticleRendererStateGroup groups[PK_PARTICLE_RENDERER_MAX_STATE_GROUPS];
+	unsigned int groupCount = 0;
+	unsigned int group = 0;
+	unsigned int groupIndex;
+
+	unsigned int *key = sortKeys;
+	particlePtr = sortParticles;
+
+	for (unsigned int index = 0; index < totalCount; ++index, ++key, ++particlePtr)
+	{
+		particle = *particlePtr;
+		*key = 0;
+
+		if (hasValue)
+		{
+			*key = (unsigned int)((PKParticleRendererSortValue(particle, sortMode) - minValue) * valueScale);
+		}
+		else if (sortMode == PKParticleSortMode_AdditiveFirst)
+		{
+			if (particle->blendDestination != GL_ONE)
+				*key = 1U << PK_PARTICLE_RENDERER_KEY_ADDITIVE_SHIFT;
+		}
+
+		if (groupByState)
+		{
+			// Consecutive particles almost always share a state, so check the
+			// last one before searching.
+			if (groupCount == 0 ||
+				groups[group].graphic != particle->graphic ||
+				groups[group].blendSource != particle->blendSource ||
+				groups[group].blendDestination != particle->blendDestination)
+			{
+				for (groupIndex = 0; groupIndex < groupCount; ++groupIndex)
+				{
+					if (groups[groupIndex].graphic == particle->graphic &&
+						groups[groupIndex].blendSource == particle->blendSource &&
+						groups[groupIndex].blendDestination == particle->blendDestination)
+					{
+						break;
+					}
+				}
+
+				if (groupIndex == groupCount)
+				{
+					if (groupCount < PK_PARTICLE_RENDERER_MAX_STATE_GROUPS)
+					{
+						groups[groupCount].graphic = particle->graphic;
+						groups[groupCount].blendSource = particle->blendSource;
+						groups[groupCount].blendDestination = particle->blendDestination;
+						++groupCount;
+					}
+					else
+						groupIndex = PK_PARTICLE_RENDERER_MAX_STATE_GROUPS - 1;
+				}
+
+				group = groupIndex;
+			}
+
+			*key |= group << PK_PARTICLE_RENDERER_KEY_GROUP_SHIFT;
+		}
+	}
+
+	PKParticleRendererRadixSort(sortKeys, sortParticles, totalCount);
+
+	return sortParticles;
+}
+
+@end
+
+PXInline float PKParticleRendererSortValue(PKParticle *particle, PKParticleSortMode sortMode)
+{
+	// The oldest particles need the smallest key.
+	if (sortMode == PKParticleSortMode_Age)
+		return -(particle->age);
+
+	return particle->y;
+}
+
+/*
+ * A stable, least significant byte first radix sort. The keys and particles
+ * must both have room for twice the count, as the second half is used to
+ * scatter into. Passes where every key shares the same byte are skipped, so
+ * sorting on a few bits is nearly free.
+ */
+void PKParticleRendererRadixSort(unsigned int *keys, PKParticle **particles, unsigned int count)
+{
+	unsigned int histogram[256];
+
+	unsigned int *srcKeys = keys;
+	unsigned int *dstKeys = keys + count;
+	PKParticle **srcParticles = particles;
+	PKParticle **dstParticles = particles + count;
+
+	unsigned int *tempKeys;
+	PKParticle **tempParticles;
+
+	unsigned int index;
+	unsigned int byte;
+	unsigned int offset;
+	unsigned int sum;
+
+	for (unsigned int shift = 0; shift < 32; shift += 8)
+	{
+		memset(histogram, 0, sizeof(histogram));
+
+		for (index = 0; index < count; ++index)
+		{
+			++histogram[(srcKeys[index] >> shift) & 0xFF];
+		}
+
+		// If every key falls in the same bucket, this pass would do nothing.
+		if (histogram[(srcKeys[0] >> shift) & 0xFF] == count)
+			continue;
+
+		sum = 0;
+		for (byte = 0; byte < 256; ++byte)
+		{
+			offset = histogram[byte];
+			histogram[byte] = sum;
+			sum += offset;
+		}
+
+		for (index = 0; index < count; ++index)
+		{
+			offset = histogram[(srcKeys[index] >> shift) & 0xFF]++;
+
+			dstKeys[offset] = srcKeys[index];
+			dstParticles[offset] = srcParticles[index];
+		}
+
+		tempKeys = srcKeys;
+		srcKeys = dstKeys;
+		dstKeys = tempKeys;
+
+		tempParticles = srcParticles;
+		srcParticles = dstParticles;
+		dstParticles = tempParticles;
+	}
+
+	// The sorted data has to end up at the front of the buffers.
+	if (srcKeys != keys)
+	{
+		memcpy(keys, srcKeys, sizeof(unsigned int) * count);
+		memcpy(particles, srcParticles, sizeof(PKParticle *) * count);
+	}
+}
@@ -46,6 +46,8 @@
 @interface PKPointRenderer(Private)
 - (void) setCount:(unsigned int)count;
 
+- (void) renderParticles:(PKParticle **)particlePtr count:(unsigned int)count;
+
 - (void) drawCurrentWithTextureData:(PXTextureData *)textureData
 						  drawCount:(unsigned int)drawCount
 						blendSource:(unsigned short)blendSource
@@ -129,7 +131,23 @@
 
 	unsigned int maxCount = 0;
 	unsigned int curCount = 0;
-	unsigned int drawCount;
+
+	if ([self isSorting])
+	{
+		// All of the particles get drawn in one go, in the sorted order.
+		PKParticle **sortedParticles = [self sortedParticlesWithCount:&maxCount];
+
+		if (maxCount == 0)
+			return;
+
+		[self setCount:maxCount];
+
+		if (vertices == nil || sizes == nil)
+			return;
+
+		[self renderParticles:sortedParticles count:maxCount];
+		return;
+	}
 
 	// Loop through each emitter getting the count.
 	PXLinkedListForEach(emitters, emitter)
@@ -149,6 +167,25 @@
 	if (vertices == nil || sizes == nil)
 		return;
 
+	PXArrayBuffer *particles;
+
+	// Loop through each emitter drawing the display object with their particle
+	// values.
+	PXLinkedListForEach(emitters, emitter)
+	{
+		particles = emitter.particles;
+
+		// If the emitter is empty, we can just continue.
+		curCount = PXArrayBufferCount(particles);
+		if (curCount == 0)
+			continue;
+
+		[self renderParticles:(PKParticle **)(particles->array) count:curCount];
+	}
+}
+
+- (void) renderParticles:(PKParticle **)particlePtr count:(unsigned int)count
+{
 	PXGLColorVertex * const pointVertices = vertices;
 
 	PXGLColorVertex *currentVertex;
@@ -161,97 +198,78 @@
 	PXGLVertexPointer(2, GL_FLOAT, sizeof(PXGLColorVertex), &(pointVertices->x));
 	PXGLColorPointer(4, GL_UNSIGNED_BYTE, sizeof(PXGLColorVertex), &(pointVertices->r));
 
-	PXArrayBuffer *particles;
-	PKParticle **particlePtr;
-	PKParticle *particle;
+	PKParticle *particle = *particlePtr;
 
+	id graphic = particle->graphic;
 	PXTextureData *textureData = nil;
-	id graphic = nil;
 	float scaleMult = 1.0f;
 
-	unsigned short blendSource = 0;
-	unsigned short blendDestination = 0;
+	unsigned short blendSource = particle->blendSource;
+	unsigned short blendDestination = particle->blendDestination;
 
-	// Loop through each emitter drawing the display object with their particle
-	// values.
-	PXLinkedListForEach(emitters, emitter)
-	{
-		particles = emitter.particles;
+	unsigned int drawCount = 0;
 
-		// If the emitter is empty, we can just continue.
-		drawCount = PXArrayBufferCount(emitter.particles);
-		if (drawCount == 0)
-			continue;
+	if ([graphic isKindOfClass:[PXTextureData class]])
+		textureData = graphic;
+	else if ([graphic isKindOfClass:[PXTexture class]])
+		textureData = ((PXTexture *)(graphic)).textureData;
+	else
+		textureData = nil;
 
-		particles = emitter.particles;
+	scaleMult = (textureData == nil) ? 1.0f : textureData.width;
 
-		particlePtr = particles->array;
-		particle = *particlePtr;
-		graphic = particle->graphic;
-		blendSource = particle->blendSource;
-		blendDestination = particle->blendDestination;
-
-		if ([graphic isKindOfClass:[PXTextureData class]])
-			textureData = graphic;
-		else if ([graphic isKindOfClass:[PXTexture class]])
-			textureData = ((PXTexture *)(graphic)).textureData;
-		else
-			textureData = nil;
+	currentVertex = pointVertices;
+	currentSize = sizes;
 
-		scaleMult = (textureData == nil) ? 1.0f : textureData.width;
-
-		currentVertex = pointVertices;
-		currentSize = sizes;
-		drawCount = 0;
+	for (unsigned int index = 0; index < count; ++index, ++particlePtr)
+	{
+		particle = *particlePtr;
 
-		PXArrayBufferPtrForEach(particles, particle)
+		if (particle->graphic != graphic || particle->blendSource != blendSource || particle->blendDestination != blendDestination)
 		{
-			if (particle->graphic != graphic || particle->blendSource != blendSource || particle->blendDestination != blendDestination)
+			if (drawCount > 0)
 			{
-				if (drawCount > 0)
-				{
-					[self drawCurrentWithTextureData:textureData drawCount:drawCount blendSource:blendSource blendDestination:blendDestination];
-				}
-
-				drawCount = 0;
-				currentVertex = pointVertices;
-				currentSize = sizes;
-
-				graphic = particle->graphic;
-				blendSource = particle->blendSource;
-				blendDestination = particle->blendDestination;
-
-				if ([graphic isKindOfClass:[PXTextureData class]])
-					textureData = graphic;
-				else if ([graphic isKindOfClass:[PXTexture class]])
-					textureData = ((PXTexture *)(graphic)).textureData;
-				else
-					textureData = nil;
-
-				scaleMult = (textureData == nil) ? 1.0f : textureData.width;
+				[self drawCurrentWithTextureData:textureData drawCount:drawCount blendSource:blendSource blendDestination:blendDestination];
 			}
 
-			// Loop through each particle copying it's data.
-			currentVertex->x = particle->x;
-			currentVertex->y = particle->y;
+			drawCount = 0;
+			currentVertex = pointVertices;
+			currentSize = sizes;
 
-			currentVertex->r = particle->r;
-			currentVertex->g = particle->g;
-			currentVertex->b = particle->b;
-			currentVertex->a = particle->a;
+			graphic = particle->graphic;
+			blendSource = particle->blendSource;
+			blendDestination = particle->blendDestination;
 
-			*currentSize = particle->scaleX * scaleMult;
+			if ([graphic isKindOfClass:[PXTextureData class]])
+				textureData = graphic;
+			else if ([graphic isKindOfClass:[PXTexture class]])
+				textureData = ((PXTexture *)(graphic)).textureData;
+			else
+				textureData = nil;
 
-			// Increment the pointers.
-			++currentVertex;
-			++currentSize;
-			++drawCount;
+			scaleMult = (textureData == nil) ? 1.0f : textureData.width;
 		}
 
-		if (drawCount > 0)
-		{
-			[self drawCurrentWithTextureData:textureData drawCount:drawCount blendSource:blendSource blendDestination:blendDestination];
-		}
+		// Loop through each particle copying it's data.
+		currentVertex->x = particle->x;
+		currentVertex->y = particle->y;
+
+		currentVertex->r = particle->r;
+		currentVertex->g = particle->g;
+		currentVertex->b = particle->b;
+		currentVertex->a = particle->a;
+
+		*currentSize = particle->scaleX * scaleMult;
+
+		// Increment the pointers.
+		++currentVertex;
+		++currentSize;
+		++drawCount;
+	}
+
+	if (drawCount > 0)
+	{
+		[self drawCurrentWithTextureData:textureData drawCount:drawCount blendSource:blendSource blendDestination:blendDestination];
 	}
 }
 
@@ -41,6 +41,11 @@
 
 //#define PKQuadRendererUseNormalGL
 #define PKQuadRendererUseStrip
+// Writes the quads straight into the batch, already transformed, rather than
+// handing them to PXGLDrawArrays. Only used along with PKQuadRendererUseStrip
+// and without PKQuadRendererUseNormalGL. The sortMode and groupByState
+// properties are only honored by this path.
+#define PKQuadRendererUseDirectWrite
 
 // The graphic of any particle within this renderer MUST be a texture data.
 @interface PKQuadRenderer : PKParticleRendererBase
@@ -50,6 +50,18 @@
 #include "PKColor.h"
 #include "PXPrivateUtils.h"
 
+#if defined(PKQuadRendererUseDirectWrite) && defined(PKQuadRendererUseStrip) && !defined(PKQuadRendererUseNormalGL)
+#define _PKQuadRendererDirect
+#endif
+
+// Must be a power of two.
+#define PK_QUAD_RENDERER_SIN_TABLE_SIZE 4096
+#define PK_QUAD_RENDERER_SIN_TABLE_MASK (PK_QUAD_RENDERER_SIN_TABLE_SIZE - 1)
+#define PK_QUAD_RENDERER_SIN_TABLE_QUARTER (PK_QUAD_RENDERER_SIN_TABLE_SIZE >> 2)
+
+static float pkQuadRendererSinTable[PK_QUAD_RENDERER_SIN_TABLE_SIZE];
+static const float pkQuadRendererRadToIndex = PK_QUAD_RENDERER_SIN_TABLE_SIZE / (2.0f * M_PI);
+
 #pragma mark -
 #pragma mark C Structures
 #pragma mark -
@@ -93,10 +105,19 @@ typedef struct
 PXInline PKQuadParticleVertex PKQuadParticleVertexMake(GLfloat x, GLfloat y, GLubyte r, GLubyte g, GLubyte b, GLubyte a, GLfloat s, GLfloat t);
 PXInline PKQuadParticleVertexQuad PKQuadParticleVertexQuadMake(PKParticle *particle, CGSize halfSize);
 PXInline PKQuadParticleLinkedQuad PKQuadParticleLinkedQuadMake(PKParticle *particle, CGSize halfSize);
+PXInline void PKQuadRendererSinCos(float radians, float *sinVal, float *cosVal);
+PXInline void PKQuadParticleDirectVertexSet(PXGLColoredTextureVertex *vertex, GLfloat x, GLfloat y, GLubyte r, GLubyte g, GLubyte b, GLubyte a, GLfloat s, GLfloat t);
+PXInline void PKQuadParticleDirectQuadMake(PXGLColoredTextureVertex *vertex, PKParticle *particle, CGSize halfSize, const PXGLMatrix *matrix, PXGLAABB *aabb);
 
 @interface PKQuadRenderer(Private)
 - (void) setCount:(unsigned int)count;
 
+- (void) renderDirectGL;
+- (void) renderDirectParticles:(PKParticle **)particlePtr count:(unsigned int)count;
+- (void) setStateWithTextureData:(PXTextureData *)textureData
+					 blendSource:(unsigned short)blendSource
+				blendDestination:(unsigned short)blendDestination;
+
 #ifdef PKQuadRendererUseStrip
 - (void) drawCurrentWithTextureData:(PXTextureData *)textureData
 					  linkeVertices:(PKQuadParticleLinkedQuad * const)linkVertices
@@ -114,6 +135,21 @@ PXInline PKQuadParticleLinkedQuad PKQuadParticleLinkedQuadMake(PKParticle *parti
 
 @implementation PKQuadRenderer
 
++ (void) initialize
+{
+	if (self != [PKQuadRenderer class])
+		return;
+
+	// Build the lookup table used for rotating particles, sinf and cosf are far
+	// too slow to call for every particle every frame.
+	float step = (2.0f * M_PI) / PK_QUAD_RENDERER_SIN_TABLE_SIZE;
+
+	for (unsigned int index = 0; index < PK_QUAD_RENDERER_SIN_TABLE_SIZE; ++index)
+	{
+		pkQuadRendererSinTable[index] = sinf(index * step);
+	}
+}
+
 - (id) init
 {
 	return [self initWithSmoothing:NO];
@@ -239,6 +275,9 @@ PXInline PKQuadParticleLinkedQuad PKQuadParticleLinkedQuadMake(PKParticle *parti
 
 - (void) _renderGL
 {
+#ifdef _PKQuadRendererDirect
+	[self renderDirectGL];
+#else
 	PKParticleEmitter *emitter;
 
 	unsigned int maxCount = 0;
@@ -381,6 +420,103 @@ PXInline PKQuadParticleLinkedQuad PKQuadParticleLinkedQuadMake(PKParticle *parti
 #endif
 		}
 	}
+#endif
+}
+
+/*
+ * Builds every quad directly inside of the batch's vertex buffer. The quads are
+ * multiplied by the current matrix as they are built, so PXGL doesn't need to
+ * transform them a second time.
+ */
+- (void) renderDirectGL
+{
+	PKParticleEmitter *emitter;
+	PXArrayBuffer *particles;
+
+	if ([self isSorting])
+	{
+		unsigned int count;
+		PKParticle **sortedParticles = [self sortedParticlesWithCount:&count];
+
+		if (count == 0)
+			return;
+
+		[self renderDirectParticles:sortedParticles count:count];
+		return;
+	}
+
+	PXLinkedListForEach(emitters, emitter)
+	{
+		particles = emitter.particles;
+
+		// If this emitter has no particles, continue!
+		if (PXArrayBufferCount(particles) == 0)
+			continue;
+
+		[self renderDirectParticles:(PKParticle **)(particles->array)
+							  count:PXArrayBufferCount(particles)];
+	}
+}
+
+- (void) renderDirectParticles:(PKParticle **)particlePtr count:(unsigned int)count
+{
+	const PXGLMatrix *matrix = PXGLGetCurrentMatrix();
+
+	PKParticle *particle;
+
+	PXGLColoredTextureVertex *vertex = NULL;
+	PXGLAABB aabb = PXGLAABBReset;
+
+	id graphic = nil;
+	PXTextureData *textureData = nil;
+	unsigned short blendSource = 0;
+	unsigned short blendDestination = 0;
+
+	CGSize halfSize = CGSizeZero;
+
+	unsigned int usedCount = 0;
+
+	for (unsigned int remainingCount = count; remainingCount > 0; --remainingCount, ++particlePtr)
+	{
+		particle = *particlePtr;
+
+		if (vertex == NULL || particle->graphic != graphic || particle->blendSource != blendSource || particle->blendDestination != blendDestination)
+		{
+			// Commit what has been built so far, the state can't change while
+			// vertices are pending.
+			if (vertex != NULL)
+				PXGLUsedTransformedVertices(usedCount, &aabb);
+
+			graphic = particle->graphic;
+			blendSource = particle->blendSource;
+			blendDestination = particle->blendDestination;
+
+			if ([graphic isKindOfClass:[PXTextureData class]])
+				textureData = graphic;
+			else if ([graphic isKindOfClass:[PXTexture class]])
+				textureData = ((PXTexture *)(graphic)).textureData;
+			else
+				textureData = nil;
+
+			halfSize = (textureData == nil) ? CGSizeMake(0.5f, 0.5f) : CGSizeMake(textureData.width * 0.5f, textureData.height * 0.5f);
+
+			[self setStateWithTextureData:textureData blendSource:blendSource blendDestination:blendDestination];
+
+			// Ask for enough room for every particle left, only the ones
+			// actually written get used.
+			vertex = PXGLAskForTransformedVertices(GL_TRIANGLE_STRIP, remainingCount * 6);
+			usedCount = 0;
+			aabb = PXGLAABBReset;
+		}
+
+		PKQuadParticleDirectQuadMake(vertex, particle, halfSize, matrix, &aabb);
+
+		vertex += 6;
+		usedCount += 6;
+	}
+
+	if (vertex != NULL)
+		PXGLUsedTransformedVertices(usedCount, &aabb);
 }
 
 #ifdef PKQuadRendererUseStrip
@@ -429,6 +565,21 @@ PXInline PKQuadParticleLinkedQuad PKQuadParticleLinkedQuadMake(PKParticle *parti
 	glDrawElements(GL_TRIANGLES, drawCount, GL_UNSIGNED_SHORT, indices);
 #endif
 #else
+	[self setStateWithTextureData:textureData blendSource:blendSource blendDestination:blendDestination];
+
+#ifdef PKQuadRendererUseStrip
+	// Draw the quads!
+	PXGLDrawArrays(GL_TRIANGLE_STRIP, 1, drawCount);
+#else
+	PXGLDrawElements(GL_TRIANGLES, drawCount, GL_UNSIGNED_SHORT, indices);
+#endif
+#endif
+}
+
+- (void) setStateWithTextureData:(PXTextureData *)textureData
+					 blendSource:(unsigned short)blendSource
+				blendDestination:(unsigned short)blendDestination
+{
 	// Set the blend function
 	PXGLBlendFunc(blendSource, blendDestination);
 
@@ -451,14 +602,6 @@ PXInline PKQuadParticleLinkedQuad PKQuadParticleLinkedQuadMake(PKParticle *parti
 			textureData->_smoothingType = smoothingType;
 		}
 	}
-
-#ifdef PKQuadRendererUseStrip
-	// Draw the quads!
-	PXGLDrawArrays(GL_TRIANGLE_STRIP, 1, drawCount);
-#else
-	PXGLDrawElements(GL_TRIANGLES, drawCount, GL_UNSIGNED_SHORT, indices);
-#endif
-#endif
 }
 
 - (BOOL) isCapableOfRenderingGraphicOfType:(Class)graphicType
@@ -548,3 +691,96 @@ PXInline PKQuadParticleLinkedQuad PKQuadParticleLinkedQuadMake(PKParticle *parti
 
 	return retVal;
 }
+
+PXInline void PKQuadRendererSinCos(float radians, float *sinVal, float *cosVal)
+{
+	// The mask takes care of both wrapping and negative angles.
+	int index = (int)(radians * pkQuadRendererRadToIndex);
+
+	*sinVal = pkQuadRendererSinTable[index & PK_QUAD_RENDERER_SIN_TABLE_MASK];
+	*cosVal = pkQuadRendererSinTable[(index + PK_QUAD_RENDERER_SIN_TABLE_QUARTER) & PK_QUAD_RENDERER_SIN_TABLE_MASK];
+}
+
+PXInline void PKQuadParticleDirectVertexSet(PXGLColoredTextureVertex *vertex, GLfloat x, GLfloat y, GLubyte r, GLubyte g, GLubyte b, GLubyte a, GLfloat s, GLfloat t)
+{
+	vertex->x = x;
+	vertex->y = y;
+
+	vertex->r = r;
+	vertex->g = g;
+	vertex->b = b;
+	vertex->a = a;
+
+	vertex->s = s;
+	vertex->t = t;
+}
+
+PXInline void PKQuadParticleDirectQuadMake(PXGLColoredTextureVertex *vertex, PKParticle *particle, CGSize halfSize, const PXGLMatrix *matrix, PXGLAABB *aabb)
+{
+	GLfloat a = matrix->a;
+	GLfloat b = matrix->b;
+	GLfloat c = matrix->c;
+	GLfloat d = matrix->d;
+
+	GLfloat width_2  = halfSize.width  * particle->scaleX;
+	GLfloat height_2 = halfSize.height * particle->scaleY;
+
+	// The quad is defined by its center and two half axes, one along its width
+	// (u) and one along its height (v), all already in screen space.
+	GLfloat cx = particle->x * a + particle->y * c + matrix->tx;
+	GLfloat cy = particle->x * b + particle->y * d + matrix->ty;
+
+	GLfloat ux;
+	GLfloat uy;
+	GLfloat vx;
+	GLfloat vy;
+
+	// Most particles are never rotated, so the rotation math is skipped for
+	// them.
+	if (!PXMathIsZero(particle->rotation))
+	{
+		GLfloat sinVal;
+		GLfloat cosVal;
+
+		PKQuadRendererSinCos(particle->rotation, &sinVal, &cosVal);
+
+		GLfloat lux =  width_2  * cosVal;
+		GLfloat luy =  width_2  * sinVal;
+		GLfloat lvx = -height_2 * sinVal;
+		GLfloat lvy =  height_2 * cosVal;
+
+		ux = lux * a + luy * c;
+		uy = lux * b + luy * d;
+		vx = lvx * a + lvy * c;
+		vy = lvx * b + lvy * d;
+	}
+	else
+	{
+		ux = width_2 * a;
+		uy = width_2 * b;
+		vx = height_2 * c;
+		vy = height_2 * d;
+	}
+
+	GLubyte r = particle->r;
+	GLubyte g = particle->g;
+	GLubyte bl = particle->b;
+	GLubyte al = particle->a;
+
+	// Top left, repeated to link to the previous quad.
+	PKQuadParticleDirectVertexSet(vertex + 0, cx - ux - vx, cy - uy - vy, r, g, bl, al, particle->sMin, particle->tMin);
+	vertex[1] = vertex[0];
+	// Bottom left
+	PKQuadParticleDirectVertexSet(vertex + 2, cx - ux + vx, cy - uy + vy, r, g, bl, al, particle->sMin, particle->tMax);
+	// Top right
+	PKQuadParticleDirectVertexSet(vertex + 3, cx + ux - vx, cy + uy - vy, r, g, bl, al, particle->sMax, particle->tMin);
+	// Bottom right, repeated to link to the next quad.
+	PKQuadParticleDirectVertexSet(vertex + 4, cx + ux + vx, cy + uy + vy, r, g, bl, al, particle->sMax, particle->tMax);
+	vertex[5] = vertex[4];
+
+	GLfloat extentX = fabsf(ux) + fabsf(vx);
+	GLfloat extentY = fabsf(uy) + fabsf(vy);
+
+	PXGLAABBExpandv(aabb, cx - extentX, cy - extentY);
+	PXGLAABBExpandv(aabb, cx + extentX, cy + extentY);
+}
@@ -41,12 +41,41 @@
 
 #include "Box2D.h"
 #include "PXGL.h"
+#include "PXEngine.h"
+#include "PXGLUtils.h"
+#include "PXPrivateUtils.h"
+
+#define PK_B2_DEBUG_DRAW_CIRCLE_SEGMENTS 16
+// The indices handed to PXGLDrawElements are shorts.
+#define PK_B2_DEBUG_DRAW_MAX_VERTICES 0xFFFF
+
+// A growing list of colored vertices and the indices that join them into
+// primitives.
+typedef struct
+{
+	GLfloat *vertices;
+	GLubyte *colors;
+	unsigned vertexCount;
+	unsigned maxVertexCount;
+
+	GLushort *indices;
+	unsigned indexCount;
+	unsigned maxIndexCount;
+} PKB2DebugDrawBatch;
 
 // This class implements debug drawing callbacks that are invoked inside
-// b2World::Step.
+// b2World::DrawDebugData. Rather than drawing each shape as it comes, all of
+// them are gathered into a triangle list and a line list, which are drawn
+// with one call each in End. Shapes outside of the view are skipped.
 class PKB2DebugDraw : public b2DebugDraw
 {
 public:
+	PKB2DebugDraw();
+	~PKB2DebugDraw();
+
+	void Begin();
+	void End();
+
 	void DrawPolygon(const b2Vec2* vertices, int32 vertexCount, const b2Color& color);
 	void DrawSolidPolygon(const b2Vec2* vertices, int32 vertexCount, const b2Color& color);
 	void DrawCircle(const b2Vec2& center, float32 radius, const b2Color& color);
@@ -55,86 +84,275 @@ public:
 	void DrawTransform(const b2Transform& xf);
 private:
 	void setGLState( );
+	void flush( );
+
+	bool isVisible(const b2Vec2* vertices, int32 vertexCount);
+	bool isCircleVisible(const b2Vec2& center, float32 radius);
+
+	unsigned addVertices(PKB2DebugDrawBatch *batch, const b2Vec2* vertices, int32 vertexCount, const b2Color& color, float32 alpha);
+	unsigned addCircleVertices(PKB2DebugDrawBatch *batch, const b2Vec2& center, float32 radius, const b2Color& color, float32 alpha);
+	GLushort *askForIndices(PKB2DebugDrawBatch *batch, unsigned count);
+	void addLoopIndices(unsigned first, int32 vertexCount);
+	void addFanIndices(unsigned first, int32 vertexCount);
+
+	PKB2DebugDrawBatch triangles;
+	PKB2DebugDrawBatch lines;
+
+	// The view in world coordinates.
+	PXGLAABBf viewAABB;
+
+	b2Vec2 unitCircle[PK_B2_DEBUG_DRAW_CIRCLE_SEGMENTS];
 };
 
+PKB2DebugDraw::PKB2DebugDraw()
+{
+	memset(&triangles, 0, sizeof(PKB2DebugDrawBatch));
+	memset(&lines, 0, sizeof(PKB2DebugDrawBatch));
+
+	viewAABB = PXGLAABBfMake(-MAXFLOAT, -MAXFLOAT, MAXFLOAT, MAXFLOAT);
+
+	// Every circle is this template scaled and moved into place.
+	const float32 k_increment = 2.0f * b2_pi / PK_B2_DEBUG_DRAW_CIRCLE_SEGMENTS;
+	for (int32 i = 0; i < PK_B2_DEBUG_DRAW_CIRCLE_SEGMENTS; ++i)
+	{
+		unitCircle[i].Set(cosf(i * k_increment), sinf(i * k_increment));
+	}
+}
+
+PKB2DebugDraw::~PKB2DebugDraw()
+{
+	PKB2DebugDrawBatch *batches[] = {&triangles, &lines};
+
+	for (int i = 0; i < 2; ++i)
+	{
+		free(batches[i]->vertices);
+		free(batches[i]->colors);
+		free(batches[i]->indices);
+	}
+}
+
 void PKB2DebugDraw::setGLState()
 {
 	PXGLDisable( GL_TEXTURE_2D );
 	PXGLDisableClientState( GL_TEXTURE_COORD_ARRAY );
-	PXGLDisableClientState( GL_COLOR_ARRAY );
+	PXGLEnableClientState( GL_COLOR_ARRAY );
 	PXGLDisableClientState( GL_POINT_SIZE_ARRAY_OES );
 }
 
-void PKB2DebugDraw::DrawPolygon(const b2Vec2* vertices, int32 vertexCount, const b2Color& color)
+void PKB2DebugDraw::Begin()
 {
-	setGLState();
+	triangles.vertexCount = 0;
+	triangles.indexCount = 0;
+	lines.vertexCount = 0;
+	lines.indexCount = 0;
+
+	// Find the view in world coordinates, by taking it through the inverse
+	// of the matrix the vertices are about to be drawn with.
+	PXGLMatrix matrix = *PXGLGetCurrentMatrix();
+	PXGLMatrixInvert(&matrix);
+
+	viewAABB = PXGLAABBfMake(0.0f, 0.0f, PXEngineGetViewWidth(), PXEngineGetViewHeight());
+	viewAABB = PXGLMatrixConvertAABBf(&matrix, viewAABB);
+}
 
-	PXGLColor4f(color.r, color.g, color.b,1);
-	PXGLVertexPointer(2, GL_FLOAT, 0, vertices);
-	PXGLDrawArrays(GL_LINE_LOOP, 0, vertexCount);
+void PKB2DebugDraw::End()
+{
+	flush();
 }
 
-void PKB2DebugDraw::DrawSolidPolygon(const b2Vec2* vertices, int32 vertexCount, const b2Color& color)
+void PKB2DebugDraw::flush()
 {
+	if (triangles.indexCount == 0 && lines.indexCount == 0)
+	{
+		return;
+	}
+
 	setGLState();
 
-	PXGLVertexPointer(2, GL_FLOAT, 0, vertices);
+	if (triangles.indexCount > 0)
+	{
+		PXGLVertexPointer(2, GL_FLOAT, 0, triangles.vertices);
+		PXGLColorPointer(4, GL_UNSIGNED_BYTE, 0, triangles.colors);
+		PXGLDrawElements(GL_TRIANGLES, triangles.indexCount, GL_UNSIGNED_SHORT, triangles.indices);
+	}
 
-	PXGLColor4f(color.r, color.g, color.b,0.5f);
-	PXGLDrawArrays(GL_TRIANGLE_FAN, 0, vertexCount);
+	// The outlines go over the fills.
+	if (lines.indexCount > 0)
+	{
+		PXGLVertexPointer(2, GL_FLOAT, 0, lines.vertices);
+		PXGLColorPointer(4, GL_UNSIGNED_BYTE, 0, lines.colors);
+		PXGLDrawElements(GL_LINES, lines.indexCount, GL_UNSIGNED_SHORT, lines.indices);
+	}
 
-	PXGLColor4f(color.r, color.g, color.b,1);
-	PXGLDrawArrays(GL_LINE_LOOP, 0, vertexCount);
+	triangles.vertexCount = 0;
+	triangles.indexCount = 0;
+	lines.vertexCount = 0;
+	lines.indexCount = 0;
 }
 
-void PKB2DebugDraw::DrawCircle(const b2Vec2& center, float32 radius, const b2Color& color)
+bool PKB2DebugDraw::isVisible(const b2Vec2* vertices, int32 vertexCount)
 {
-	const float32 k_segments = 16.0f;
-	int vertexCount=16;
-	const float32 k_increment = 2.0f * b2_pi / k_segments;
-	float32 theta = 0.0f;
+	PXGLAABBf aabb = PXGLAABBfReset;
 
-	GLfloat glVertices[vertexCount*2];
+	for (int32 i = 0; i < vertexCount; ++i)
+	{
+		PXGLAABBfExpandv(&aabb, vertices[i].x, vertices[i].y);
+	}
 
-	for (int32 i = 0; i < k_segments; ++i)
+	return !(aabb.xMin > viewAABB.xMax || aabb.xMax < viewAABB.xMin ||
+	         aabb.yMin > viewAABB.yMax || aabb.yMax < viewAABB.yMin);
+}
+
+bool PKB2DebugDraw::isCircleVisible(const b2Vec2& center, float32 radius)
+{
+	return !(center.x - radius > viewAABB.xMax || center.x + radius < viewAABB.xMin ||
+	         center.y - radius > viewAABB.yMax || center.y + radius < viewAABB.yMin);
+}
+
+// Returns the index of the first vertex added.
+unsigned PKB2DebugDraw::addVertices(PKB2DebugDrawBatch *batch, const b2Vec2* vertices, int32 vertexCount, const b2Color& color, float32 alpha)
+{
+	if (batch->vertexCount + vertexCount > PK_B2_DEBUG_DRAW_MAX_VERTICES)
 	{
-		b2Vec2 v = center + radius * b2Vec2(cosf(theta), sinf(theta));
-		glVertices[i*2]=v.x;
-		glVertices[i*2+1]=v.y;
-		theta += k_increment;
+		// Too many to index with shorts, draw what we have and start over.
+		flush();
 	}
 
-	setGLState( );
+	if (batch->vertexCount + vertexCount > batch->maxVertexCount)
+	{
+		batch->maxVertexCount = b2Max(batch->maxVertexCount << 1, batch->vertexCount + vertexCount);
+		batch->vertices = (GLfloat *)realloc(batch->vertices, sizeof(GLfloat) * 2 * batch->maxVertexCount);
+		batch->colors = (GLubyte *)realloc(batch->colors, sizeof(GLubyte) * 4 * batch->maxVertexCount);
+	}
+
+	unsigned first = batch->vertexCount;
+
+	GLfloat *vertex = batch->vertices + first * 2;
+	GLubyte *vertexColor = batch->colors + first * 4;
 
-	PXGLColor4f(color.r, color.g, color.b,1);
-	PXGLVertexPointer(2, GL_FLOAT, 0, glVertices);
+	GLubyte red   = PX_COLOR_FLOAT_TO_BYTE(color.r);
+	GLubyte green = PX_COLOR_FLOAT_TO_BYTE(color.g);
+	GLubyte blue  = PX_COLOR_FLOAT_TO_BYTE(color.b);
+	GLubyte alphaByte = PX_COLOR_FLOAT_TO_BYTE(alpha);
 
-	PXGLDrawArrays(GL_TRIANGLE_FAN, 0, vertexCount);
+	for (int32 i = 0; i < vertexCount; ++i, vertex += 2, vertexColor += 4)
+	{
+		vertex[0] = vertices[i].x;
+		vertex[1] = vertices[i].y;
+
+		vertexColor[0] = red;
+		vertexColor[1] = green;
+		vertexColor[2] = blue;
+		vertexColor[3] = alphaByte;
+	}
+
+	batch->vertexCount += vertexCount;
+
+	return first;
 }
 
-void PKB2DebugDraw::DrawSolidCircle(const b2Vec2& center, float32 radius, const b2Vec2& axis, const b2Color& color)
+unsigned PKB2DebugDraw::addCircleVertices(PKB2DebugDrawBatch *batch, const b2Vec2& center, float32 radius, const b2Color& color, float32 alpha)
 {
-	const float32 k_segments = 16.0f;
-	int vertexCount=16;
-	const float32 k_increment = 2.0f * b2_pi / k_segments;
-	float32 theta = 0.0f;
+	b2Vec2 vertices[PK_B2_DEBUG_DRAW_CIRCLE_SEGMENTS];
 
-	GLfloat glVertices[vertexCount*2];
-	for (int32 i = 0; i < k_segments; ++i)
+	for (int32 i = 0; i < PK_B2_DEBUG_DRAW_CIRCLE_SEGMENTS; ++i)
 	{
-		b2Vec2 v = center + radius * b2Vec2(cosf(theta), sinf(theta));
-		glVertices[i*2]=v.x;
-		glVertices[i*2+1]=v.y;
-		theta += k_increment;
+		vertices[i] = center + radius * unitCircle[i];
 	}
 
-	setGLState();
+	return addVertices(batch, vertices, PK_B2_DEBUG_DRAW_CIRCLE_SEGMENTS, color, alpha);
+}
+
+GLushort *PKB2DebugDraw::askForIndices(PKB2DebugDrawBatch *batch, unsigned count)
+{
+	if (batch->indexCount + count > batch->maxIndexCount)
+	{
+		batch->maxIndexCount = b2Max(batch->maxIndexCount << 1, batch->indexCount + count);
+		batch->indices = (GLushort *)realloc(batch->indices, sizeof(GLushort) * batch->maxIndexCount);
+	}
+
+	GLushort *indices = batch->indices + batch->indexCount;
+	batch->indexCount += count;
+
+	return indices;
+}
+
+void PKB2DebugDraw::addLoopIndices(unsigned first, int32 vertexCount)
+{
+	GLushort *index = askForIndices(&lines, vertexCount * 2);
+
+	for (int32 i = 0; i < vertexCount; ++i)
+	{
+		*(index++) = first + i;
+		*(index++) = first + ((i + 1) % vertexCount);
+	}
+}
+
+void PKB2DebugDraw::addFanIndices(unsigned first, int32 vertexCount)
+{
+	if (vertexCount < 3)
+	{
+		return;
+	}
+
+	GLushort *index = askForIndices(&triangles, (vertexCount - 2) * 3);
+
+	for (int32 i = 1; i < vertexCount - 1; ++i)
+	{
+		*(index++) = first;
+		*(index++) = first + i;
+		*(index++) = first + i + 1;
+	}
+}
 
-	PXGLColor4f(color.r, color.g, color.b,0.5f);
-	PXGLVertexPointer(2, GL_FLOAT, 0, glVertices);
-	PXGLDrawArrays(GL_TRIANGLE_FAN, 0, vertexCount);
-	PXGLColor4f(color.r, color.g, color.b,1);
-	PXGLDrawArrays(GL_LINE_LOOP, 0, vertexCount);
+void PKB2DebugDraw::DrawPolygon(const b2Vec2* vertices, int32 vertexCount, const b2Color& color)
+{
+	if (!isVisible(vertices, vertexCount))
+	{
+		return;
+	}
+
+	unsigned first = addVertices(&lines, vertices, vertexCount, color, 1.0f);
+	addLoopIndices(first, vertexCount);
+}
+
+void PKB2DebugDraw::DrawSolidPolygon(const b2Vec2* vertices, int32 vertexCount, const b2Color& color)
+{
+	if (!isVisible(vertices, vertexCount))
+	{
+		return;
+	}
+
+	unsigned first = addVertices(&triangles, vertices, vertexCount, color, 0.5f);
+	addFanIndices(first, vertexCount);
+
+	first = addVertices(&lines, vertices, vertexCount, color, 1.0f);
+	addLoopIndices(first, vertexCount);
+}
+
+void PKB2DebugDraw::DrawCircle(const b2Vec2& center, float32 radius, const b2Color& color)
+{
+	if (!isCircleVisible(center, radius))
+	{
+		return;
+	}
+
+	unsigned first = addCircleVertices(&lines, center, radius, color, 1.0f);
+	addLoopIndices(first, PK_B2_DEBUG_DRAW_CIRCLE_SEGMENTS);
+}
+
+void PKB2DebugDraw::DrawSolidCircle(const b2Vec2& center, float32 radius, const b2Vec2& axis, const b2Color& color)
+{
+	if (!isCircleVisible(center, radius))
+	{
+		return;
+	}
+
+	unsigned first = addCircleVertices(&triangles, center, radius, color, 0.5f);
+	addFanIndices(first, PK_B2_DEBUG_DRAW_CIRCLE_SEGMENTS);
+
+	first = addCircleVertices(&lines, center, radius, color, 1.0f);
+	addLoopIndices(first, PK_B2_DEBUG_DRAW_CIRCLE_SEGMENTS);
 
 	// Draw the axis line
 	DrawSegment(center,center+radius*axis,color);
@@ -142,17 +360,13 @@ void PKB2DebugDraw::DrawSolidCircle(const b2Vec2& center, float32 radius, const
 
 void PKB2DebugDraw::DrawSegment(const b2Vec2& p1, const b2Vec2& p2, const b2Color& color)
 {
-	setGLState();
-
-	GLfloat	glVertices[] =
-	{
-		p1.x,p1.y,p2.x,p2.y
-	};
+	b2Vec2 vertices[] = {p1, p2};
 
-	PXGLColor4f(color.r, color.g, color.b,1);
+	unsigned first = addVertices(&lines, vertices, 2, color, 1.0f);
 
-	PXGLVertexPointer(2, GL_FLOAT, 0, glVertices);
-	PXGLDrawArrays(GL_LINES, 0, 2);
+	GLushort *index = askForIndices(&lines, 2);
+	index[0] = first;
+	index[1] = first + 1;
 }
 
 void PKB2DebugDraw::DrawTransform(const b2Transform& xf)
@@ -291,7 +505,9 @@ void PKB2DebugDraw::DrawTransform(const b2Transform& xf)
 {
 	if (physicsWorld)
 	{
+		debugDrawer->Begin();
 		physicsWorld->DrawDebugData();
+		debugDrawer->End();
 	}
 }
 
@@ -0,0 +1,88 @@
+/*
+ *  _____                       ___                                            
+ * /\  _ `\  __                /\_ \                                           
+ * \ \ \L\ \/\_\   __  _    ___\//\ \    __  __  __    ___     __  __    ___   
+ *  \ \  __/\/\ \ /\ \/ \  / __`\\ \ \  /\ \/\ \/\ \  / __`\  /\ \/\ \  / __`\ 
+ *   \ \ \/  \ \ \\/>  </ /\  __/ \_\ \_\ \ \_/ \_/ \/\ \L\ \_\ \ \_/ |/\  __/ 
+ *    \ \_\   \ \_\/\_/\_\\ \____\/\____\\ \___^___ /\ \__/|\_\\ \___/ \ \____\
+ *     \/_/    \/_/\//\/_/ \/____/\/____/ \/__//__ /  \/__/\/_/ \/__/   \/____/
+ *       
+ *           www.pixelwave.org + www.spiralstormgames.com
+ *                            ~;   
+ *                           ,/|\.           
+ *                         ,/  |\ \.                 Core Team: Oz Michaeli
+ *                       ,/    | |  \                           John Lattin
+ *                     ,/      | |   |
+ *                   ,/        |/    |
+ *                 ./__________|----'  .
+ *            ,(   ___.....-,~-''-----/   ,(            ,~            ,(        
+ * _.-~-.,.-'`  `_.\,.',.-'`  )_.-~-./.-'`  `_._,.',.-'`  )_.-~-.,.-'`  `_._._,.
+ * 
+ * Copyright (c) 2011 Spiralstorm Games http://www.spiralstormgames.com
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+#ifndef _PK_BOX_2D_PROFILE_LAYER_H_
+#define _PK_BOX_2D_PROFILE_LAYER_H_
+
+#import "Pixelwave.h"
+
+class b2World;
+struct b2Profile;
+
+/**
+ * Shows where the time of b2World::Step goes, from b2World::GetProfile. The
+ * profile is sampled every frame and the slowest step of each update
+ * interval is shown, so a frame spike can be tied to a phase of the step.
+ * Place it on top of a PKBox2DDebugLayer or anywhere on the stage.
+ */
+@interface PKBox2DProfileLayer : PXDisplayObjectContainer
+{
+@private
+	b2World *physicsWorld;
+
+	PXTextField **textFields;
+	unsigned textFieldCount;
+
+	b2Profile *peakProfile;
+	BOOL peakProfileShown;
+	unsigned frameCount;
+	unsigned updateInterval;
+}
+
+@property (nonatomic, assign) b2World *physicsWorld;
+
+/**
+ * The number of frames between updates of the text. The slowest step of those
+ * frames is shown.
+ *
+ * **Default:** 30
+ */
+@property (nonatomic) unsigned updateInterval;
+
+/**
+ * The profile currently shown, NULL until the first update.
+ */
+@property (nonatomic, readonly) const b2Profile *peakProfile;
+
+- (id) initWithPhysicsWorld:(b2World *)physicsWorld;
+
++ (PKBox2DProfileLayer *)box2DProfileLayerWithPhysicsWorld:(b2World *)physicsWorld;
+
+@end
+
+#endif
@@ -0,0 +1,244 @@
+/*
+ *  _____                       ___                                            
+ * /\  _ `\  __                /\_ \                                           
+ * \ \ \L\ \/\_\   __  _    ___\//\ \    __  __  __    ___     __  __    ___   
+ *  \ \  __/\/\ \ /\ \/ \  / __`\\ \ \  /\ \/\ \/\ \  / __`\  /\ \/\ \  / __`\ 
+ *   \ \ \/  \ \ \\/>  </ /\  __/ \_\ \_\ \ \_/ \_/ \/\ \L\ \_\ \ \_/ |/\  __/ 
+ *    \ \_\   \ \_\/\_/\_\\ \____\/\____\\ \___^___ /\ \__/|\_\\ \___/ \ \____\
+ *     \/_/    \/_/\//\/_/ \/____/\/____/ \/__//__ /  \/__/\/_/ \/__/   \/____/
+ *       
+ *           www.pixelwave.org + www.spiralstormgames.com
+ *                            ~;   
+ *                           ,/|\.           
+ *                         ,/  |\ \.                 Core Team: Oz Michaeli
+ *                       ,/    | |  \                           John Lattin
+ *                     ,/      | |   |
+ *                   ,/        |/    |
+ *                 ./__________|----'  .
+ *            ,(   ___.....-,~-''-----/   ,(            ,~            ,(        
+ * _.-~-.,.-'`  `_.\,.',.-'`  )_.-~-./.-'`  `_._,.',.-'`  )_.-~-.,.-'`  `_._._,.
+ * 
+ * Copyright (c) 2011 Spiralstorm Games http://www.spiralstormgames.com
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+
+#import "PKBox2DProfileLayer.h"
+
+#include "Box2D.h"
+#include <stddef.h>
+
+typedef enum
+{
+	PKBox2DProfileRowType_Time = 0,
+	PKBox2DProfileRowType_Count,
+	PKBox2DProfileRowType_Bytes
+} PKBox2DProfileRowType;
+
+typedef struct
+{
+	NSString *label;
+	size_t offset;
+	PKBox2DProfileRowType type;
+} PKBox2DProfileRow;
+
+// One text field per row, the system font renderer draws a single line. The
+// indentation follows how the times nest.
+static const PKBox2DProfileRow pkBox2DProfileRows[] =
+{
+	{@"Step        ", offsetof(b2Profile, step), PKBox2DProfileRowType_Time},
+	{@" Collide    ", offsetof(b2Profile, collide), PKBox2DProfileRowType_Time},
+	{@" Solve      ", offsetof(b2Profile, solve), PKBox2DProfileRowType_Time},
+	{@"  Islands   ", offsetof(b2Profile, buildIslands), PKBox2DProfileRowType_Time},
+	{@"  Init      ", offsetof(b2Profile, solveInit), PKBox2DProfileRowType_Time},
+	{@"  Velocity  ", offsetof(b2Profile, solveVelocity), PKBox2DProfileRowType_Time},
+	{@"  Position  ", offsetof(b2Profile, solvePosition), PKBox2DProfileRowType_Time},
+	{@"  Sync      ", offsetof(b2Profile, synchronizeFixtures), PKBox2DProfileRowType_Time},
+	{@" TOI        ", offsetof(b2Profile, solveTOI), PKBox2DProfileRowType_Time},
+	{@"Broad-phase ", offsetof(b2Profile, findNewContacts), PKBox2DProfileRowType_Time},
+	{@"Pairs       ", offsetof(b2Profile, pairCount), PKBox2DProfileRowType_Count},
+	{@"Contacts    ", offsetof(b2Profile, contactCount), PKBox2DProfileRowType_Count},
+	{@"Islands     ", offsetof(b2Profile, islandCount), PKBox2DProfileRowType_Count},
+	{@"Awake       ", offsetof(b2Profile, awakeBodyCount), PKBox2DProfileRowType_Count},
+	{@"Stack peak  ", offsetof(b2Profile, stackPeakBytes), PKBox2DProfileRowType_Bytes},
+	{@"Block peak  ", offsetof(b2Profile, blockPeakBytes), PKBox2DProfileRowType_Bytes}
+};
+
+static const unsigned pkBox2DProfileRowCount = sizeof(pkBox2DProfileRows) / sizeof(PKBox2DProfileRow);
+
+@interface PKBox2DProfileLayer(Private)
+- (void) onEnterFrame;
+- (void) updateTextFields;
+@end
+
+@implementation PKBox2DProfileLayer
+
+@synthesize physicsWorld, updateInterval;
+
+- (id) init
+{
+	return [self initWithPhysicsWorld:NULL];
+}
+
+- (id) initWithPhysicsWorld:(b2World *)_physicsWorld
+{
+	self = [super init];
+
+	if (self)
+	{
+		physicsWorld = _physicsWorld;
+
+		peakProfile = new b2Profile();
+		peakProfileShown = NO;
+		frameCount = 0;
+		updateInterval = 30;
+
+		// The first row is the title.
+		textFieldCount = pkBox2DProfileRowCount + 1;
+		textFields = (PXTextField **)malloc(sizeof(PXTextField *) * textFieldCount);
+
+		const float fontSize = 10.0f;
+
+		unsigned index;
+		PXTextField *textField;
+
+		for (index = 0; index < textFieldCount; ++index)
+		{
+			textField = [[PXTextField alloc] initWithFont:@"Courier"];
+			textField.fontSize = fontSize;
+			textField.textColor = 0xFFFFFF;
+			textField.background = YES;
+			textField.backgroundColor = 0x000000;
+			textField.backgroundAlpha = 0.6f;
+			textField.touchEnabled = NO;
+			textField.y = index * (fontSize + 2.0f);
+
+			[self addChild:textField];
+			[textField release];
+
+			textFields[index] = textField;
+		}
+
+		textFields[0].text = @"Box2D";
+
+		self.touchChildren = NO;
+
+		[self addEventListenerOfType:PXEvent_EnterFrame listener:PXListener(onEnterFrame)];
+	}
+
+	return self;
+}
+
+- (void) dealloc
+{
+	[self removeEventListenerOfType:PXEvent_EnterFrame listener:PXListener(onEnterFrame)];
+
+	// The text fields are retained by the display list.
+	free(textFields);
+	textFields = NULL;
+
+	delete peakProfile;
+	peakProfile = NULL;
+
+	[super dealloc];
+}
+
+- (void) setPhysicsWorld:(b2World *)_physicsWorld
+{
+	physicsWorld = _physicsWorld;
+	frameCount = 0;
+}
+
+- (void) setUpdateInterval:(unsigned)val
+{
+	updateInterval = MAX(val, 1);
+}
+
+- (const b2Profile *)peakProfile
+{
+	if (peakProfileShown)
+	{
+		return peakProfile;
+	}
+
+	return NULL;
+}
+
+- (void) onEnterFrame
+{
+	if (!physicsWorld)
+	{
+		return;
+	}
+
+	// Keep the slowest step of the interval. If the world isn't stepped every
+	// frame the same step may be sampled more than once, which is harmless.
+	const b2Profile &profile = physicsWorld->GetProfile();
+
+	if (frameCount == 0 || profile.step > peakProfile->step)
+	{
+		*peakProfile = profile;
+	}
+
+	++frameCount;
+
+	if (frameCount >= updateInterval)
+	{
+		[self updateTextFields];
+		frameCount = 0;
+	}
+}
+
+- (void) updateTextFields
+{
+	const char *profileBytes = (const char *)peakProfile;
+
+	unsigned index;
+	const PKBox2DProfileRow *row;
+	NSString *value;
+
+	for (index = 0; index < pkBox2DProfileRowCount; ++index)
+	{
+		row = pkBox2DProfileRows + index;
+
+		switch (row->type)
+		{
+			case PKBox2DProfileRowType_Time:
+				value = [NSString stringWithFormat:@"%7.2f ms", *((const float32 *)(profileBytes + row->offset))];
+				break;
+			case PKBox2DProfileRowType_Count:
+				value = [NSString stringWithFormat:@"%7d", *((const int32 *)(profileBytes + row->offset))];
+				break;
+			case PKBox2DProfileRowType_Bytes:
+				value = [NSString stringWithFormat:@"%7d KB", *((const int32 *)(profileBytes + row->offset)) / 1024];
+				break;
+			default:
+				value = @"";
+				break;
+		}
+
+		textFields[index + 1].text = [row->label stringByAppendingString:value];
+	}
+
+	peakProfileShown = YES;
+}
+
++ (PKBox2DProfileLayer *)box2DProfileLayerWithPhysicsWorld:(b2World *)physicsWorld
+{
+	return [[[PKBox2DProfileLayer alloc] initWithPhysicsWorld:physicsWorld] autorelease];
+}
+
+@end
@@ -0,0 +1,719 @@
+/*
+* Copyright (c) 2011 Spiralstorm Games http://www.spiralstormgames.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+// A headless benchmark for the bundled Box2D. Each scene is stepped for a
+// fixed number of frames at 60Hz and reports the step times, the allocator
+// traffic and a checksum of the final state. Equal checksums mean bit for bit
+// equal simulations, so this checks determinism as well as speed.
+//
+// Build and run from this directory, on Linux or Mac OS X:
+//
+//   g++ -O2 -pthread $(find ../Box2D -type d | sed 's/^/-I/')
+//       Benchmark.cpp $(find ../Box2D -name '*.cpp') -o benchmark
+//
+// (on one line).
+//   ./benchmark [-threads n] [-frames n] [-simd] [-verify] [scene...]
+//
+// -threads n  step the worlds with a b2ThreadPool of n threads
+// -frames n   the number of steps per scene, the default is 600
+// -simd       use the SIMD contact solver
+// -verify     also run each scene without a thread pool and compare
+//
+// The scenes are pyramid, tumbler, ragdolls, tiles and bullets, all of them
+// are run by default.
+
+#include "Box2D.h"
+
+#include <pthread.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+const float32 k_timeStep = 1.0f / 60.0f;
+const int32 k_velocityIterations = 8;
+const int32 k_positionIterations = 3;
+
+// Counts what the world's allocators ask for. It is called from the pool's
+// threads too, hence the lock.
+class CountingArena : public b2MemoryArena
+{
+public:
+	CountingArena()
+	{
+		pthread_mutex_init(&m_mutex, NULL);
+		Clear();
+	}
+
+	~CountingArena()
+	{
+		pthread_mutex_destroy(&m_mutex);
+	}
+
+	void* Allocate(int32 size)
+	{
+		pthread_mutex_lock(&m_mutex);
+		++m_allocationCount;
+		m_allocationBytes += size;
+		pthread_mutex_unlock(&m_mutex);
+		return malloc(size);
+	}
+
+	void Free(void* mem, int32 size)
+	{
+		B2_NOT_USED(size);
+		free(mem);
+	}
+
+	void Clear()
+	{
+		m_allocationCount = 0;
+		m_allocationBytes = 0;
+	}
+
+	int32 m_allocationCount;
+	long long m_allocationBytes;
+
+private:
+	pthread_mutex_t m_mutex;
+};
+
+// A scene builds its bodies in Create and may add more as it is stepped.
+class Scene
+{
+public:
+	virtual ~Scene() {}
+	virtual const char* GetName() const = 0;
+	virtual void Create(b2World* world) = 0;
+	virtual void Step(b2World* world, int32 frame)
+	{
+		B2_NOT_USED(world);
+		B2_NOT_USED(frame);
+	}
+};
+
+static b2Body* CreateGround(b2World* world, float32 halfWidth)
+{
+	b2BodyDef bd;
+	b2Body* ground = world->CreateBody(&bd);
+
+	b2EdgeShape shape;
+	shape.Set(b2Vec2(-halfWidth, 0.0f), b2Vec2(halfWidth, 0.0f));
+	ground->CreateFixture(&shape, 0.0f);
+
+	return ground;
+}
+
+// A pyramid of boxes, 30 at the base. This is mostly contact solving.
+class PyramidScene : public Scene
+{
+public:
+	const char* GetName() const { return "pyramid"; }
+
+	void Create(b2World* world)
+	{
+		CreateGround(world, 60.0f);
+
+		const int32 baseCount = 30;
+		const float32 a = 0.5f;
+
+		b2PolygonShape shape;
+		shape.SetAsBox(a, a);
+
+		b2Vec2 x(-(baseCount - 1) * 0.5625f, 0.75f);
+		b2Vec2 deltaX(0.5625f, 1.25f);
+		b2Vec2 deltaY(1.125f, 0.0f);
+
+		for (int32 i = 0; i < baseCount; ++i)
+		{
+			b2Vec2 y = x;
+
+			for (int32 j = i; j < baseCount; ++j)
+			{
+				b2BodyDef bd;
+				bd.type = b2_dynamicBody;
+				bd.position = y;
+				b2Body* body = world->CreateBody(&bd);
+				body->CreateFixture(&shape, 5.0f);
+
+				y += deltaY;
+			}
+
+			x += deltaX;
+		}
+	}
+};
+
+// A motorized box that keeps tumbling small bodies, which never sleep.
+class TumblerScene : public Scene
+{
+public:
+	const char* GetName() const { return "tumbler"; }
+
+	void Create(b2World* world)
+	{
+		b2BodyDef gd;
+		b2Body* ground = world->CreateBody(&gd);
+
+		b2BodyDef bd;
+		bd.type = b2_dynamicBody;
+		bd.allowSleep = false;
+		bd.position.Set(0.0f, 10.0f);
+		b2Body* body = world->CreateBody(&bd);
+
+		b2PolygonShape shape;
+		shape.SetAsBox(0.5f, 10.0f, b2Vec2( 10.0f, 0.0f), 0.0f);
+		body->CreateFixture(&shape, 5.0f);
+		shape.SetAsBox(0.5f, 10.0f, b2Vec2(-10.0f, 0.0f), 0.0f);
+		body->CreateFixture(&shape, 5.0f);
+		shape.SetAsBox(10.0f, 0.5f, b2Vec2(0.0f, 10.0f), 0.0f);
+		body->CreateFixture(&shape, 5.0f);
+		shape.SetAsBox(10.0f, 0.5f, b2Vec2(0.0f, -10.0f), 0.0f);
+		body->CreateFixture(&shape, 5.0f);
+
+		b2RevoluteJointDef jd;
+		jd.Initialize(ground, body, b2Vec2(0.0f, 10.0f));
+		jd.motorSpeed = 0.05f * b2_pi;
+		jd.maxMotorTorque = 1e8f;
+		jd.enableMotor = true;
+		world->CreateJoint(&jd);
+	}
+
+	void Step(b2World* world, int32 frame)
+	{
+		// Pour in a body every other frame, up to 600 of them.
+		if (frame % 2 != 0 || frame >= 1200)
+		{
+			return;
+		}
+
+		b2BodyDef bd;
+		bd.type = b2_dynamicBody;
+		bd.position.Set(-5.0f + (frame % 20) * 0.5f, 15.0f);
+		b2Body* body = world->CreateBody(&bd);
+
+		if (frame % 4 == 0)
+		{
+			b2PolygonShape shape;
+			shape.SetAsBox(0.125f, 0.125f);
+			body->CreateFixture(&shape, 1.0f);
+		}
+		else
+		{
+			b2CircleShape shape;
+			shape.m_radius = 0.15f;
+			body->CreateFixture(&shape, 1.0f);
+		}
+	}
+};
+
+// Ragdolls made of revolute joint chains with limits, dropped in a heap.
+class RagdollScene : public Scene
+{
+public:
+	const char* GetName() const { return "ragdolls"; }
+
+	void Create(b2World* world)
+	{
+		CreateGround(world, 60.0f);
+
+		for (int32 i = 0; i < 60; ++i)
+		{
+			b2Vec2 position(-30.0f + (i % 12) * 5.0f, 4.0f + (i / 12) * 6.0f);
+			CreateRagdoll(world, position);
+		}
+	}
+
+private:
+
+	b2Body* CreatePart(b2World* world, const b2Vec2& center, float32 hx, float32 hy)
+	{
+		b2BodyDef bd;
+		bd.type = b2_dynamicBody;
+		bd.position = center;
+		b2Body* body = world->CreateBody(&bd);
+
+		b2PolygonShape shape;
+		shape.SetAsBox(hx, hy);
+
+		b2FixtureDef fd;
+		fd.shape = &shape;
+		fd.density = 1.0f;
+		fd.friction = 0.4f;
+		// Parts of one ragdoll don't collide, the joints hold them together.
+		fd.filter.groupIndex = -1;
+		body->CreateFixture(&fd);
+
+		return body;
+	}
+
+	void Join(b2World* world, b2Body* bodyA, b2Body* bodyB, const b2Vec2& anchor, float32 lower, float32 upper)
+	{
+		b2RevoluteJointDef jd;
+		jd.Initialize(bodyA, bodyB, anchor);
+		jd.lowerAngle = lower;
+		jd.upperAngle = upper;
+		jd.enableLimit = true;
+		world->CreateJoint(&jd);
+	}
+
+	void CreateRagdoll(b2World* world, const b2Vec2& p)
+	{
+		b2Body* torso = CreatePart(world, p + b2Vec2(0.0f, 1.5f), 0.3f, 0.6f);
+		b2Body* head = CreatePart(world, p + b2Vec2(0.0f, 2.45f), 0.25f, 0.25f);
+		Join(world, torso, head, p + b2Vec2(0.0f, 2.15f), -0.5f, 0.5f);
+
+		for (int32 side = -1; side <= 1; side += 2)
+		{
+			b2Body* upperArm = CreatePart(world, p + b2Vec2(side * 0.65f, 1.9f), 0.35f, 0.1f);
+			Join(world, torso, upperArm, p + b2Vec2(side * 0.3f, 1.9f), -1.5f, 1.5f);
+			b2Body* lowerArm = CreatePart(world, p + b2Vec2(side * 1.3f, 1.9f), 0.3f, 0.08f);
+			Join(world, upperArm, lowerArm, p + b2Vec2(side * 1.0f, 1.9f), -1.5f, 0.0f);
+
+			b2Body* upperLeg = CreatePart(world, p + b2Vec2(side * 0.15f, 0.55f), 0.12f, 0.35f);
+			Join(world, torso, upperLeg, p + b2Vec2(side * 0.15f, 0.9f), -1.0f, 1.0f);
+			b2Body* lowerLeg = CreatePart(world, p + b2Vec2(side * 0.15f, -0.1f), 0.1f, 0.3f);
+			Join(world, upperLeg, lowerLeg, p + b2Vec2(side * 0.15f, 0.2f), 0.0f, 1.5f);
+		}
+	}
+};
+
+// A tile map level: the surfaces of solid tiles become edge shapes and each
+// floating platform a loop shape. Boxes and circles rain down on it.
+class TileScene : public Scene
+{
+public:
+	const char* GetName() const { return "tiles"; }
+
+	void Create(b2World* world)
+	{
+		const int32 width = 120;
+		const int32 height = 24;
+		const float32 tileSize = 1.0f;
+
+		// A rolling floor, the column heights of a repeating pattern.
+		int32 heights[width];
+		for (int32 i = 0; i < width; ++i)
+		{
+			heights[i] = 2 + (i * 7 % 11) / 4;
+		}
+
+		b2BodyDef bd;
+		b2Body* ground = world->CreateBody(&bd);
+
+		// The top of each column and the walls between columns of different
+		// heights. Hidden edges inside the solid tiles are left out.
+		b2EdgeShape edge;
+		float32 x0 = -0.5f * width * tileSize;
+		for (int32 i = 0; i < width; ++i)
+		{
+			float32 x = x0 + i * tileSize;
+			float32 y = heights[i] * tileSize;
+			edge.Set(b2Vec2(x, y), b2Vec2(x + tileSize, y));
+			ground->CreateFixture(&edge, 0.0f);
+
+			if (i + 1 < width && heights[i + 1] != heights[i])
+			{
+				float32 y2 = heights[i + 1] * tileSize;
+				edge.Set(b2Vec2(x + tileSize, y), b2Vec2(x + tileSize, y2));
+				ground->CreateFixture(&edge, 0.0f);
+			}
+		}
+
+		edge.Set(b2Vec2(x0, 0.0f), b2Vec2(x0, height * tileSize));
+		ground->CreateFixture(&edge, 0.0f);
+		edge.Set(b2Vec2(-x0, 0.0f), b2Vec2(-x0, height * tileSize));
+		ground->CreateFixture(&edge, 0.0f);
+
+		// Platforms of a few tiles. A loop shape doesn't copy its vertices, so
+		// they are kept for the life of the scene.
+		const int32 platformCount = 16;
+		m_vertices.resize(platformCount * 4);
+		for (int32 i = 0; i < platformCount; ++i)
+		{
+			float32 left = x0 + 4.0f + i * 7.0f;
+			float32 bottom = 8.0f + (i % 4) * 3.0f;
+			float32 right = left + (3 + i % 3) * tileSize;
+			float32 top = bottom + tileSize;
+
+			b2Vec2* v = &m_vertices[i * 4];
+			v[0].Set(left, bottom);
+			v[1].Set(right, bottom);
+			v[2].Set(right, top);
+			v[3].Set(left, top);
+
+			b2LoopShape loop;
+			loop.m_vertices = v;
+			loop.m_count = 4;
+			ground->CreateFixture(&loop, 0.0f);
+		}
+
+		m_top = height * tileSize;
+		m_left = x0 + 1.0f;
+		m_width = width * tileSize - 2.0f;
+	}
+
+	void Step(b2World* world, int32 frame)
+	{
+		// Drop 4 bodies every 4 frames, up to 800 of them.
+		if (frame % 4 != 0 || frame >= 800)
+		{
+			return;
+		}
+
+		for (int32 i = 0; i < 4; ++i)
+		{
+			int32 n = frame + i;
+
+			b2BodyDef bd;
+			bd.type = b2_dynamicBody;
+			bd.position.Set(m_left + (n * 37 % 101) / 101.0f * m_width, m_top);
+			b2Body* body = world->CreateBody(&bd);
+
+			if (n % 2 == 0)
+			{
+				b2PolygonShape shape;
+				shape.SetAsBox(0.3f, 0.3f);
+				body->CreateFixture(&shape, 1.0f);
+			}
+			else
+			{
+				b2CircleShape shape;
+				shape.m_radius = 0.3f;
+				body->CreateFixture(&shape, 1.0f);
+			}
+		}
+	}
+
+private:
+	std::vector<b2Vec2> m_vertices;
+	float32 m_top;
+	float32 m_left;
+	float32 m_width;
+};
+
+// Fast bullets fired at a wall of boxes. This is mostly continuous collision.
+class BulletScene : public Scene
+{
+public:
+	const char* GetName() const { return "bullets"; }
+
+	void Create(b2World* world)
+	{
+		CreateGround(world, 100.0f);
+
+		b2PolygonShape shape;
+		shape.SetAsBox(0.5f, 0.5f);
+
+		for (int32 i = 0; i < 20; ++i)
+		{
+			for (int32 j = 0; j < 10; ++j)
+			{
+				b2BodyDef bd;
+				bd.type = b2_dynamicBody;
+				bd.position.Set(20.0f + j * 1.02f, 0.5f + i * 1.01f);
+				b2Body* body = world->CreateBody(&bd);
+				body->CreateFixture(&shape, 1.0f);
+			}
+		}
+	}
+
+	void Step(b2World* world, int32 frame)
+	{
+		// A volley of 8 bullets every 10 frames.
+		if (frame % 10 != 0)
+		{
+			return;
+		}
+
+		b2CircleShape shape;
+		shape.m_radius = 0.1f;
+
+		for (int32 i = 0; i < 8; ++i)
+		{
+			b2BodyDef bd;
+			bd.type = b2_dynamicBody;
+			bd.bullet = true;
+			bd.position.Set(-40.0f, 1.0f + i * 2.5f + (frame / 10 % 3) * 0.7f);
+			bd.linearVelocity.Set(400.0f + i * 10.0f, 5.0f);
+			b2Body* body = world->CreateBody(&bd);
+			body->CreateFixture(&shape, 20.0f);
+		}
+	}
+};
+
+struct Options
+{
+	int32 threadCount;
+	int32 frameCount;
+	bool simd;
+	bool verify;
+};
+
+struct Result
+{
+	int32 bodyCount;
+	int32 jointCount;
+	int32 contactCount;
+
+	// Per step, in milliseconds.
+	float32 mean;
+	float32 median;
+	float32 p95;
+	float32 max;
+
+	// Mean phase times from b2Profile.
+	float32 collide;
+	float32 solve;
+	float32 solveTOI;
+	float32 findNewContacts;
+
+	int32 stepAllocationCount;
+	long long stepAllocationBytes;
+	int32 stackPeakBytes;
+	int32 blockPeakBytes;
+
+	unsigned long long checksum;
+};
+
+// FNV-1a over the state of every body, in body list order.
+static void Hash(unsigned long long* hash, const void* data, int32 size)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (int32 i = 0; i < size; ++i)
+	{
+		*hash ^= bytes[i];
+		*hash *= 1099511628211ULL;
+	}
+}
+
+static unsigned long long ComputeChecksum(b2World* world)
+{
+	unsigned long long hash = 14695981039346656037ULL;
+
+	for (b2Body* b = world->GetBodyList(); b; b = b->GetNext())
+	{
+		b2Vec2 position = b->GetPosition();
+		float32 angle = b->GetAngle();
+		b2Vec2 v = b->GetLinearVelocity();
+		float32 w = b->GetAngularVelocity();
+		bool awake = b->IsAwake();
+
+		Hash(&hash, &position, sizeof(position));
+		Hash(&hash, &angle, sizeof(angle));
+		Hash(&hash, &v, sizeof(v));
+		Hash(&hash, &w, sizeof(w));
+		Hash(&hash, &awake, sizeof(awake));
+	}
+
+	return hash;
+}
+
+static void Run(Scene* scene, const Options& options, int32 threadCount, Result* result)
+{
+	CountingArena arena;
+
+	b2WorldMemoryDef memoryDef;
+	memoryDef.arena = &arena;
+
+	b2World* world = new b2World(b2Vec2(0.0f, -10.0f), true, &memoryDef);
+	world->SetSIMDContactSolver(options.simd);
+
+	b2ThreadPool* pool = NULL;
+	if (threadCount > 1)
+	{
+		pool = new b2ThreadPool(threadCount);
+		world->SetThreadPool(pool);
+	}
+
+	scene->Create(world);
+
+	// Only count what stepping allocates.
+	arena.Clear();
+
+	std::vector<float32> times(options.frameCount);
+	float32 collide = 0.0f;
+	float32 solve = 0.0f;
+	float32 solveTOI = 0.0f;
+	float32 findNewContacts = 0.0f;
+	int32 stackPeakBytes = 0;
+
+	for (int32 i = 0; i < options.frameCount; ++i)
+	{
+		scene->Step(world, i);
+
+		b2Timer timer;
+		world->Step(k_timeStep, k_velocityIterations, k_positionIterations);
+		times[i] = timer.GetMilliseconds();
+
+		const b2Profile& profile = world->GetProfile();
+		collide += profile.collide;
+		solve += profile.solve;
+		solveTOI += profile.solveTOI;
+		findNewContacts += profile.findNewContacts;
+		stackPeakBytes = b2Max(stackPeakBytes, profile.stackPeakBytes);
+	}
+
+	float32 frameCount = (float32)b2Max(options.frameCount, 1);
+
+	float32 total = 0.0f;
+	for (int32 i = 0; i < options.frameCount; ++i)
+	{
+		total += times[i];
+	}
+
+	std::sort(times.begin(), times.end());
+
+	result->bodyCount = world->GetBodyCount();
+	result->jointCount = world->GetJointCount();
+	result->contactCount = world->GetContactCount();
+	result->mean = total / frameCount;
+	result->median = options.frameCount > 0 ? times[options.frameCount / 2] : 0.0f;
+	result->p95 = options.frameCount > 0 ? times[(options.frameCount * 95) / 100] : 0.0f;
+	result->max = options.frameCount > 0 ? times[options.frameCount - 1] : 0.0f;
+	result->collide = collide / frameCount;
+	result->solve = solve / frameCount;
+	result->solveTOI = solveTOI / frameCount;
+	result->findNewContacts = findNewContacts / frameCount;
+	result->stepAllocationCount = arena.m_allocationCount;
+	result->stepAllocationBytes = arena.m_allocationBytes;
+	result->stackPeakBytes = stackPeakBytes;
+	result->blockPeakBytes = world->GetProfile().blockPeakBytes;
+	result->checksum = ComputeChecksum(world);
+
+	// The pool must outlive the world's use of it.
+	delete world;
+	delete pool;
+}
+
+static void Usage()
+{
+	printf("usage: benchmark [-threads n] [-frames n] [-simd] [-verify] [scene...]\n");
+	printf("scenes: pyramid tumbler ragdolls tiles bullets\n");
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	options.threadCount = 1;
+	options.frameCount = 600;
+	options.simd = false;
+	options.verify = false;
+
+	PyramidScene pyramid;
+	TumblerScene tumbler;
+	RagdollScene ragdolls;
+	TileScene tiles;
+	BulletScene bullets;
+	Scene* scenes[] = {&pyramid, &tumbler, &ragdolls, &tiles, &bullets};
+	const int32 sceneCount = sizeof(scenes) / sizeof(scenes[0]);
+
+	bool selected[sceneCount];
+	bool anySelected = false;
+	memset(selected, 0, sizeof(selected));
+
+	for (int32 i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc)
+		{
+			options.threadCount = b2Max(atoi(argv[++i]), 1);
+		}
+		else if (strcmp(argv[i], "-frames") == 0 && i + 1 < argc)
+		{
+			options.frameCount = b2Max(atoi(argv[++i]), 1);
+		}
+		else if (strcmp(argv[i], "-simd") == 0)
+		{
+			options.simd = true;
+		}
+		else if (strcmp(argv[i], "-verify") == 0)
+		{
+			options.verify = true;
+		}
+		else
+		{
+			int32 j = 0;
+			while (j < sceneCount && strcmp(argv[i], scenes[j]->GetName()) != 0)
+			{
+				++j;
+			}
+
+			if (j == sceneCount)
+			{
+				Usage();
+				return 1;
+			}
+
+			selected[j] = true;
+			anySelected = true;
+		}
+	}
+
+	printf("%d frames, %d thread(s)%s\n\n", options.frameCount, options.threadCount, options.simd ? ", SIMD solver" : "");
+	printf("%-9s %6s %6s %6s %8s %8s %8s %8s %8s %8s %8s %8s %7s %9s %8s %8s  %s\n",
+		"scene", "bodies", "joints", "cntcts",
+		"mean", "median", "p95", "max",
+		"collide", "solve", "toi", "find",
+		"allocs", "alloc KB", "stack KB", "block KB", "checksum");
+
+	int32 failureCount = 0;
+
+	for (int32 i = 0; i < sceneCount; ++i)
+	{
+		if (anySelected && selected[i] == false)
+		{
+			continue;
+		}
+
+		Result result;
+		Run(scenes[i], options, options.threadCount, &result);
+
+		printf("%-9s %6d %6d %6d %8.3f %8.3f %8.3f %8.3f %8.3f %8.3f %8.3f %8.3f %7d %9lld %8d %8d  %016llx",
+			scenes[i]->GetName(), result.bodyCount, result.jointCount, result.contactCount,
+			result.mean, result.median, result.p95, result.max,
+			result.collide, result.solve, result.solveTOI, result.findNewContacts,
+			result.stepAllocationCount, result.stepAllocationBytes / 1024,
+			result.stackPeakBytes / 1024, result.blockPeakBytes / 1024,
+			result.checksum);
+
+		if (options.verify)
+		{
+			Result serial;
+			Run(scenes[i], options, 1, &serial);
+
+			if (serial.checksum == result.checksum)
+			{
+				printf("  same as serial");
+			}
+			else
+			{
+				printf("  DIFFERS from serial %016llx", serial.checksum);
+				++failureCount;
+			}
+		}
+
+		printf("\n");
+	}
+
+	printf("\nTimes are in milliseconds per step. collide, solve, toi and find (finding\n");
+	printf("new contacts) are means from b2Profile. allocs and alloc KB count the world\n");
+	printf("allocator requests made while stepping.\n");
+
+	return failureCount > 0 ? 1 : 0;
+}
@@ -0,0 +1,293 @@
+/*
+* Copyright (c) 2011 Spiralstorm Games http://www.spiralstormgames.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+// A lockstep test of b2World::SaveSnapshot and RestoreSnapshot. A world is
+// stepped for a while and saved. A second world, built by the same code, is
+// restored from the snapshot, then both are stepped side by side and their
+// bodies and snapshots are compared bit for bit after every step. Finally the
+// first world is rewound to the snapshot and stepped again, which must replay
+// the same steps.
+//
+// Build and run from this directory, on Linux or Mac OS X:
+//
+//   g++ -O2 -pthread $(find ../Box2D -type d | sed 's/^/-I/')
+//       Determinism.cpp $(find ../Box2D -name '*.cpp') -o determinism
+//
+// (on one line).
+//   ./determinism [-threads n] [-frames n] [-simd]
+//
+// -threads n  step the restored world with a b2ThreadPool of n threads, the
+//             first world is always stepped without one
+// -frames n   the number of lockstep steps, the default is 300
+// -simd       use the SIMD contact solver in both worlds
+//
+// It prints the first difference found and exits with 1, or 0 if there was
+// none.
+
+#include "Box2D.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+const float32 k_timeStep = 1.0f / 60.0f;
+const int32 k_velocityIterations = 8;
+const int32 k_positionIterations = 3;
+
+// Steps taken before the snapshot, so that it holds sleeping bodies, touching
+// contacts with warm starting impulses and a broad-phase that has moved.
+const int32 k_warmUpFrameCount = 120;
+
+// A pyramid of boxes hit by bullets, with a chain of revolute joints swinging
+// into it. This covers contacts, joints and continuous collision.
+static void CreateScene(b2World* world)
+{
+	b2BodyDef gd;
+	b2Body* ground = world->CreateBody(&gd);
+
+	b2EdgeShape edge;
+	edge.Set(b2Vec2(-1000.0f, 0.0f), b2Vec2(80.0f, 0.0f));
+	ground->CreateFixture(&edge, 0.0f);
+
+	b2PolygonShape box;
+	box.SetAsBox(0.5f, 0.5f);
+
+	const int32 baseCount = 15;
+	b2Vec2 x(-7.0f, 0.75f);
+	for (int32 i = 0; i < baseCount; ++i)
+	{
+		b2Vec2 y = x;
+		for (int32 j = i; j < baseCount; ++j)
+		{
+			b2BodyDef bd;
+			bd.type = b2_dynamicBody;
+			bd.position = y;
+			b2Body* body = world->CreateBody(&bd);
+			body->CreateFixture(&box, 5.0f);
+			y += b2Vec2(1.125f, 0.0f);
+		}
+		x += b2Vec2(0.5625f, 1.25f);
+	}
+
+	b2PolygonShape link;
+	link.SetAsBox(0.6f, 0.125f);
+
+	b2Body* prevBody = ground;
+	for (int32 i = 0; i < 12; ++i)
+	{
+		b2BodyDef bd;
+		bd.type = b2_dynamicBody;
+		bd.position.Set(-30.0f + 1.2f * i + 0.6f, 25.0f);
+		b2Body* body = world->CreateBody(&bd);
+		body->CreateFixture(&link, 20.0f);
+
+		b2RevoluteJointDef jd;
+		jd.Initialize(prevBody, body, b2Vec2(-30.0f + 1.2f * i, 25.0f));
+		world->CreateJoint(&jd);
+
+		prevBody = body;
+	}
+
+	// Bullets lobbed at the pyramid from further and further away, so that
+	// the later ones arrive after the snapshot.
+	b2CircleShape bullet;
+	bullet.m_radius = 0.1f;
+
+	for (int32 i = 0; i < 10; ++i)
+	{
+		float32 distance = 40.0f + i * 100.0f;
+		float32 time = distance / 300.0f;
+
+		b2BodyDef bd;
+		bd.type = b2_dynamicBody;
+		bd.bullet = true;
+		bd.position.Set(-distance, 1.0f + i * 1.5f);
+		bd.linearVelocity.Set(300.0f, 5.0f * time);
+		b2Body* body = world->CreateBody(&bd);
+		body->CreateFixture(&bullet, 20.0f);
+	}
+}
+
+static b2World* CreateWorld(bool simd, b2ThreadPool* pool)
+{
+	b2World* world = new b2World(b2Vec2(0.0f, -10.0f), true);
+	world->SetSIMDContactSolver(simd);
+	world->SetThreadPool(pool);
+	CreateScene(world);
+	return world;
+}
+
+static void Step(b2World* world)
+{
+	world->Step(k_timeStep, k_velocityIterations, k_positionIterations);
+}
+
+// Compare the bodies of two worlds field by field, bit for bit, and print the
+// first one that differs.
+static bool CompareBodies(b2World* worldA, b2World* worldB, const char* stage, int32 frame)
+{
+	if (worldA->GetBodyCount() != worldB->GetBodyCount())
+	{
+		printf("%s, frame %d: %d bodies vs %d\n", stage, frame, worldA->GetBodyCount(), worldB->GetBodyCount());
+		return false;
+	}
+
+	int32 index = 0;
+	for (b2Body* a = worldA->GetBodyList(), *b = worldB->GetBodyList(); a; a = a->GetNext(), b = b->GetNext(), ++index)
+	{
+		b2Transform ta = a->GetTransform();
+		b2Transform tb = b->GetTransform();
+		b2Vec2 va = a->GetLinearVelocity();
+		b2Vec2 vb = b->GetLinearVelocity();
+		float32 wa = a->GetAngularVelocity();
+		float32 wb = b->GetAngularVelocity();
+
+		bool same =
+			memcmp(&ta, &tb, sizeof(ta)) == 0 &&
+			memcmp(&va, &vb, sizeof(va)) == 0 &&
+			memcmp(&wa, &wb, sizeof(wa)) == 0 &&
+			a->IsAwake() == b->IsAwake();
+
+		if (same == false)
+		{
+			printf("%s, frame %d: body %d differs\n", stage, frame, index);
+			printf("  position (%.9g, %.9g) vs (%.9g, %.9g)\n", ta.position.x, ta.position.y, tb.position.x, tb.position.y);
+			printf("  velocity (%.9g, %.9g) vs (%.9g, %.9g)\n", va.x, va.y, vb.x, vb.y);
+			printf("  angular velocity %.9g vs %.9g, awake %d vs %d\n", wa, wb, a->IsAwake(), b->IsAwake());
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool CompareSnapshots(const b2Snapshot& a, const b2Snapshot& b, const char* stage, int32 frame)
+{
+	if (a.GetSize() != b.GetSize() || memcmp(a.GetData(), b.GetData(), a.GetSize()) != 0)
+	{
+		printf("%s, frame %d: snapshots differ (%d and %d bytes)\n", stage, frame, a.GetSize(), b.GetSize());
+		return false;
+	}
+
+	return true;
+}
+
+static void Usage()
+{
+	printf("usage: determinism [-threads n] [-frames n] [-simd]\n");
+}
+
+int main(int argc, char** argv)
+{
+	int32 threadCount = 1;
+	int32 frameCount = 300;
+	bool simd = false;
+
+	for (int32 i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc)
+		{
+			threadCount = b2Max(atoi(argv[++i]), 1);
+		}
+		else if (strcmp(argv[i], "-frames") == 0 && i + 1 < argc)
+		{
+			frameCount = b2Max(atoi(argv[++i]), 1);
+		}
+		else if (strcmp(argv[i], "-simd") == 0)
+		{
+			simd = true;
+		}
+		else
+		{
+			Usage();
+			return 1;
+		}
+	}
+
+	b2ThreadPool* pool = threadCount > 1 ? new b2ThreadPool(threadCount) : NULL;
+
+	b2World* worldA = CreateWorld(simd, NULL);
+	for (int32 i = 0; i < k_warmUpFrameCount; ++i)
+	{
+		Step(worldA);
+	}
+
+	b2Snapshot saved;
+	worldA->SaveSnapshot(&saved);
+
+	b2World* worldB = CreateWorld(simd, pool);
+	bool ok = worldB->RestoreSnapshot(saved);
+	if (ok == false)
+	{
+		printf("restore: the snapshot was rejected\n");
+	}
+
+	b2Snapshot snapshotA;
+	b2Snapshot snapshotB;
+
+	if (ok)
+	{
+		worldB->SaveSnapshot(&snapshotB);
+		ok = CompareBodies(worldA, worldB, "restore", 0) && CompareSnapshots(saved, snapshotB, "restore", 0);
+	}
+
+	// Step both worlds in lockstep, keeping the final state of the first one
+	// for the rewind below.
+	for (int32 i = 1; ok && i <= frameCount; ++i)
+	{
+		Step(worldA);
+		Step(worldB);
+
+		worldA->SaveSnapshot(&snapshotA);
+		worldB->SaveSnapshot(&snapshotB);
+		ok = CompareBodies(worldA, worldB, "lockstep", i) && CompareSnapshots(snapshotA, snapshotB, "lockstep", i);
+	}
+
+	// Rewind the first world and replay the same steps.
+	if (ok)
+	{
+		ok = worldA->RestoreSnapshot(saved);
+		if (ok == false)
+		{
+			printf("rewind: the snapshot was rejected\n");
+		}
+	}
+
+	for (int32 i = 1; ok && i <= frameCount; ++i)
+	{
+		Step(worldA);
+	}
+
+	if (ok)
+	{
+		b2Snapshot replayed;
+		worldA->SaveSnapshot(&replayed);
+		ok = CompareBodies(worldA, worldB, "rewind", frameCount) && CompareSnapshots(snapshotA, replayed, "rewind", frameCount);
+	}
+
+	printf("%d bodies, %d joints, %d contacts, snapshot of %d bytes, %d frames, %d thread(s)%s: %s\n",
+		worldA->GetBodyCount(), worldA->GetJointCount(), worldA->GetContactCount(), saved.GetSize(),
+		frameCount, threadCount, simd ? ", SIMD solver" : "", ok ? "same" : "DIFFERENT");
+
+	// The pool must outlive the world's use of it.
+	delete worldB;
+	delete worldA;
+	delete pool;
+
+	return ok ? 0 : 1;
+}
@@ -32,6 +32,9 @@ For discussion please visit http://box2d.org/forum
 // These include files constitute the main Box2D API
 
 #include "b2Settings.h"
+#include "b2ThreadPool.h"
+#include "b2Snapshot.h"
+#include "b2Timer.h"
 
 #include "b2CircleShape.h"
 #include "b2EdgeShape.h"
@@ -17,30 +17,191 @@
 */
 
 #include "b2BroadPhase.h"
+#include "b2ThreadPool.h"
+#include "b2Snapshot.h"
 #include <cstring>
 
+// Where the pairs found for one range of the move buffer ended up.
+struct b2PairRange
+{
+	int32 threadIndex;
+	int32 begin;
+	int32 count;
+};
+
+// Moved proxies per task. Queries vary a lot in cost, so keep the ranges small.
+const int32 b2_pairQueryRangeSize = 16;
+
+// The static tree is rebuilt once more than 1/b2_staticRebuildRatio of its
+// proxies were added or moved, e.g. after a level is loaded.
+const int32 b2_staticRebuildRatio = 4;
+
+static void b2InitPairBuffer(b2MemoryArena* arena, b2PairBuffer* buffer)
+{
+	buffer->capacity = 16;
+	buffer->count = 0;
+	buffer->pairs = (b2Pair*)b2Alloc(arena, buffer->capacity * sizeof(b2Pair));
+}
+
+static void b2AddPair(b2MemoryArena* arena, b2PairBuffer* buffer, int32 proxyIdA, int32 proxyIdB)
+{
+	// Grow the pair buffer as needed.
+	if (buffer->count == buffer->capacity)
+	{
+		b2Pair* oldBuffer = buffer->pairs;
+		int32 oldCapacity = buffer->capacity;
+		buffer->capacity *= 2;
+		buffer->pairs = (b2Pair*)b2Alloc(arena, buffer->capacity * sizeof(b2Pair));
+		memcpy(buffer->pairs, oldBuffer, buffer->count * sizeof(b2Pair));
+		b2Free(arena, oldBuffer, oldCapacity * sizeof(b2Pair));
+	}
+
+	buffer->pairs[buffer->count].proxyIdA = b2Min(proxyIdA, proxyIdB);
+	buffer->pairs[buffer->count].proxyIdB = b2Max(proxyIdA, proxyIdB);
+	++buffer->count;
+}
+
+// This is called from b2DynamicTree::Query when we are gathering pairs.
+struct b2PairQuery
+{
+	bool QueryCallback(int32 proxyId)
+	{
+		int32 nodeId = proxyId;
+		proxyId |= proxyBits;
+
+		// A proxy cannot form a pair with itself.
+		if (proxyId == queryProxyId)
+		{
+			return true;
+		}
+
+		// If both proxies moved, the pair is found by both queries. Only keep
+		// the one made for the larger id.
+		if (proxyId > queryProxyId && tree->WasMoved(nodeId))
+		{
+			return true;
+		}
+
+		b2AddPair(arena, buffer, proxyId, queryProxyId);
+		return true;
+	}
+
+	// The tree being queried and the bits that turn its nodes into proxy ids.
+	const b2DynamicTree* tree;
+	int32 proxyBits;
+
+	b2MemoryArena* arena;
+	b2PairBuffer* buffer;
+	int32 queryProxyId;
+};
+
 b2BroadPhase::b2BroadPhase()
 {
+	m_arena = NULL;
+
 	m_proxyCount = 0;
+	m_staticProxyCount = 0;
+	m_staticChangeCount = 0;
+
+	// Static proxies don't move, so they don't need any slack.
+	m_staticTree.SetFattening(0.0f, 0.0f);
 
-	m_pairCapacity = 16;
-	m_pairCount = 0;
-	m_pairBuffer = (b2Pair*)b2Alloc(m_pairCapacity * sizeof(b2Pair));
+	b2InitPairBuffer(m_arena, &m_pairBuffer);
 
 	m_moveCapacity = 16;
 	m_moveCount = 0;
-	m_moveBuffer = (int32*)b2Alloc(m_moveCapacity * sizeof(int32));
+	m_moveBuffer = (int32*)b2Alloc(m_arena, m_moveCapacity * sizeof(int32));
+
+	m_threadPool = NULL;
+	m_threadPairBuffers = NULL;
+	m_threadPairBufferCount = 0;
+	m_pairRanges = NULL;
+	m_pairRangeCapacity = 0;
 }
 
 b2BroadPhase::~b2BroadPhase()
 {
-	b2Free(m_moveBuffer);
-	b2Free(m_pairBuffer);
+	SetThreadPool(NULL);
+
+	b2Free(m_arena, m_moveBuffer, m_moveCapacity * sizeof(int32));
+	b2Free(m_arena, m_pairBuffer.pairs, m_pairBuffer.capacity * sizeof(b2Pair));
+}
+
+void b2BroadPhase::SetArena(b2MemoryArena* arena)
+{
+	b2Assert(m_proxyCount == 0);
+
+	// The per-thread buffers are made again from the new arena.
+	b2ThreadPool* threadPool = m_threadPool;
+	SetThreadPool(NULL);
+
+	int32 moveSize = m_moveCapacity * sizeof(int32);
+	int32* oldMoveBuffer = m_moveBuffer;
+	m_moveBuffer = (int32*)b2Alloc(arena, moveSize);
+	memcpy(m_moveBuffer, oldMoveBuffer, m_moveCount * sizeof(int32));
+	b2Free(m_arena, oldMoveBuffer, moveSize);
+
+	int32 pairSize = m_pairBuffer.capacity * sizeof(b2Pair);
+	b2Pair* oldPairs = m_pairBuffer.pairs;
+	m_pairBuffer.pairs = (b2Pair*)b2Alloc(arena, pairSize);
+	memcpy(m_pairBuffer.pairs, oldPairs, m_pairBuffer.count * sizeof(b2Pair));
+	b2Free(m_arena, oldPairs, pairSize);
+
+	m_arena = arena;
+	m_tree.SetArena(arena);
+	m_staticTree.SetArena(arena);
+
+	SetThreadPool(threadPool);
+}
+
+void b2BroadPhase::SetThreadPool(b2ThreadPool* threadPool)
+{
+	if (m_threadPairBuffers)
+	{
+		for (int32 i = 0; i < m_threadPairBufferCount; ++i)
+		{
+			b2Free(m_arena, m_threadPairBuffers[i].pairs, m_threadPairBuffers[i].capacity * sizeof(b2Pair));
+		}
+
+		b2Free(m_arena, m_threadPairBuffers, m_threadPairBufferCount * sizeof(b2PairBuffer));
+		m_threadPairBuffers = NULL;
+		m_threadPairBufferCount = 0;
+	}
+
+	if (m_pairRanges)
+	{
+		b2Free(m_arena, m_pairRanges, m_pairRangeCapacity * sizeof(b2PairRange));
+		m_pairRanges = NULL;
+		m_pairRangeCapacity = 0;
+	}
+
+	m_threadPool = threadPool;
+
+	if (m_threadPool && m_threadPool->GetThreadCount() > 1)
+	{
+		m_threadPairBufferCount = m_threadPool->GetThreadCount();
+		m_threadPairBuffers = (b2PairBuffer*)b2Alloc(m_arena, m_threadPairBufferCount * sizeof(b2PairBuffer));
+		for (int32 i = 0; i < m_threadPairBufferCount; ++i)
+		{
+			b2InitPairBuffer(m_arena, m_threadPairBuffers + i);
+		}
+	}
 }
 
-int32 b2BroadPhase::CreateProxy(const b2AABB& aabb, void* userData)
+int32 b2BroadPhase::CreateProxy(const b2AABB& aabb, void* userData, bool isStatic)
 {
-	int32 proxyId = m_tree.CreateProxy(aabb, userData);
+	int32 proxyId;
+	if (isStatic)
+	{
+		proxyId = m_staticTree.CreateProxy(aabb, userData) | e_staticProxyBit;
+		++m_staticProxyCount;
+		++m_staticChangeCount;
+	}
+	else
+	{
+		proxyId = m_tree.CreateProxy(aabb, userData);
+	}
+
 	++m_proxyCount;
 	BufferMove(proxyId);
 	return proxyId;
@@ -50,35 +211,66 @@ void b2BroadPhase::DestroyProxy(int32 proxyId)
 {
 	UnBufferMove(proxyId);
 	--m_proxyCount;
-	m_tree.DestroyProxy(proxyId);
+
+	if (proxyId & e_staticProxyBit)
+	{
+		--m_staticProxyCount;
+	}
+
+	GetTree(proxyId)->DestroyProxy(proxyId & ~e_staticProxyBit);
 }
 
 void b2BroadPhase::MoveProxy(int32 proxyId, const b2AABB& aabb, const b2Vec2& displacement)
 {
-	bool buffer = m_tree.MoveProxy(proxyId, aabb, displacement);
+	bool buffer = GetTree(proxyId)->MoveProxy(proxyId & ~e_staticProxyBit, aabb, displacement);
 	if (buffer)
 	{
+		if (proxyId & e_staticProxyBit)
+		{
+			++m_staticChangeCount;
+		}
+
 		BufferMove(proxyId);
 	}
 }
 
 void b2BroadPhase::BufferMove(int32 proxyId)
 {
+	b2DynamicTree* tree = GetTree(proxyId);
+	int32 nodeId = proxyId & ~e_staticProxyBit;
+
+	// Each proxy is buffered at most once per step.
+	if (tree->WasMoved(nodeId))
+	{
+		return;
+	}
+
 	if (m_moveCount == m_moveCapacity)
 	{
 		int32* oldBuffer = m_moveBuffer;
+		int32 oldCapacity = m_moveCapacity;
 		m_moveCapacity *= 2;
-		m_moveBuffer = (int32*)b2Alloc(m_moveCapacity * sizeof(int32));
+		m_moveBuffer = (int32*)b2Alloc(m_arena, m_moveCapacity * sizeof(int32));
 		memcpy(m_moveBuffer, oldBuffer, m_moveCount * sizeof(int32));
-		b2Free(oldBuffer);
+		b2Free(m_arena, oldBuffer, oldCapacity * sizeof(int32));
 	}
 
+	tree->SetMoved(nodeId, true);
 	m_moveBuffer[m_moveCount] = proxyId;
 	++m_moveCount;
 }
 
 void b2BroadPhase::UnBufferMove(int32 proxyId)
 {
+	b2DynamicTree* tree = GetTree(proxyId);
+	int32 nodeId = proxyId & ~e_staticProxyBit;
+	if (tree->WasMoved(nodeId) == false)
+	{
+		return;
+	}
+
+	tree->SetMoved(nodeId, false);
+
 	for (int32 i = 0; i < m_moveCount; ++i)
 	{
 		if (m_moveBuffer[i] == proxyId)
@@ -89,28 +281,185 @@ void b2BroadPhase::UnBufferMove(int32 proxyId)
 	}
 }
 
-// This is called from b2DynamicTree::Query when we are gathering pairs.
-bool b2BroadPhase::QueryCallback(int32 proxyId)
+// Find the pairs of one moved proxy.
+void b2BroadPhase::QueryPairs(b2PairQuery* query, int32 proxyId) const
 {
-	// A proxy cannot form a pair with itself.
-	if (proxyId == m_queryProxyId)
+	query->queryProxyId = proxyId;
+
+	// We have to query the tree with the fat AABB so that
+	// we don't fail to create a pair that may touch later.
+	const b2AABB& fatAABB = GetFatAABB(proxyId);
+
+	// Query tree, create pairs and add them pair buffer.
+	query->tree = &m_tree;
+	query->proxyBits = 0;
+	m_tree.Query(query, fatAABB);
+
+	// Static proxies don't pair up with each other.
+	if ((proxyId & e_staticProxyBit) == 0)
 	{
-		return true;
+		query->tree = &m_staticTree;
+		query->proxyBits = e_staticProxyBit;
+		m_staticTree.Query(query, fatAABB);
 	}
+}
 
-	// Grow the pair buffer as needed.
-	if (m_pairCount == m_pairCapacity)
+void b2BroadPhase::FindPairs()
+{
+	// Reset pair buffer
+	m_pairBuffer.count = 0;
+
+	// Build a fresh static tree when a lot of it changed. Proxy ids are kept.
+	if (m_staticChangeCount > 0 && b2_staticRebuildRatio * m_staticChangeCount > m_staticProxyCount)
+	{
+		m_staticTree.RebuildTopDown();
+		m_staticChangeCount = 0;
+	}
+
+	if (m_threadPairBuffers && m_moveCount > b2_pairQueryRangeSize)
+	{
+		FindPairsParallel();
+	}
+	else
+	{
+		b2PairQuery query;
+		query.arena = m_arena;
+		query.buffer = &m_pairBuffer;
+
+		// Perform tree queries for all moving proxies.
+		for (int32 i = 0; i < m_moveCount; ++i)
+		{
+			int32 proxyId = m_moveBuffer[i];
+			if (proxyId == e_nullProxy)
+			{
+				continue;
+			}
+
+			QueryPairs(&query, proxyId);
+		}
+	}
+
+	// The moved flags were needed by the queries, clear them now.
+	for (int32 i = 0; i < m_moveCount; ++i)
 	{
-		b2Pair* oldBuffer = m_pairBuffer;
-		m_pairCapacity *= 2;
-		m_pairBuffer = (b2Pair*)b2Alloc(m_pairCapacity * sizeof(b2Pair));
-		memcpy(m_pairBuffer, oldBuffer, m_pairCount * sizeof(b2Pair));
-		b2Free(oldBuffer);
+		int32 proxyId = m_moveBuffer[i];
+		if (proxyId != e_nullProxy)
+		{
+			GetTree(proxyId)->SetMoved(proxyId & ~e_staticProxyBit, false);
+		}
 	}
 
-	m_pairBuffer[m_pairCount].proxyIdA = b2Min(proxyId, m_queryProxyId);
-	m_pairBuffer[m_pairCount].proxyIdB = b2Max(proxyId, m_queryProxyId);
-	++m_pairCount;
+	// Reset move buffer
+	m_moveCount = 0;
+}
+
+void b2BroadPhase::FindPairsTask(void* userData, int32 begin, int32 end, int32 threadIndex)
+{
+	b2BroadPhase* broadPhase = (b2BroadPhase*)userData;
+
+	b2PairQuery query;
+	query.arena = broadPhase->m_arena;
+	query.buffer = broadPhase->m_threadPairBuffers + threadIndex;
+
+	b2PairRange* range = broadPhase->m_pairRanges + begin / b2_pairQueryRangeSize;
+	range->threadIndex = threadIndex;
+	range->begin = query.buffer->count;
+
+	for (int32 i = begin; i < end; ++i)
+	{
+		int32 proxyId = broadPhase->m_moveBuffer[i];
+		if (proxyId == e_nullProxy)
+		{
+			continue;
+		}
+
+		broadPhase->QueryPairs(&query, proxyId);
+	}
+
+	range->count = query.buffer->count - range->begin;
+}
+
+void b2BroadPhase::FindPairsParallel()
+{
+	int32 rangeCount = (m_moveCount + b2_pairQueryRangeSize - 1) / b2_pairQueryRangeSize;
+	if (m_pairRangeCapacity < rangeCount)
+	{
+		if (m_pairRanges)
+		{
+			b2Free(m_arena, m_pairRanges, m_pairRangeCapacity * sizeof(b2PairRange));
+		}
+
+		m_pairRangeCapacity = b2Max(rangeCount, 2 * m_pairRangeCapacity);
+		m_pairRanges = (b2PairRange*)b2Alloc(m_arena, m_pairRangeCapacity * sizeof(b2PairRange));
+	}
+
+	for (int32 i = 0; i < m_threadPairBufferCount; ++i)
+	{
+		m_threadPairBuffers[i].count = 0;
+	}
+
+	m_threadPool->ParallelFor(m_moveCount, b2_pairQueryRangeSize, FindPairsTask, this);
+
+	// Merge the ranges in move buffer order, so the pairs come out as they
+	// would on one thread.
+	int32 pairCount = 0;
+	for (int32 i = 0; i < rangeCount; ++i)
+	{
+		pairCount += m_pairRanges[i].count;
+	}
+
+	if (m_pairBuffer.capacity < pairCount)
+	{
+		b2Free(m_arena, m_pairBuffer.pairs, m_pairBuffer.capacity * sizeof(b2Pair));
+		m_pairBuffer.capacity = b2Max(pairCount, 2 * m_pairBuffer.capacity);
+		m_pairBuffer.pairs = (b2Pair*)b2Alloc(m_arena, m_pairBuffer.capacity * sizeof(b2Pair));
+	}
+
+	for (int32 i = 0; i < rangeCount; ++i)
+	{
+		const b2PairRange* range = m_pairRanges + i;
+		const b2PairBuffer* buffer = m_threadPairBuffers + range->threadIndex;
+		memcpy(m_pairBuffer.pairs + m_pairBuffer.count, buffer->pairs + range->begin, range->count * sizeof(b2Pair));
+		m_pairBuffer.count += range->count;
+	}
+}
+
+void b2BroadPhase::WriteSnapshot(b2Snapshot* snapshot) const
+{
+	snapshot->Write(m_proxyCount);
+	snapshot->Write(m_staticProxyCount);
+	snapshot->Write(m_staticChangeCount);
+
+	snapshot->Write(m_moveCount);
+	snapshot->Write(m_moveBuffer, m_moveCount * sizeof(int32));
+
+	m_tree.WriteSnapshot(snapshot);
+	m_staticTree.WriteSnapshot(snapshot);
+}
+
+bool b2BroadPhase::ReadSnapshot(b2SnapshotReader* reader)
+{
+	int32 moveCount;
+	reader->Read(&m_proxyCount);
+	reader->Read(&m_staticProxyCount);
+	reader->Read(&m_staticChangeCount);
+	reader->Read(&moveCount);
+	if (reader->IsValid() == false || moveCount < 0 || moveCount > reader->GetRemaining())
+	{
+		return false;
+	}
+
+	if (moveCount > m_moveCapacity)
+	{
+		b2Free(m_arena, m_moveBuffer, m_moveCapacity * sizeof(int32));
+		while (m_moveCapacity < moveCount)
+		{
+			m_moveCapacity *= 2;
+		}
+		m_moveBuffer = (int32*)b2Alloc(m_arena, m_moveCapacity * sizeof(int32));
+	}
+	m_moveCount = moveCount;
+	reader->Read(m_moveBuffer, m_moveCount * sizeof(int32));
 
-	return true;
+	return m_tree.ReadSnapshot(reader) && m_staticTree.ReadSnapshot(reader);
 }
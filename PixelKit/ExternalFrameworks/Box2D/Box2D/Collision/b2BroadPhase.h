@@ -22,7 +22,6 @@
 #include "b2Settings.h"
 #include "b2Collision.h"
 #include "b2DynamicTree.h"
-#include <algorithm>
 
 struct b2Pair
 {
@@ -31,9 +30,83 @@ struct b2Pair
 	int32 next;
 };
 
+/// A growable array of pairs.
+struct b2PairBuffer
+{
+	b2Pair* pairs;
+	int32 count;
+	int32 capacity;
+};
+
+class b2ThreadPool;
+struct b2PairRange;
+struct b2PairQuery;
+
+/// Passes the nodes found in one of the broad-phase trees on as proxy ids, and
+/// remembers whether the callback stopped the search.
+template <typename T>
+struct b2TreeCallbackWrapper
+{
+	bool QueryCallback(int32 nodeId)
+	{
+		proceed = callback->QueryCallback(nodeId | proxyBits);
+		return proceed;
+	}
+
+	float32 RayCastCallback(const b2RayCastInput& input, int32 nodeId)
+	{
+		float32 value = callback->RayCastCallback(input, nodeId | proxyBits);
+		if (value == 0.0f)
+		{
+			proceed = false;
+		}
+		else if (value > 0.0f)
+		{
+			maxFraction = value;
+		}
+		return value;
+	}
+
+	T* callback;
+	int32 proxyBits;
+	float32 maxFraction;
+	bool proceed;
+};
+
+/// The packet version of b2TreeCallbackWrapper. Rays can be left out of the
+/// packet, so the packet's ray indices are mapped back to the caller's.
+template <typename T>
+struct b2TreePacketCallbackWrapper
+{
+	float32 RayCastCallback(const b2RayCastInput& input, int32 nodeId, int32 rayIndex)
+	{
+		int32 index = rayIndices[rayIndex];
+		float32 value = callback->RayCastCallback(input, nodeId | proxyBits, index);
+		if (value == 0.0f)
+		{
+			proceed[index] = false;
+		}
+		else if (value > 0.0f)
+		{
+			maxFractions[index] = value;
+		}
+		return value;
+	}
+
+	T* callback;
+	int32 proxyBits;
+	int32 rayIndices[b2_rayPacketSize];
+	float32 maxFractions[b2_rayPacketSize];
+	bool proceed[b2_rayPacketSize];
+};
+
 /// The broad-phase is used for computing pairs and performing volume queries and ray casts.
 /// This broad-phase does not persist pairs. Instead, this reports potentially new pairs.
 /// It is up to the client to consume the new pairs and to track subsequent overlap.
+///
+/// Static proxies are kept in a tree of their own. They are not fattened, the
+/// tree is rebuilt in bulk when many of them change, and they are only tested
+/// against the other tree since static pairs are never wanted.
 class b2BroadPhase
 {
 public:
@@ -46,9 +119,13 @@ public:
 	b2BroadPhase();
 	~b2BroadPhase();
 
+	/// Set where the buffers and trees get their memory. NULL means b2Alloc.
+	/// This must be set before any proxy is created.
+	void SetArena(b2MemoryArena* arena);
+
 	/// Create a proxy with an initial AABB. Pairs are not reported until
-	/// UpdatePairs is called.
-	int32 CreateProxy(const b2AABB& aabb, void* userData);
+	/// UpdatePairs is called. Static proxies never form pairs with each other.
+	int32 CreateProxy(const b2AABB& aabb, void* userData, bool isStatic);
 
 	/// Destroy a proxy. It is up to the client to remove any pairs.
 	void DestroyProxy(int32 proxyId);
@@ -63,6 +140,9 @@ public:
 	/// Get user data from a proxy. Returns NULL if the id is invalid.
 	void* GetUserData(int32 proxyId) const;
 
+	/// Set the user data of a proxy.
+	void SetUserData(int32 proxyId, void* userData);
+
 	/// Test overlap of fat AABBs.
 	bool TestOverlap(int32 proxyIdA, int32 proxyIdB) const;
 
@@ -70,9 +150,18 @@ public:
 	int32 GetProxyCount() const;
 
 	/// Update the pairs. This results in pair callbacks. This can only add pairs.
+	/// Each new pair is reported once.
 	template <typename T>
 	void UpdatePairs(T* callback);
 
+	/// Get the number of pairs reported by the last UpdatePairs.
+	int32 GetPairCount() const;
+
+	/// Query the tree for the moved proxies on these threads. Pairs are still
+	/// reported from the calling thread, in the same order as without a pool.
+	/// Pass NULL to run the queries on the calling thread.
+	void SetThreadPool(b2ThreadPool* threadPool);
+
 	/// Query an AABB for overlapping proxies. The callback class
 	/// is called for each proxy that overlaps the supplied AABB.
 	template <typename T>
@@ -88,64 +177,118 @@ public:
 	template <typename T>
 	void RayCast(T* callback, const b2RayCastInput& input) const;
 
-	/// Compute the height of the embedded tree.
+	/// Ray-cast a packet of up to b2_rayPacketSize rays together.
+	/// See b2DynamicTree::RayCastPacket.
+	template <typename T>
+	void RayCastPacket(T* callback, const b2RayCastInput* inputs, int32 count) const;
+
+	/// Compute the height of the tree holding the non-static proxies.
 	int32 ComputeHeight() const;
 
+	/// Get the height of the non-static tree in O(1) time.
+	int32 GetTreeHeight() const;
+
+	/// Get the balance of the non-static tree.
+	int32 GetTreeBalance() const;
+
+	/// Get the quality metric of the non-static tree.
+	float32 GetTreeQuality() const;
+
+	/// Get the height of the static tree in O(1) time.
+	int32 GetStaticTreeHeight() const;
+
+	/// Rebuild both trees from scratch. See b2DynamicTree::RebuildTopDown.
+	void RebuildTree();
+
+	/// Set how much non-static proxy AABBs are fattened. Static proxies are
+	/// never fattened. See b2DynamicTree::SetFattening.
+	void SetFattening(float32 extension, float32 multiplier);
+
+	/// Write both trees and the move buffer to a snapshot. See b2DynamicTree::WriteSnapshot.
+	void WriteSnapshot(b2Snapshot* snapshot) const;
+
+	/// Replace the proxies with the ones written by WriteSnapshot. User data
+	/// is cleared and must be set again with SetUserData.
+	bool ReadSnapshot(b2SnapshotReader* reader);
+
 private:
 
-	friend class b2DynamicTree;
+	enum
+	{
+		// Set on the ids of proxies in the static tree.
+		e_staticProxyBit = 0x40000000
+	};
+
+	const b2DynamicTree* GetTree(int32 proxyId) const;
+	b2DynamicTree* GetTree(int32 proxyId);
 
 	void BufferMove(int32 proxyId);
 	void UnBufferMove(int32 proxyId);
 
-	bool QueryCallback(int32 proxyId);
+	// Query the tree for the moved proxies, filling m_pairBuffer with the new
+	// pairs, and empty the move buffer.
+	void FindPairs();
+	void FindPairsParallel();
+	void QueryPairs(b2PairQuery* query, int32 proxyId) const;
+	static void FindPairsTask(void* userData, int32 begin, int32 end, int32 threadIndex);
+
+	b2MemoryArena* m_arena;
 
 	b2DynamicTree m_tree;
+	b2DynamicTree m_staticTree;
 
 	int32 m_proxyCount;
+	int32 m_staticProxyCount;
+
+	// Static proxies created or re-inserted since the static tree was last built.
+	int32 m_staticChangeCount;
 
 	int32* m_moveBuffer;
 	int32 m_moveCapacity;
 	int32 m_moveCount;
 
-	b2Pair* m_pairBuffer;
-	int32 m_pairCapacity;
-	int32 m_pairCount;
+	b2PairBuffer m_pairBuffer;
+
+	b2ThreadPool* m_threadPool;
 
-	int32 m_queryProxyId;
+	// One pair buffer per thread, and where each range of the move buffer put
+	// its pairs, so they can be merged back in order.
+	b2PairBuffer* m_threadPairBuffers;
+	int32 m_threadPairBufferCount;
+	b2PairRange* m_pairRanges;
+	int32 m_pairRangeCapacity;
 };
 
-/// This is used to sort pairs.
-inline bool b2PairLessThan(const b2Pair& pair1, const b2Pair& pair2)
+inline const b2DynamicTree* b2BroadPhase::GetTree(int32 proxyId) const
 {
-	if (pair1.proxyIdA < pair2.proxyIdA)
-	{
-		return true;
-	}
-
-	if (pair1.proxyIdA == pair2.proxyIdA)
-	{
-		return pair1.proxyIdB < pair2.proxyIdB;
-	}
+	return (proxyId & e_staticProxyBit) ? &m_staticTree : &m_tree;
+}
 
-	return false;
+inline b2DynamicTree* b2BroadPhase::GetTree(int32 proxyId)
+{
+	return (proxyId & e_staticProxyBit) ? &m_staticTree : &m_tree;
 }
 
 inline void* b2BroadPhase::GetUserData(int32 proxyId) const
 {
-	return m_tree.GetUserData(proxyId);
+	return GetTree(proxyId)->GetUserData(proxyId & ~e_staticProxyBit);
+}
+
+inline void b2BroadPhase::SetUserData(int32 proxyId, void* userData)
+{
+	GetTree(proxyId)->SetUserData(proxyId & ~e_staticProxyBit, userData);
 }
 
 inline bool b2BroadPhase::TestOverlap(int32 proxyIdA, int32 proxyIdB) const
 {
-	const b2AABB& aabbA = m_tree.GetFatAABB(proxyIdA);
-	const b2AABB& aabbB = m_tree.GetFatAABB(proxyIdB);
+	const b2AABB& aabbA = GetFatAABB(proxyIdA);
+	const b2AABB& aabbB = GetFatAABB(proxyIdB);
 	return b2TestOverlap(aabbA, aabbB);
 }
 
 inline const b2AABB& b2BroadPhase::GetFatAABB(int32 proxyId) const
 {
-	return m_tree.GetFatAABB(proxyId);
+	return GetTree(proxyId)->GetFatAABB(proxyId & ~e_staticProxyBit);
 }
 
 inline int32 b2BroadPhase::GetProxyCount() const
@@ -158,72 +301,137 @@ inline int32 b2BroadPhase::ComputeHeight() const
 	return m_tree.ComputeHeight();
 }
 
-template <typename T>
-void b2BroadPhase::UpdatePairs(T* callback)
+inline int32 b2BroadPhase::GetTreeHeight() const
 {
-	// Reset pair buffer
-	m_pairCount = 0;
+	return m_tree.GetHeight();
+}
 
-	// Perform tree queries for all moving proxies.
-	for (int32 i = 0; i < m_moveCount; ++i)
-	{
-		m_queryProxyId = m_moveBuffer[i];
-		if (m_queryProxyId == e_nullProxy)
-		{
-			continue;
-		}
+inline int32 b2BroadPhase::GetTreeBalance() const
+{
+	return m_tree.GetMaxBalance();
+}
 
-		// We have to query the tree with the fat AABB so that
-		// we don't fail to create a pair that may touch later.
-		const b2AABB& fatAABB = m_tree.GetFatAABB(m_queryProxyId);
+inline float32 b2BroadPhase::GetTreeQuality() const
+{
+	return m_tree.GetAreaRatio();
+}
 
-		// Query tree, create pairs and add them pair buffer.
-		m_tree.Query(this, fatAABB);
-	}
+inline int32 b2BroadPhase::GetStaticTreeHeight() const
+{
+	return m_staticTree.GetHeight();
+}
+
+inline int32 b2BroadPhase::GetPairCount() const
+{
+	return m_pairBuffer.count;
+}
+
+inline void b2BroadPhase::RebuildTree()
+{
+	m_tree.RebuildTopDown();
+	m_staticTree.RebuildTopDown();
+	m_staticChangeCount = 0;
+}
 
-	// Reset move buffer
-	m_moveCount = 0;
+inline void b2BroadPhase::SetFattening(float32 extension, float32 multiplier)
+{
+	m_tree.SetFattening(extension, multiplier);
+}
 
-	// Sort the pair buffer to expose duplicates.
-	std::sort(m_pairBuffer, m_pairBuffer + m_pairCount, b2PairLessThan);
+template <typename T>
+void b2BroadPhase::UpdatePairs(T* callback)
+{
+	FindPairs();
 
 	// Send the pairs back to the client.
-	int32 i = 0;
-	while (i < m_pairCount)
+	for (int32 i = 0; i < m_pairBuffer.count; ++i)
 	{
-		b2Pair* primaryPair = m_pairBuffer + i;
-		void* userDataA = m_tree.GetUserData(primaryPair->proxyIdA);
-		void* userDataB = m_tree.GetUserData(primaryPair->proxyIdB);
+		const b2Pair* pair = m_pairBuffer.pairs + i;
+		void* userDataA = GetUserData(pair->proxyIdA);
+		void* userDataB = GetUserData(pair->proxyIdB);
 
 		callback->AddPair(userDataA, userDataB);
-		++i;
-
-		// Skip any duplicate pairs.
-		while (i < m_pairCount)
-		{
-			b2Pair* pair = m_pairBuffer + i;
-			if (pair->proxyIdA != primaryPair->proxyIdA || pair->proxyIdB != primaryPair->proxyIdB)
-			{
-				break;
-			}
-			++i;
-		}
 	}
-
-	// Try to keep the tree balanced.
-	m_tree.Rebalance(4);
 }
 
 template <typename T>
 inline void b2BroadPhase::Query(T* callback, const b2AABB& aabb) const
 {
-	m_tree.Query(callback, aabb);
+	b2TreeCallbackWrapper<T> wrapper;
+	wrapper.callback = callback;
+	wrapper.proxyBits = 0;
+	wrapper.proceed = true;
+	m_tree.Query(&wrapper, aabb);
+
+	if (wrapper.proceed == false)
+	{
+		return;
+	}
+
+	wrapper.proxyBits = e_staticProxyBit;
+	m_staticTree.Query(&wrapper, aabb);
 }
 
 template <typename T>
 inline void b2BroadPhase::RayCast(T* callback, const b2RayCastInput& input) const
 {
-	m_tree.RayCast(callback, input);
+	b2TreeCallbackWrapper<T> wrapper;
+	wrapper.callback = callback;
+	wrapper.proxyBits = 0;
+	wrapper.maxFraction = input.maxFraction;
+	wrapper.proceed = true;
+	m_tree.RayCast(&wrapper, input);
+
+	if (wrapper.proceed == false)
+	{
+		return;
+	}
+
+	// Carry the clipped ray over to the static tree.
+	b2RayCastInput subInput = input;
+	subInput.maxFraction = wrapper.maxFraction;
+	wrapper.proxyBits = e_staticProxyBit;
+	m_staticTree.RayCast(&wrapper, subInput);
+}
+
+template <typename T>
+inline void b2BroadPhase::RayCastPacket(T* callback, const b2RayCastInput* inputs, int32 count) const
+{
+	b2TreePacketCallbackWrapper<T> wrapper;
+	wrapper.callback = callback;
+	wrapper.proxyBits = 0;
+	for (int32 i = 0; i < count; ++i)
+	{
+		wrapper.rayIndices[i] = i;
+		wrapper.maxFractions[i] = inputs[i].maxFraction;
+		wrapper.proceed[i] = true;
+	}
+
+	m_tree.RayCastPacket(&wrapper, inputs, count);
+
+	// Carry the rays that are still going over to the static tree.
+	b2RayCastInput subInputs[b2_rayPacketSize];
+	int32 subCount = 0;
+	for (int32 i = 0; i < count; ++i)
+	{
+		if (wrapper.proceed[i] == false)
+		{
+			continue;
+		}
+
+		subInputs[subCount] = inputs[i];
+		subInputs[subCount].maxFraction = wrapper.maxFractions[i];
+		wrapper.rayIndices[subCount] = i;
+		++subCount;
+	}
+
+	if (subCount == 0)
+	{
+		return;
+	}
+
+	wrapper.proxyBits = e_staticProxyBit;
+	m_staticTree.RayCastPacket(&wrapper, subInputs, subCount);
 }
 
 #endif
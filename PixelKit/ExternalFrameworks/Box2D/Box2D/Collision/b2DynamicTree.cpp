@@ -17,35 +17,56 @@
 */
 
 #include "b2DynamicTree.h"
+#include "b2Snapshot.h"
 #include <cstring>
 #include <cfloat>
 
 b2DynamicTree::b2DynamicTree()
 {
+	m_arena = NULL;
+
 	m_root = b2_nullNode;
 
 	m_nodeCapacity = 16;
 	m_nodeCount = 0;
-	m_nodes = (b2DynamicTreeNode*)b2Alloc(m_nodeCapacity * sizeof(b2DynamicTreeNode));
+	m_nodes = (b2DynamicTreeNode*)b2Alloc(m_arena, m_nodeCapacity * sizeof(b2DynamicTreeNode));
 	memset(m_nodes, 0, m_nodeCapacity * sizeof(b2DynamicTreeNode));
 
 	// Build a linked list for the free list.
 	for (int32 i = 0; i < m_nodeCapacity - 1; ++i)
 	{
 		m_nodes[i].next = i + 1;
+		m_nodes[i].height = -1;
 	}
 	m_nodes[m_nodeCapacity-1].next = b2_nullNode;
+	m_nodes[m_nodeCapacity-1].height = -1;
 	m_freeList = 0;
 
 	m_path = 0;
 
 	m_insertionCount = 0;
+
+	m_aabbExtension = b2_aabbExtension;
+	m_aabbMultiplier = b2_aabbMultiplier;
 }
 
 b2DynamicTree::~b2DynamicTree()
 {
 	// This frees the entire tree in one shot.
-	b2Free(m_nodes);
+	b2Free(m_arena, m_nodes, m_nodeCapacity * sizeof(b2DynamicTreeNode));
+}
+
+void b2DynamicTree::SetArena(b2MemoryArena* arena)
+{
+	b2Assert(m_nodeCount == 0);
+
+	// The empty pool only holds the free list, so it is moved as is.
+	int32 size = m_nodeCapacity * sizeof(b2DynamicTreeNode);
+	b2DynamicTreeNode* oldNodes = m_nodes;
+	m_nodes = (b2DynamicTreeNode*)b2Alloc(arena, size);
+	memcpy(m_nodes, oldNodes, size);
+	b2Free(m_arena, oldNodes, size);
+	m_arena = arena;
 }
 
 // Allocate a node from the pool. Grow the pool if necessary.
@@ -58,18 +79,21 @@ int32 b2DynamicTree::AllocateNode()
 
 		// The free list is empty. Rebuild a bigger pool.
 		b2DynamicTreeNode* oldNodes = m_nodes;
+		int32 oldCapacity = m_nodeCapacity;
 		m_nodeCapacity *= 2;
-		m_nodes = (b2DynamicTreeNode*)b2Alloc(m_nodeCapacity * sizeof(b2DynamicTreeNode));
+		m_nodes = (b2DynamicTreeNode*)b2Alloc(m_arena, m_nodeCapacity * sizeof(b2DynamicTreeNode));
 		memcpy(m_nodes, oldNodes, m_nodeCount * sizeof(b2DynamicTreeNode));
-		b2Free(oldNodes);
+		b2Free(m_arena, oldNodes, oldCapacity * sizeof(b2DynamicTreeNode));
 
 		// Build a linked list for the free list. The parent
 		// pointer becomes the "next" pointer.
 		for (int32 i = m_nodeCount; i < m_nodeCapacity - 1; ++i)
 		{
 			m_nodes[i].next = i + 1;
+			m_nodes[i].height = -1;
 		}
 		m_nodes[m_nodeCapacity-1].next = b2_nullNode;
+		m_nodes[m_nodeCapacity-1].height = -1;
 		m_freeList = m_nodeCount;
 	}
 
@@ -80,6 +104,8 @@ int32 b2DynamicTree::AllocateNode()
 	m_nodes[nodeId].child1 = b2_nullNode;
 	m_nodes[nodeId].child2 = b2_nullNode;
 	m_nodes[nodeId].leafCount = 0;
+	m_nodes[nodeId].height = 0;
+	m_nodes[nodeId].moved = false;
 	++m_nodeCount;
 	return nodeId;
 }
@@ -90,6 +116,7 @@ void b2DynamicTree::FreeNode(int32 nodeId)
 	b2Assert(0 <= nodeId && nodeId < m_nodeCapacity);
 	b2Assert(0 < m_nodeCount);
 	m_nodes[nodeId].next = m_freeList;
+	m_nodes[nodeId].height = -1;
 	m_freeList = nodeId;
 	--m_nodeCount;
 }
@@ -102,11 +129,12 @@ int32 b2DynamicTree::CreateProxy(const b2AABB& aabb, void* userData)
 	int32 proxyId = AllocateNode();
 
 	// Fatten the aabb.
-	b2Vec2 r(b2_aabbExtension, b2_aabbExtension);
+	b2Vec2 r(m_aabbExtension, m_aabbExtension);
 	m_nodes[proxyId].aabb.lowerBound = aabb.lowerBound - r;
 	m_nodes[proxyId].aabb.upperBound = aabb.upperBound + r;
 	m_nodes[proxyId].userData = userData;
 	m_nodes[proxyId].leafCount = 1;
+	m_nodes[proxyId].height = 0;
 
 	InsertLeaf(proxyId);
 
@@ -137,12 +165,12 @@ bool b2DynamicTree::MoveProxy(int32 proxyId, const b2AABB& aabb, const b2Vec2& d
 
 	// Extend AABB.
 	b2AABB b = aabb;
-	b2Vec2 r(b2_aabbExtension, b2_aabbExtension);
+	b2Vec2 r(m_aabbExtension, m_aabbExtension);
 	b.lowerBound = b.lowerBound - r;
 	b.upperBound = b.upperBound + r;
 
 	// Predict AABB displacement.
-	b2Vec2 d = b2_aabbMultiplier * displacement;
+	b2Vec2 d = m_aabbMultiplier * displacement;
 
 	if (d.x < 0.0f)
 	{
@@ -168,6 +196,13 @@ bool b2DynamicTree::MoveProxy(int32 proxyId, const b2AABB& aabb, const b2Vec2& d
 	return true;
 }
 
+void b2DynamicTree::SetFattening(float32 extension, float32 multiplier)
+{
+	b2Assert(extension >= 0.0f && multiplier >= 0.0f);
+	m_aabbExtension = extension;
+	m_aabbMultiplier = multiplier;
+}
+
 void b2DynamicTree::InsertLeaf(int32 leaf)
 {
 	++m_insertionCount;
@@ -187,18 +222,18 @@ void b2DynamicTree::InsertLeaf(int32 leaf)
 		int32 child1 = m_nodes[sibling].child1;
 		int32 child2 = m_nodes[sibling].child2;
 
-		// Expand the node's AABB.
-		m_nodes[sibling].aabb.Combine(leafAABB);
-		m_nodes[sibling].leafCount += 1;
-
 		float32 siblingArea = m_nodes[sibling].aabb.GetPerimeter();
 		b2AABB parentAABB;
 		parentAABB.Combine(m_nodes[sibling].aabb, leafAABB);
 		float32 parentArea = parentAABB.GetPerimeter();
+
+		// Cost of creating a new parent for this node and the new leaf
 		float32 cost1 = 2.0f * parentArea;
 
+		// Minimum cost of pushing the leaf further down the tree
 		float32 inheritanceCost = 2.0f * (parentArea - siblingArea);
 
+		// Cost of descending into child1
 		float32 cost2;
 		if (m_nodes[child1].IsLeaf())
 		{
@@ -215,6 +250,7 @@ void b2DynamicTree::InsertLeaf(int32 leaf)
 			cost2 = (newArea - oldArea) + inheritanceCost;
 		}
 
+		// Cost of descending into child2
 		float32 cost3;
 		if (m_nodes[child2].IsLeaf())
 		{
@@ -237,9 +273,6 @@ void b2DynamicTree::InsertLeaf(int32 leaf)
 			break;
 		}
 
-		// Expand the node's AABB to account for the new leaf.
-		m_nodes[sibling].aabb.Combine(leafAABB);
-
 		// Descend
 		if (cost2 < cost3)
 		{
@@ -258,6 +291,7 @@ void b2DynamicTree::InsertLeaf(int32 leaf)
 	m_nodes[newParent].userData = NULL;
 	m_nodes[newParent].aabb.Combine(leafAABB, m_nodes[sibling].aabb);
 	m_nodes[newParent].leafCount = m_nodes[sibling].leafCount + 1;
+	m_nodes[newParent].height = m_nodes[sibling].height + 1;
 
 	if (oldParent != b2_nullNode)
 	{
@@ -285,6 +319,9 @@ void b2DynamicTree::InsertLeaf(int32 leaf)
 		m_nodes[leaf].parent = newParent;
 		m_root = newParent;
 	}
+
+	// Walk back up the tree fixing heights and AABBs.
+	UpdateAncestors(m_nodes[leaf].parent);
 }
 
 void b2DynamicTree::RemoveLeaf(int32 leaf)
@@ -322,26 +359,184 @@ void b2DynamicTree::RemoveLeaf(int32 leaf)
 		FreeNode(parent);
 
 		// Adjust ancestor bounds.
-		parent = grandParent;
-		while (parent != b2_nullNode)
+		UpdateAncestors(grandParent);
+	}
+	else
+	{
+		m_root = sibling;
+		m_nodes[sibling].parent = b2_nullNode;
+		FreeNode(parent);
+	}
+}
+
+// Refit the AABBs, heights and leaf counts from a node up to the root,
+// rotating where the heights get out of balance.
+void b2DynamicTree::UpdateAncestors(int32 index)
+{
+	while (index != b2_nullNode)
+	{
+		index = Balance(index);
+
+		b2DynamicTreeNode* node = m_nodes + index;
+		const b2DynamicTreeNode* child1 = m_nodes + node->child1;
+		const b2DynamicTreeNode* child2 = m_nodes + node->child2;
+
+		b2Assert(node->child1 != b2_nullNode);
+		b2Assert(node->child2 != b2_nullNode);
+
+		node->aabb.Combine(child1->aabb, child2->aabb);
+		node->height = 1 + b2Max(child1->height, child2->height);
+		node->leafCount = child1->leafCount + child2->leafCount;
+
+		index = node->parent;
+	}
+}
+
+// Perform a left or right rotation if node A is imbalanced.
+// Returns the new root index of the sub-tree.
+int32 b2DynamicTree::Balance(int32 iA)
+{
+	b2Assert(iA != b2_nullNode);
+
+	b2DynamicTreeNode* A = m_nodes + iA;
+	if (A->IsLeaf() || A->height < 2)
+	{
+		return iA;
+	}
+
+	int32 iB = A->child1;
+	int32 iC = A->child2;
+	b2Assert(0 <= iB && iB < m_nodeCapacity);
+	b2Assert(0 <= iC && iC < m_nodeCapacity);
+
+	b2DynamicTreeNode* B = m_nodes + iB;
+	b2DynamicTreeNode* C = m_nodes + iC;
+
+	int32 balance = C->height - B->height;
+
+	// Rotate C up
+	if (balance > 1)
+	{
+		int32 iF = C->child1;
+		int32 iG = C->child2;
+		b2DynamicTreeNode* F = m_nodes + iF;
+		b2DynamicTreeNode* G = m_nodes + iG;
+		b2Assert(0 <= iF && iF < m_nodeCapacity);
+		b2Assert(0 <= iG && iG < m_nodeCapacity);
+
+		// Swap A and C
+		C->child1 = iA;
+		C->parent = A->parent;
+		A->parent = iC;
+
+		// A's old parent should point to C
+		ReplaceChild(C->parent, iA, iC);
+
+		// Rotate
+		if (F->height > G->height)
 		{
-			b2AABB oldAABB = m_nodes[parent].aabb;
-			if (oldAABB.IsValid())
-			{
-			}
-			m_nodes[parent].aabb.Combine(m_nodes[m_nodes[parent].child1].aabb, m_nodes[m_nodes[parent].child2].aabb);
+			C->child2 = iF;
+			A->child2 = iG;
+			G->parent = iA;
+			A->aabb.Combine(B->aabb, G->aabb);
+			C->aabb.Combine(A->aabb, F->aabb);
+
+			A->height = 1 + b2Max(B->height, G->height);
+			C->height = 1 + b2Max(A->height, F->height);
+
+			A->leafCount = B->leafCount + G->leafCount;
+			C->leafCount = A->leafCount + F->leafCount;
+		}
+		else
+		{
+			C->child2 = iG;
+			A->child2 = iF;
+			F->parent = iA;
+			A->aabb.Combine(B->aabb, F->aabb);
+			C->aabb.Combine(A->aabb, G->aabb);
+
+			A->height = 1 + b2Max(B->height, F->height);
+			C->height = 1 + b2Max(A->height, G->height);
+
+			A->leafCount = B->leafCount + F->leafCount;
+			C->leafCount = A->leafCount + G->leafCount;
+		}
+
+		return iC;
+	}
+
+	// Rotate B up
+	if (balance < -1)
+	{
+		int32 iD = B->child1;
+		int32 iE = B->child2;
+		b2DynamicTreeNode* D = m_nodes + iD;
+		b2DynamicTreeNode* E = m_nodes + iE;
+		b2Assert(0 <= iD && iD < m_nodeCapacity);
+		b2Assert(0 <= iE && iE < m_nodeCapacity);
+
+		// Swap A and B
+		B->child1 = iA;
+		B->parent = A->parent;
+		A->parent = iB;
+
+		// A's old parent should point to B
+		ReplaceChild(B->parent, iA, iB);
+
+		// Rotate
+		if (D->height > E->height)
+		{
+			B->child2 = iD;
+			A->child1 = iE;
+			E->parent = iA;
+			A->aabb.Combine(C->aabb, E->aabb);
+			B->aabb.Combine(A->aabb, D->aabb);
 
-			b2Assert(m_nodes[parent].leafCount > 0);
-			m_nodes[parent].leafCount -= 1;
+			A->height = 1 + b2Max(C->height, E->height);
+			B->height = 1 + b2Max(A->height, D->height);
 
-			parent = m_nodes[parent].parent;
+			A->leafCount = C->leafCount + E->leafCount;
+			B->leafCount = A->leafCount + D->leafCount;
 		}
+		else
+		{
+			B->child2 = iE;
+			A->child1 = iD;
+			D->parent = iA;
+			A->aabb.Combine(C->aabb, D->aabb);
+			B->aabb.Combine(A->aabb, E->aabb);
+
+			A->height = 1 + b2Max(C->height, D->height);
+			B->height = 1 + b2Max(A->height, E->height);
+
+			A->leafCount = C->leafCount + D->leafCount;
+			B->leafCount = A->leafCount + E->leafCount;
+		}
+
+		return iB;
+	}
+
+	return iA;
+}
+
+// Point a parent (or the root) at a new child.
+void b2DynamicTree::ReplaceChild(int32 parent, int32 oldChild, int32 newChild)
+{
+	if (parent == b2_nullNode)
+	{
+		b2Assert(m_root == oldChild);
+		m_root = newChild;
+		return;
+	}
+
+	if (m_nodes[parent].child1 == oldChild)
+	{
+		m_nodes[parent].child1 = newChild;
 	}
 	else
 	{
-		m_root = sibling;
-		m_nodes[sibling].parent = b2_nullNode;
-		FreeNode(parent);
+		b2Assert(m_nodes[parent].child2 == oldChild);
+		m_nodes[parent].child2 = newChild;
 	}
 }
 
@@ -379,6 +574,205 @@ void b2DynamicTree::Rebalance(int32 iterations)
 	}
 }
 
+// The number of bins used along the split axis by RebuildTopDown.
+#define b2_treeBinCount	16
+
+void b2DynamicTree::RebuildTopDown()
+{
+	if (m_root == b2_nullNode)
+	{
+		return;
+	}
+
+	// Gather the leaves and free the internal nodes.
+	int32 leafCapacity = m_nodeCount;
+	int32* leaves = (int32*)b2Alloc(m_arena, leafCapacity * sizeof(int32));
+	int32 leafCount = 0;
+	for (int32 i = 0; i < m_nodeCapacity; ++i)
+	{
+		if (m_nodes[i].height < 0)
+		{
+			// free node in pool
+			continue;
+		}
+
+		if (m_nodes[i].IsLeaf())
+		{
+			m_nodes[i].parent = b2_nullNode;
+			leaves[leafCount++] = i;
+		}
+		else
+		{
+			FreeNode(i);
+		}
+	}
+
+	m_root = BuildTopDown(leaves, leafCount);
+	m_nodes[m_root].parent = b2_nullNode;
+
+	b2Free(m_arena, leaves, leafCapacity * sizeof(int32));
+}
+
+// Build a sub-tree over some leaves, splitting them where the binned surface
+// area heuristic says. The leaves array is reordered.
+int32 b2DynamicTree::BuildTopDown(int32* leaves, int32 count)
+{
+	b2Assert(count > 0);
+
+	if (count == 1)
+	{
+		return leaves[0];
+	}
+
+	// Bound the centers, and split along the longest axis.
+	b2Vec2 lower = m_nodes[leaves[0]].aabb.GetCenter();
+	b2Vec2 upper = lower;
+	for (int32 i = 1; i < count; ++i)
+	{
+		b2Vec2 center = m_nodes[leaves[i]].aabb.GetCenter();
+		lower = b2Min(lower, center);
+		upper = b2Max(upper, center);
+	}
+
+	b2Vec2 extents = upper - lower;
+	int32 axis = extents.x >= extents.y ? 0 : 1;
+	float32 axisLower = axis == 0 ? lower.x : lower.y;
+	float32 axisExtent = axis == 0 ? extents.x : extents.y;
+
+	int32 split = count / 2;
+
+	if (axisExtent > b2_epsilon)
+	{
+		float32 binScale = b2_treeBinCount / axisExtent;
+
+		int32 binCounts[b2_treeBinCount];
+		b2AABB binAABBs[b2_treeBinCount];
+		for (int32 i = 0; i < b2_treeBinCount; ++i)
+		{
+			binCounts[i] = 0;
+		}
+
+		for (int32 i = 0; i < count; ++i)
+		{
+			const b2AABB& aabb = m_nodes[leaves[i]].aabb;
+			int32 bin = GetBin(aabb, axis, axisLower, binScale);
+			if (binCounts[bin] == 0)
+			{
+				binAABBs[bin] = aabb;
+			}
+			else
+			{
+				binAABBs[bin].Combine(aabb);
+			}
+			++binCounts[bin];
+		}
+
+		// Sweep from the right to get the cost of everything past each plane,
+		// then from the left to find the cheapest plane.
+		float32 rightCosts[b2_treeBinCount];
+		b2AABB aabb;
+		aabb.lowerBound.SetZero();
+		aabb.upperBound.SetZero();
+		int32 rightCount = 0;
+		for (int32 i = b2_treeBinCount - 1; i > 0; --i)
+		{
+			if (binCounts[i] > 0)
+			{
+				if (rightCount == 0)
+				{
+					aabb = binAABBs[i];
+				}
+				else
+				{
+					aabb.Combine(binAABBs[i]);
+				}
+				rightCount += binCounts[i];
+			}
+
+			rightCosts[i] = rightCount > 0 ? rightCount * aabb.GetPerimeter() : 0.0f;
+		}
+
+		float32 bestCost = b2_maxFloat;
+		int32 bestPlane = -1;
+		int32 leftCount = 0;
+		for (int32 i = 0; i < b2_treeBinCount - 1; ++i)
+		{
+			if (binCounts[i] > 0)
+			{
+				if (leftCount == 0)
+				{
+					aabb = binAABBs[i];
+				}
+				else
+				{
+					aabb.Combine(binAABBs[i]);
+				}
+				leftCount += binCounts[i];
+			}
+
+			if (leftCount == 0 || leftCount == count)
+			{
+				continue;
+			}
+
+			float32 cost = leftCount * aabb.GetPerimeter() + rightCosts[i + 1];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestPlane = i;
+			}
+		}
+
+		// Partition the leaves about the plane.
+		if (bestPlane >= 0)
+		{
+			int32 left = 0;
+			int32 right = count - 1;
+			while (left <= right)
+			{
+				if (GetBin(m_nodes[leaves[left]].aabb, axis, axisLower, binScale) <= bestPlane)
+				{
+					++left;
+				}
+				else
+				{
+					b2Swap(leaves[left], leaves[right]);
+					--right;
+				}
+			}
+
+			split = left;
+		}
+	}
+
+	b2Assert(0 < split && split < count);
+
+	int32 child1 = BuildTopDown(leaves, split);
+	int32 child2 = BuildTopDown(leaves + split, count - split);
+
+	int32 parent = AllocateNode();
+	b2DynamicTreeNode* node = m_nodes + parent;
+	node->child1 = child1;
+	node->child2 = child2;
+	node->userData = NULL;
+	node->aabb.Combine(m_nodes[child1].aabb, m_nodes[child2].aabb);
+	node->height = 1 + b2Max(m_nodes[child1].height, m_nodes[child2].height);
+	node->leafCount = m_nodes[child1].leafCount + m_nodes[child2].leafCount;
+
+	m_nodes[child1].parent = parent;
+	m_nodes[child2].parent = parent;
+
+	return parent;
+}
+
+int32 b2DynamicTree::GetBin(const b2AABB& aabb, int32 axis, float32 axisLower, float32 binScale)
+{
+	b2Vec2 center = aabb.GetCenter();
+	float32 value = axis == 0 ? center.x : center.y;
+	int32 bin = (int32)((value - axisLower) * binScale);
+	return b2Clamp(bin, 0, b2_treeBinCount - 1);
+}
+
 // Compute the height of a sub-tree.
 int32 b2DynamicTree::ComputeHeight(int32 nodeId) const
 {
@@ -399,6 +793,61 @@ int32 b2DynamicTree::ComputeHeight() const
 	return ComputeHeight(m_root);
 }
 
+int32 b2DynamicTree::GetHeight() const
+{
+	if (m_root == b2_nullNode)
+	{
+		return 0;
+	}
+
+	return m_nodes[m_root].height;
+}
+
+int32 b2DynamicTree::GetMaxBalance() const
+{
+	int32 maxBalance = 0;
+	for (int32 i = 0; i < m_nodeCapacity; ++i)
+	{
+		const b2DynamicTreeNode* node = m_nodes + i;
+		if (node->height <= 1)
+		{
+			continue;
+		}
+
+		b2Assert(node->IsLeaf() == false);
+
+		int32 balance = b2Abs(m_nodes[node->child2].height - m_nodes[node->child1].height);
+		maxBalance = b2Max(maxBalance, balance);
+	}
+
+	return maxBalance;
+}
+
+float32 b2DynamicTree::GetAreaRatio() const
+{
+	if (m_root == b2_nullNode)
+	{
+		return 0.0f;
+	}
+
+	float32 rootArea = m_nodes[m_root].aabb.GetPerimeter();
+
+	float32 totalArea = 0.0f;
+	for (int32 i = 0; i < m_nodeCapacity; ++i)
+	{
+		const b2DynamicTreeNode* node = m_nodes + i;
+		if (node->height < 0)
+		{
+			// Free node in pool
+			continue;
+		}
+
+		totalArea += node->aabb.GetPerimeter();
+	}
+
+	return totalArea / rootArea;
+}
+
 int32 b2DynamicTree::CountLeaves(int32 nodeId) const
 {
 	if (nodeId == b2_nullNode)
@@ -412,9 +861,14 @@ int32 b2DynamicTree::CountLeaves(int32 nodeId) const
 	if (node->IsLeaf())
 	{
 		b2Assert(node->leafCount == 1);
+		b2Assert(node->height == 0);
 		return 1;
 	}
 
+	b2Assert(m_nodes[node->child1].parent == nodeId);
+	b2Assert(m_nodes[node->child2].parent == nodeId);
+	b2Assert(node->height == 1 + b2Max(m_nodes[node->child1].height, m_nodes[node->child2].height));
+
 	int32 count1 = CountLeaves(node->child1);
 	int32 count2 = CountLeaves(node->child2);
 	int32 count = count1 + count2;
@@ -426,3 +880,87 @@ void b2DynamicTree::Validate() const
 {
 	CountLeaves(m_root);	
 }
+
+void b2DynamicTree::WriteSnapshot(b2Snapshot* snapshot) const
+{
+	snapshot->Write(m_root);
+	snapshot->Write(m_nodeCapacity);
+	snapshot->Write(m_nodeCount);
+	snapshot->Write(m_freeList);
+	snapshot->Write(m_path);
+	snapshot->Write(m_insertionCount);
+	snapshot->Write(m_aabbExtension);
+	snapshot->Write(m_aabbMultiplier);
+
+	for (int32 i = 0; i < m_nodeCapacity; ++i)
+	{
+		const b2DynamicTreeNode* node = m_nodes + i;
+		snapshot->Write(node->height);
+		snapshot->Write(node->next);
+
+		// Free nodes only keep their place in the free list.
+		if (node->height == -1)
+		{
+			continue;
+		}
+
+		snapshot->Write(node->aabb);
+		snapshot->Write(node->child1);
+		snapshot->Write(node->child2);
+		snapshot->Write(node->leafCount);
+		snapshot->Write(node->moved);
+	}
+}
+
+bool b2DynamicTree::ReadSnapshot(b2SnapshotReader* reader)
+{
+	int32 root, nodeCapacity, nodeCount, freeList;
+	reader->Read(&root);
+	reader->Read(&nodeCapacity);
+	reader->Read(&nodeCount);
+	reader->Read(&freeList);
+	if (reader->IsValid() == false || nodeCapacity <= 0 || nodeCount < 0 || nodeCount > nodeCapacity)
+	{
+		return false;
+	}
+
+	// The capacity decides when the pool grows next, so it is restored as well.
+	if (nodeCapacity != m_nodeCapacity)
+	{
+		b2Free(m_arena, m_nodes, m_nodeCapacity * sizeof(b2DynamicTreeNode));
+		m_nodeCapacity = nodeCapacity;
+		m_nodes = (b2DynamicTreeNode*)b2Alloc(m_arena, m_nodeCapacity * sizeof(b2DynamicTreeNode));
+	}
+	for (int32 i = 0; i < m_nodeCapacity; ++i)
+	{
+		m_nodes[i] = b2DynamicTreeNode();
+	}
+
+	m_root = root;
+	m_nodeCount = nodeCount;
+	m_freeList = freeList;
+	reader->Read(&m_path);
+	reader->Read(&m_insertionCount);
+	reader->Read(&m_aabbExtension);
+	reader->Read(&m_aabbMultiplier);
+
+	for (int32 i = 0; i < m_nodeCapacity; ++i)
+	{
+		b2DynamicTreeNode* node = m_nodes + i;
+		reader->Read(&node->height);
+		reader->Read(&node->next);
+
+		if (node->height == -1)
+		{
+			continue;
+		}
+
+		reader->Read(&node->aabb);
+		reader->Read(&node->child1);
+		reader->Read(&node->child2);
+		reader->Read(&node->leafCount);
+		reader->Read(&node->moved);
+	}
+
+	return reader->IsValid();
+}
@@ -22,10 +22,16 @@
 #include "b2Collision.h"
 #include "b2GrowableStack.h"
 
+class b2Snapshot;
+class b2SnapshotReader;
+
 /// A dynamic AABB tree broad-phase, inspired by Nathanael Presson's btDbvt.
 
 #define b2_nullNode (-1)
 
+/// The maximum number of rays in a packet. See b2DynamicTree::RayCastPacket.
+#define b2_rayPacketSize 4
+
 /// A node in the dynamic tree. The client does not interact with this directly.
 struct b2DynamicTreeNode
 {
@@ -48,6 +54,12 @@ struct b2DynamicTreeNode
 	int32 child1;
 	int32 child2;
 	int32 leafCount;
+
+	// leaf = 0, free node = -1
+	int32 height;
+
+	// Set while the proxy is in the broad-phase move buffer.
+	bool moved;
 };
 
 /// A dynamic tree arranges data in a binary tree to accelerate
@@ -56,6 +68,9 @@ struct b2DynamicTreeNode
 /// so that the proxy AABB is bigger than the client object. This allows the client
 /// object to move by small amounts without triggering a tree update.
 ///
+/// The tree is kept balanced as proxies are inserted and removed, using
+/// rotations on the way back up from the changed leaf.
+///
 /// Nodes are pooled and relocatable, so we use node indices rather than pointers.
 class b2DynamicTree
 {
@@ -67,6 +82,10 @@ public:
 	/// Destroy the tree, freeing the node pool.
 	~b2DynamicTree();
 
+	/// Set where the node pool and scratch memory come from. NULL means
+	/// b2Alloc. The tree must be empty.
+	void SetArena(b2MemoryArena* arena);
+
 	/// Create a proxy. Provide a tight fitting AABB and a userData pointer.
 	int32 CreateProxy(const b2AABB& aabb, void* userData);
 
@@ -79,20 +98,59 @@ public:
 	/// @return true if the proxy was re-inserted.
 	bool MoveProxy(int32 proxyId, const b2AABB& aabb1, const b2Vec2& displacement);
 
-	/// Perform some iterations to re-balance the tree.
+	/// Perform some iterations to re-balance the tree. Insertion and removal
+	/// already keep the tree balanced, so this is rarely needed.
 	void Rebalance(int32 iterations);
 
+	/// Build an optimal tree from scratch using the current leaves. This is
+	/// O(N log N), so call it after creating many proxies at once (e.g. when
+	/// a level is loaded) rather than every step.
+	void RebuildTopDown();
+
+	/// Set how much proxy AABBs are fattened. The extension is added to every
+	/// side of the AABB and the multiplier scales the predicted displacement
+	/// in MoveProxy. Bigger values mean fewer re-insertions but more pairs.
+	/// This only affects proxies created or moved afterwards.
+	void SetFattening(float32 extension, float32 multiplier);
+
+	/// Get the AABB extension. See SetFattening.
+	float32 GetAABBExtension() const;
+
+	/// Get the AABB displacement multiplier. See SetFattening.
+	float32 GetAABBMultiplier() const;
+
 	/// Get proxy user data.
 	/// @return the proxy user data or 0 if the id is invalid.
 	void* GetUserData(int32 proxyId) const;
 
+	/// Set proxy user data.
+	void SetUserData(int32 proxyId, void* userData);
+
 	/// Get the fat AABB for a proxy.
 	const b2AABB& GetFatAABB(int32 proxyId) const;
 
+	/// Was the proxy moved since the flag was last cleared? This is set and
+	/// cleared by the broad-phase.
+	bool WasMoved(int32 proxyId) const;
+
+	/// Set or clear the moved flag of a proxy.
+	void SetMoved(int32 proxyId, bool flag);
+
 	/// Compute the height of the binary tree in O(N) time. Should not be
 	/// called often.
 	int32 ComputeHeight() const;
 
+	/// Get the height of the binary tree in O(1) time.
+	int32 GetHeight() const;
+
+	/// Get the maximum balance of a node in the tree. The balance is the difference
+	/// in height of the two children of a node.
+	int32 GetMaxBalance() const;
+
+	/// Get the ratio of the sum of the node perimeters to the root perimeter.
+	/// Lower is better.
+	float32 GetAreaRatio() const;
+
 	/// Query an AABB for overlapping proxies. The callback class
 	/// is called for each proxy that overlaps the supplied AABB.
 	template <typename T>
@@ -108,8 +166,25 @@ public:
 	template <typename T>
 	void RayCast(T* callback, const b2RayCastInput& input) const;
 
+	/// Ray-cast a packet of up to b2_rayPacketSize rays together. Each node is
+	/// visited once for the whole packet, which saves work when the rays are
+	/// coherent (e.g. they share an origin). The callback is called as
+	/// RayCastCallback(input, proxyId, rayIndex) and controls each ray the same
+	/// way as in RayCast.
+	template <typename T>
+	void RayCastPacket(T* callback, const b2RayCastInput* inputs, int32 count) const;
+
 	void Validate() const;
 
+	/// Write the nodes and the state that affects future inserts to a snapshot.
+	/// User data is not written.
+	void WriteSnapshot(b2Snapshot* snapshot) const;
+
+	/// Replace the tree with one written by WriteSnapshot. All proxy ids are
+	/// the same as when it was written. User data is cleared and must be set
+	/// again with SetUserData.
+	bool ReadSnapshot(b2SnapshotReader* reader);
+
 private:
 
 	int32 AllocateNode();
@@ -118,10 +193,19 @@ private:
 	void InsertLeaf(int32 node);
 	void RemoveLeaf(int32 node);
 
+	void UpdateAncestors(int32 index);
+	int32 Balance(int32 index);
+	void ReplaceChild(int32 parent, int32 oldChild, int32 newChild);
+
+	int32 BuildTopDown(int32* leaves, int32 count);
+	static int32 GetBin(const b2AABB& aabb, int32 axis, float32 axisLower, float32 binScale);
+
 	int32 ComputeHeight(int32 nodeId) const;
 	
 	int32 CountLeaves(int32 nodeId) const;
 
+	b2MemoryArena* m_arena;
+
 	int32 m_root;
 
 	b2DynamicTreeNode* m_nodes;
@@ -134,6 +218,9 @@ private:
 	uint32 m_path;
 
 	int32 m_insertionCount;
+
+	float32 m_aabbExtension;
+	float32 m_aabbMultiplier;
 };
 
 inline void* b2DynamicTree::GetUserData(int32 proxyId) const
@@ -142,16 +229,44 @@ inline void* b2DynamicTree::GetUserData(int32 proxyId) const
 	return m_nodes[proxyId].userData;
 }
 
+inline void b2DynamicTree::SetUserData(int32 proxyId, void* userData)
+{
+	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
+	m_nodes[proxyId].userData = userData;
+}
+
 inline const b2AABB& b2DynamicTree::GetFatAABB(int32 proxyId) const
 {
 	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
 	return m_nodes[proxyId].aabb;
 }
 
+inline bool b2DynamicTree::WasMoved(int32 proxyId) const
+{
+	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
+	return m_nodes[proxyId].moved;
+}
+
+inline void b2DynamicTree::SetMoved(int32 proxyId, bool flag)
+{
+	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
+	m_nodes[proxyId].moved = flag;
+}
+
+inline float32 b2DynamicTree::GetAABBExtension() const
+{
+	return m_aabbExtension;
+}
+
+inline float32 b2DynamicTree::GetAABBMultiplier() const
+{
+	return m_aabbMultiplier;
+}
+
 template <typename T>
 inline void b2DynamicTree::Query(T* callback, const b2AABB& aabb) const
 {
-	b2GrowableStack<int32, 256> stack;
+	b2GrowableStack<int32, 256> stack(m_arena);
 	stack.Push(m_root);
 
 	while (stack.GetCount() > 0)
@@ -209,7 +324,7 @@ inline void b2DynamicTree::RayCast(T* callback, const b2RayCastInput& input) con
 		segmentAABB.upperBound = b2Max(p1, t);
 	}
 
-	b2GrowableStack<int32, 256> stack;
+	b2GrowableStack<int32, 256> stack(m_arena);
 	stack.Push(m_root);
 
 	while (stack.GetCount() > 0)
@@ -269,4 +384,137 @@ inline void b2DynamicTree::RayCast(T* callback, const b2RayCastInput& input) con
 	}
 }
 
+// A node to visit, and the rays of the packet that reached it.
+struct b2RayPacketNode
+{
+	int32 nodeId;
+	int32 rayMask;
+};
+
+template <typename T>
+inline void b2DynamicTree::RayCastPacket(T* callback, const b2RayCastInput* inputs, int32 count) const
+{
+	b2Assert(0 < count && count <= b2_rayPacketSize);
+
+	b2Vec2 vs[b2_rayPacketSize];
+	b2Vec2 abs_vs[b2_rayPacketSize];
+	float32 maxFractions[b2_rayPacketSize];
+	b2AABB segmentAABBs[b2_rayPacketSize];
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Vec2 p1 = inputs[i].p1;
+		b2Vec2 p2 = inputs[i].p2;
+		b2Vec2 r = p2 - p1;
+		b2Assert(r.LengthSquared() > 0.0f);
+		r.Normalize();
+
+		// v is perpendicular to the segment.
+		vs[i] = b2Cross(1.0f, r);
+		abs_vs[i] = b2Abs(vs[i]);
+
+		maxFractions[i] = inputs[i].maxFraction;
+
+		b2Vec2 t = p1 + maxFractions[i] * (p2 - p1);
+		segmentAABBs[i].lowerBound = b2Min(p1, t);
+		segmentAABBs[i].upperBound = b2Max(p1, t);
+	}
+
+	// Rays that have not been terminated by the client.
+	int32 activeMask = (1 << count) - 1;
+
+	b2GrowableStack<b2RayPacketNode, 256> stack(m_arena);
+	b2RayPacketNode root;
+	root.nodeId = m_root;
+	root.rayMask = activeMask;
+	stack.Push(root);
+
+	while (stack.GetCount() > 0)
+	{
+		b2RayPacketNode entry = stack.Pop();
+		if (entry.nodeId == b2_nullNode)
+		{
+			continue;
+		}
+
+		const b2DynamicTreeNode* node = m_nodes + entry.nodeId;
+		b2Vec2 c = node->aabb.GetCenter();
+		b2Vec2 h = node->aabb.GetExtents();
+
+		// Find the rays that reach this node.
+		int32 rayMask = 0;
+		for (int32 i = 0; i < count; ++i)
+		{
+			if ((entry.rayMask & activeMask & (1 << i)) == 0)
+			{
+				continue;
+			}
+
+			if (b2TestOverlap(node->aabb, segmentAABBs[i]) == false)
+			{
+				continue;
+			}
+
+			// Separating axis for segment (Gino, p80).
+			// |dot(v, p1 - c)| > dot(|v|, h)
+			float32 separation = b2Abs(b2Dot(vs[i], inputs[i].p1 - c)) - b2Dot(abs_vs[i], h);
+			if (separation > 0.0f)
+			{
+				continue;
+			}
+
+			rayMask |= 1 << i;
+		}
+
+		if (rayMask == 0)
+		{
+			continue;
+		}
+
+		if (node->IsLeaf() == false)
+		{
+			b2RayPacketNode child;
+			child.rayMask = rayMask;
+			child.nodeId = node->child1;
+			stack.Push(child);
+			child.nodeId = node->child2;
+			stack.Push(child);
+			continue;
+		}
+
+		for (int32 i = 0; i < count; ++i)
+		{
+			if ((rayMask & (1 << i)) == 0)
+			{
+				continue;
+			}
+
+			b2RayCastInput subInput;
+			subInput.p1 = inputs[i].p1;
+			subInput.p2 = inputs[i].p2;
+			subInput.maxFraction = maxFractions[i];
+
+			float32 value = callback->RayCastCallback(subInput, entry.nodeId, i);
+
+			if (value == 0.0f)
+			{
+				// The client has terminated this ray.
+				activeMask &= ~(1 << i);
+				if (activeMask == 0)
+				{
+					return;
+				}
+			}
+			else if (value > 0.0f)
+			{
+				// Update segment bounding box.
+				maxFractions[i] = value;
+				b2Vec2 t = inputs[i].p1 + value * (inputs[i].p2 - inputs[i].p1);
+				segmentAABBs[i].lowerBound = b2Min(inputs[i].p1, t);
+				segmentAABBs[i].upperBound = b2Max(inputs[i].p1, t);
+			}
+		}
+	}
+}
+
 #endif
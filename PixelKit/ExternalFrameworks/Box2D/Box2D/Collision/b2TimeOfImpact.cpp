@@ -24,6 +24,8 @@
 
 #include <cstdio>
 
+// Profiling counters. They are updated atomically, once per call, since a
+// world with a thread pool computes TOIs on the pool's threads.
 int32 b2_toiCalls, b2_toiIters, b2_toiMaxIters;
 int32 b2_toiRootIters, b2_toiMaxRootIters;
 
@@ -255,8 +257,6 @@ struct b2SeparationFunction
 // by computing the largest time at which separation is maintained.
 void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 {
-	++b2_toiCalls;
-
 	output->state = b2TOIOutput::e_unknown;
 	output->t = input->tMax;
 
@@ -281,6 +281,8 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 	float32 t1 = 0.0f;
 	const int32 k_maxIterations = 20;	// TODO_ERIN b2Settings
 	int32 iter = 0;
+	int32 rootIters = 0;
+	int32 maxRootIters = 0;
 
 	// Prepare input for distance query.
 	b2SimplexCache cache;
@@ -443,7 +445,7 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 				}
 
 				++rootIterCount;
-				++b2_toiRootIters;
+				++rootIters;
 
 				if (rootIterCount == 50)
 				{
@@ -451,7 +453,7 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 				}
 			}
 
-			b2_toiMaxRootIters = b2Max(b2_toiMaxRootIters, rootIterCount);
+			maxRootIters = b2Max(maxRootIters, rootIterCount);
 
 			++pushBackIter;
 
@@ -462,7 +464,6 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 		}
 
 		++iter;
-		++b2_toiIters;
 
 		if (done)
 		{
@@ -478,5 +479,9 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 		}
 	}
 
-	b2_toiMaxIters = b2Max(b2_toiMaxIters, iter);
+	b2AtomicAdd(&b2_toiCalls, 1);
+	b2AtomicAdd(&b2_toiIters, iter);
+	b2AtomicMax(&b2_toiMaxIters, iter);
+	b2AtomicAdd(&b2_toiRootIters, rootIters);
+	b2AtomicMax(&b2_toiMaxRootIters, maxRootIters);
 }
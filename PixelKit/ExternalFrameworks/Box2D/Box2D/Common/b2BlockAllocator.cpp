@@ -17,10 +17,12 @@
 */
 
 #include "b2BlockAllocator.h"
+#include "b2Math.h"
 #include <cstdlib>
 #include <climits>
 #include <cstring>
 #include <memory>
+#include <algorithm>
 
 int32 b2BlockAllocator::s_blockSizes[b2_blockSizes] = 
 {
@@ -45,6 +47,7 @@ bool b2BlockAllocator::s_blockSizeLookupInitialized;
 struct b2Chunk
 {
 	int32 blockSize;
+	int32 size;
 	b2Block* blocks;
 };
 
@@ -57,9 +60,17 @@ b2BlockAllocator::b2BlockAllocator()
 {
 	b2Assert(b2_blockSizes < UCHAR_MAX);
 
+	m_arena = NULL;
+	m_chunkSize = b2_chunkSize;
+
+	m_allocatedBytes = 0;
+	m_maxAllocatedBytes = 0;
+	m_chunkBytes = 0;
+	m_maxChunkBytes = 0;
+
 	m_chunkSpace = b2_chunkArrayIncrement;
 	m_chunkCount = 0;
-	m_chunks = (b2Chunk*)b2Alloc(m_chunkSpace * sizeof(b2Chunk));
+	m_chunks = (b2Chunk*)AllocateMemory(m_chunkSpace * sizeof(b2Chunk));
 	
 	memset(m_chunks, 0, m_chunkSpace * sizeof(b2Chunk));
 	memset(m_freeLists, 0, sizeof(m_freeLists));
@@ -89,10 +100,48 @@ b2BlockAllocator::~b2BlockAllocator()
 {
 	for (int32 i = 0; i < m_chunkCount; ++i)
 	{
-		b2Free(m_chunks[i].blocks);
+		FreeMemory(m_chunks[i].blocks, m_chunks[i].size);
 	}
 
-	b2Free(m_chunks);
+	FreeMemory(m_chunks, m_chunkSpace * sizeof(b2Chunk));
+}
+
+void b2BlockAllocator::SetArena(b2MemoryArena* arena)
+{
+	b2Assert(m_chunkCount == 0);
+
+	FreeMemory(m_chunks, m_chunkSpace * sizeof(b2Chunk));
+	m_arena = arena;
+	m_chunks = (b2Chunk*)AllocateMemory(m_chunkSpace * sizeof(b2Chunk));
+	memset(m_chunks, 0, m_chunkSpace * sizeof(b2Chunk));
+}
+
+void b2BlockAllocator::SetChunkSize(int32 chunkSize)
+{
+	b2Assert(chunkSize >= b2_maxBlockSize);
+	m_chunkSize = chunkSize;
+}
+
+void* b2BlockAllocator::AllocateMemory(int32 size)
+{
+	if (m_arena)
+	{
+		return m_arena->Allocate(size);
+	}
+
+	return b2Alloc(size);
+}
+
+void b2BlockAllocator::FreeMemory(void* p, int32 size)
+{
+	if (m_arena)
+	{
+		m_arena->Free(p, size);
+	}
+	else
+	{
+		b2Free(p);
+	}
 }
 
 void* b2BlockAllocator::Allocate(int32 size)
@@ -105,6 +154,9 @@ void* b2BlockAllocator::Allocate(int32 size)
 	int32 index = s_blockSizeLookup[size];
 	b2Assert(0 <= index && index < b2_blockSizes);
 
+	m_allocatedBytes += s_blockSizes[index];
+	m_maxAllocatedBytes = b2Max(m_maxAllocatedBytes, m_allocatedBytes);
+
 	if (m_freeLists[index])
 	{
 		b2Block* block = m_freeLists[index];
@@ -117,21 +169,25 @@ void* b2BlockAllocator::Allocate(int32 size)
 		{
 			b2Chunk* oldChunks = m_chunks;
 			m_chunkSpace += b2_chunkArrayIncrement;
-			m_chunks = (b2Chunk*)b2Alloc(m_chunkSpace * sizeof(b2Chunk));
+			m_chunks = (b2Chunk*)AllocateMemory(m_chunkSpace * sizeof(b2Chunk));
 			memcpy(m_chunks, oldChunks, m_chunkCount * sizeof(b2Chunk));
 			memset(m_chunks + m_chunkCount, 0, b2_chunkArrayIncrement * sizeof(b2Chunk));
-			b2Free(oldChunks);
+			FreeMemory(oldChunks, (m_chunkSpace - b2_chunkArrayIncrement) * sizeof(b2Chunk));
 		}
 
 		b2Chunk* chunk = m_chunks + m_chunkCount;
-		chunk->blocks = (b2Block*)b2Alloc(b2_chunkSize);
+		chunk->size = m_chunkSize;
+		chunk->blocks = (b2Block*)AllocateMemory(chunk->size);
 #if defined(_DEBUG)
-		memset(chunk->blocks, 0xcd, b2_chunkSize);
+		memset(chunk->blocks, 0xcd, chunk->size);
 #endif
+		m_chunkBytes += chunk->size;
+		m_maxChunkBytes = b2Max(m_maxChunkBytes, m_chunkBytes);
+
 		int32 blockSize = s_blockSizes[index];
 		chunk->blockSize = blockSize;
-		int32 blockCount = b2_chunkSize / blockSize;
-		b2Assert(blockCount * blockSize <= b2_chunkSize);
+		int32 blockCount = chunk->size / blockSize;
+		b2Assert(blockCount * blockSize <= chunk->size);
 		for (int32 i = 0; i < blockCount - 1; ++i)
 		{
 			b2Block* block = (b2Block*)((int8*)chunk->blocks + blockSize * i);
@@ -160,6 +216,8 @@ void b2BlockAllocator::Free(void* p, int32 size)
 	int32 index = s_blockSizeLookup[size];
 	b2Assert(0 <= index && index < b2_blockSizes);
 
+	m_allocatedBytes -= s_blockSizes[index];
+
 #ifdef _DEBUG
 	// Verify the memory address and size is valid.
 	int32 blockSize = s_blockSizes[index];
@@ -170,11 +228,11 @@ void b2BlockAllocator::Free(void* p, int32 size)
 		if (chunk->blockSize != blockSize)
 		{
 			b2Assert(	(int8*)p + blockSize <= (int8*)chunk->blocks ||
-						(int8*)chunk->blocks + b2_chunkSize <= (int8*)p);
+						(int8*)chunk->blocks + chunk->size <= (int8*)p);
 		}
 		else
 		{
-			if ((int8*)chunk->blocks <= (int8*)p && (int8*)p + blockSize <= (int8*)chunk->blocks + b2_chunkSize)
+			if ((int8*)chunk->blocks <= (int8*)p && (int8*)p + blockSize <= (int8*)chunk->blocks + chunk->size)
 			{
 				found = true;
 			}
@@ -195,11 +253,127 @@ void b2BlockAllocator::Clear()
 {
 	for (int32 i = 0; i < m_chunkCount; ++i)
 	{
-		b2Free(m_chunks[i].blocks);
+		FreeMemory(m_chunks[i].blocks, m_chunks[i].size);
 	}
 
 	m_chunkCount = 0;
+	m_chunkBytes = 0;
+	m_allocatedBytes = 0;
 	memset(m_chunks, 0, m_chunkSpace * sizeof(b2Chunk));
 
 	memset(m_freeLists, 0, sizeof(m_freeLists));
 }
+
+// A chunk's memory range, used to find the chunk a free block belongs to.
+struct b2ChunkRange
+{
+	bool operator<(const b2ChunkRange& other) const
+	{
+		return begin < other.begin;
+	}
+
+	int8* begin;
+	int32 index;
+};
+
+static int32 b2FindChunk(const b2ChunkRange* ranges, int32 count, void* p)
+{
+	// Find the last chunk starting at or before p.
+	int32 low = 0;
+	int32 high = count - 1;
+	while (low < high)
+	{
+		int32 mid = (low + high + 1) / 2;
+		if (ranges[mid].begin <= (int8*)p)
+		{
+			low = mid;
+		}
+		else
+		{
+			high = mid - 1;
+		}
+	}
+
+	return ranges[low].index;
+}
+
+void b2BlockAllocator::Trim()
+{
+	if (m_chunkCount == 0)
+	{
+		return;
+	}
+
+	int32 rangesSize = m_chunkCount * sizeof(b2ChunkRange);
+	int32 freeCountsSize = m_chunkCount * sizeof(int32);
+	b2ChunkRange* ranges = (b2ChunkRange*)AllocateMemory(rangesSize);
+	int32* freeCounts = (int32*)AllocateMemory(freeCountsSize);
+	for (int32 i = 0; i < m_chunkCount; ++i)
+	{
+		ranges[i].begin = (int8*)m_chunks[i].blocks;
+		ranges[i].index = i;
+		freeCounts[i] = 0;
+	}
+
+	std::sort(ranges, ranges + m_chunkCount);
+
+	// Count the free blocks in each chunk.
+	for (int32 i = 0; i < b2_blockSizes; ++i)
+	{
+		for (b2Block* block = m_freeLists[i]; block; block = block->next)
+		{
+			++freeCounts[b2FindChunk(ranges, m_chunkCount, block)];
+		}
+	}
+
+	// Mark the chunks that are completely free.
+	bool found = false;
+	for (int32 i = 0; i < m_chunkCount; ++i)
+	{
+		const b2Chunk* chunk = m_chunks + i;
+		bool empty = freeCounts[i] == chunk->size / chunk->blockSize;
+		freeCounts[i] = empty ? 1 : 0;
+		found = found || empty;
+	}
+
+	if (found)
+	{
+		// Take their blocks off the free lists.
+		for (int32 i = 0; i < b2_blockSizes; ++i)
+		{
+			b2Block** link = m_freeLists + i;
+			while (*link)
+			{
+				if (freeCounts[b2FindChunk(ranges, m_chunkCount, *link)])
+				{
+					*link = (*link)->next;
+				}
+				else
+				{
+					link = &(*link)->next;
+				}
+			}
+		}
+
+		// Release them and close the gaps.
+		int32 count = 0;
+		for (int32 i = 0; i < m_chunkCount; ++i)
+		{
+			if (freeCounts[i])
+			{
+				m_chunkBytes -= m_chunks[i].size;
+				FreeMemory(m_chunks[i].blocks, m_chunks[i].size);
+			}
+			else
+			{
+				m_chunks[count++] = m_chunks[i];
+			}
+		}
+
+		memset(m_chunks + count, 0, (m_chunkCount - count) * sizeof(b2Chunk));
+		m_chunkCount = count;
+	}
+
+	FreeMemory(freeCounts, freeCountsSize);
+	FreeMemory(ranges, rangesSize);
+}
@@ -38,17 +38,48 @@ public:
 	b2BlockAllocator();
 	~b2BlockAllocator();
 
+	// Set where the memory comes from. NULL means b2Alloc. This must be set
+	// before anything is allocated.
+	void SetArena(b2MemoryArena* arena);
+
+	// Set the size of the chunks that blocks are carved from. This applies to
+	// chunks allocated from now on. It must be at least b2_maxBlockSize.
+	void SetChunkSize(int32 chunkSize);
+
 	void* Allocate(int32 size);
 	void Free(void* p, int32 size);
 
 	void Clear();
 
+	// Give back the chunks whose blocks are all free. This is O(N) in the
+	// number of free blocks, so call it now and then, e.g. after a level.
+	void Trim();
+
+	// The bytes handed out in blocks, now and at most.
+	int32 GetAllocatedBytes() const;
+	int32 GetMaxAllocatedBytes() const;
+
+	// The bytes held in chunks, now and at most.
+	int32 GetChunkBytes() const;
+	int32 GetMaxChunkBytes() const;
+
 private:
 
+	void* AllocateMemory(int32 size);
+	void FreeMemory(void* p, int32 size);
+
+	b2MemoryArena* m_arena;
+	int32 m_chunkSize;
+
 	b2Chunk* m_chunks;
 	int32 m_chunkCount;
 	int32 m_chunkSpace;
 
+	int32 m_allocatedBytes;
+	int32 m_maxAllocatedBytes;
+	int32 m_chunkBytes;
+	int32 m_maxChunkBytes;
+
 	b2Block* m_freeLists[b2_blockSizes];
 
 	static int32 s_blockSizes[b2_blockSizes];
@@ -56,4 +87,24 @@ private:
 	static bool s_blockSizeLookupInitialized;
 };
 
+inline int32 b2BlockAllocator::GetAllocatedBytes() const
+{
+	return m_allocatedBytes;
+}
+
+inline int32 b2BlockAllocator::GetMaxAllocatedBytes() const
+{
+	return m_maxAllocatedBytes;
+}
+
+inline int32 b2BlockAllocator::GetChunkBytes() const
+{
+	return m_chunkBytes;
+}
+
+inline int32 b2BlockAllocator::GetMaxChunkBytes() const
+{
+	return m_maxChunkBytes;
+}
+
 #endif
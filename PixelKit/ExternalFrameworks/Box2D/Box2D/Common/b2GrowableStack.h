@@ -24,13 +24,15 @@
 
 /// This is a growable LIFO stack with an initial capacity of N.
 /// If the stack size exceeds the initial capacity, the heap is used
-/// to increase the size of the stack.
+/// to increase the size of the stack. The heap memory comes from the
+/// arena, or b2Alloc if it is NULL.
 template <typename T, int32 N>
 class b2GrowableStack
 {
 public:
-	b2GrowableStack()
+	b2GrowableStack(b2MemoryArena* arena = NULL)
 	{
+		m_arena = arena;
 		m_stack = m_array;
 		m_count = 0;
 		m_capacity = N;
@@ -40,7 +42,7 @@ public:
 	{
 		if (m_stack != m_array)
 		{
-			b2Free(m_stack);
+			b2Free(m_arena, m_stack, m_capacity * sizeof(T));
 			m_stack = NULL;
 		}
 	}
@@ -50,12 +52,13 @@ public:
 		if (m_count == m_capacity)
 		{
 			T* old = m_stack;
+			int32 oldCapacity = m_capacity;
 			m_capacity *= 2;
-			m_stack = (T*)b2Alloc(m_capacity * sizeof(T));
+			m_stack = (T*)b2Alloc(m_arena, m_capacity * sizeof(T));
 			memcpy(m_stack, old, m_count * sizeof(T));
 			if (old != m_array)
 			{
-				b2Free(old);
+				b2Free(m_arena, old, oldCapacity * sizeof(T));
 			}
 		}
 
@@ -76,6 +79,7 @@ public:
 	}
 
 private:
+	b2MemoryArena* m_arena;
 	T* m_stack;
 	T m_array[N];
 	int32 m_count;
@@ -31,3 +31,25 @@ void b2Free(void* mem)
 {
 	free(mem);
 }
+
+void* b2Alloc(b2MemoryArena* arena, int32 size)
+{
+	if (arena)
+	{
+		return arena->Allocate(size);
+	}
+
+	return b2Alloc(size);
+}
+
+void b2Free(b2MemoryArena* arena, void* mem, int32 size)
+{
+	if (arena)
+	{
+		arena->Free(mem, size);
+	}
+	else
+	{
+		b2Free(mem);
+	}
+}
@@ -78,6 +78,10 @@ typedef float float32;
 /// Maximum number of contacts to be handled to solve a TOI impact.
 #define b2_maxTOIContacts			32
 
+/// The default maximum number of TOI events handled in a time step. See
+/// b2World::SetMaxTOIEvents.
+#define b2_maxTOIEvents				10
+
 /// A velocity threshold for elastic collisions. Any collision with a relative linear
 /// velocity below this threshold will be treated as inelastic.
 #define b2_velocityThreshold		1.0f
@@ -105,7 +109,7 @@ typedef float float32;
 /// to overshoot.
 #define b2_contactBaumgarte			0.2f
 
-// Sleep
+// Sleep. These are the defaults, see b2World::SetSleepTolerances.
 
 /// The time that a body must be still before it will go to sleep.
 #define b2_timeToSleep				0.5f
@@ -124,6 +128,27 @@ void* b2Alloc(int32 size);
 /// If you implement b2Alloc, you should also implement this function.
 void b2Free(void* mem);
 
+/// Implement this to give a world's allocators and buffers their memory
+/// instead of b2Alloc. See b2WorldMemoryDef. If the world has a thread pool,
+/// this is called from several threads at once.
+class b2MemoryArena
+{
+public:
+	virtual ~b2MemoryArena() {}
+
+	/// Allocate size bytes, aligned for any type.
+	virtual void* Allocate(int32 size) = 0;
+
+	/// Free memory from Allocate. The size is the one it was allocated with.
+	virtual void Free(void* mem, int32 size) = 0;
+};
+
+/// Allocate from the arena, or with b2Alloc if the arena is NULL.
+void* b2Alloc(b2MemoryArena* arena, int32 size);
+
+/// Free memory from b2Alloc(arena, size) with the same arena and size.
+void b2Free(b2MemoryArena* arena, void* mem, int32 size);
+
 /// Version numbering scheme.
 /// See http://en.wikipedia.org/wiki/Software_versioning
 struct b2Version
@@ -148,4 +173,25 @@ inline float32 b2MixRestitution(float32 restitution1, float32 restitution2)
 	return restitution1 > restitution2 ? restitution1 : restitution2;
 }
 
+/// Add to a counter that several threads may update at once.
+inline void b2AtomicAdd(int32* counter, int32 value)
+{
+	__sync_fetch_and_add(counter, value);
+}
+
+/// Raise a value that several threads may update at once to at least x.
+inline void b2AtomicMax(int32* value, int32 x)
+{
+	int32 old = __atomic_load_n(value, __ATOMIC_RELAXED);
+	while (old < x)
+	{
+		int32 seen = __sync_val_compare_and_swap(value, old, x);
+		if (seen == old)
+		{
+			break;
+		}
+		old = seen;
+	}
+}
+
 #endif
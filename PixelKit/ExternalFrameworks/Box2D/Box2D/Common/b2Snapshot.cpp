@@ -0,0 +1,94 @@
+/*
+* Copyright (c) 2011 Spiralstorm Games http://www.spiralstormgames.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "b2Snapshot.h"
+#include "b2Math.h"
+
+b2Snapshot::b2Snapshot()
+{
+	m_data = NULL;
+	m_size = 0;
+	m_capacity = 0;
+}
+
+b2Snapshot::~b2Snapshot()
+{
+	if (m_data)
+	{
+		b2Free(m_data);
+	}
+}
+
+void b2Snapshot::Reserve(int32 capacity)
+{
+	if (capacity <= m_capacity)
+	{
+		return;
+	}
+
+	int32 newCapacity = b2Max(m_capacity * 2, 256);
+	while (newCapacity < capacity)
+	{
+		newCapacity *= 2;
+	}
+
+	char* oldData = m_data;
+	m_data = (char*)b2Alloc(newCapacity);
+	if (oldData)
+	{
+		memcpy(m_data, oldData, m_size);
+		b2Free(oldData);
+	}
+	m_capacity = newCapacity;
+}
+
+void b2Snapshot::SetData(const void* data, int32 size)
+{
+	b2Assert(size >= 0);
+	m_size = 0;
+	Write(data, size);
+}
+
+void b2Snapshot::Write(const void* data, int32 size)
+{
+	Reserve(m_size + size);
+	memcpy(m_data + m_size, data, size);
+	m_size += size;
+}
+
+b2SnapshotReader::b2SnapshotReader(const b2Snapshot& snapshot)
+{
+	m_data = (const char*)snapshot.GetData();
+	m_size = snapshot.GetSize();
+	m_offset = 0;
+	m_valid = true;
+}
+
+bool b2SnapshotReader::Read(void* data, int32 size)
+{
+	if (m_valid == false || m_offset + size > m_size)
+	{
+		memset(data, 0, size);
+		m_valid = false;
+		return false;
+	}
+
+	memcpy(data, m_data + m_offset, size);
+	m_offset += size;
+	return true;
+}
@@ -0,0 +1,159 @@
+/*
+* Copyright (c) 2011 Spiralstorm Games http://www.spiralstormgames.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_SNAPSHOT_H
+#define B2_SNAPSHOT_H
+
+#include "b2Settings.h"
+
+#include <cstring>
+
+/// A growable byte buffer holding the state of a world, written by
+/// b2World::SaveSnapshot and read back by b2World::RestoreSnapshot.
+/// The data holds no pointers, so snapshots of two worlds in the same state are
+/// equal byte for byte, and a snapshot can be stored or sent as is. Saving into
+/// the same snapshot again reuses its memory.
+class b2Snapshot
+{
+public:
+	b2Snapshot();
+	~b2Snapshot();
+
+	/// Get the saved bytes.
+	const void* GetData() const;
+
+	/// Get the number of saved bytes.
+	int32 GetSize() const;
+
+	/// Replace the contents with a copy of the given bytes, such as a snapshot
+	/// loaded from disk or received over the network.
+	void SetData(const void* data, int32 size);
+
+	/// Empty the snapshot, keeping its memory.
+	void Clear();
+
+	/// Append raw bytes.
+	void Write(const void* data, int32 size);
+
+	/// Append a value. The type must not have padding bytes.
+	template <typename T>
+	void Write(const T& value);
+
+	/// Overwrite a value written earlier, at the given byte offset.
+	template <typename T>
+	void Patch(int32 offset, const T& value);
+
+private:
+
+	b2Snapshot(const b2Snapshot&);
+	b2Snapshot& operator=(const b2Snapshot&);
+
+	void Reserve(int32 capacity);
+
+	char* m_data;
+	int32 m_size;
+	int32 m_capacity;
+};
+
+/// Reads the values of a snapshot back in the order they were written.
+class b2SnapshotReader
+{
+public:
+	b2SnapshotReader(const b2Snapshot& snapshot);
+
+	/// Read raw bytes. Returns false, and zeroes the bytes, past the end of the data.
+	bool Read(void* data, int32 size);
+
+	/// Read a value written by b2Snapshot::Write.
+	template <typename T>
+	bool Read(T* value);
+
+	/// Read a value and check that it is equal to the given one.
+	template <typename T>
+	bool Expect(const T& value);
+
+	/// False once a read has run past the end of the data or an Expect failed.
+	bool IsValid() const;
+
+	/// Get the number of bytes left to read.
+	int32 GetRemaining() const;
+
+private:
+
+	const char* m_data;
+	int32 m_size;
+	int32 m_offset;
+	bool m_valid;
+};
+
+inline const void* b2Snapshot::GetData() const
+{
+	return m_data;
+}
+
+inline int32 b2Snapshot::GetSize() const
+{
+	return m_size;
+}
+
+inline void b2Snapshot::Clear()
+{
+	m_size = 0;
+}
+
+template <typename T>
+inline void b2Snapshot::Write(const T& value)
+{
+	Write(&value, sizeof(T));
+}
+
+template <typename T>
+inline void b2Snapshot::Patch(int32 offset, const T& value)
+{
+	b2Assert(0 <= offset && offset + (int32)sizeof(T) <= m_size);
+	memcpy(m_data + offset, &value, sizeof(T));
+}
+
+template <typename T>
+inline bool b2SnapshotReader::Read(T* value)
+{
+	return Read(value, sizeof(T));
+}
+
+template <typename T>
+inline bool b2SnapshotReader::Expect(const T& value)
+{
+	T readValue;
+	if (Read(&readValue) == false || memcmp(&readValue, &value, sizeof(T)) != 0)
+	{
+		m_valid = false;
+	}
+	return m_valid;
+}
+
+inline bool b2SnapshotReader::IsValid() const
+{
+	return m_valid;
+}
+
+inline int32 b2SnapshotReader::GetRemaining() const
+{
+	return m_size - m_offset;
+}
+
+#endif
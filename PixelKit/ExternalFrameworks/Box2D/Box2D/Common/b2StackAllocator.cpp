@@ -21,9 +21,17 @@
 
 b2StackAllocator::b2StackAllocator()
 {
+	m_arena = NULL;
+	m_data = NULL;
+	m_capacity = b2_stackSize;
+	m_minCapacity = b2_stackSize;
+	m_resize = true;
 	m_index = 0;
 	m_allocation = 0;
 	m_maxAllocation = 0;
+	m_stepMaxAllocation = 0;
+	m_fallbackCount = 0;
+	m_fallbackBytes = 0;
 	m_entryCount = 0;
 }
 
@@ -31,18 +39,89 @@ b2StackAllocator::~b2StackAllocator()
 {
 	b2Assert(m_index == 0);
 	b2Assert(m_entryCount == 0);
+
+	if (m_data)
+	{
+		FreeMemory(m_data, m_capacity);
+	}
+}
+
+void b2StackAllocator::SetArena(b2MemoryArena* arena)
+{
+	b2Assert(m_data == NULL && m_entryCount == 0);
+	m_arena = arena;
+}
+
+void b2StackAllocator::SetSize(int32 size, bool resize)
+{
+	b2Assert(m_entryCount == 0);
+	b2Assert(size > 0);
+
+	m_minCapacity = size;
+	m_resize = resize;
+	SetCapacity(size);
+}
+
+void* b2StackAllocator::AllocateMemory(int32 size)
+{
+	if (m_arena)
+	{
+		return m_arena->Allocate(size);
+	}
+
+	return b2Alloc(size);
+}
+
+void b2StackAllocator::FreeMemory(void* p, int32 size)
+{
+	if (m_arena)
+	{
+		m_arena->Free(p, size);
+	}
+	else
+	{
+		b2Free(p);
+	}
+}
+
+void b2StackAllocator::SetCapacity(int32 capacity)
+{
+	b2Assert(m_entryCount == 0);
+
+	if (capacity == m_capacity && m_data)
+	{
+		return;
+	}
+
+	if (m_data)
+	{
+		FreeMemory(m_data, m_capacity);
+		m_data = NULL;
+	}
+
+	// The stack itself is allocated on first use.
+	m_capacity = capacity;
 }
 
 void* b2StackAllocator::Allocate(int32 size)
 {
 	b2Assert(m_entryCount < b2_maxStackEntries);
 
+	size = (size + b2_stackAlignment - 1) & ~(b2_stackAlignment - 1);
+
+	if (m_data == NULL)
+	{
+		m_data = (char*)AllocateMemory(m_capacity);
+	}
+
 	b2StackEntry* entry = m_entries + m_entryCount;
 	entry->size = size;
-	if (m_index + size > b2_stackSize)
+	if (m_index + size > m_capacity)
 	{
-		entry->data = (char*)b2Alloc(size);
+		entry->data = (char*)AllocateMemory(size);
 		entry->usedMalloc = true;
+		++m_fallbackCount;
+		m_fallbackBytes += size;
 	}
 	else
 	{
@@ -53,6 +132,7 @@ void* b2StackAllocator::Allocate(int32 size)
 
 	m_allocation += size;
 	m_maxAllocation = b2Max(m_maxAllocation, m_allocation);
+	m_stepMaxAllocation = b2Max(m_stepMaxAllocation, m_allocation);
 	++m_entryCount;
 
 	return entry->data;
@@ -65,7 +145,7 @@ void b2StackAllocator::Free(void* p)
 	b2Assert(p == entry->data);
 	if (entry->usedMalloc)
 	{
-		b2Free(p);
+		FreeMemory(p, entry->size);
 	}
 	else
 	{
@@ -77,6 +157,27 @@ void b2StackAllocator::Free(void* p)
 	p = NULL;
 }
 
+void b2StackAllocator::Reset()
+{
+	b2Assert(m_entryCount == 0);
+
+	// Grow with some room to spare, so a slowly rising peak doesn't cause a
+	// resize every step. Shrinking is left to Trim, since a quiet step is
+	// usually followed by a busy one.
+	if (m_resize && m_stepMaxAllocation > m_capacity)
+	{
+		SetCapacity(m_stepMaxAllocation + m_stepMaxAllocation / 4);
+	}
+
+	m_stepMaxAllocation = 0;
+}
+
+void b2StackAllocator::Trim()
+{
+	SetCapacity(m_minCapacity);
+	m_stepMaxAllocation = 0;
+}
+
 int32 b2StackAllocator::GetMaxAllocation() const
 {
 	return m_maxAllocation;
@@ -24,6 +24,10 @@
 const int32 b2_stackSize = 100 * 1024;	// 100k
 const int32 b2_maxStackEntries = 32;
 
+// Every allocation is rounded up to this many bytes, so that pointers and SIMD
+// data allocated after an odd sized array of floats stay aligned.
+const int32 b2_stackAlignment = 16;
+
 struct b2StackEntry
 {
 	char* data;
@@ -34,27 +38,89 @@ struct b2StackEntry
 // This is a stack allocator used for fast per step allocations.
 // You must nest allocate/free pairs. The code will assert
 // if you try to interleave multiple allocate/free pairs.
+//
+// Allocations that don't fit in the stack fall back to the heap (or the
+// arena). If resizing is on, Reset grows the stack to fit the peak of the
+// last step, so the fallbacks don't happen again.
 class b2StackAllocator
 {
 public:
 	b2StackAllocator();
 	~b2StackAllocator();
 
+	// Set where the memory comes from. NULL means b2Alloc. This must be set
+	// before anything is allocated.
+	void SetArena(b2MemoryArena* arena);
+
+	// Set the size the stack starts with and never shrinks below, and whether
+	// Reset may resize it.
+	void SetSize(int32 size, bool resize);
+
 	void* Allocate(int32 size);
 	void Free(void* p);
 
+	// Call between steps, when nothing is allocated.
+	void Reset();
+
+	// Shrink the stack back to its initial size.
+	void Trim();
+
 	int32 GetMaxAllocation() const;
 
+	// The peak since the last Reset.
+	int32 GetStepMaxAllocation() const;
+
+	int32 GetCapacity() const;
+
+	int32 GetFallbackCount() const;
+
+	int32 GetFallbackBytes() const;
+
 private:
 
-	char m_data[b2_stackSize];
+	void* AllocateMemory(int32 size);
+	void FreeMemory(void* p, int32 size);
+	void SetCapacity(int32 capacity);
+
+	b2MemoryArena* m_arena;
+
+	char* m_data;
+	int32 m_capacity;
+	int32 m_minCapacity;
+	bool m_resize;
 	int32 m_index;
 
 	int32 m_allocation;
 	int32 m_maxAllocation;
 
+	// The peak since the last Reset.
+	int32 m_stepMaxAllocation;
+
+	int32 m_fallbackCount;
+	int32 m_fallbackBytes;
+
 	b2StackEntry m_entries[b2_maxStackEntries];
 	int32 m_entryCount;
 };
 
+inline int32 b2StackAllocator::GetStepMaxAllocation() const
+{
+	return m_stepMaxAllocation;
+}
+
+inline int32 b2StackAllocator::GetCapacity() const
+{
+	return m_capacity;
+}
+
+inline int32 b2StackAllocator::GetFallbackCount() const
+{
+	return m_fallbackCount;
+}
+
+inline int32 b2StackAllocator::GetFallbackBytes() const
+{
+	return m_fallbackBytes;
+}
+
 #endif
@@ -0,0 +1,172 @@
+/*
+* Copyright (c) 2011 Spiralstorm Games http://www.spiralstormgames.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "b2ThreadPool.h"
+#include "b2Math.h"
+
+b2ThreadPool::b2ThreadPool(int32 threadCount)
+{
+	b2Assert(threadCount > 0);
+
+	m_threadCount = b2Max(threadCount, 1);
+
+	m_task = NULL;
+	m_userData = NULL;
+	m_count = 0;
+	m_rangeSize = 1;
+	m_nextIndex = 0;
+
+	m_busyCount = 0;
+	m_generation = 0;
+	m_quit = false;
+
+	pthread_mutex_init(&m_mutex, NULL);
+	pthread_cond_init(&m_workCondition, NULL);
+	pthread_cond_init(&m_doneCondition, NULL);
+
+	// The calling thread is thread 0, the workers take the rest.
+	m_workers = NULL;
+	if (m_threadCount > 1)
+	{
+		m_workers = (b2Worker*)b2Alloc((m_threadCount - 1) * sizeof(b2Worker));
+
+		for (int32 i = 0; i < m_threadCount - 1; ++i)
+		{
+			b2Worker* worker = m_workers + i;
+			worker->pool = this;
+			worker->threadIndex = i + 1;
+			pthread_create(&worker->thread, NULL, WorkerMain, worker);
+		}
+	}
+}
+
+b2ThreadPool::~b2ThreadPool()
+{
+	pthread_mutex_lock(&m_mutex);
+	m_quit = true;
+	pthread_cond_broadcast(&m_workCondition);
+	pthread_mutex_unlock(&m_mutex);
+
+	for (int32 i = 0; i < m_threadCount - 1; ++i)
+	{
+		pthread_join(m_workers[i].thread, NULL);
+	}
+
+	if (m_workers)
+	{
+		b2Free(m_workers);
+		m_workers = NULL;
+	}
+
+	pthread_cond_destroy(&m_doneCondition);
+	pthread_cond_destroy(&m_workCondition);
+	pthread_mutex_destroy(&m_mutex);
+}
+
+void b2ThreadPool::ParallelFor(int32 count, int32 rangeSize, b2ParallelForTask* task, void* userData)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	rangeSize = b2Max(rangeSize, 1);
+
+	// Not worth waking anyone up.
+	if (m_threadCount == 1 || count <= rangeSize)
+	{
+		task(userData, 0, count, 0);
+		return;
+	}
+
+	pthread_mutex_lock(&m_mutex);
+	m_task = task;
+	m_userData = userData;
+	m_count = count;
+	m_rangeSize = rangeSize;
+	m_nextIndex = 0;
+	m_busyCount = m_threadCount - 1;
+	++m_generation;
+	pthread_cond_broadcast(&m_workCondition);
+	pthread_mutex_unlock(&m_mutex);
+
+	RunRanges(0);
+
+	pthread_mutex_lock(&m_mutex);
+	while (m_busyCount > 0)
+	{
+		pthread_cond_wait(&m_doneCondition, &m_mutex);
+	}
+	m_task = NULL;
+	m_userData = NULL;
+	pthread_mutex_unlock(&m_mutex);
+}
+
+void b2ThreadPool::RunRanges(int32 threadIndex)
+{
+	for (;;)
+	{
+		int32 begin = __sync_fetch_and_add(&m_nextIndex, m_rangeSize);
+		if (begin >= m_count)
+		{
+			break;
+		}
+
+		int32 end = b2Min(begin + m_rangeSize, m_count);
+		m_task(m_userData, begin, end, threadIndex);
+	}
+}
+
+void* b2ThreadPool::WorkerMain(void* workerPtr)
+{
+	b2Worker* worker = (b2Worker*)workerPtr;
+	b2ThreadPool* pool = worker->pool;
+
+	// Workers are created before the first job is posted.
+	int32 generation = 0;
+
+	pthread_mutex_lock(&pool->m_mutex);
+
+	for (;;)
+	{
+		while (pool->m_generation == generation && pool->m_quit == false)
+		{
+			pthread_cond_wait(&pool->m_workCondition, &pool->m_mutex);
+		}
+
+		if (pool->m_quit)
+		{
+			break;
+		}
+
+		generation = pool->m_generation;
+		pthread_mutex_unlock(&pool->m_mutex);
+
+		pool->RunRanges(worker->threadIndex);
+
+		pthread_mutex_lock(&pool->m_mutex);
+		if (--pool->m_busyCount == 0)
+		{
+			pthread_cond_signal(&pool->m_doneCondition);
+		}
+	}
+
+	pthread_mutex_unlock(&pool->m_mutex);
+
+	return NULL;
+}
@@ -0,0 +1,88 @@
+/*
+* Copyright (c) 2011 Spiralstorm Games http://www.spiralstormgames.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_THREAD_POOL_H
+#define B2_THREAD_POOL_H
+
+#include "b2Settings.h"
+
+#include <pthread.h>
+
+/// A task run by b2ThreadPool::ParallelFor. The task is called with consecutive
+/// ranges [begin, end) which together cover [0, count), possibly from several
+/// threads at once. The thread index is in [0, GetThreadCount()) and is unique
+/// among the calls that run concurrently, so it can be used to pick per thread
+/// scratch memory.
+typedef void b2ParallelForTask(void* userData, int32 begin, int32 end, int32 threadIndex);
+
+/// A fixed set of worker threads used by b2World to spread independent work
+/// (such as solving islands) across cores. The pool is owned by you and may be
+/// shared by several worlds, as long as they are not stepped at the same time.
+class b2ThreadPool
+{
+public:
+	/// @param threadCount the number of threads taking part in the work, including
+	/// the thread calling ParallelFor. A count of 1 runs everything on the caller.
+	b2ThreadPool(int32 threadCount);
+
+	/// Stops and joins the worker threads.
+	~b2ThreadPool();
+
+	/// Get the number of threads taking part in the work, including the caller.
+	int32 GetThreadCount() const;
+
+	/// Run a task over [0, count) in ranges of at most rangeSize elements and wait
+	/// for all of them to finish. This is not re-entrant.
+	void ParallelFor(int32 count, int32 rangeSize, b2ParallelForTask* task, void* userData);
+
+private:
+
+	struct b2Worker
+	{
+		b2ThreadPool* pool;
+		pthread_t thread;
+		int32 threadIndex;
+	};
+
+	static void* WorkerMain(void* worker);
+	void RunRanges(int32 threadIndex);
+
+	b2Worker* m_workers;
+	int32 m_threadCount;
+
+	pthread_mutex_t m_mutex;
+	pthread_cond_t m_workCondition;
+	pthread_cond_t m_doneCondition;
+
+	b2ParallelForTask* m_task;
+	void* m_userData;
+	int32 m_count;
+	int32 m_rangeSize;
+	volatile int32 m_nextIndex;
+
+	int32 m_busyCount;
+	int32 m_generation;
+	bool m_quit;
+};
+
+inline int32 b2ThreadPool::GetThreadCount() const
+{
+	return m_threadCount;
+}
+
+#endif
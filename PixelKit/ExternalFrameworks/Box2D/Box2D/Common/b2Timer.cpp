@@ -0,0 +1,67 @@
+/*
+* Copyright (c) 2011 Spiralstorm Games http://www.spiralstormgames.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "b2Timer.h"
+
+#if defined(__APPLE__)
+#include <mach/mach_time.h>
+#else
+#include <time.h>
+#endif
+
+#if defined(__APPLE__)
+
+static double b2GetTimebaseScale()
+{
+	mach_timebase_info_data_t info;
+	mach_timebase_info(&info);
+	return 1e-6 * (double)info.numer / (double)info.denom;
+}
+
+// The current time in milliseconds, from an arbitrary start.
+static double b2GetMilliseconds()
+{
+	static const double scale = b2GetTimebaseScale();
+	return scale * (double)mach_absolute_time();
+}
+
+#else
+
+static double b2GetMilliseconds()
+{
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return 1e3 * (double)now.tv_sec + 1e-6 * (double)now.tv_nsec;
+}
+
+#endif
+
+b2Timer::b2Timer()
+{
+	Reset();
+}
+
+void b2Timer::Reset()
+{
+	m_start = b2GetMilliseconds();
+}
+
+float32 b2Timer::GetMilliseconds() const
+{
+	return (float32)(b2GetMilliseconds() - m_start);
+}
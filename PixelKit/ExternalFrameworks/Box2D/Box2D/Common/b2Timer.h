@@ -0,0 +1,44 @@
+/*
+* Copyright (c) 2011 Spiralstorm Games http://www.spiralstormgames.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_TIMER_H
+#define B2_TIMER_H
+
+#include "b2Settings.h"
+
+/// Measures elapsed time for b2Profile. It uses mach_absolute_time on Apple
+/// platforms and the monotonic clock_gettime clock elsewhere.
+class b2Timer
+{
+public:
+
+	/// Start the timer.
+	b2Timer();
+
+	/// Start the timer again.
+	void Reset();
+
+	/// Get the time since the timer was started, in milliseconds.
+	float32 GetMilliseconds() const;
+
+private:
+
+	double m_start;
+};
+
+#endif
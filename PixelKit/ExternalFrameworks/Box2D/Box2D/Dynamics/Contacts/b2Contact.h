@@ -149,6 +149,13 @@ protected:
 
 	void Update(b2ContactListener* listener);
 
+	// Update is split in two so the narrow phase can run on several threads.
+	// UpdateManifold only reads the contact and computes the new manifold
+	// (with the warm starting impulses) and whether the shapes touch. The
+	// second Update applies the result, wakes the bodies and calls the listener.
+	bool UpdateManifold(b2Manifold* manifold);
+	void Update(b2ContactListener* listener, const b2Manifold& manifold, bool touching);
+
 	static b2ContactRegister s_registers[b2Shape::e_typeCount][b2Shape::e_typeCount];
 	static bool s_initialized;
 
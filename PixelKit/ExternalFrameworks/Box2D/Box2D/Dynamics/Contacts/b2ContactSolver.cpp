@@ -224,10 +224,20 @@ void b2ContactSolver::WarmStart()
 		{
 			b2ContactConstraintPoint* ccp = c->points + j;
 			b2Vec2 P = ccp->normalImpulse * normal + ccp->tangentImpulse * tangent;
-			bodyA->m_angularVelocity -= invIA * b2Cross(ccp->rA, P);
-			bodyA->m_linearVelocity -= invMassA * P;
-			bodyB->m_angularVelocity += invIB * b2Cross(ccp->rB, P);
-			bodyB->m_linearVelocity += invMassB * P;
+
+			// Static bodies can be in several islands solved at once, so
+			// they are never written to, not even with zero changes.
+			if (bodyA->GetType() != b2_staticBody)
+			{
+				bodyA->m_angularVelocity -= invIA * b2Cross(ccp->rA, P);
+				bodyA->m_linearVelocity -= invMassA * P;
+			}
+
+			if (bodyB->GetType() != b2_staticBody)
+			{
+				bodyB->m_angularVelocity += invIB * b2Cross(ccp->rB, P);
+				bodyB->m_linearVelocity += invMassB * P;
+			}
 		}
 	}
 }
@@ -524,10 +534,17 @@ void b2ContactSolver::SolveVelocityConstraints()
 			}
 		}
 
-		bodyA->m_linearVelocity = vA;
-		bodyA->m_angularVelocity = wA;
-		bodyB->m_linearVelocity = vB;
-		bodyB->m_angularVelocity = wB;
+		if (bodyA->GetType() != b2_staticBody)
+		{
+			bodyA->m_linearVelocity = vA;
+			bodyA->m_angularVelocity = wA;
+		}
+
+		if (bodyB->GetType() != b2_staticBody)
+		{
+			bodyB->m_linearVelocity = vB;
+			bodyB->m_angularVelocity = wB;
+		}
 	}
 }
 
@@ -650,13 +667,19 @@ bool b2ContactSolver::SolvePositionConstraints(float32 baumgarte)
 
 			b2Vec2 P = impulse * normal;
 
-			bodyA->m_sweep.c -= invMassA * P;
-			bodyA->m_sweep.a -= invIA * b2Cross(rA, P);
-			bodyA->SynchronizeTransform();
+			if (bodyA->GetType() != b2_staticBody)
+			{
+				bodyA->m_sweep.c -= invMassA * P;
+				bodyA->m_sweep.a -= invIA * b2Cross(rA, P);
+				bodyA->SynchronizeTransform();
+			}
 
-			bodyB->m_sweep.c += invMassB * P;
-			bodyB->m_sweep.a += invIB * b2Cross(rB, P);
-			bodyB->SynchronizeTransform();
+			if (bodyB->GetType() != b2_staticBody)
+			{
+				bodyB->m_sweep.c += invMassB * P;
+				bodyB->m_sweep.a += invIB * b2Cross(rB, P);
+				bodyB->SynchronizeTransform();
+			}
 		}
 	}
 
@@ -722,13 +745,19 @@ bool b2ContactSolver::SolveTOIPositionConstraints(float32 baumgarte, const b2Bod
 
 			b2Vec2 P = impulse * normal;
 
-			bodyA->m_sweep.c -= invMassA * P;
-			bodyA->m_sweep.a -= invIA * b2Cross(rA, P);
-			bodyA->SynchronizeTransform();
+			if (bodyA->GetType() != b2_staticBody)
+			{
+				bodyA->m_sweep.c -= invMassA * P;
+				bodyA->m_sweep.a -= invIA * b2Cross(rA, P);
+				bodyA->SynchronizeTransform();
+			}
 
-			bodyB->m_sweep.c += invMassB * P;
-			bodyB->m_sweep.a += invIB * b2Cross(rB, P);
-			bodyB->SynchronizeTransform();
+			if (bodyB->GetType() != b2_staticBody)
+			{
+				bodyB->m_sweep.c += invMassB * P;
+				bodyB->m_sweep.a += invIB * b2Cross(rB, P);
+				bodyB->SynchronizeTransform();
+			}
 		}
 	}
 
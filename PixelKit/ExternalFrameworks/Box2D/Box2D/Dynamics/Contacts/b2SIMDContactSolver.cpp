@@ -0,0 +1,599 @@
+/*
+* Copyright (c) 2011 Spiralstorm Games http://www.spiralstormgames.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "b2SIMDContactSolver.h"
+#include "b2Body.h"
+#include "b2StackAllocator.h"
+
+#include <cstring>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+	#include <arm_neon.h>
+	#define B2_SIMD_NEON
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#include <xmmintrin.h>
+	#define B2_SIMD_SSE
+#endif
+
+// Four floats, and a mask of four lanes as returned by the comparisons.
+struct b2Float4
+{
+#if defined(B2_SIMD_NEON)
+	float32x4_t v;
+#elif defined(B2_SIMD_SSE)
+	__m128 v;
+#else
+	float32 v[4];
+#endif
+};
+
+struct b2Mask4
+{
+#if defined(B2_SIMD_NEON)
+	uint32x4_t v;
+#elif defined(B2_SIMD_SSE)
+	__m128 v;
+#else
+	bool v[4];
+#endif
+};
+
+#if defined(B2_SIMD_NEON)
+
+inline b2Float4 b2Load4(const float32* p) { b2Float4 r; r.v = vld1q_f32(p); return r; }
+inline void b2Store4(float32* p, const b2Float4& a) { vst1q_f32(p, a.v); }
+inline b2Float4 b2Splat4(float32 a) { b2Float4 r; r.v = vdupq_n_f32(a); return r; }
+inline b2Float4 operator+(const b2Float4& a, const b2Float4& b) { b2Float4 r; r.v = vaddq_f32(a.v, b.v); return r; }
+inline b2Float4 operator-(const b2Float4& a, const b2Float4& b) { b2Float4 r; r.v = vsubq_f32(a.v, b.v); return r; }
+inline b2Float4 operator*(const b2Float4& a, const b2Float4& b) { b2Float4 r; r.v = vmulq_f32(a.v, b.v); return r; }
+inline b2Float4 operator-(const b2Float4& a) { b2Float4 r; r.v = vnegq_f32(a.v); return r; }
+inline b2Float4 b2Min4(const b2Float4& a, const b2Float4& b) { b2Float4 r; r.v = vminq_f32(a.v, b.v); return r; }
+inline b2Float4 b2Max4(const b2Float4& a, const b2Float4& b) { b2Float4 r; r.v = vmaxq_f32(a.v, b.v); return r; }
+inline b2Mask4 b2GreaterEqual4(const b2Float4& a, const b2Float4& b) { b2Mask4 r; r.v = vcgeq_f32(a.v, b.v); return r; }
+inline b2Mask4 b2And4(const b2Mask4& a, const b2Mask4& b) { b2Mask4 r; r.v = vandq_u32(a.v, b.v); return r; }
+inline b2Float4 b2Select4(const b2Mask4& m, const b2Float4& a, const b2Float4& b) { b2Float4 r; r.v = vbslq_f32(m.v, a.v, b.v); return r; }
+
+#elif defined(B2_SIMD_SSE)
+
+inline b2Float4 b2Load4(const float32* p) { b2Float4 r; r.v = _mm_loadu_ps(p); return r; }
+inline void b2Store4(float32* p, const b2Float4& a) { _mm_storeu_ps(p, a.v); }
+inline b2Float4 b2Splat4(float32 a) { b2Float4 r; r.v = _mm_set1_ps(a); return r; }
+inline b2Float4 operator+(const b2Float4& a, const b2Float4& b) { b2Float4 r; r.v = _mm_add_ps(a.v, b.v); return r; }
+inline b2Float4 operator-(const b2Float4& a, const b2Float4& b) { b2Float4 r; r.v = _mm_sub_ps(a.v, b.v); return r; }
+inline b2Float4 operator*(const b2Float4& a, const b2Float4& b) { b2Float4 r; r.v = _mm_mul_ps(a.v, b.v); return r; }
+inline b2Float4 operator-(const b2Float4& a) { b2Float4 r; r.v = _mm_sub_ps(_mm_setzero_ps(), a.v); return r; }
+inline b2Float4 b2Min4(const b2Float4& a, const b2Float4& b) { b2Float4 r; r.v = _mm_min_ps(a.v, b.v); return r; }
+inline b2Float4 b2Max4(const b2Float4& a, const b2Float4& b) { b2Float4 r; r.v = _mm_max_ps(a.v, b.v); return r; }
+inline b2Mask4 b2GreaterEqual4(const b2Float4& a, const b2Float4& b) { b2Mask4 r; r.v = _mm_cmpge_ps(a.v, b.v); return r; }
+inline b2Mask4 b2And4(const b2Mask4& a, const b2Mask4& b) { b2Mask4 r; r.v = _mm_and_ps(a.v, b.v); return r; }
+inline b2Float4 b2Select4(const b2Mask4& m, const b2Float4& a, const b2Float4& b) { b2Float4 r; r.v = _mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v)); return r; }
+
+#else
+
+inline b2Float4 b2Load4(const float32* p) { b2Float4 r; for (int32 i = 0; i < 4; ++i) r.v[i] = p[i]; return r; }
+inline void b2Store4(float32* p, const b2Float4& a) { for (int32 i = 0; i < 4; ++i) p[i] = a.v[i]; }
+inline b2Float4 b2Splat4(float32 a) { b2Float4 r; for (int32 i = 0; i < 4; ++i) r.v[i] = a; return r; }
+inline b2Float4 operator+(const b2Float4& a, const b2Float4& b) { b2Float4 r; for (int32 i = 0; i < 4; ++i) r.v[i] = a.v[i] + b.v[i]; return r; }
+inline b2Float4 operator-(const b2Float4& a, const b2Float4& b) { b2Float4 r; for (int32 i = 0; i < 4; ++i) r.v[i] = a.v[i] - b.v[i]; return r; }
+inline b2Float4 operator*(const b2Float4& a, const b2Float4& b) { b2Float4 r; for (int32 i = 0; i < 4; ++i) r.v[i] = a.v[i] * b.v[i]; return r; }
+inline b2Float4 operator-(const b2Float4& a) { b2Float4 r; for (int32 i = 0; i < 4; ++i) r.v[i] = -a.v[i]; return r; }
+inline b2Float4 b2Min4(const b2Float4& a, const b2Float4& b) { b2Float4 r; for (int32 i = 0; i < 4; ++i) r.v[i] = b2Min(a.v[i], b.v[i]); return r; }
+inline b2Float4 b2Max4(const b2Float4& a, const b2Float4& b) { b2Float4 r; for (int32 i = 0; i < 4; ++i) r.v[i] = b2Max(a.v[i], b.v[i]); return r; }
+inline b2Mask4 b2GreaterEqual4(const b2Float4& a, const b2Float4& b) { b2Mask4 r; for (int32 i = 0; i < 4; ++i) r.v[i] = a.v[i] >= b.v[i]; return r; }
+inline b2Mask4 b2And4(const b2Mask4& a, const b2Mask4& b) { b2Mask4 r; for (int32 i = 0; i < 4; ++i) r.v[i] = a.v[i] && b.v[i]; return r; }
+inline b2Float4 b2Select4(const b2Mask4& m, const b2Float4& a, const b2Float4& b) { b2Float4 r; for (int32 i = 0; i < 4; ++i) r.v[i] = m.v[i] ? a.v[i] : b.v[i]; return r; }
+
+#endif
+
+// Cross products of the scalar b2Cross overloads, per lane.
+inline b2Float4 b2Cross4(const b2Float4& ax, const b2Float4& ay, const b2Float4& bx, const b2Float4& by)
+{
+	return ax * by - ay * bx;
+}
+
+// Body velocities of a group, gathered per lane.
+struct b2VelocityLanes
+{
+	float32 vAX[b2_simdLaneCount];
+	float32 vAY[b2_simdLaneCount];
+	float32 wA[b2_simdLaneCount];
+	float32 vBX[b2_simdLaneCount];
+	float32 vBY[b2_simdLaneCount];
+	float32 wB[b2_simdLaneCount];
+};
+
+inline void b2GatherLanes(b2VelocityLanes* lanes, const b2SIMDContactConstraintGroup* group,
+						  const float32* vx, const float32* vy, const float32* w)
+{
+	for (int32 i = 0; i < b2_simdLaneCount; ++i)
+	{
+		int32 indexA = group->indexA[i];
+		int32 indexB = group->indexB[i];
+		lanes->vAX[i] = vx[indexA];
+		lanes->vAY[i] = vy[indexA];
+		lanes->wA[i] = w[indexA];
+		lanes->vBX[i] = vx[indexB];
+		lanes->vBY[i] = vy[indexB];
+		lanes->wB[i] = w[indexB];
+	}
+}
+
+// Lanes can share static bodies (index 0). Their masses are zero, so they get
+// their velocity back unchanged.
+inline void b2ScatterLanes(const b2VelocityLanes* lanes, const b2SIMDContactConstraintGroup* group,
+						   float32* vx, float32* vy, float32* w)
+{
+	for (int32 i = 0; i < b2_simdLaneCount; ++i)
+	{
+		int32 indexA = group->indexA[i];
+		int32 indexB = group->indexB[i];
+		vx[indexA] = lanes->vAX[i];
+		vy[indexA] = lanes->vAY[i];
+		w[indexA] = lanes->wA[i];
+		vx[indexB] = lanes->vBX[i];
+		vy[indexB] = lanes->vBY[i];
+		w[indexB] = lanes->wB[i];
+	}
+}
+
+int32 b2SIMDContactSolver::GetVelocityIndex(const b2Body* body)
+{
+	if (body->GetType() == b2_staticBody)
+	{
+		return 0;
+	}
+
+	return body->m_islandIndex + 1;
+}
+
+int32 b2SIMDContactSolver::ColorConstraint(const b2ContactConstraint* cc, uint32* bodyColors)
+{
+	int32 indexA = GetVelocityIndex(cc->bodyA);
+	int32 indexB = GetVelocityIndex(cc->bodyB);
+
+	// Static bodies can be shared.
+	uint32 colorsA = indexA ? bodyColors[indexA] : 0;
+	uint32 colorsB = indexB ? bodyColors[indexB] : 0;
+	uint32 used = colorsA | colorsB;
+
+	for (int32 color = 0; color < b2_simdMaxColors; ++color)
+	{
+		uint32 bit = 1u << color;
+		if (used & bit)
+		{
+			continue;
+		}
+
+		if (indexA)
+		{
+			bodyColors[indexA] |= bit;
+		}
+
+		if (indexB)
+		{
+			bodyColors[indexB] |= bit;
+		}
+
+		return 2 * color + cc->pointCount - 1;
+	}
+
+	return b2_simdOverflowBucket;
+}
+
+int32 b2SIMDContactSolver::GetLaneCount(int32 bucket)
+{
+	return bucket == b2_simdOverflowBucket ? 1 : b2_simdLaneCount;
+}
+
+b2SIMDContactSolver::b2SIMDContactSolver(b2ContactSolver* solver, b2Body** bodies, int32 bodyCount, b2StackAllocator* allocator)
+{
+	m_allocator = allocator;
+	m_bodies = bodies;
+	m_bodyCount = bodyCount;
+
+	int32 velocityCount = bodyCount + 1;
+	m_vx = (float32*)m_allocator->Allocate(velocityCount * sizeof(float32));
+	m_vy = (float32*)m_allocator->Allocate(velocityCount * sizeof(float32));
+	m_w = (float32*)m_allocator->Allocate(velocityCount * sizeof(float32));
+
+	m_vx[0] = 0.0f;
+	m_vy[0] = 0.0f;
+	m_w[0] = 0.0f;
+	GatherVelocities();
+
+	int32 count = solver->m_count;
+	b2ContactConstraint* constraints = solver->m_constraints;
+
+	// Color the constraints so that no two of a color share a body. Each color
+	// is split by point count, which gives a bucket per color and point count,
+	// plus one for the constraints that ran out of colors.
+	// The coloring is done twice, once to size the groups and once to fill
+	// them in, so the stack allocations stay in order.
+	int32 bucketCounts[b2_simdBucketCount];
+	memset(bucketCounts, 0, sizeof(bucketCounts));
+
+	uint32* bodyColors = (uint32*)m_allocator->Allocate(velocityCount * sizeof(uint32));
+	memset(bodyColors, 0, velocityCount * sizeof(uint32));
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		++bucketCounts[ColorConstraint(constraints + i, bodyColors)];
+	}
+
+	m_allocator->Free(bodyColors);
+
+	// Overflowing constraints get a group each.
+	int32 groupStarts[b2_simdBucketCount];
+	m_groupCount = 0;
+	for (int32 i = 0; i < b2_simdBucketCount; ++i)
+	{
+		groupStarts[i] = m_groupCount;
+		m_groupCount += (bucketCounts[i] + GetLaneCount(i) - 1) / GetLaneCount(i);
+	}
+
+	m_groups = (b2SIMDContactConstraintGroup*)m_allocator->Allocate(m_groupCount * sizeof(b2SIMDContactConstraintGroup));
+
+	// The stack allocator keeps every allocation aligned, however odd the
+	// velocity arrays before the groups are.
+	b2Assert(((size_t)m_groups & (b2_stackAlignment - 1)) == 0);
+
+	memset(m_groups, 0, m_groupCount * sizeof(b2SIMDContactConstraintGroup));
+
+	bodyColors = (uint32*)m_allocator->Allocate(velocityCount * sizeof(uint32));
+	memset(bodyColors, 0, velocityCount * sizeof(uint32));
+	memset(bucketCounts, 0, sizeof(bucketCounts));
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2ContactConstraint* cc = constraints + i;
+		int32 bucket = ColorConstraint(cc, bodyColors);
+		int32 laneCount = GetLaneCount(bucket);
+		int32 position = bucketCounts[bucket]++;
+
+		b2SIMDContactConstraintGroup* group = m_groups + groupStarts[bucket] + position / laneCount;
+		int32 lane = position % laneCount;
+
+		b2Body* bodyA = cc->bodyA;
+		b2Body* bodyB = cc->bodyB;
+
+		group->constraints[lane] = cc;
+		group->indexA[lane] = GetVelocityIndex(bodyA);
+		group->indexB[lane] = GetVelocityIndex(bodyB);
+		group->pointCount = cc->pointCount;
+
+		group->invMassA[lane] = bodyA->m_invMass;
+		group->invIA[lane] = bodyA->m_invI;
+		group->invMassB[lane] = bodyB->m_invMass;
+		group->invIB[lane] = bodyB->m_invI;
+		group->normalX[lane] = cc->normal.x;
+		group->normalY[lane] = cc->normal.y;
+		group->friction[lane] = cc->friction;
+
+		for (int32 j = 0; j < cc->pointCount; ++j)
+		{
+			b2ContactConstraintPoint* ccp = cc->points + j;
+			group->rAX[j][lane] = ccp->rA.x;
+			group->rAY[j][lane] = ccp->rA.y;
+			group->rBX[j][lane] = ccp->rB.x;
+			group->rBY[j][lane] = ccp->rB.y;
+			group->normalImpulse[j][lane] = ccp->normalImpulse;
+			group->tangentImpulse[j][lane] = ccp->tangentImpulse;
+			group->normalMass[j][lane] = ccp->normalMass;
+			group->tangentMass[j][lane] = ccp->tangentMass;
+			group->velocityBias[j][lane] = ccp->velocityBias;
+		}
+
+		if (cc->pointCount == 2)
+		{
+			group->k11[lane] = cc->K.col1.x;
+			group->k12[lane] = cc->K.col1.y;
+			group->k22[lane] = cc->K.col2.y;
+			group->m11[lane] = cc->normalMass.col1.x;
+			group->m12[lane] = cc->normalMass.col2.x;
+			group->m21[lane] = cc->normalMass.col1.y;
+			group->m22[lane] = cc->normalMass.col2.y;
+		}
+	}
+
+	m_allocator->Free(bodyColors);
+}
+
+b2SIMDContactSolver::~b2SIMDContactSolver()
+{
+	m_allocator->Free(m_groups);
+	m_allocator->Free(m_w);
+	m_allocator->Free(m_vy);
+	m_allocator->Free(m_vx);
+}
+
+void b2SIMDContactSolver::GatherVelocities()
+{
+	for (int32 i = 0; i < m_bodyCount; ++i)
+	{
+		b2Body* b = m_bodies[i];
+		if (b->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+
+		m_vx[i + 1] = b->m_linearVelocity.x;
+		m_vy[i + 1] = b->m_linearVelocity.y;
+		m_w[i + 1] = b->m_angularVelocity;
+	}
+}
+
+void b2SIMDContactSolver::ScatterVelocities()
+{
+	for (int32 i = 0; i < m_bodyCount; ++i)
+	{
+		b2Body* b = m_bodies[i];
+		if (b->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+
+		b->m_linearVelocity.Set(m_vx[i + 1], m_vy[i + 1]);
+		b->m_angularVelocity = m_w[i + 1];
+	}
+}
+
+void b2SIMDContactSolver::SolveVelocityConstraints()
+{
+	for (int32 i = 0; i < m_groupCount; ++i)
+	{
+		b2SIMDContactConstraintGroup* group = m_groups + i;
+		if (group->pointCount == 1)
+		{
+			SolveGroup1(group);
+		}
+		else
+		{
+			SolveGroup2(group);
+		}
+	}
+}
+
+void b2SIMDContactSolver::StoreImpulses()
+{
+	for (int32 i = 0; i < m_groupCount; ++i)
+	{
+		b2SIMDContactConstraintGroup* group = m_groups + i;
+
+		for (int32 lane = 0; lane < b2_simdLaneCount; ++lane)
+		{
+			b2ContactConstraint* cc = group->constraints[lane];
+			if (cc == NULL)
+			{
+				continue;
+			}
+
+			for (int32 k = 0; k < cc->pointCount; ++k)
+			{
+				cc->points[k].normalImpulse = group->normalImpulse[k][lane];
+				cc->points[k].tangentImpulse = group->tangentImpulse[k][lane];
+			}
+		}
+	}
+}
+
+// The state of a group while it is being solved. These follow
+// b2ContactSolver::SolveVelocityConstraints, see there for the details.
+struct b2SIMDGroupState
+{
+	void Load(const b2SIMDContactConstraintGroup* group, const float32* vx, const float32* vy, const float32* w)
+	{
+		b2GatherLanes(&lanes, group, vx, vy, w);
+		vAX = b2Load4(lanes.vAX);
+		vAY = b2Load4(lanes.vAY);
+		wA = b2Load4(lanes.wA);
+		vBX = b2Load4(lanes.vBX);
+		vBY = b2Load4(lanes.vBY);
+		wB = b2Load4(lanes.wB);
+
+		invMassA = b2Load4(group->invMassA);
+		invIA = b2Load4(group->invIA);
+		invMassB = b2Load4(group->invMassB);
+		invIB = b2Load4(group->invIB);
+
+		// The tangent is b2Cross(normal, 1.0f).
+		normalX = b2Load4(group->normalX);
+		normalY = b2Load4(group->normalY);
+		tangentX = normalY;
+		tangentY = -normalX;
+		friction = b2Load4(group->friction);
+	}
+
+	void Store(const b2SIMDContactConstraintGroup* group, float32* vx, float32* vy, float32* w)
+	{
+		b2Store4(lanes.vAX, vAX);
+		b2Store4(lanes.vAY, vAY);
+		b2Store4(lanes.wA, wA);
+		b2Store4(lanes.vBX, vBX);
+		b2Store4(lanes.vBY, vBY);
+		b2Store4(lanes.wB, wB);
+		b2ScatterLanes(&lanes, group, vx, vy, w);
+	}
+
+	// Relative velocity at contact along a direction.
+	b2Float4 RelativeVelocity(const b2Float4& rAX, const b2Float4& rAY, const b2Float4& rBX, const b2Float4& rBY,
+							  const b2Float4& dirX, const b2Float4& dirY) const
+	{
+		b2Float4 dvX = vBX - wB * rBY - vAX + wA * rAY;
+		b2Float4 dvY = vBY + wB * rBX - vAY - wA * rAX;
+		return dvX * dirX + dvY * dirY;
+	}
+
+	void ApplyImpulse(const b2Float4& rAX, const b2Float4& rAY, const b2Float4& rBX, const b2Float4& rBY,
+					  const b2Float4& PX, const b2Float4& PY)
+	{
+		vAX = vAX - invMassA * PX;
+		vAY = vAY - invMassA * PY;
+		wA = wA - invIA * b2Cross4(rAX, rAY, PX, PY);
+
+		vBX = vBX + invMassB * PX;
+		vBY = vBY + invMassB * PY;
+		wB = wB + invIB * b2Cross4(rBX, rBY, PX, PY);
+	}
+
+	void SolveTangent(b2SIMDContactConstraintGroup* group, int32 j)
+	{
+		b2Float4 rAX = b2Load4(group->rAX[j]);
+		b2Float4 rAY = b2Load4(group->rAY[j]);
+		b2Float4 rBX = b2Load4(group->rBX[j]);
+		b2Float4 rBY = b2Load4(group->rBY[j]);
+
+		// Compute tangent force
+		b2Float4 vt = RelativeVelocity(rAX, rAY, rBX, rBY, tangentX, tangentY);
+		b2Float4 lambda = -(b2Load4(group->tangentMass[j]) * vt);
+
+		// b2Clamp the accumulated force
+		b2Float4 oldImpulse = b2Load4(group->tangentImpulse[j]);
+		b2Float4 maxFriction = friction * b2Load4(group->normalImpulse[j]);
+		b2Float4 newImpulse = b2Max4(-maxFriction, b2Min4(oldImpulse + lambda, maxFriction));
+		lambda = newImpulse - oldImpulse;
+
+		// Apply contact impulse
+		ApplyImpulse(rAX, rAY, rBX, rBY, lambda * tangentX, lambda * tangentY);
+		b2Store4(group->tangentImpulse[j], newImpulse);
+	}
+
+	b2VelocityLanes lanes;
+	b2Float4 vAX, vAY, wA;
+	b2Float4 vBX, vBY, wB;
+	b2Float4 invMassA, invIA;
+	b2Float4 invMassB, invIB;
+	b2Float4 normalX, normalY;
+	b2Float4 tangentX, tangentY;
+	b2Float4 friction;
+};
+
+void b2SIMDContactSolver::SolveGroup1(b2SIMDContactConstraintGroup* group)
+{
+	b2SIMDGroupState state;
+	state.Load(group, m_vx, m_vy, m_w);
+
+	// Solve tangent constraints
+	state.SolveTangent(group, 0);
+
+	// Solve normal constraints
+	b2Float4 rAX = b2Load4(group->rAX[0]);
+	b2Float4 rAY = b2Load4(group->rAY[0]);
+	b2Float4 rBX = b2Load4(group->rBX[0]);
+	b2Float4 rBY = b2Load4(group->rBY[0]);
+
+	b2Float4 vn = state.RelativeVelocity(rAX, rAY, rBX, rBY, state.normalX, state.normalY);
+	b2Float4 lambda = -(b2Load4(group->normalMass[0]) * (vn - b2Load4(group->velocityBias[0])));
+
+	// b2Clamp the accumulated impulse
+	b2Float4 oldImpulse = b2Load4(group->normalImpulse[0]);
+	b2Float4 newImpulse = b2Max4(oldImpulse + lambda, b2Splat4(0.0f));
+	lambda = newImpulse - oldImpulse;
+
+	// Apply contact impulse
+	state.ApplyImpulse(rAX, rAY, rBX, rBY, lambda * state.normalX, lambda * state.normalY);
+	b2Store4(group->normalImpulse[0], newImpulse);
+
+	state.Store(group, m_vx, m_vy, m_w);
+}
+
+void b2SIMDContactSolver::SolveGroup2(b2SIMDContactConstraintGroup* group)
+{
+	b2SIMDGroupState state;
+	state.Load(group, m_vx, m_vy, m_w);
+
+	// Solve tangent constraints
+	state.SolveTangent(group, 0);
+	state.SolveTangent(group, 1);
+
+	// Block solver. All four cases are computed and each lane takes the first
+	// valid one. When there is none the impulses are left unchanged.
+	b2Float4 r1AX = b2Load4(group->rAX[0]);
+	b2Float4 r1AY = b2Load4(group->rAY[0]);
+	b2Float4 r1BX = b2Load4(group->rBX[0]);
+	b2Float4 r1BY = b2Load4(group->rBY[0]);
+	b2Float4 r2AX = b2Load4(group->rAX[1]);
+	b2Float4 r2AY = b2Load4(group->rAY[1]);
+	b2Float4 r2BX = b2Load4(group->rBX[1]);
+	b2Float4 r2BY = b2Load4(group->rBY[1]);
+
+	b2Float4 aX = b2Load4(group->normalImpulse[0]);
+	b2Float4 aY = b2Load4(group->normalImpulse[1]);
+
+	// Compute normal velocity
+	b2Float4 vn1 = state.RelativeVelocity(r1AX, r1AY, r1BX, r1BY, state.normalX, state.normalY);
+	b2Float4 vn2 = state.RelativeVelocity(r2AX, r2AY, r2BX, r2BY, state.normalX, state.normalY);
+
+	// b = vn - velocityBias - K * a
+	b2Float4 k11 = b2Load4(group->k11);
+	b2Float4 k12 = b2Load4(group->k12);
+	b2Float4 k22 = b2Load4(group->k22);
+	b2Float4 bX = vn1 - b2Load4(group->velocityBias[0]) - (k11 * aX + k12 * aY);
+	b2Float4 bY = vn2 - b2Load4(group->velocityBias[1]) - (k12 * aX + k22 * aY);
+
+	b2Float4 zero = b2Splat4(0.0f);
+
+	// Case 1: vn = 0
+	b2Float4 x1X = -(b2Load4(group->m11) * bX + b2Load4(group->m12) * bY);
+	b2Float4 x1Y = -(b2Load4(group->m21) * bX + b2Load4(group->m22) * bY);
+	b2Mask4 case1 = b2And4(b2GreaterEqual4(x1X, zero), b2GreaterEqual4(x1Y, zero));
+
+	// Case 2: vn1 = 0 and x2 = 0
+	b2Float4 x2X = -(b2Load4(group->normalMass[0]) * bX);
+	b2Mask4 case2 = b2And4(b2GreaterEqual4(x2X, zero), b2GreaterEqual4(k12 * x2X + bY, zero));
+
+	// Case 3: vn2 = 0 and x1 = 0
+	b2Float4 x3Y = -(b2Load4(group->normalMass[1]) * bY);
+	b2Mask4 case3 = b2And4(b2GreaterEqual4(x3Y, zero), b2GreaterEqual4(k12 * x3Y + bX, zero));
+
+	// Case 4: x1 = 0 and x2 = 0
+	b2Mask4 case4 = b2And4(b2GreaterEqual4(bX, zero), b2GreaterEqual4(bY, zero));
+
+	// Select from the last case to the first, so the first valid one wins.
+	b2Float4 xX = b2Select4(case4, zero, aX);
+	b2Float4 xY = b2Select4(case4, zero, aY);
+	xX = b2Select4(case3, zero, xX);
+	xY = b2Select4(case3, x3Y, xY);
+	xX = b2Select4(case2, x2X, xX);
+	xY = b2Select4(case2, zero, xY);
+	xX = b2Select4(case1, x1X, xX);
+	xY = b2Select4(case1, x1Y, xY);
+
+	// Resubstitute for the incremental impulse
+	b2Float4 dX = xX - aX;
+	b2Float4 dY = xY - aY;
+
+	// Apply incremental impulse
+	b2Float4 P1X = dX * state.normalX;
+	b2Float4 P1Y = dX * state.normalY;
+	b2Float4 P2X = dY * state.normalX;
+	b2Float4 P2Y = dY * state.normalY;
+
+	state.vAX = state.vAX - state.invMassA * (P1X + P2X);
+	state.vAY = state.vAY - state.invMassA * (P1Y + P2Y);
+	state.wA = state.wA - state.invIA * (b2Cross4(r1AX, r1AY, P1X, P1Y) + b2Cross4(r2AX, r2AY, P2X, P2Y));
+
+	state.vBX = state.vBX + state.invMassB * (P1X + P2X);
+	state.vBY = state.vBY + state.invMassB * (P1Y + P2Y);
+	state.wB = state.wB + state.invIB * (b2Cross4(r1BX, r1BY, P1X, P1Y) + b2Cross4(r2BX, r2BY, P2X, P2Y));
+
+	// Accumulate
+	b2Store4(group->normalImpulse[0], xX);
+	b2Store4(group->normalImpulse[1], xY);
+
+	state.Store(group, m_vx, m_vy, m_w);
+}
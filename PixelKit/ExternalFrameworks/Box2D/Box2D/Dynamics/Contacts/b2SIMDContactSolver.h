@@ -0,0 +1,126 @@
+/*
+* Copyright (c) 2011 Spiralstorm Games http://www.spiralstormgames.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_SIMD_CONTACT_SOLVER_H
+#define B2_SIMD_CONTACT_SOLVER_H
+
+#include "b2ContactSolver.h"
+
+class b2Body;
+class b2StackAllocator;
+
+/// The number of constraints solved in lockstep.
+#define b2_simdLaneCount	4
+
+/// Up to this many colors are used to group the constraints. Constraints that
+/// don't fit in any of them are solved one at a time.
+#define b2_simdMaxColors	32
+
+// Constraints are grouped by color and point count.
+#define b2_simdBucketCount		(2 * b2_simdMaxColors + 1)
+#define b2_simdOverflowBucket	(b2_simdBucketCount - 1)
+
+/// A group of constraints that share no bodies (other than static ones), laid
+/// out as structures of arrays so that the lanes can be solved together.
+/// Unused lanes have no constraint and zero masses.
+struct b2SIMDContactConstraintGroup
+{
+	b2ContactConstraint* constraints[b2_simdLaneCount];
+	int32 indexA[b2_simdLaneCount];
+	int32 indexB[b2_simdLaneCount];
+	int32 pointCount;
+
+	float32 invMassA[b2_simdLaneCount];
+	float32 invIA[b2_simdLaneCount];
+	float32 invMassB[b2_simdLaneCount];
+	float32 invIB[b2_simdLaneCount];
+	float32 normalX[b2_simdLaneCount];
+	float32 normalY[b2_simdLaneCount];
+	float32 friction[b2_simdLaneCount];
+
+	float32 rAX[b2_maxManifoldPoints][b2_simdLaneCount];
+	float32 rAY[b2_maxManifoldPoints][b2_simdLaneCount];
+	float32 rBX[b2_maxManifoldPoints][b2_simdLaneCount];
+	float32 rBY[b2_maxManifoldPoints][b2_simdLaneCount];
+	float32 normalImpulse[b2_maxManifoldPoints][b2_simdLaneCount];
+	float32 tangentImpulse[b2_maxManifoldPoints][b2_simdLaneCount];
+	float32 normalMass[b2_maxManifoldPoints][b2_simdLaneCount];
+	float32 tangentMass[b2_maxManifoldPoints][b2_simdLaneCount];
+	float32 velocityBias[b2_maxManifoldPoints][b2_simdLaneCount];
+
+	// Block solver matrices, used when there are two points.
+	float32 k11[b2_simdLaneCount];
+	float32 k12[b2_simdLaneCount];
+	float32 k22[b2_simdLaneCount];
+	float32 m11[b2_simdLaneCount];
+	float32 m12[b2_simdLaneCount];
+	float32 m21[b2_simdLaneCount];
+	float32 m22[b2_simdLaneCount];
+};
+
+/// Solves the velocity constraints of a b2ContactSolver with SSE or NEON (or
+/// plain floats when neither is available). The constraints are graph colored
+/// into groups of b2_simdLaneCount that touch distinct bodies, and the body
+/// velocities are kept in arrays of their own while solving.
+/// The scalar solver still initializes the constraints, warm starts and solves
+/// the positions. The constraints are solved in a different order, so results
+/// differ slightly from the scalar solver.
+class b2SIMDContactSolver
+{
+public:
+	/// The bodies must have their island index set, static bodies excepted.
+	/// Copies the body velocities in.
+	b2SIMDContactSolver(b2ContactSolver* solver, b2Body** bodies, int32 bodyCount, b2StackAllocator* allocator);
+	~b2SIMDContactSolver();
+
+	void SolveVelocityConstraints();
+
+	/// Copy the impulses back to the scalar solver's constraints.
+	void StoreImpulses();
+
+	/// Copy the velocities back to the bodies, before solving joints and when done.
+	void ScatterVelocities();
+
+	/// Copy the velocities in from the bodies, after solving joints.
+	void GatherVelocities();
+
+private:
+
+	static int32 GetVelocityIndex(const b2Body* body);
+	static int32 ColorConstraint(const b2ContactConstraint* cc, uint32* bodyColors);
+	static int32 GetLaneCount(int32 bucket);
+
+	void SolveGroup1(b2SIMDContactConstraintGroup* group);
+	void SolveGroup2(b2SIMDContactConstraintGroup* group);
+
+	b2StackAllocator* m_allocator;
+
+	b2Body** m_bodies;
+	int32 m_bodyCount;
+
+	// Body velocities. Index 0 stands in for all static bodies, body i of the
+	// island is at i + 1.
+	float32* m_vx;
+	float32* m_vy;
+	float32* m_w;
+
+	b2SIMDContactConstraintGroup* m_groups;
+	int32 m_groupCount;
+};
+
+#endif
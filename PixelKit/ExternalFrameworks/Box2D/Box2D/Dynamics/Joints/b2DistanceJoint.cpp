@@ -19,6 +19,7 @@
 #include "b2DistanceJoint.h"
 #include "b2Body.h"
 #include "b2TimeStep.h"
+#include "b2Snapshot.h"
 
 // 1-D constrained system
 // m (v2 - v1) = lambda
@@ -115,10 +116,17 @@ void b2DistanceJoint::InitVelocityConstraints(const b2TimeStep& step)
 		m_impulse *= step.dtRatio;
 
 		b2Vec2 P = m_impulse * m_u;
-		b1->m_linearVelocity -= b1->m_invMass * P;
-		b1->m_angularVelocity -= b1->m_invI * b2Cross(r1, P);
-		b2->m_linearVelocity += b2->m_invMass * P;
-		b2->m_angularVelocity += b2->m_invI * b2Cross(r2, P);
+		if (b1->GetType() != b2_staticBody)
+		{
+			b1->m_linearVelocity -= b1->m_invMass * P;
+			b1->m_angularVelocity -= b1->m_invI * b2Cross(r1, P);
+		}
+
+		if (b2->GetType() != b2_staticBody)
+		{
+			b2->m_linearVelocity += b2->m_invMass * P;
+			b2->m_angularVelocity += b2->m_invI * b2Cross(r2, P);
+		}
 	}
 	else
 	{
@@ -145,10 +153,17 @@ void b2DistanceJoint::SolveVelocityConstraints(const b2TimeStep& step)
 	m_impulse += impulse;
 
 	b2Vec2 P = impulse * m_u;
-	b1->m_linearVelocity -= b1->m_invMass * P;
-	b1->m_angularVelocity -= b1->m_invI * b2Cross(r1, P);
-	b2->m_linearVelocity += b2->m_invMass * P;
-	b2->m_angularVelocity += b2->m_invI * b2Cross(r2, P);
+	if (b1->GetType() != b2_staticBody)
+	{
+		b1->m_linearVelocity -= b1->m_invMass * P;
+		b1->m_angularVelocity -= b1->m_invI * b2Cross(r1, P);
+	}
+
+	if (b2->GetType() != b2_staticBody)
+	{
+		b2->m_linearVelocity += b2->m_invMass * P;
+		b2->m_angularVelocity += b2->m_invI * b2Cross(r2, P);
+	}
 }
 
 bool b2DistanceJoint::SolvePositionConstraints(float32 baumgarte)
@@ -177,13 +192,19 @@ bool b2DistanceJoint::SolvePositionConstraints(float32 baumgarte)
 	m_u = d;
 	b2Vec2 P = impulse * m_u;
 
-	b1->m_sweep.c -= b1->m_invMass * P;
-	b1->m_sweep.a -= b1->m_invI * b2Cross(r1, P);
-	b2->m_sweep.c += b2->m_invMass * P;
-	b2->m_sweep.a += b2->m_invI * b2Cross(r2, P);
+	if (b1->GetType() != b2_staticBody)
+	{
+		b1->m_sweep.c -= b1->m_invMass * P;
+		b1->m_sweep.a -= b1->m_invI * b2Cross(r1, P);
+		b1->SynchronizeTransform();
+	}
 
-	b1->SynchronizeTransform();
-	b2->SynchronizeTransform();
+	if (b2->GetType() != b2_staticBody)
+	{
+		b2->m_sweep.c += b2->m_invMass * P;
+		b2->m_sweep.a += b2->m_invI * b2Cross(r2, P);
+		b2->SynchronizeTransform();
+	}
 
 	return b2Abs(C) < b2_linearSlop;
 }
@@ -209,3 +230,19 @@ float32 b2DistanceJoint::GetReactionTorque(float32 inv_dt) const
 	B2_NOT_USED(inv_dt);
 	return 0.0f;
 }
+
+void b2DistanceJoint::WriteSnapshot(b2Snapshot* snapshot) const
+{
+	snapshot->Write(m_impulse);
+	snapshot->Write(m_length);
+	snapshot->Write(m_frequencyHz);
+	snapshot->Write(m_dampingRatio);
+}
+
+void b2DistanceJoint::ReadSnapshot(b2SnapshotReader* reader)
+{
+	reader->Read(&m_impulse);
+	reader->Read(&m_length);
+	reader->Read(&m_frequencyHz);
+	reader->Read(&m_dampingRatio);
+}
@@ -19,6 +19,7 @@
 #include "b2FrictionJoint.h"
 #include "b2Body.h"
 #include "b2TimeStep.h"
+#include "b2Snapshot.h"
 
 // Point-to-point constraint
 // Cdot = v2 - v1
@@ -103,11 +104,17 @@ void b2FrictionJoint::InitVelocityConstraints(const b2TimeStep& step)
 
 		b2Vec2 P(m_linearImpulse.x, m_linearImpulse.y);
 
-		bA->m_linearVelocity -= mA * P;
-		bA->m_angularVelocity -= iA * (b2Cross(rA, P) + m_angularImpulse);
+		if (bA->GetType() != b2_staticBody)
+		{
+			bA->m_linearVelocity -= mA * P;
+			bA->m_angularVelocity -= iA * (b2Cross(rA, P) + m_angularImpulse);
+		}
 
-		bB->m_linearVelocity += mB * P;
-		bB->m_angularVelocity += iB * (b2Cross(rB, P) + m_angularImpulse);
+		if (bB->GetType() != b2_staticBody)
+		{
+			bB->m_linearVelocity += mB * P;
+			bB->m_angularVelocity += iB * (b2Cross(rB, P) + m_angularImpulse);
+		}
 	}
 	else
 	{
@@ -173,10 +180,17 @@ void b2FrictionJoint::SolveVelocityConstraints(const b2TimeStep& step)
 		wB += iB * b2Cross(rB, impulse);
 	}
 
-	bA->m_linearVelocity = vA;
-	bA->m_angularVelocity = wA;
-	bB->m_linearVelocity = vB;
-	bB->m_angularVelocity = wB;
+	if (bA->GetType() != b2_staticBody)
+	{
+		bA->m_linearVelocity = vA;
+		bA->m_angularVelocity = wA;
+	}
+
+	if (bB->GetType() != b2_staticBody)
+	{
+		bB->m_linearVelocity = vB;
+		bB->m_angularVelocity = wB;
+	}
 }
 
 bool b2FrictionJoint::SolvePositionConstraints(float32 baumgarte)
@@ -227,3 +241,19 @@ float32 b2FrictionJoint::GetMaxTorque() const
 {
 	return m_maxTorque;
 }
+
+void b2FrictionJoint::WriteSnapshot(b2Snapshot* snapshot) const
+{
+	snapshot->Write(m_linearImpulse);
+	snapshot->Write(m_angularImpulse);
+	snapshot->Write(m_maxForce);
+	snapshot->Write(m_maxTorque);
+}
+
+void b2FrictionJoint::ReadSnapshot(b2SnapshotReader* reader)
+{
+	reader->Read(&m_linearImpulse);
+	reader->Read(&m_angularImpulse);
+	reader->Read(&m_maxForce);
+	reader->Read(&m_maxTorque);
+}
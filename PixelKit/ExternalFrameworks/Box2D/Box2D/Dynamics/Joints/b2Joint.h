@@ -25,6 +25,8 @@ class b2Body;
 class b2Joint;
 struct b2TimeStep;
 class b2BlockAllocator;
+class b2Snapshot;
+class b2SnapshotReader;
 
 enum b2JointType
 {
@@ -151,12 +153,19 @@ protected:
 	b2Joint(const b2JointDef* def);
 	virtual ~b2Joint() {}
 
+	// The solvers must not write to static bodies, even zero changes: islands
+	// solved at the same time can share them.
 	virtual void InitVelocityConstraints(const b2TimeStep& step) = 0;
 	virtual void SolveVelocityConstraints(const b2TimeStep& step) = 0;
 
 	// This returns true if the position errors are within tolerance.
 	virtual bool SolvePositionConstraints(float32 baumgarte) = 0;
 
+	// Write and read the state kept from one step to the next: the accumulated
+	// impulses and limit states, and the values that can be changed after creation.
+	virtual void WriteSnapshot(b2Snapshot* snapshot) const = 0;
+	virtual void ReadSnapshot(b2SnapshotReader* reader) = 0;
+
 	b2JointType m_type;
 	b2Joint* m_prev;
 	b2Joint* m_next;
@@ -19,6 +19,7 @@
 #include "b2MouseJoint.h"
 #include "b2Body.h"
 #include "b2TimeStep.h"
+#include "b2Snapshot.h"
 
 // p = attached point, m = mouse point
 // C = p - m
@@ -195,3 +196,21 @@ float32 b2MouseJoint::GetReactionTorque(float32 inv_dt) const
 {
 	return inv_dt * 0.0f;
 }
+
+void b2MouseJoint::WriteSnapshot(b2Snapshot* snapshot) const
+{
+	snapshot->Write(m_impulse);
+	snapshot->Write(m_target);
+	snapshot->Write(m_maxForce);
+	snapshot->Write(m_frequencyHz);
+	snapshot->Write(m_dampingRatio);
+}
+
+void b2MouseJoint::ReadSnapshot(b2SnapshotReader* reader)
+{
+	reader->Read(&m_impulse);
+	reader->Read(&m_target);
+	reader->Read(&m_maxForce);
+	reader->Read(&m_frequencyHz);
+	reader->Read(&m_dampingRatio);
+}
@@ -19,6 +19,7 @@
 #include "b2PrismaticJoint.h"
 #include "b2Body.h"
 #include "b2TimeStep.h"
+#include "b2Snapshot.h"
 
 // Linear constraint (point-to-line)
 // d = p2 - p1 = x2 + r2 - x1 - r1
@@ -229,11 +230,17 @@ void b2PrismaticJoint::InitVelocityConstraints(const b2TimeStep& step)
 		float32 L1 = m_impulse.x * m_s1 + m_impulse.y + (m_motorImpulse + m_impulse.z) * m_a1;
 		float32 L2 = m_impulse.x * m_s2 + m_impulse.y + (m_motorImpulse + m_impulse.z) * m_a2;
 
-		b1->m_linearVelocity -= m_invMassA * P;
-		b1->m_angularVelocity -= m_invIA * L1;
+		if (b1->GetType() != b2_staticBody)
+		{
+			b1->m_linearVelocity -= m_invMassA * P;
+			b1->m_angularVelocity -= m_invIA * L1;
+		}
 
-		b2->m_linearVelocity += m_invMassB * P;
-		b2->m_angularVelocity += m_invIB * L2;
+		if (b2->GetType() != b2_staticBody)
+		{
+			b2->m_linearVelocity += m_invMassB * P;
+			b2->m_angularVelocity += m_invIB * L2;
+		}
 	}
 	else
 	{
@@ -333,10 +340,17 @@ void b2PrismaticJoint::SolveVelocityConstraints(const b2TimeStep& step)
 		w2 += m_invIB * L2;
 	}
 
-	b1->m_linearVelocity = v1;
-	b1->m_angularVelocity = w1;
-	b2->m_linearVelocity = v2;
-	b2->m_angularVelocity = w2;
+	if (b1->GetType() != b2_staticBody)
+	{
+		b1->m_linearVelocity = v1;
+		b1->m_angularVelocity = w1;
+	}
+
+	if (b2->GetType() != b2_staticBody)
+	{
+		b2->m_linearVelocity = v2;
+		b2->m_angularVelocity = w2;
+	}
 }
 
 bool b2PrismaticJoint::SolvePositionConstraints(float32 baumgarte)
@@ -458,12 +472,19 @@ bool b2PrismaticJoint::SolvePositionConstraints(float32 baumgarte)
 	a2 += m_invIB * L2;
 
 	// TODO_ERIN remove need for this.
-	b1->m_sweep.c = c1;
-	b1->m_sweep.a = a1;
-	b2->m_sweep.c = c2;
-	b2->m_sweep.a = a2;
-	b1->SynchronizeTransform();
-	b2->SynchronizeTransform();
+	if (b1->GetType() != b2_staticBody)
+	{
+		b1->m_sweep.c = c1;
+		b1->m_sweep.a = a1;
+		b1->SynchronizeTransform();
+	}
+
+	if (b2->GetType() != b2_staticBody)
+	{
+		b2->m_sweep.c = c2;
+		b2->m_sweep.a = a2;
+		b2->SynchronizeTransform();
+	}
 	
 	return linearError <= b2_linearSlop && angularError <= b2_angularSlop;
 }
@@ -584,3 +605,29 @@ float32 b2PrismaticJoint::GetMotorForce() const
 {
 	return m_motorImpulse;
 }
+
+void b2PrismaticJoint::WriteSnapshot(b2Snapshot* snapshot) const
+{
+	snapshot->Write(m_impulse);
+	snapshot->Write(m_motorImpulse);
+	snapshot->Write(m_limitState);
+	snapshot->Write(m_lowerTranslation);
+	snapshot->Write(m_upperTranslation);
+	snapshot->Write(m_maxMotorForce);
+	snapshot->Write(m_motorSpeed);
+	snapshot->Write(m_enableLimit);
+	snapshot->Write(m_enableMotor);
+}
+
+void b2PrismaticJoint::ReadSnapshot(b2SnapshotReader* reader)
+{
+	reader->Read(&m_impulse);
+	reader->Read(&m_motorImpulse);
+	reader->Read(&m_limitState);
+	reader->Read(&m_lowerTranslation);
+	reader->Read(&m_upperTranslation);
+	reader->Read(&m_maxMotorForce);
+	reader->Read(&m_motorSpeed);
+	reader->Read(&m_enableLimit);
+	reader->Read(&m_enableMotor);
+}
@@ -19,6 +19,7 @@
 #include "b2PulleyJoint.h"
 #include "b2Body.h"
 #include "b2TimeStep.h"
+#include "b2Snapshot.h"
 
 // Pulley:
 // length1 = norm(p1 - s1)
@@ -176,10 +177,17 @@ void b2PulleyJoint::InitVelocityConstraints(const b2TimeStep& step)
 		// Warm starting.
 		b2Vec2 P1 = -(m_impulse + m_limitImpulse1) * m_u1;
 		b2Vec2 P2 = (-m_ratio * m_impulse - m_limitImpulse2) * m_u2;
-		b1->m_linearVelocity += b1->m_invMass * P1;
-		b1->m_angularVelocity += b1->m_invI * b2Cross(r1, P1);
-		b2->m_linearVelocity += b2->m_invMass * P2;
-		b2->m_angularVelocity += b2->m_invI * b2Cross(r2, P2);
+		if (b1->GetType() != b2_staticBody)
+		{
+			b1->m_linearVelocity += b1->m_invMass * P1;
+			b1->m_angularVelocity += b1->m_invI * b2Cross(r1, P1);
+		}
+
+		if (b2->GetType() != b2_staticBody)
+		{
+			b2->m_linearVelocity += b2->m_invMass * P2;
+			b2->m_angularVelocity += b2->m_invI * b2Cross(r2, P2);
+		}
 	}
 	else
 	{
@@ -212,10 +220,17 @@ void b2PulleyJoint::SolveVelocityConstraints(const b2TimeStep& step)
 
 		b2Vec2 P1 = -impulse * m_u1;
 		b2Vec2 P2 = -m_ratio * impulse * m_u2;
-		b1->m_linearVelocity += b1->m_invMass * P1;
-		b1->m_angularVelocity += b1->m_invI * b2Cross(r1, P1);
-		b2->m_linearVelocity += b2->m_invMass * P2;
-		b2->m_angularVelocity += b2->m_invI * b2Cross(r2, P2);
+		if (b1->GetType() != b2_staticBody)
+		{
+			b1->m_linearVelocity += b1->m_invMass * P1;
+			b1->m_angularVelocity += b1->m_invI * b2Cross(r1, P1);
+		}
+
+		if (b2->GetType() != b2_staticBody)
+		{
+			b2->m_linearVelocity += b2->m_invMass * P2;
+			b2->m_angularVelocity += b2->m_invI * b2Cross(r2, P2);
+		}
 	}
 
 	if (m_limitState1 == e_atUpperLimit)
@@ -229,8 +244,11 @@ void b2PulleyJoint::SolveVelocityConstraints(const b2TimeStep& step)
 		impulse = m_limitImpulse1 - oldImpulse;
 
 		b2Vec2 P1 = -impulse * m_u1;
-		b1->m_linearVelocity += b1->m_invMass * P1;
-		b1->m_angularVelocity += b1->m_invI * b2Cross(r1, P1);
+		if (b1->GetType() != b2_staticBody)
+		{
+			b1->m_linearVelocity += b1->m_invMass * P1;
+			b1->m_angularVelocity += b1->m_invI * b2Cross(r1, P1);
+		}
 	}
 
 	if (m_limitState2 == e_atUpperLimit)
@@ -244,8 +262,11 @@ void b2PulleyJoint::SolveVelocityConstraints(const b2TimeStep& step)
 		impulse = m_limitImpulse2 - oldImpulse;
 
 		b2Vec2 P2 = -impulse * m_u2;
-		b2->m_linearVelocity += b2->m_invMass * P2;
-		b2->m_angularVelocity += b2->m_invI * b2Cross(r2, P2);
+		if (b2->GetType() != b2_staticBody)
+		{
+			b2->m_linearVelocity += b2->m_invMass * P2;
+			b2->m_angularVelocity += b2->m_invI * b2Cross(r2, P2);
+		}
 	}
 }
 
@@ -303,13 +324,19 @@ bool b2PulleyJoint::SolvePositionConstraints(float32 baumgarte)
 		b2Vec2 P1 = -impulse * m_u1;
 		b2Vec2 P2 = -m_ratio * impulse * m_u2;
 
-		b1->m_sweep.c += b1->m_invMass * P1;
-		b1->m_sweep.a += b1->m_invI * b2Cross(r1, P1);
-		b2->m_sweep.c += b2->m_invMass * P2;
-		b2->m_sweep.a += b2->m_invI * b2Cross(r2, P2);
+		if (b1->GetType() != b2_staticBody)
+		{
+			b1->m_sweep.c += b1->m_invMass * P1;
+			b1->m_sweep.a += b1->m_invI * b2Cross(r1, P1);
+			b1->SynchronizeTransform();
+		}
 
-		b1->SynchronizeTransform();
-		b2->SynchronizeTransform();
+		if (b2->GetType() != b2_staticBody)
+		{
+			b2->m_sweep.c += b2->m_invMass * P2;
+			b2->m_sweep.a += b2->m_invI * b2Cross(r2, P2);
+			b2->SynchronizeTransform();
+		}
 	}
 
 	if (m_limitState1 == e_atUpperLimit)
@@ -335,10 +362,12 @@ bool b2PulleyJoint::SolvePositionConstraints(float32 baumgarte)
 		float32 impulse = -m_limitMass1 * C;
 
 		b2Vec2 P1 = -impulse * m_u1;
-		b1->m_sweep.c += b1->m_invMass * P1;
-		b1->m_sweep.a += b1->m_invI * b2Cross(r1, P1);
-
-		b1->SynchronizeTransform();
+		if (b1->GetType() != b2_staticBody)
+		{
+			b1->m_sweep.c += b1->m_invMass * P1;
+			b1->m_sweep.a += b1->m_invI * b2Cross(r1, P1);
+			b1->SynchronizeTransform();
+		}
 	}
 
 	if (m_limitState2 == e_atUpperLimit)
@@ -364,10 +393,12 @@ bool b2PulleyJoint::SolvePositionConstraints(float32 baumgarte)
 		float32 impulse = -m_limitMass2 * C;
 
 		b2Vec2 P2 = -impulse * m_u2;
-		b2->m_sweep.c += b2->m_invMass * P2;
-		b2->m_sweep.a += b2->m_invI * b2Cross(r2, P2);
-
-		b2->SynchronizeTransform();
+		if (b2->GetType() != b2_staticBody)
+		{
+			b2->m_sweep.c += b2->m_invMass * P2;
+			b2->m_sweep.a += b2->m_invI * b2Cross(r2, P2);
+			b2->SynchronizeTransform();
+		}
 	}
 
 	return linearError < b2_linearSlop;
@@ -425,3 +456,23 @@ float32 b2PulleyJoint::GetRatio() const
 {
 	return m_ratio;
 }
+
+void b2PulleyJoint::WriteSnapshot(b2Snapshot* snapshot) const
+{
+	snapshot->Write(m_impulse);
+	snapshot->Write(m_limitImpulse1);
+	snapshot->Write(m_limitImpulse2);
+	snapshot->Write(m_state);
+	snapshot->Write(m_limitState1);
+	snapshot->Write(m_limitState2);
+}
+
+void b2PulleyJoint::ReadSnapshot(b2SnapshotReader* reader)
+{
+	reader->Read(&m_impulse);
+	reader->Read(&m_limitImpulse1);
+	reader->Read(&m_limitImpulse2);
+	reader->Read(&m_state);
+	reader->Read(&m_limitState1);
+	reader->Read(&m_limitState2);
+}
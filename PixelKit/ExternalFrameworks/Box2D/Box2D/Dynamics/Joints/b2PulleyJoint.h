@@ -116,6 +116,9 @@ protected:
 	void SolveVelocityConstraints(const b2TimeStep& step);
 	bool SolvePositionConstraints(float32 baumgarte);
 
+	void WriteSnapshot(b2Snapshot* snapshot) const;
+	void ReadSnapshot(b2SnapshotReader* reader);
+
 	b2Vec2 m_groundAnchor1;
 	b2Vec2 m_groundAnchor2;
 	b2Vec2 m_localAnchor1;
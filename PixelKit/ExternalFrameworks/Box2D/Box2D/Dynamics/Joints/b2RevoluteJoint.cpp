@@ -19,6 +19,7 @@
 #include "b2RevoluteJoint.h"
 #include "b2Body.h"
 #include "b2TimeStep.h"
+#include "b2Snapshot.h"
 
 // Point-to-point constraint
 // C = p2 - p1
@@ -152,11 +153,17 @@ void b2RevoluteJoint::InitVelocityConstraints(const b2TimeStep& step)
 
 		b2Vec2 P(m_impulse.x, m_impulse.y);
 
-		b1->m_linearVelocity -= m1 * P;
-		b1->m_angularVelocity -= i1 * (b2Cross(r1, P) + m_motorImpulse + m_impulse.z);
+		if (b1->GetType() != b2_staticBody)
+		{
+			b1->m_linearVelocity -= m1 * P;
+			b1->m_angularVelocity -= i1 * (b2Cross(r1, P) + m_motorImpulse + m_impulse.z);
+		}
 
-		b2->m_linearVelocity += m2 * P;
-		b2->m_angularVelocity += i2 * (b2Cross(r2, P) + m_motorImpulse + m_impulse.z);
+		if (b2->GetType() != b2_staticBody)
+		{
+			b2->m_linearVelocity += m2 * P;
+			b2->m_angularVelocity += i2 * (b2Cross(r2, P) + m_motorImpulse + m_impulse.z);
+		}
 	}
 	else
 	{
@@ -265,10 +272,17 @@ void b2RevoluteJoint::SolveVelocityConstraints(const b2TimeStep& step)
 		w2 += i2 * b2Cross(r2, impulse);
 	}
 
-	b1->m_linearVelocity = v1;
-	b1->m_angularVelocity = w1;
-	b2->m_linearVelocity = v2;
-	b2->m_angularVelocity = w2;
+	if (b1->GetType() != b2_staticBody)
+	{
+		b1->m_linearVelocity = v1;
+		b1->m_angularVelocity = w1;
+	}
+
+	if (b2->GetType() != b2_staticBody)
+	{
+		b2->m_linearVelocity = v2;
+		b2->m_angularVelocity = w2;
+	}
 }
 
 bool b2RevoluteJoint::SolvePositionConstraints(float32 baumgarte)
@@ -315,11 +329,17 @@ bool b2RevoluteJoint::SolvePositionConstraints(float32 baumgarte)
 			limitImpulse = -m_motorMass * C;
 		}
 
-		b1->m_sweep.a -= b1->m_invI * limitImpulse;
-		b2->m_sweep.a += b2->m_invI * limitImpulse;
+		if (b1->GetType() != b2_staticBody)
+		{
+			b1->m_sweep.a -= b1->m_invI * limitImpulse;
+			b1->SynchronizeTransform();
+		}
 
-		b1->SynchronizeTransform();
-		b2->SynchronizeTransform();
+		if (b2->GetType() != b2_staticBody)
+		{
+			b2->m_sweep.a += b2->m_invI * limitImpulse;
+			b2->SynchronizeTransform();
+		}
 	}
 
 	// Solve point-to-point constraint.
@@ -346,8 +366,15 @@ bool b2RevoluteJoint::SolvePositionConstraints(float32 baumgarte)
 			}
 			b2Vec2 impulse = m * (-C);
 			const float32 k_beta = 0.5f;
-			b1->m_sweep.c -= k_beta * invMass1 * impulse;
-			b2->m_sweep.c += k_beta * invMass2 * impulse;
+			if (b1->GetType() != b2_staticBody)
+			{
+				b1->m_sweep.c -= k_beta * invMass1 * impulse;
+			}
+
+			if (b2->GetType() != b2_staticBody)
+			{
+				b2->m_sweep.c += k_beta * invMass2 * impulse;
+			}
 
 			C = b2->m_sweep.c + r2 - b1->m_sweep.c - r1;
 		}
@@ -367,14 +394,19 @@ bool b2RevoluteJoint::SolvePositionConstraints(float32 baumgarte)
 		b2Mat22 K = K1 + K2 + K3;
 		b2Vec2 impulse = K.Solve(-C);
 
-		b1->m_sweep.c -= b1->m_invMass * impulse;
-		b1->m_sweep.a -= b1->m_invI * b2Cross(r1, impulse);
-
-		b2->m_sweep.c += b2->m_invMass * impulse;
-		b2->m_sweep.a += b2->m_invI * b2Cross(r2, impulse);
+		if (b1->GetType() != b2_staticBody)
+		{
+			b1->m_sweep.c -= b1->m_invMass * impulse;
+			b1->m_sweep.a -= b1->m_invI * b2Cross(r1, impulse);
+			b1->SynchronizeTransform();
+		}
 
-		b1->SynchronizeTransform();
-		b2->SynchronizeTransform();
+		if (b2->GetType() != b2_staticBody)
+		{
+			b2->m_sweep.c += b2->m_invMass * impulse;
+			b2->m_sweep.a += b2->m_invI * b2Cross(r2, impulse);
+			b2->SynchronizeTransform();
+		}
 	}
 	
 	return positionError <= b2_linearSlop && angularError <= b2_angularSlop;
@@ -476,3 +508,29 @@ void b2RevoluteJoint::SetLimits(float32 lower, float32 upper)
 	m_lowerAngle = lower;
 	m_upperAngle = upper;
 }
+
+void b2RevoluteJoint::WriteSnapshot(b2Snapshot* snapshot) const
+{
+	snapshot->Write(m_impulse);
+	snapshot->Write(m_motorImpulse);
+	snapshot->Write(m_limitState);
+	snapshot->Write(m_lowerAngle);
+	snapshot->Write(m_upperAngle);
+	snapshot->Write(m_maxMotorTorque);
+	snapshot->Write(m_motorSpeed);
+	snapshot->Write(m_enableLimit);
+	snapshot->Write(m_enableMotor);
+}
+
+void b2RevoluteJoint::ReadSnapshot(b2SnapshotReader* reader)
+{
+	reader->Read(&m_impulse);
+	reader->Read(&m_motorImpulse);
+	reader->Read(&m_limitState);
+	reader->Read(&m_lowerAngle);
+	reader->Read(&m_upperAngle);
+	reader->Read(&m_maxMotorTorque);
+	reader->Read(&m_motorSpeed);
+	reader->Read(&m_enableLimit);
+	reader->Read(&m_enableMotor);
+}
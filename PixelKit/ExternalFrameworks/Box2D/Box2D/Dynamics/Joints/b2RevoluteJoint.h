@@ -147,6 +147,9 @@ protected:
 
 	bool SolvePositionConstraints(float32 baumgarte);
 
+	void WriteSnapshot(b2Snapshot* snapshot) const;
+	void ReadSnapshot(b2SnapshotReader* reader);
+
 	b2Vec2 m_localAnchor1;	// relative
 	b2Vec2 m_localAnchor2;
 	b2Vec3 m_impulse;
@@ -19,6 +19,7 @@
 #include "b2WeldJoint.h"
 #include "b2Body.h"
 #include "b2TimeStep.h"
+#include "b2Snapshot.h"
 
 // Point-to-point constraint
 // C = p2 - p1
@@ -91,11 +92,17 @@ void b2WeldJoint::InitVelocityConstraints(const b2TimeStep& step)
 
 		b2Vec2 P(m_impulse.x, m_impulse.y);
 
-		bA->m_linearVelocity -= mA * P;
-		bA->m_angularVelocity -= iA * (b2Cross(rA, P) + m_impulse.z);
-
-		bB->m_linearVelocity += mB * P;
-		bB->m_angularVelocity += iB * (b2Cross(rB, P) + m_impulse.z);
+		if (bA->GetType() != b2_staticBody)
+		{
+			bA->m_linearVelocity -= mA * P;
+			bA->m_angularVelocity -= iA * (b2Cross(rA, P) + m_impulse.z);
+		}
+
+		if (bB->GetType() != b2_staticBody)
+		{
+			bB->m_linearVelocity += mB * P;
+			bB->m_angularVelocity += iB * (b2Cross(rB, P) + m_impulse.z);
+		}
 	}
 	else
 	{
@@ -137,10 +144,17 @@ void b2WeldJoint::SolveVelocityConstraints(const b2TimeStep& step)
 	vB += mB * P;
 	wB += iB * (b2Cross(rB, P) + impulse.z);
 
-	bA->m_linearVelocity = vA;
-	bA->m_angularVelocity = wA;
-	bB->m_linearVelocity = vB;
-	bB->m_angularVelocity = wB;
+	if (bA->GetType() != b2_staticBody)
+	{
+		bA->m_linearVelocity = vA;
+		bA->m_angularVelocity = wA;
+	}
+
+	if (bB->GetType() != b2_staticBody)
+	{
+		bB->m_linearVelocity = vB;
+		bB->m_angularVelocity = wB;
+	}
 }
 
 bool b2WeldJoint::SolvePositionConstraints(float32 baumgarte)
@@ -185,14 +199,19 @@ bool b2WeldJoint::SolvePositionConstraints(float32 baumgarte)
 
 	b2Vec2 P(impulse.x, impulse.y);
 
-	bA->m_sweep.c -= mA * P;
-	bA->m_sweep.a -= iA * (b2Cross(rA, P) + impulse.z);
-
-	bB->m_sweep.c += mB * P;
-	bB->m_sweep.a += iB * (b2Cross(rB, P) + impulse.z);
+	if (bA->GetType() != b2_staticBody)
+	{
+		bA->m_sweep.c -= mA * P;
+		bA->m_sweep.a -= iA * (b2Cross(rA, P) + impulse.z);
+		bA->SynchronizeTransform();
+	}
 
-	bA->SynchronizeTransform();
-	bB->SynchronizeTransform();
+	if (bB->GetType() != b2_staticBody)
+	{
+		bB->m_sweep.c += mB * P;
+		bB->m_sweep.a += iB * (b2Cross(rB, P) + impulse.z);
+		bB->SynchronizeTransform();
+	}
 
 	return positionError <= b2_linearSlop && angularError <= b2_angularSlop;
 }
@@ -217,3 +236,13 @@ float32 b2WeldJoint::GetReactionTorque(float32 inv_dt) const
 {
 	return inv_dt * m_impulse.z;
 }
+
+void b2WeldJoint::WriteSnapshot(b2Snapshot* snapshot) const
+{
+	snapshot->Write(m_impulse);
+}
+
+void b2WeldJoint::ReadSnapshot(b2SnapshotReader* reader)
+{
+	reader->Read(&m_impulse);
+}
@@ -31,6 +31,7 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 	b2Assert(b2IsValid(bd->inertiaScale) && bd->inertiaScale >= 0.0f);
 	b2Assert(b2IsValid(bd->angularDamping) && bd->angularDamping >= 0.0f);
 	b2Assert(b2IsValid(bd->linearDamping) && bd->linearDamping >= 0.0f);
+	b2Assert(b2IsValid(bd->continuousSpeed) && bd->continuousSpeed >= 0.0f);
 
 	m_flags = 0;
 
@@ -54,13 +55,19 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 	{
 		m_flags |= e_activeFlag;
 	}
+	if (bd->continuous)
+	{
+		m_flags |= e_continuousFlag;
+	}
 
 	m_world = world;
+	m_awakeIndex = -1;
 
 	m_xf.position = bd->position;
 	m_xf.R.Set(bd->angle);
 
 	m_sweep.localCenter.SetZero();
+	m_sweep.alpha0 = 0.0f;
 	m_sweep.a0 = m_sweep.a = bd->angle;
 	m_sweep.c0 = m_sweep.c = b2Mul(m_xf, m_sweep.localCenter);
 
@@ -80,6 +87,8 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 
 	m_sleepTime = 0.0f;
 
+	m_continuousSpeed = bd->continuousSpeed;
+
 	m_type = bd->type;
 
 	if (m_type == b2_dynamicBody)
@@ -114,8 +123,22 @@ void b2Body::SetType(b2BodyType type)
 		return;
 	}
 
+	bool wasStatic = m_type == b2_staticBody;
 	m_type = type;
 
+	// Static proxies live in their own tree, so move the proxies across.
+	if ((m_flags & e_activeFlag) && wasStatic != (m_type == b2_staticBody))
+	{
+		b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
+		for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
+		{
+			f->DestroyProxies(broadPhase);
+			f->CreateProxies(broadPhase, m_xf);
+		}
+
+		m_world->m_flags |= b2World::e_newFixture;
+	}
+
 	ResetMassData();
 
 	if (m_type == b2_staticBody)
@@ -440,6 +463,12 @@ void b2Body::SetActive(bool flag)
 		}
 
 		// Contacts are created the next time step.
+
+		// Put it back in the awake list.
+		if (m_flags & e_awakeFlag)
+		{
+			SetAwake(true);
+		}
 	}
 	else
 	{
@@ -463,3 +492,8 @@ void b2Body::SetActive(bool flag)
 		m_contactList = NULL;
 	}
 }
+
+void b2Body::AddToAwakeList()
+{
+	m_world->AddAwakeBody(this);
+}
@@ -64,6 +64,8 @@ struct b2BodyDef
 		awake = true;
 		fixedRotation = false;
 		bullet = false;
+		continuous = true;
+		continuousSpeed = 0.0f;
 		type = b2_staticBody;
 		active = true;
 		inertiaScale = 1.0f;
@@ -112,6 +114,16 @@ struct b2BodyDef
 	/// @warning You should use this flag sparingly since it increases processing time.
 	bool bullet;
 
+	/// Set this flag to false to leave this body out of continuous collision
+	/// detection altogether, even against static bodies and bullets. This is for
+	/// bodies where tunneling doesn't matter, like debris. It overrides bullet.
+	bool continuous;
+
+	/// Continuous collision is skipped for this body while its linear speed is
+	/// below this. A contact is skipped when neither body is fast enough, static
+	/// bodies never are. Zero, the default, means always.
+	float32 continuousSpeed;
+
 	/// Does this body start out active?
 	bool active;
 
@@ -296,6 +308,20 @@ public:
 	/// Is this body treated like a bullet for continuous collision detection?
 	bool IsBullet() const;
 
+	/// Should this body take part in continuous collision detection at all?
+	/// See b2BodyDef::continuous.
+	void SetContinuous(bool flag);
+
+	/// Does this body take part in continuous collision detection?
+	bool IsContinuous() const;
+
+	/// Set the speed below which continuous collision is skipped for this body.
+	/// See b2BodyDef::continuousSpeed.
+	void SetContinuousSpeed(float32 speed);
+
+	/// Get the speed below which continuous collision is skipped for this body.
+	float32 GetContinuousSpeed() const;
+
 	/// You can disable sleeping on this body. If you disable sleeping, the
 	/// body will be woken.
 	void SetSleepingAllowed(bool flag);
@@ -371,6 +397,7 @@ private:
 	friend class b2Island;
 	friend class b2ContactManager;
 	friend class b2ContactSolver;
+	friend class b2SIMDContactSolver;
 	
 	friend class b2DistanceJoint;
 	friend class b2GearJoint;
@@ -392,6 +419,7 @@ private:
 		e_fixedRotationFlag	= 0x0010,
 		e_activeFlag		= 0x0020,
 		e_toiFlag			= 0x0040,
+		e_continuousFlag	= 0x0080,
 	};
 
 	b2Body(const b2BodyDef* bd, b2World* world);
@@ -406,12 +434,18 @@ private:
 
 	void Advance(float32 t);
 
+	// Add the body to the world's awake list. See SetAwake.
+	void AddToAwakeList();
+
 	b2BodyType m_type;
 
 	uint16 m_flags;
 
 	int32 m_islandIndex;
 
+	// Index in the world's awake list, or -1.
+	int32 m_awakeIndex;
+
 	b2Transform m_xf;		// the body origin transform
 	b2Sweep m_sweep;		// the swept motion for CCD
 
@@ -441,6 +475,8 @@ private:
 
 	float32 m_sleepTime;
 
+	float32 m_continuousSpeed;
+
 	void* m_userData;
 };
 
@@ -598,6 +634,34 @@ inline bool b2Body::IsBullet() const
 	return (m_flags & e_bulletFlag) == e_bulletFlag;
 }
 
+inline void b2Body::SetContinuous(bool flag)
+{
+	if (flag)
+	{
+		m_flags |= e_continuousFlag;
+	}
+	else
+	{
+		m_flags &= ~e_continuousFlag;
+	}
+}
+
+inline bool b2Body::IsContinuous() const
+{
+	return (m_flags & e_continuousFlag) == e_continuousFlag;
+}
+
+inline void b2Body::SetContinuousSpeed(float32 speed)
+{
+	b2Assert(b2IsValid(speed) && speed >= 0.0f);
+	m_continuousSpeed = speed;
+}
+
+inline float32 b2Body::GetContinuousSpeed() const
+{
+	return m_continuousSpeed;
+}
+
 inline void b2Body::SetAwake(bool flag)
 {
 	if (flag)
@@ -607,6 +671,13 @@ inline void b2Body::SetAwake(bool flag)
 			m_flags |= e_awakeFlag;
 			m_sleepTime = 0.0f;
 		}
+
+		// Bodies that go to sleep stay in the awake list until the next
+		// step, so this only has to add them.
+		if (m_awakeIndex == -1 && m_type != b2_staticBody && (m_flags & e_activeFlag))
+		{
+			AddToAwakeList();
+		}
 	}
 	else
 	{
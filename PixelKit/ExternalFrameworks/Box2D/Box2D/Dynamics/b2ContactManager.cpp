@@ -21,10 +21,20 @@
 #include "b2Fixture.h"
 #include "b2WorldCallbacks.h"
 #include "b2Contact.h"
+#include "b2ThreadPool.h"
+#include "b2Timer.h"
 
 b2ContactFilter b2_defaultFilter;
 b2ContactListener b2_defaultListener;
 
+// A contact whose manifold was computed ahead of Collide.
+struct b2ContactUpdate
+{
+	b2Contact* contact;
+	b2Manifold manifold;
+	bool touching;
+};
+
 b2ContactManager::b2ContactManager()
 {
 	m_contactList = NULL;
@@ -32,6 +42,23 @@ b2ContactManager::b2ContactManager()
 	m_contactFilter = &b2_defaultFilter;
 	m_contactListener = &b2_defaultListener;
 	m_allocator = NULL;
+	m_arena = NULL;
+
+	m_threadPool = NULL;
+	m_updates = NULL;
+	m_updateCount = 0;
+	m_updateCapacity = 0;
+
+	m_findNewContactsTime = 0.0f;
+	m_pairCount = 0;
+}
+
+b2ContactManager::~b2ContactManager()
+{
+	if (m_updates)
+	{
+		b2Free(m_arena, m_updates, m_updateCapacity * sizeof(b2ContactUpdate));
+	}
 }
 
 void b2ContactManager::Destroy(b2Contact* c)
@@ -99,15 +126,96 @@ void b2ContactManager::Destroy(b2Contact* c)
 	--m_contactCount;
 }
 
+// Contacts per task. Manifolds are cheap, so keep the ranges fairly large.
+const int32 b2_contactUpdateRangeSize = 32;
+
+void b2ContactManager::UpdateManifoldsTask(void* userData, int32 begin, int32 end, int32 threadIndex)
+{
+	B2_NOT_USED(threadIndex);
+
+	b2ContactUpdate* updates = (b2ContactUpdate*)userData;
+	for (int32 i = begin; i < end; ++i)
+	{
+		b2ContactUpdate* update = updates + i;
+		update->touching = update->contact->UpdateManifold(&update->manifold);
+	}
+}
+
+void b2ContactManager::UpdateManifolds()
+{
+	m_updateCount = 0;
+
+	if (m_threadPool == NULL || m_threadPool->GetThreadCount() == 1)
+	{
+		return;
+	}
+
+	if (m_updateCapacity < m_contactCount)
+	{
+		if (m_updates)
+		{
+			b2Free(m_arena, m_updates, m_updateCapacity * sizeof(b2ContactUpdate));
+		}
+
+		m_updateCapacity = b2Max(m_contactCount, 2 * m_updateCapacity);
+		m_updates = (b2ContactUpdate*)b2Alloc(m_arena, m_updateCapacity * sizeof(b2ContactUpdate));
+	}
+
+	// Gather the contacts that Collide is going to update, as far as can be
+	// told without calling the filter. A contact can still be woken up by an
+	// earlier one in the list, Collide updates those itself.
+	for (b2Contact* c = m_contactList; c; c = c->GetNext())
+	{
+		if (c->m_flags & b2Contact::e_filterFlag)
+		{
+			continue;
+		}
+
+		b2Fixture* fixtureA = c->GetFixtureA();
+		b2Fixture* fixtureB = c->GetFixtureB();
+		b2Body* bodyA = fixtureA->GetBody();
+		b2Body* bodyB = fixtureB->GetBody();
+
+		if (bodyA->IsAwake() == false && bodyB->IsAwake() == false)
+		{
+			continue;
+		}
+
+		int32 proxyIdA = fixtureA->m_proxies[c->GetChildIndexA()].proxyId;
+		int32 proxyIdB = fixtureB->m_proxies[c->GetChildIndexB()].proxyId;
+		if (m_broadPhase.TestOverlap(proxyIdA, proxyIdB) == false)
+		{
+			continue;
+		}
+
+		m_updates[m_updateCount++].contact = c;
+	}
+
+	m_threadPool->ParallelFor(m_updateCount, b2_contactUpdateRangeSize, UpdateManifoldsTask, m_updates);
+}
+
 // This is the top level collision call for the time step. Here
 // all the narrow phase collision is processed for the world
 // contact list.
 void b2ContactManager::Collide()
 {
+	UpdateManifolds();
+
+	// The precomputed updates are in list order, and contacts are only
+	// removed from the list from here on.
+	int32 updateIndex = 0;
+
 	// Update awake contacts.
 	b2Contact* c = m_contactList;
 	while (c)
 	{
+		b2ContactUpdate* update = NULL;
+		if (updateIndex < m_updateCount && m_updates[updateIndex].contact == c)
+		{
+			update = m_updates + updateIndex;
+			++updateIndex;
+		}
+
 		b2Fixture* fixtureA = c->GetFixtureA();
 		b2Fixture* fixtureB = c->GetFixtureB();
 		int32 indexA = c->GetChildIndexA();
@@ -160,14 +268,27 @@ void b2ContactManager::Collide()
 		}
 
 		// The contact persists.
-		c->Update(m_contactListener);
+		if (update)
+		{
+			c->Update(m_contactListener, update->manifold, update->touching);
+		}
+		else
+		{
+			c->Update(m_contactListener);
+		}
+
 		c = c->GetNext();
 	}
+
+	m_updateCount = 0;
 }
 
 void b2ContactManager::FindNewContacts()
 {
+	b2Timer timer;
 	m_broadPhase.UpdatePairs(this);
+	m_pairCount += m_broadPhase.GetPairCount();
+	m_findNewContactsTime += timer.GetMilliseconds();
 }
 
 void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
@@ -25,12 +25,15 @@ class b2Contact;
 class b2ContactFilter;
 class b2ContactListener;
 class b2BlockAllocator;
+class b2ThreadPool;
+struct b2ContactUpdate;
 
 // Delegate of b2World.
 class b2ContactManager
 {
 public:
 	b2ContactManager();
+	~b2ContactManager();
 
 	// Broad-phase callback.
 	void AddPair(void* proxyUserDataA, void* proxyUserDataB);
@@ -40,6 +43,11 @@ public:
 	void Destroy(b2Contact* c);
 
 	void Collide();
+
+	// Computes the manifolds of the contacts that will be updated across the
+	// thread pool, ahead of the serial pass in Collide.
+	void UpdateManifolds();
+	static void UpdateManifoldsTask(void* userData, int32 begin, int32 end, int32 threadIndex);
             
 	b2BroadPhase m_broadPhase;
 	b2Contact* m_contactList;
@@ -47,6 +55,22 @@ public:
 	b2ContactFilter* m_contactFilter;
 	b2ContactListener* m_contactListener;
 	b2BlockAllocator* m_allocator;
+
+	// Where m_updates comes from. NULL means b2Alloc.
+	b2MemoryArena* m_arena;
+
+	// If set, manifolds are computed on these threads. Listener and filter
+	// callbacks are still made from the calling thread, in list order.
+	b2ThreadPool* m_threadPool;
+
+	b2ContactUpdate* m_updates;
+	int32 m_updateCount;
+	int32 m_updateCapacity;
+
+	// Time spent in FindNewContacts and the pairs it found. b2World::Step
+	// resets these for its profile.
+	float32 m_findNewContactsTime;
+	int32 m_pairCount;
 };
 
 #endif
@@ -23,8 +23,10 @@
 #include "b2World.h"
 #include "b2Contact.h"
 #include "b2ContactSolver.h"
+#include "b2SIMDContactSolver.h"
 #include "b2Joint.h"
 #include "b2StackAllocator.h"
+#include "b2Timer.h"
 
 /*
 Position Correction Notes
@@ -160,6 +162,8 @@ b2Island::b2Island(
 
 	m_allocator = allocator;
 	m_listener = listener;
+	m_deferredImpulses = NULL;
+	m_sharedStaticBodies = false;
 
 	m_bodies = (b2Body**)m_allocator->Allocate(bodyCapacity * sizeof(b2Body*));
 	m_contacts = (b2Contact**)m_allocator->Allocate(contactCapacity	 * sizeof(b2Contact*));
@@ -179,8 +183,10 @@ b2Island::~b2Island()
 	m_allocator->Free(m_bodies);
 }
 
-void b2Island::Solve(const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep)
+void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep)
 {
+	b2Timer timer;
+
 	// Integrate velocities and apply damping.
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
@@ -244,20 +250,55 @@ void b2Island::Solve(const b2TimeStep& step, const b2Vec2& gravity, bool allowSl
 		m_joints[i]->InitVelocityConstraints(step);
 	}
 
+	profile->solveInit += timer.GetMilliseconds();
+
 	// Solve velocity constraints.
-	for (int32 i = 0; i < step.velocityIterations; ++i)
+	timer.Reset();
+	if (step.simdContactSolver && m_contactCount > 0)
 	{
-		for (int32 j = 0; j < m_jointCount; ++j)
+		b2SIMDContactSolver simdSolver(&contactSolver, m_bodies, m_bodyCount, m_allocator);
+
+		for (int32 i = 0; i < step.velocityIterations; ++i)
 		{
-			m_joints[j]->SolveVelocityConstraints(step);
+			// The joints work on the bodies directly.
+			if (m_jointCount > 0)
+			{
+				simdSolver.ScatterVelocities();
+
+				for (int32 j = 0; j < m_jointCount; ++j)
+				{
+					m_joints[j]->SolveVelocityConstraints(step);
+				}
+
+				simdSolver.GatherVelocities();
+			}
+
+			simdSolver.SolveVelocityConstraints();
 		}
 
-		contactSolver.SolveVelocityConstraints();
+		simdSolver.ScatterVelocities();
+		simdSolver.StoreImpulses();
+	}
+	else
+	{
+		for (int32 i = 0; i < step.velocityIterations; ++i)
+		{
+			for (int32 j = 0; j < m_jointCount; ++j)
+			{
+				m_joints[j]->SolveVelocityConstraints(step);
+			}
+
+			contactSolver.SolveVelocityConstraints();
+		}
 	}
 
 	// Post-solve (store impulses for warm starting).
 	contactSolver.StoreImpulses();
 
+	profile->solveVelocity += timer.GetMilliseconds();
+
+	timer.Reset();
+
 	// Integrate positions.
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
@@ -316,14 +357,16 @@ void b2Island::Solve(const b2TimeStep& step, const b2Vec2& gravity, bool allowSl
 		}
 	}
 
+	profile->solvePosition += timer.GetMilliseconds();
+
 	Report(contactSolver.m_constraints);
 
 	if (allowSleep)
 	{
 		float32 minSleepTime = b2_maxFloat;
 
-		const float32 linTolSqr = b2_linearSleepTolerance * b2_linearSleepTolerance;
-		const float32 angTolSqr = b2_angularSleepTolerance * b2_angularSleepTolerance;
+		const float32 linTolSqr = step.linearSleepTolerance * step.linearSleepTolerance;
+		const float32 angTolSqr = step.angularSleepTolerance * step.angularSleepTolerance;
 
 		for (int32 i = 0; i < m_bodyCount; ++i)
 		{
@@ -353,11 +396,18 @@ void b2Island::Solve(const b2TimeStep& step, const b2Vec2& gravity, bool allowSl
 			}
 		}
 
-		if (minSleepTime >= b2_timeToSleep)
+		if (minSleepTime >= step.timeToSleep)
 		{
 			for (int32 i = 0; i < m_bodyCount; ++i)
 			{
+				// Static bodies shared with islands that are being solved at
+				// the same time are put to sleep by the world afterwards.
 				b2Body* b = m_bodies[i];
+				if (m_sharedStaticBodies && b->GetType() == b2_staticBody)
+				{
+					continue;
+				}
+
 				b->SetAwake(false);
 			}
 		}
@@ -507,6 +557,13 @@ void b2Island::Report(const b2ContactConstraint* constraints)
 			impulse.tangentImpulses[j] = cc->points[j].tangentImpulse;
 		}
 
-		m_listener->PostSolve(c, &impulse);
+		if (m_deferredImpulses)
+		{
+			m_deferredImpulses[i] = impulse;
+		}
+		else
+		{
+			m_listener->PostSolve(c, &impulse);
+		}
 	}
 }
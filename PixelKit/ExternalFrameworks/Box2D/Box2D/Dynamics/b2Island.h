@@ -28,6 +28,7 @@ class b2Joint;
 class b2StackAllocator;
 class b2ContactListener;
 struct b2ContactConstraint;
+struct b2ContactImpulse;
 
 /// This is an internal structure.
 struct b2Position
@@ -58,7 +59,8 @@ public:
 		m_jointCount = 0;
 	}
 
-	void Solve(const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep);
+	// Adds the time of the solver phases to the profile.
+	void Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep);
 
 	void SolveTOI(const b2TimeStep& subStep, const b2Body* bodyA, const b2Body* bodyB);
 
@@ -86,6 +88,15 @@ public:
 	b2StackAllocator* m_allocator;
 	b2ContactListener* m_listener;
 
+	// If set, Report stores the impulses here (one per contact, in the order of
+	// m_contacts) instead of calling the listener. Used when islands are solved
+	// on several threads.
+	b2ContactImpulse* m_deferredImpulses;
+
+	// If set, static bodies are not put to sleep along with the island, as
+	// other islands may be using them on another thread.
+	bool m_sharedStaticBodies;
+
 	b2Body** m_bodies;
 	b2Contact** m_contacts;
 	b2Joint** m_joints;
@@ -21,6 +21,64 @@
 
 #include "b2Settings.h"
 
+/// Where the time of a b2World::Step went and what it worked on. See
+/// b2World::GetProfile. Times are in milliseconds.
+struct b2Profile
+{
+	/// The whole step.
+	float32 step;
+
+	/// Updating the contacts, see b2ContactManager::Collide.
+	float32 collide;
+
+	/// Finding new pairs in the broad-phase, throughout the step.
+	float32 findNewContacts;
+
+	/// Solving the islands, moving the broad-phase proxies and finding the
+	/// new pairs that result.
+	float32 solve;
+
+	/// Searching the constraint graph for islands.
+	float32 buildIslands;
+
+	/// Integrating velocities and setting up the contact and joint constraints.
+	/// This and the next two are summed over the islands, with a thread pool
+	/// they are CPU time and can add up to more than solve.
+	float32 solveInit;
+
+	/// The velocity iterations.
+	float32 solveVelocity;
+
+	/// Integrating positions and the position iterations.
+	float32 solvePosition;
+
+	/// Moving the broad-phase proxies of the bodies that moved.
+	float32 synchronizeFixtures;
+
+	/// Continuous collision, see b2World::GetTOIStats.
+	float32 solveTOI;
+
+	/// The pairs reported by the broad-phase, each of which can start a contact.
+	int32 pairCount;
+
+	/// The contacts at the end of the step.
+	int32 contactCount;
+
+	/// The islands solved, not counting the ones of TOI events.
+	int32 islandCount;
+
+	/// The bodies in the awake list at the end of the step.
+	int32 awakeBodyCount;
+
+	/// The most stack allocator memory used at once during the step, by any
+	/// one of the stack allocators.
+	int32 stackPeakBytes;
+
+	/// The most memory handed out by the block allocator since the world was
+	/// created.
+	int32 blockPeakBytes;
+};
+
 /// This is an internal structure.
 struct b2TimeStep
 {
@@ -29,7 +87,11 @@ struct b2TimeStep
 	float32 dtRatio;	// dt * inv_dt0
 	int32 velocityIterations;
 	int32 positionIterations;
+	float32 linearSleepTolerance;
+	float32 angularSleepTolerance;
+	float32 timeToSleep;
 	bool warmStarting;
+	bool simdContactSolver;
 };
 
 #endif
@@ -30,37 +30,103 @@
 #include "b2LoopShape.h"
 #include "b2PolygonShape.h"
 #include "b2TimeOfImpact.h"
+#include "b2ThreadPool.h"
+#include "b2Snapshot.h"
+#include "b2Timer.h"
 #include <new>
+#include <cstring>
+#include <algorithm>
 
-b2World::b2World(const b2Vec2& gravity, bool doSleep)
+b2World::b2World(const b2Vec2& gravity, bool doSleep, const b2WorldMemoryDef* memoryDef)
 {
+	if (memoryDef)
+	{
+		m_memoryDef = *memoryDef;
+	}
+
+	m_blockAllocator.SetArena(m_memoryDef.arena);
+	m_blockAllocator.SetChunkSize(m_memoryDef.chunkSize);
+	m_stackAllocator.SetArena(m_memoryDef.arena);
+	m_stackAllocator.SetSize(m_memoryDef.stackSize, m_memoryDef.resizeStack);
+
 	m_destructionListener = NULL;
 	m_debugDraw = NULL;
 
+	m_threadPool = NULL;
+	m_threadStackAllocators = NULL;
+	m_threadStackAllocatorCount = 0;
+
 	m_bodyList = NULL;
 	m_jointList = NULL;
 
 	m_bodyCount = 0;
 	m_jointCount = 0;
 
+	m_awakeBodies = NULL;
+	m_awakeBodyCount = 0;
+	m_awakeBodyCapacity = 0;
+
 	m_warmStarting = true;
+	m_simdContactSolver = false;
 	m_continuousPhysics = true;
 	m_subStepping = false;
 
 	m_stepComplete = true;
 
+	m_maxTOIEvents = b2_maxTOIEvents;
+	m_toiStats.toiCount = 0;
+	m_toiStats.eventCount = 0;
+	m_toiStats.subStepCount = 0;
+	m_toiStats.capped = false;
+
+	memset(&m_profile, 0, sizeof(b2Profile));
+
 	m_allowSleep = doSleep;
 	m_gravity = gravity;
 
+	m_linearSleepTolerance = b2_linearSleepTolerance;
+	m_angularSleepTolerance = b2_angularSleepTolerance;
+	m_timeToSleep = b2_timeToSleep;
+
 	m_flags = e_clearForces;
 
 	m_inv_dt0 = 0.0f;
 
 	m_contactManager.m_allocator = &m_blockAllocator;
+	m_contactManager.m_arena = m_memoryDef.arena;
+	m_contactManager.m_broadPhase.SetArena(m_memoryDef.arena);
 }
 
 b2World::~b2World()
 {
+	SetThreadPool(NULL);
+
+	if (m_awakeBodies)
+	{
+		FreeMemory(m_awakeBodies, m_awakeBodyCapacity * sizeof(b2Body*));
+	}
+}
+
+void* b2World::AllocateMemory(int32 size) const
+{
+	if (m_memoryDef.arena)
+	{
+		return m_memoryDef.arena->Allocate(size);
+	}
+
+	return b2Alloc(size);
+}
+
+void b2World::FreeMemory(void* p, int32 size) const
+{
+	if (m_memoryDef.arena)
+	{
+		m_memoryDef.arena->Free(p, size);
+	}
+	else
+	{
+		b2Free(p);
+	}
 }
 
 void b2World::SetDestructionListener(b2DestructionListener* listener)
@@ -83,6 +149,44 @@ void b2World::SetDebugDraw(b2DebugDraw* debugDraw)
 	m_debugDraw = debugDraw;
 }
 
+void b2World::SetThreadPool(b2ThreadPool* threadPool)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	for (int32 i = 0; i < m_threadStackAllocatorCount; ++i)
+	{
+		m_threadStackAllocators[i].~b2StackAllocator();
+	}
+
+	if (m_threadStackAllocators)
+	{
+		FreeMemory(m_threadStackAllocators, m_threadStackAllocatorCount * sizeof(b2StackAllocator));
+		m_threadStackAllocators = NULL;
+	}
+
+	m_threadStackAllocatorCount = 0;
+	m_threadPool = threadPool;
+	m_contactManager.m_threadPool = threadPool;
+	m_contactManager.m_broadPhase.SetThreadPool(threadPool);
+
+	if (m_threadPool && m_threadPool->GetThreadCount() > 1)
+	{
+		m_threadStackAllocatorCount = m_threadPool->GetThreadCount();
+		m_threadStackAllocators = (b2StackAllocator*)AllocateMemory(m_threadStackAllocatorCount * sizeof(b2StackAllocator));
+
+		for (int32 i = 0; i < m_threadStackAllocatorCount; ++i)
+		{
+			b2StackAllocator* allocator = new (m_threadStackAllocators + i) b2StackAllocator();
+			allocator->SetArena(m_memoryDef.arena);
+			allocator->SetSize(m_memoryDef.stackSize, m_memoryDef.resizeStack);
+		}
+	}
+}
+
 b2Body* b2World::CreateBody(const b2BodyDef* def)
 {
 	b2Assert(IsLocked() == false);
@@ -104,6 +208,11 @@ b2Body* b2World::CreateBody(const b2BodyDef* def)
 	m_bodyList = b;
 	++m_bodyCount;
 
+	if (b->IsAwake() && b->IsActive() && b->GetType() != b2_staticBody)
+	{
+		AddAwakeBody(b);
+	}
+
 	return b;
 }
 
@@ -178,6 +287,12 @@ void b2World::DestroyBody(b2Body* b)
 		m_bodyList = b->m_next;
 	}
 
+	// Destroying the contacts may have woken the body, so this comes last.
+	if (b->m_awakeIndex != -1)
+	{
+		RemoveAwakeBody(b);
+	}
+
 	--m_bodyCount;
 	b->~b2Body();
 	m_blockAllocator.Free(b, sizeof(b2Body));
@@ -338,35 +453,174 @@ void b2World::DestroyJoint(b2Joint* j)
 	}
 }
 
-// Find islands, integrate and solve constraints, solve position constraints
-void b2World::Solve(const b2TimeStep& step)
+void b2World::AddAwakeBody(b2Body* body)
 {
-	// Size the island for the worst case.
-	b2Island island(m_bodyCount,
-					m_contactManager.m_contactCount,
-					m_jointCount,
-					&m_stackAllocator,
-					m_contactManager.m_contactListener);
+	b2Assert(body->m_awakeIndex == -1);
 
-	// Clear all the island flags.
-	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	if (m_awakeBodyCount == m_awakeBodyCapacity)
 	{
-		b->m_flags &= ~b2Body::e_islandFlag;
+		b2Body** oldBodies = m_awakeBodies;
+		int32 oldCapacity = m_awakeBodyCapacity;
+		m_awakeBodyCapacity = b2Max(2 * m_awakeBodyCapacity, 16);
+		m_awakeBodies = (b2Body**)AllocateMemory(m_awakeBodyCapacity * sizeof(b2Body*));
+		if (oldBodies)
+		{
+			memcpy(m_awakeBodies, oldBodies, m_awakeBodyCount * sizeof(b2Body*));
+			FreeMemory(oldBodies, oldCapacity * sizeof(b2Body*));
+		}
 	}
-	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+
+	body->m_awakeIndex = m_awakeBodyCount;
+	m_awakeBodies[m_awakeBodyCount] = body;
+	++m_awakeBodyCount;
+}
+
+void b2World::RemoveAwakeBody(b2Body* body)
+{
+	int32 index = body->m_awakeIndex;
+	b2Assert(0 <= index && index < m_awakeBodyCount && m_awakeBodies[index] == body);
+
+	--m_awakeBodyCount;
+	b2Body* last = m_awakeBodies[m_awakeBodyCount];
+	m_awakeBodies[index] = last;
+	last->m_awakeIndex = index;
+	body->m_awakeIndex = -1;
+}
+
+void b2World::CompactAwakeBodies()
+{
+	// Keep the order, the islands are seeded from this list.
+	int32 count = 0;
+	for (int32 i = 0; i < m_awakeBodyCount; ++i)
 	{
-		c->m_flags &= ~b2Contact::e_islandFlag;
+		b2Body* b = m_awakeBodies[i];
+		if (b->IsAwake() && b->IsActive() && b->GetType() != b2_staticBody)
+		{
+			b->m_awakeIndex = count;
+			m_awakeBodies[count++] = b;
+		}
+		else
+		{
+			b->m_awakeIndex = -1;
+		}
 	}
-	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	m_awakeBodyCount = count;
+}
+
+// Find islands, integrate and solve constraints, solve position constraints
+// An island found by b2World::SolveIslandsParallel, as ranges into the arrays
+// shared by all of the islands.
+struct b2IslandRange
+{
+	int32 bodyStart;
+	int32 bodyCount;
+	int32 contactStart;
+	int32 contactCount;
+	int32 jointStart;
+	int32 jointCount;
+};
+
+struct b2IslandSolveContext
+{
+	const b2TimeStep* step;
+	b2Vec2 gravity;
+	bool allowSleep;
+
+	const b2IslandRange* islands;
+	b2Body** bodies;
+	b2Contact** contacts;
+	b2Joint** joints;
+
+	b2ContactListener* listener;
+	b2ContactImpulse* impulses;
+
+	b2StackAllocator* allocators;
+
+	// The solver times of each thread.
+	b2Profile* profiles;
+};
+
+void b2World::SolveIslandsTask(void* userData, int32 begin, int32 end, int32 threadIndex)
+{
+	b2IslandSolveContext* context = (b2IslandSolveContext*)userData;
+	b2StackAllocator* allocator = context->allocators + threadIndex;
+
+	for (int32 i = begin; i < end; ++i)
 	{
-		j->m_islandFlag = false;
+		const b2IslandRange* range = context->islands + i;
+
+		b2Island island(range->bodyCount,
+						range->contactCount,
+						range->jointCount,
+						allocator,
+						context->listener);
+
+		// Copy the island in directly rather than through b2Island::Add, which
+		// writes to the bodies (and static bodies can be in several islands).
+		memcpy(island.m_bodies, context->bodies + range->bodyStart, range->bodyCount * sizeof(b2Body*));
+		memcpy(island.m_contacts, context->contacts + range->contactStart, range->contactCount * sizeof(b2Contact*));
+		memcpy(island.m_joints, context->joints + range->jointStart, range->jointCount * sizeof(b2Joint*));
+		island.m_bodyCount = range->bodyCount;
+
+		// Static bodies are left alone, the solvers don't need their index.
+		for (int32 j = 0; j < island.m_bodyCount; ++j)
+		{
+			b2Body* b = island.m_bodies[j];
+			if (b->GetType() != b2_staticBody)
+			{
+				b->m_islandIndex = j;
+			}
+		}
+		island.m_contactCount = range->contactCount;
+		island.m_jointCount = range->jointCount;
+
+		if (context->impulses)
+		{
+			island.m_deferredImpulses = context->impulses + range->contactStart;
+		}
+
+		island.m_sharedStaticBodies = true;
+
+		island.Solve(context->profiles + threadIndex, *context->step, context->gravity, context->allowSleep);
+
+		// The island reorders its contacts, keep them in the order it reported
+		// their impulses in.
+		memcpy(context->contacts + range->contactStart, island.m_contacts, range->contactCount * sizeof(b2Contact*));
 	}
+}
+
+// Same as the island loop in Solve, except that all the islands are found
+// first and then solved on the thread pool. Islands share nothing but static
+// bodies. The contact and joint solvers skip every write to a static body,
+// and the islands leave putting them to sleep to the world, so nothing that
+// is shared gets written while the islands are solved.
+void b2World::SolveIslandsParallel(const b2TimeStep& step)
+{
+	b2ContactListener* listener = m_contactManager.m_contactListener;
+	int32 contactCapacity = m_contactManager.m_contactCount;
+
+	// A static body is added once to each island it touches, which is at most
+	// once per contact or joint.
+	int32 bodyCapacity = m_bodyCount + contactCapacity + m_jointCount;
+
+	b2Body** bodies = (b2Body**)m_stackAllocator.Allocate(bodyCapacity * sizeof(b2Body*));
+	b2Contact** contacts = (b2Contact**)m_stackAllocator.Allocate(contactCapacity * sizeof(b2Contact*));
+	b2Joint** joints = (b2Joint**)m_stackAllocator.Allocate(m_jointCount * sizeof(b2Joint*));
+	b2IslandRange* islands = (b2IslandRange*)m_stackAllocator.Allocate(m_bodyCount * sizeof(b2IslandRange));
+
+	int32 bodyCount = 0;
+	int32 contactCount = 0;
+	int32 jointCount = 0;
+	int32 islandCount = 0;
+
+	b2Timer timer;
 
-	// Build and simulate all awake islands.
 	int32 stackSize = m_bodyCount;
 	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
-	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
+	// Bodies woken by the search are appended to the awake list as it goes.
+	for (int32 seedIndex = 0; seedIndex < m_awakeBodyCount; ++seedIndex)
 	{
+		b2Body* seed = m_awakeBodies[seedIndex];
 		if (seed->m_flags & b2Body::e_islandFlag)
 		{
 			continue;
@@ -383,8 +637,11 @@ void b2World::Solve(const b2TimeStep& step)
 			continue;
 		}
 
-		// Reset island and stack.
-		island.Clear();
+		b2IslandRange* range = islands + islandCount++;
+		range->bodyStart = bodyCount;
+		range->contactStart = contactCount;
+		range->jointStart = jointCount;
+
 		int32 stackCount = 0;
 		stack[stackCount++] = seed;
 		seed->m_flags |= b2Body::e_islandFlag;
@@ -395,7 +652,8 @@ void b2World::Solve(const b2TimeStep& step)
 			// Grab the next body off the stack and add it to the island.
 			b2Body* b = stack[--stackCount];
 			b2Assert(b->IsActive() == true);
-			island.Add(b);
+			b2Assert(bodyCount < bodyCapacity);
+			bodies[bodyCount++] = b;
 
 			// Make sure the body is awake.
 			b->SetAwake(true);
@@ -433,7 +691,7 @@ void b2World::Solve(const b2TimeStep& step)
 					continue;
 				}
 
-				island.Add(contact);
+				contacts[contactCount++] = contact;
 				contact->m_flags |= b2Contact::e_islandFlag;
 
 				b2Body* other = ce->other;
@@ -465,7 +723,7 @@ void b2World::Solve(const b2TimeStep& step)
 					continue;
 				}
 
-				island.Add(je->joint);
+				joints[jointCount++] = je->joint;
 				je->joint->m_islandFlag = true;
 
 				if (other->m_flags & b2Body::e_islandFlag)
@@ -479,13 +737,14 @@ void b2World::Solve(const b2TimeStep& step)
 			}
 		}
 
-		island.Solve(step, m_gravity, m_allowSleep);
+		range->bodyCount = bodyCount - range->bodyStart;
+		range->contactCount = contactCount - range->contactStart;
+		range->jointCount = jointCount - range->jointStart;
 
-		// Post solve cleanup.
-		for (int32 i = 0; i < island.m_bodyCount; ++i)
+		// Allow static bodies to participate in other islands.
+		for (int32 i = range->bodyStart; i < bodyCount; ++i)
 		{
-			// Allow static bodies to participate in other islands.
-			b2Body* b = island.m_bodies[i];
+			b2Body* b = bodies[i];
 			if (b->GetType() == b2_staticBody)
 			{
 				b->m_flags &= ~b2Body::e_islandFlag;
@@ -495,157 +754,498 @@ void b2World::Solve(const b2TimeStep& step)
 
 	m_stackAllocator.Free(stack);
 
-	// Synchronize fixtures, check for out of range bodies.
-	for (b2Body* b = m_bodyList; b; b = b->GetNext())
+	m_profile.buildIslands += timer.GetMilliseconds();
+	m_profile.islandCount += islandCount;
+
+	b2ContactImpulse* impulses = NULL;
+	if (listener)
 	{
-		// If a body was not in an island then it did not move.
-		if ((b->m_flags & b2Body::e_islandFlag) == 0)
+		impulses = (b2ContactImpulse*)m_stackAllocator.Allocate(contactCount * sizeof(b2ContactImpulse));
+	}
+
+	int32 threadCount = m_threadStackAllocatorCount;
+	b2Profile* profiles = (b2Profile*)m_stackAllocator.Allocate(threadCount * sizeof(b2Profile));
+	memset(profiles, 0, threadCount * sizeof(b2Profile));
+
+	b2IslandSolveContext context;
+	context.step = &step;
+	context.gravity = m_gravity;
+	context.allowSleep = m_allowSleep;
+	context.islands = islands;
+	context.bodies = bodies;
+	context.contacts = contacts;
+	context.joints = joints;
+	context.listener = listener;
+	context.impulses = impulses;
+	context.allocators = m_threadStackAllocators;
+	context.profiles = profiles;
+
+	m_threadPool->ParallelFor(islandCount, 1, SolveIslandsTask, &context);
+
+	for (int32 i = 0; i < threadCount; ++i)
+	{
+		m_profile.solveInit += profiles[i].solveInit;
+		m_profile.solveVelocity += profiles[i].solveVelocity;
+		m_profile.solvePosition += profiles[i].solvePosition;
+	}
+
+	m_stackAllocator.Free(profiles);
+
+	// Static bodies take the awake state of the last island they are in, as
+	// they would when solving the islands one after the other. The seed of an
+	// island is never static.
+	for (int32 i = 0; i < islandCount; ++i)
+	{
+		const b2IslandRange* range = islands + i;
+		bool awake = bodies[range->bodyStart]->IsAwake();
+
+		for (int32 j = range->bodyStart; j < range->bodyStart + range->bodyCount; ++j)
 		{
-			continue;
+			b2Body* b = bodies[j];
+			if (b->GetType() == b2_staticBody)
+			{
+				b->SetAwake(awake);
+			}
 		}
+	}
 
-		if (b->GetType() == b2_staticBody)
+	// See SolveIslands.
+	for (int32 i = 0; i < contactCount; ++i)
+	{
+		contacts[i]->m_flags &= ~b2Contact::e_islandFlag;
+	}
+	for (int32 i = 0; i < jointCount; ++i)
+	{
+		joints[i]->m_islandFlag = false;
+	}
+
+	// Report the impulses in the same order as when solving on a single thread.
+	if (impulses)
+	{
+		for (int32 i = 0; i < contactCount; ++i)
 		{
-			continue;
+			listener->PostSolve(contacts[i], impulses + i);
 		}
 
-		// Update fixtures (for broad-phase).
-		b->SynchronizeFixtures();
+		m_stackAllocator.Free(impulses);
 	}
 
-	// Look for new contacts.
-	m_contactManager.FindNewContacts();
+	m_stackAllocator.Free(islands);
+	m_stackAllocator.Free(joints);
+	m_stackAllocator.Free(contacts);
+	m_stackAllocator.Free(bodies);
 }
 
-// Find TOI contacts and solve them.
-void b2World::SolveTOI(const b2TimeStep& step)
+void b2World::SolveIslands(const b2TimeStep& step)
 {
-	b2Island island(2 * b2_maxTOIContacts, b2_maxTOIContacts, 0, &m_stackAllocator, m_contactManager.m_contactListener);
+	b2Timer timer;
+	float32 islandTime = 0.0f;
 
-	if (m_stepComplete)
+	// Size the island for the worst case.
+	b2Island island(m_bodyCount,
+					m_contactManager.m_contactCount,
+					m_jointCount,
+					&m_stackAllocator,
+					m_contactManager.m_contactListener);
+
+	// Build and simulate all awake islands.
+	int32 stackSize = m_bodyCount;
+	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
+	// Bodies woken by the search are appended to the awake list as it goes.
+	for (int32 seedIndex = 0; seedIndex < m_awakeBodyCount; ++seedIndex)
 	{
-		for (b2Body* b = m_bodyList; b; b = b->m_next)
+		b2Body* seed = m_awakeBodies[seedIndex];
+		if (seed->m_flags & b2Body::e_islandFlag)
 		{
-			b->m_flags &= ~b2Body::e_islandFlag;
-			b->m_sweep.alpha0 = 0.0f;
+			continue;
 		}
 
-		for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+		if (seed->IsAwake() == false || seed->IsActive() == false)
 		{
-			// Invalidate TOI
-			c->m_flags &= ~(b2Contact::e_toiFlag | b2Contact::e_islandFlag);
+			continue;
 		}
-	}
 
-	// Find TOI events and solve them.
-	for (int32 contactStep = 0; contactStep < 10; ++contactStep)
-	//for (;;)
-	{
-		// Find the first TOI.
-		b2Contact* minContact = NULL;
-		float32 minAlpha = 1.0f;
+		// The seed can be dynamic or kinematic.
+		if (seed->GetType() == b2_staticBody)
+		{
+			continue;
+		}
 
-		for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+		// Reset island and stack.
+		island.Clear();
+		int32 stackCount = 0;
+		stack[stackCount++] = seed;
+		seed->m_flags |= b2Body::e_islandFlag;
+
+		// Perform a depth first search (DFS) on the constraint graph.
+		while (stackCount > 0)
 		{
-			// Is this contact disabled?
-			if (c->IsEnabled() == false)
+			// Grab the next body off the stack and add it to the island.
+			b2Body* b = stack[--stackCount];
+			b2Assert(b->IsActive() == true);
+			island.Add(b);
+
+			// Make sure the body is awake.
+			b->SetAwake(true);
+
+			// To keep islands as small as possible, we don't
+			// propagate islands across static bodies.
+			if (b->GetType() == b2_staticBody)
 			{
 				continue;
 			}
 
-			float32 alpha = 1.0f;
-			if (c->m_flags & b2Contact::e_toiFlag)
-			{
-				// This contact has a valid cached TOI.
-				alpha = c->m_toi;
-			}
-			else
+			// Search all contacts connected to this body.
+			for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
 			{
-				b2Fixture* fA = c->GetFixtureA();
-				b2Fixture* fB = c->GetFixtureB();
+				b2Contact* contact = ce->contact;
 
-				// Is there a sensor?
-				if (fA->IsSensor() || fB->IsSensor())
+				// Has this contact already been added to an island?
+				if (contact->m_flags & b2Contact::e_islandFlag)
 				{
 					continue;
 				}
 
-				b2Body* bA = fA->GetBody();
-				b2Body* bB = fB->GetBody();
-
-				b2BodyType typeA = bA->GetType();
-				b2BodyType typeB = bB->GetType();
-				b2Assert(typeA == b2_dynamicBody || typeB == b2_dynamicBody);
-
-				bool awakeA = bA->IsAwake() && typeA != b2_staticBody;
-				bool awakeB = bB->IsAwake() && typeB != b2_staticBody;
-
-				// Is at least one body awake?
-				if (awakeA == false && awakeB == false)
+				// Is this contact solid and touching?
+				if (contact->IsEnabled() == false ||
+					contact->IsTouching() == false)
 				{
 					continue;
 				}
 
-				bool collideA = bA->IsBullet() || typeA != b2_dynamicBody;
-				bool collideB = bB->IsBullet() || typeB != b2_dynamicBody;
-
-				// Are these two non-bullet dynamic bodies?
-				if (collideA == false && collideB == false)
+				// Skip sensors.
+				bool sensorA = contact->m_fixtureA->m_isSensor;
+				bool sensorB = contact->m_fixtureB->m_isSensor;
+				if (sensorA || sensorB)
 				{
 					continue;
 				}
 
-				// Compute the TOI for this contact.
-				// Put the sweeps onto the same time interval.
-				float32 alpha0 = bA->m_sweep.alpha0;
-
-				if (bA->m_sweep.alpha0 < bB->m_sweep.alpha0)
-				{
-					alpha0 = bB->m_sweep.alpha0;
-					bA->m_sweep.Advance(alpha0);
-				}
-				else if (bB->m_sweep.alpha0 < bA->m_sweep.alpha0)
-				{
-					alpha0 = bA->m_sweep.alpha0;
-					bB->m_sweep.Advance(alpha0);
-				}
-
-				b2Assert(alpha0 < 1.0f);
-
-				int32 indexA = c->GetChildIndexA();
-				int32 indexB = c->GetChildIndexB();
-
-				// Compute the time of impact in interval [0, minTOI]
-				b2TOIInput input;
-				input.proxyA.Set(fA->GetShape(), indexA);
-				input.proxyB.Set(fB->GetShape(), indexB);
-				input.sweepA = bA->m_sweep;
-				input.sweepB = bB->m_sweep;
-				input.tMax = 1.0f;
+				island.Add(contact);
+				contact->m_flags |= b2Contact::e_islandFlag;
 
-				b2TOIOutput output;
-				b2TimeOfImpact(&output, &input);
+				b2Body* other = ce->other;
 
-				// Beta is the fraction of the remaining portion of the .
-				float32 beta = output.t;
-				if (output.state == b2TOIOutput::e_touching)
-				{
-					alpha = b2Min(alpha0 + (1.0f - alpha0) * beta, 1.0f);
-				}
-				else
+				// Was the other body already added to this island?
+				if (other->m_flags & b2Body::e_islandFlag)
 				{
-					alpha = 1.0f;
+					continue;
 				}
 
-				c->m_toi = alpha;
-				c->m_flags |= b2Contact::e_toiFlag;
+				b2Assert(stackCount < stackSize);
+				stack[stackCount++] = other;
+				other->m_flags |= b2Body::e_islandFlag;
 			}
 
-			if (alpha < minAlpha)
+			// Search all joints connect to this body.
+			for (b2JointEdge* je = b->m_jointList; je; je = je->next)
+			{
+				if (je->joint->m_islandFlag == true)
+				{
+					continue;
+				}
+
+				b2Body* other = je->other;
+
+				// Don't simulate joints connected to inactive bodies.
+				if (other->IsActive() == false)
+				{
+					continue;
+				}
+
+				island.Add(je->joint);
+				je->joint->m_islandFlag = true;
+
+				if (other->m_flags & b2Body::e_islandFlag)
+				{
+					continue;
+				}
+
+				b2Assert(stackCount < stackSize);
+				stack[stackCount++] = other;
+				other->m_flags |= b2Body::e_islandFlag;
+			}
+		}
+
+		b2Timer islandTimer;
+		island.Solve(&m_profile, step, m_gravity, m_allowSleep);
+		islandTime += islandTimer.GetMilliseconds();
+		++m_profile.islandCount;
+
+		// Post solve cleanup.
+		for (int32 i = 0; i < island.m_bodyCount; ++i)
+		{
+			// Allow static bodies to participate in other islands.
+			b2Body* b = island.m_bodies[i];
+			if (b->GetType() == b2_staticBody)
+			{
+				b->m_flags &= ~b2Body::e_islandFlag;
+			}
+		}
+
+		// No other island can reach these, so the flags are cleared here rather
+		// than for every contact and joint before the next step.
+		for (int32 i = 0; i < island.m_contactCount; ++i)
+		{
+			island.m_contacts[i]->m_flags &= ~b2Contact::e_islandFlag;
+		}
+		for (int32 i = 0; i < island.m_jointCount; ++i)
+		{
+			island.m_joints[i]->m_islandFlag = false;
+		}
+	}
+
+	m_stackAllocator.Free(stack);
+
+	// The search is interleaved with solving the islands.
+	m_profile.buildIslands += timer.GetMilliseconds() - islandTime;
+}
+
+void b2World::Solve(const b2TimeStep& step)
+{
+	// The island flags were all cleared by the last step, see below and
+	// SolveTOI. That way sleeping bodies and their contacts are never visited.
+	if (m_threadStackAllocatorCount > 1)
+	{
+		SolveIslandsParallel(step);
+	}
+	else
+	{
+		SolveIslands(step);
+	}
+
+	// Synchronize fixtures, check for out of range bodies. Every body that was
+	// in an island is in the awake list, including the ones that just fell asleep.
+	b2Timer timer;
+	for (int32 i = 0; i < m_awakeBodyCount; ++i)
+	{
+		b2Body* b = m_awakeBodies[i];
+
+		// If a body was not in an island then it did not move.
+		if ((b->m_flags & b2Body::e_islandFlag) == 0)
+		{
+			continue;
+		}
+
+		b->m_flags &= ~b2Body::e_islandFlag;
+
+		if (b->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+
+		// Update fixtures (for broad-phase).
+		b->SynchronizeFixtures();
+	}
+
+	m_profile.synchronizeFixtures += timer.GetMilliseconds();
+
+	CompactAwakeBodies();
+
+	// Look for new contacts.
+	m_contactManager.FindNewContacts();
+}
+
+// The candidate contacts of a SolveTOI pass are split into ranges of this
+// size for the thread pool.
+const int32 b2_toiRangeSize = 8;
+
+// Is this body too slow to need continuous collision? Static bodies don't move.
+inline bool b2IsSlowForTOI(const b2Body* body)
+{
+	if (body->GetType() == b2_staticBody)
+	{
+		return true;
+	}
+
+	float32 speed = body->GetContinuousSpeed();
+	b2Vec2 v = body->GetLinearVelocity();
+	return speed > 0.0f && b2Dot(v, v) < speed * speed;
+}
+
+// Compute the TOIs of the candidate contacts that don't have a cached one.
+// The bodies are shared between contacts, so they are only read from.
+void b2World::ComputeTOITask(void* userData, int32 begin, int32 end, int32 threadIndex)
+{
+	B2_NOT_USED(threadIndex);
+
+	b2Contact** contacts = (b2Contact**)userData;
+
+	for (int32 i = begin; i < end; ++i)
+	{
+		b2Contact* c = contacts[i];
+		if (c->m_flags & b2Contact::e_toiFlag)
+		{
+			continue;
+		}
+
+		b2Fixture* fA = c->GetFixtureA();
+		b2Fixture* fB = c->GetFixtureB();
+		b2Body* bA = fA->GetBody();
+		b2Body* bB = fB->GetBody();
+
+		// Put the sweeps onto the same time interval.
+		b2Sweep sweepA = bA->m_sweep;
+		b2Sweep sweepB = bB->m_sweep;
+		float32 alpha0 = sweepA.alpha0;
+
+		if (sweepA.alpha0 < sweepB.alpha0)
+		{
+			alpha0 = sweepB.alpha0;
+			sweepA.Advance(alpha0);
+		}
+		else if (sweepB.alpha0 < sweepA.alpha0)
+		{
+			alpha0 = sweepA.alpha0;
+			sweepB.Advance(alpha0);
+		}
+
+		b2Assert(alpha0 < 1.0f);
+
+		int32 indexA = c->GetChildIndexA();
+		int32 indexB = c->GetChildIndexB();
+
+		// Compute the time of impact in interval [0, minTOI]
+		b2TOIInput input;
+		input.proxyA.Set(fA->GetShape(), indexA);
+		input.proxyB.Set(fB->GetShape(), indexB);
+		input.sweepA = sweepA;
+		input.sweepB = sweepB;
+		input.tMax = 1.0f;
+
+		b2TOIOutput output;
+		b2TimeOfImpact(&output, &input);
+
+		// Beta is the fraction of the remaining portion of the .
+		float32 beta = output.t;
+		float32 alpha;
+		if (output.state == b2TOIOutput::e_touching)
+		{
+			alpha = b2Min(alpha0 + (1.0f - alpha0) * beta, 1.0f);
+		}
+		else
+		{
+			alpha = 1.0f;
+		}
+
+		c->m_toi = alpha;
+		c->m_flags |= b2Contact::e_toiFlag;
+	}
+}
+
+// Find TOI contacts and solve them.
+void b2World::SolveTOI(const b2TimeStep& step)
+{
+	b2Island island(2 * b2_maxTOIContacts, b2_maxTOIContacts, 0, &m_stackAllocator, m_contactManager.m_contactListener);
+
+	// The contacts that can have a TOI event in a pass, in contact list order.
+	int32 candidateCapacity = m_contactManager.m_contactCount;
+	b2Contact** candidates = (b2Contact**)m_stackAllocator.Allocate(candidateCapacity * sizeof(b2Contact*));
+
+	// The sweeps and cached TOIs were reset when the last step completed, see below.
+
+	// Find TOI events and solve them.
+	for (;;)
+	{
+		// New contacts are found after each event.
+		if (m_contactManager.m_contactCount > candidateCapacity)
+		{
+			m_stackAllocator.Free(candidates);
+			candidateCapacity = m_contactManager.m_contactCount;
+			candidates = (b2Contact**)m_stackAllocator.Allocate(candidateCapacity * sizeof(b2Contact*));
+		}
+
+		// Gather the contacts with a cached TOI and the ones that need one.
+		int32 candidateCount = 0;
+		int32 toiCount = 0;
+
+		for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+		{
+			// Is this contact disabled?
+			if (c->IsEnabled() == false)
+			{
+				continue;
+			}
+
+			if ((c->m_flags & b2Contact::e_toiFlag) == 0)
+			{
+				b2Fixture* fA = c->GetFixtureA();
+				b2Fixture* fB = c->GetFixtureB();
+
+				// Is there a sensor?
+				if (fA->IsSensor() || fB->IsSensor())
+				{
+					continue;
+				}
+
+				b2Body* bA = fA->GetBody();
+				b2Body* bB = fB->GetBody();
+
+				b2BodyType typeA = bA->GetType();
+				b2BodyType typeB = bB->GetType();
+				b2Assert(typeA == b2_dynamicBody || typeB == b2_dynamicBody);
+
+				bool awakeA = bA->IsAwake() && typeA != b2_staticBody;
+				bool awakeB = bB->IsAwake() && typeB != b2_staticBody;
+
+				// Is at least one body awake?
+				if (awakeA == false && awakeB == false)
+				{
+					continue;
+				}
+
+				bool collideA = bA->IsBullet() || typeA != b2_dynamicBody;
+				bool collideB = bB->IsBullet() || typeB != b2_dynamicBody;
+
+				// Are these two non-bullet dynamic bodies?
+				if (collideA == false && collideB == false)
+				{
+					continue;
+				}
+
+				// Has either body opted out of continuous collision?
+				if (bA->IsContinuous() == false || bB->IsContinuous() == false)
+				{
+					continue;
+				}
+
+				// Is neither body fast enough to need it?
+				if (b2IsSlowForTOI(bA) && b2IsSlowForTOI(bB))
+				{
+					continue;
+				}
+
+				++toiCount;
+			}
+
+			candidates[candidateCount++] = c;
+		}
+
+		// Compute the missing TOIs. This is where the time goes, so they are
+		// spread across the thread pool if there are enough.
+		if (m_threadPool && toiCount > b2_toiRangeSize)
+		{
+			m_threadPool->ParallelFor(candidateCount, b2_toiRangeSize, ComputeTOITask, candidates);
+		}
+		else if (toiCount > 0)
+		{
+			ComputeTOITask(candidates, 0, candidateCount, 0);
+		}
+
+		m_toiStats.toiCount += toiCount;
+
+		// Find the first TOI.
+		b2Contact* minContact = NULL;
+		float32 minAlpha = 1.0f;
+
+		for (int32 i = 0; i < candidateCount; ++i)
+		{
+			b2Contact* c = candidates[i];
+			if (c->m_toi < minAlpha)
 			{
 				// This is the minimum TOI found so far.
 				minContact = c;
-				minAlpha = alpha;
+				minAlpha = c->m_toi;
 			}
 		}
 
@@ -656,6 +1256,16 @@ void b2World::SolveTOI(const b2TimeStep& step)
 			break;
 		}
 
+		if (m_toiStats.eventCount == m_maxTOIEvents)
+		{
+			// Out of events for this step, drop the rest.
+			m_toiStats.capped = true;
+			m_stepComplete = true;
+			break;
+		}
+
+		++m_toiStats.eventCount;
+
 		// Advance the bodies to the TOI.
 		b2Fixture* fA = minContact->GetFixtureA();
 		b2Fixture* fB = minContact->GetFixtureB();
@@ -722,6 +1332,12 @@ void b2World::SolveTOI(const b2TimeStep& step)
 						continue;
 					}
 
+					// Skip bodies that opted out of continuous collision.
+					if (other->IsContinuous() == false)
+					{
+						continue;
+					}
+
 					// Skip sensors.
 					bool sensorA = contact->m_fixtureA->m_isSensor;
 					bool sensorB = contact->m_fixtureB->m_isSensor;
@@ -786,7 +1402,9 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		subStep.positionIterations = 20;
 		subStep.velocityIterations = step.velocityIterations;
 		subStep.warmStarting = false;
+		subStep.simdContactSolver = false;
 		island.SolveTOI(subStep, bA, bB);
+		++m_toiStats.subStepCount;
 
 		// Reset island flags and synchronize broad-phase proxies.
 		for (int32 i = 0; i < island.m_bodyCount; ++i)
@@ -818,10 +1436,37 @@ void b2World::SolveTOI(const b2TimeStep& step)
 			break;
 		}
 	}
+
+	m_stackAllocator.Free(candidates);
+
+	if (m_stepComplete)
+	{
+		// Reset the sweeps and invalidate the TOIs for the next step. Only awake
+		// bodies and the bodies touching them can have been advanced, and only
+		// their contacts can have a TOI. No body is put to sleep in here, so they
+		// are all still in the awake list.
+		for (int32 i = 0; i < m_awakeBodyCount; ++i)
+		{
+			b2Body* b = m_awakeBodies[i];
+			b->m_sweep.alpha0 = 0.0f;
+
+			for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
+			{
+				ce->other->m_sweep.alpha0 = 0.0f;
+				ce->contact->m_flags &= ~(b2Contact::e_toiFlag | b2Contact::e_islandFlag);
+			}
+		}
+	}
 }
 
 void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIterations)
 {
+	b2Timer stepTimer;
+
+	memset(&m_profile, 0, sizeof(b2Profile));
+	m_contactManager.m_findNewContactsTime = 0.0f;
+	m_contactManager.m_pairCount = 0;
+
 	// If new fixtures were added, we need to find the new contacts.
 	if (m_flags & e_newFixture)
 	{
@@ -831,6 +1476,13 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 
 	m_flags |= e_locked;
 
+	// Size the stack allocators for this step from the last one.
+	m_stackAllocator.Reset();
+	for (int32 i = 0; i < m_threadStackAllocatorCount; ++i)
+	{
+		m_threadStackAllocators[i].Reset();
+	}
+
 	b2TimeStep step;
 	step.dt = dt;
 	step.velocityIterations	= velocityIterations;
@@ -846,21 +1498,38 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 
 	step.dtRatio = m_inv_dt0 * dt;
 
+	step.linearSleepTolerance = m_linearSleepTolerance;
+	step.angularSleepTolerance = m_angularSleepTolerance;
+	step.timeToSleep = m_timeToSleep;
 	step.warmStarting = m_warmStarting;
+	step.simdContactSolver = m_simdContactSolver;
+
+	m_toiStats.toiCount = 0;
+	m_toiStats.eventCount = 0;
+	m_toiStats.subStepCount = 0;
+	m_toiStats.capped = false;
 
 	// Update contacts. This is where some contacts are destroyed.
-	m_contactManager.Collide();
+	{
+		b2Timer timer;
+		m_contactManager.Collide();
+		m_profile.collide = timer.GetMilliseconds();
+	}
 
 	// Integrate velocities, solve velocity constraints, and integrate positions.
 	if (m_stepComplete && step.dt > 0.0f)
 	{
+		b2Timer timer;
 		Solve(step);
+		m_profile.solve = timer.GetMilliseconds();
 	}
 
 	// Handle TOI events.
 	if (m_continuousPhysics && step.dt > 0.0f)
 	{
+		b2Timer timer;
 		SolveTOI(step);
+		m_profile.solveTOI = timer.GetMilliseconds();
 	}
 
 	if (step.dt > 0.0f)
@@ -874,12 +1543,28 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 	}
 
 	m_flags &= ~e_locked;
+
+	m_profile.findNewContacts = m_contactManager.m_findNewContactsTime;
+	m_profile.pairCount = m_contactManager.m_pairCount;
+	m_profile.contactCount = m_contactManager.m_contactCount;
+	m_profile.awakeBodyCount = m_awakeBodyCount;
+
+	m_profile.stackPeakBytes = m_stackAllocator.GetStepMaxAllocation();
+	for (int32 i = 0; i < m_threadStackAllocatorCount; ++i)
+	{
+		m_profile.stackPeakBytes = b2Max(m_profile.stackPeakBytes, m_threadStackAllocators[i].GetStepMaxAllocation());
+	}
+	m_profile.blockPeakBytes = m_blockAllocator.GetMaxAllocatedBytes();
+
+	m_profile.step = stepTimer.GetMilliseconds();
 }
 
 void b2World::ClearForces()
 {
-	for (b2Body* body = m_bodyList; body; body = body->GetNext())
+	// Forces are only applied to awake bodies, and zeroed when they fall asleep.
+	for (int32 i = 0; i < m_awakeBodyCount; ++i)
 	{
+		b2Body* body = m_awakeBodies[i];
 		body->m_force.SetZero();
 		body->m_torque = 0.0f;
 	}
@@ -942,24 +1627,194 @@ void b2World::RayCast(b2RayCastCallback* callback, const b2Vec2& point1, const b
 	m_contactManager.m_broadPhase.RayCast(&wrapper, input);
 }
 
-void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color& color)
+struct b2WorldBatchContext
 {
-	switch (fixture->GetType())
-	{
-	case b2Shape::e_circle:
-		{
-			b2CircleShape* circle = (b2CircleShape*)fixture->GetShape();
+	const b2World* world;
+	void* batch;
+};
 
-			b2Vec2 center = b2Mul(xf, circle->m_p);
-			float32 radius = circle->m_radius;
-			b2Vec2 axis = xf.R.col1;
+// Boxes and rays per task.
+const int32 b2_queryBatchRangeSize = 8;
 
-			m_debugDraw->DrawSolidCircle(center, radius, axis, color);
-		}
-		break;
+struct b2WorldBatchQueryWrapper
+{
+	bool QueryCallback(int32 proxyId)
+	{
+		b2FixtureProxy* proxy = (b2FixtureProxy*)broadPhase->GetUserData(proxyId);
+		fixtures[count++] = proxy->fixture;
+		return count < maxCount;
+	}
 
-	case b2Shape::e_edge:
-		{
+	const b2BroadPhase* broadPhase;
+	b2Fixture** fixtures;
+	int32 count;
+	int32 maxCount;
+};
+
+void b2World::QueryAABBBatchTask(void* userData, int32 begin, int32 end, int32 threadIndex)
+{
+	B2_NOT_USED(threadIndex);
+
+	b2WorldBatchContext* context = (b2WorldBatchContext*)userData;
+	b2AABBQueryBatch* batch = (b2AABBQueryBatch*)context->batch;
+
+	b2WorldBatchQueryWrapper wrapper;
+	wrapper.broadPhase = &context->world->m_contactManager.m_broadPhase;
+	wrapper.maxCount = batch->maxFixtures;
+
+	for (int32 i = begin; i < end; ++i)
+	{
+		wrapper.fixtures = batch->fixtures + i * batch->maxFixtures;
+		wrapper.count = 0;
+		wrapper.broadPhase->Query(&wrapper, batch->aabbs[i]);
+		batch->fixtureCounts[i] = wrapper.count;
+	}
+}
+
+void b2World::QueryAABBBatch(b2AABBQueryBatch* batch) const
+{
+	b2Assert(batch->maxFixtures > 0);
+
+	b2WorldBatchContext context;
+	context.world = this;
+	context.batch = batch;
+
+	if (m_threadPool)
+	{
+		m_threadPool->ParallelFor(batch->aabbCount, b2_queryBatchRangeSize, QueryAABBBatchTask, &context);
+	}
+	else
+	{
+		QueryAABBBatchTask(&context, 0, batch->aabbCount, 0);
+	}
+}
+
+struct b2WorldBatchRayCastWrapper
+{
+	float32 RayCastCallback(const b2RayCastInput& input, int32 proxyId)
+	{
+		return RayCastCallback(input, proxyId, 0);
+	}
+
+	float32 RayCastCallback(const b2RayCastInput& input, int32 proxyId, int32 rayIndex)
+	{
+		void* userData = broadPhase->GetUserData(proxyId);
+		b2FixtureProxy* proxy = (b2FixtureProxy*)userData;
+		b2Fixture* fixture = proxy->fixture;
+		int32 index = proxy->childIndex;
+		b2RayCastOutput output;
+		bool hit = fixture->RayCast(&output, input, index);
+
+		if (hit == false)
+		{
+			return input.maxFraction;
+		}
+
+		// Insert the hit, keeping the closest ones sorted by fraction. The
+		// ray is clipped to the farthest hit once the list is full.
+		int32 maxHits = batch->maxHits;
+		b2RayCastHit* hits = batch->hits + (firstRay + rayIndex) * maxHits;
+		int32* count = batch->hitCounts + firstRay + rayIndex;
+
+		int32 i = b2Min(*count, maxHits - 1);
+		while (i > 0 && hits[i - 1].fraction > output.fraction)
+		{
+			hits[i] = hits[i - 1];
+			--i;
+		}
+
+		hits[i].fixture = fixture;
+		hits[i].point = (1.0f - output.fraction) * input.p1 + output.fraction * input.p2;
+		hits[i].normal = output.normal;
+		hits[i].fraction = output.fraction;
+		*count = b2Min(*count + 1, maxHits);
+
+		if (*count == maxHits)
+		{
+			return hits[maxHits - 1].fraction;
+		}
+
+		return input.maxFraction;
+	}
+
+	const b2BroadPhase* broadPhase;
+	b2RayCastBatch* batch;
+	int32 firstRay;
+};
+
+void b2World::RayCastBatchTask(void* userData, int32 begin, int32 end, int32 threadIndex)
+{
+	B2_NOT_USED(threadIndex);
+
+	b2WorldBatchContext* context = (b2WorldBatchContext*)userData;
+	b2RayCastBatch* batch = (b2RayCastBatch*)context->batch;
+
+	b2WorldBatchRayCastWrapper wrapper;
+	wrapper.broadPhase = &context->world->m_contactManager.m_broadPhase;
+	wrapper.batch = batch;
+
+	int32 step = batch->usePackets ? b2_rayPacketSize : 1;
+	for (int32 i = begin; i < end; i += step)
+	{
+		int32 count = b2Min(step, end - i);
+
+		b2RayCastInput inputs[b2_rayPacketSize];
+		for (int32 j = 0; j < count; ++j)
+		{
+			inputs[j].p1 = batch->points1[i + j];
+			inputs[j].p2 = batch->points2[i + j];
+			inputs[j].maxFraction = 1.0f;
+			batch->hitCounts[i + j] = 0;
+		}
+
+		wrapper.firstRay = i;
+		if (batch->usePackets)
+		{
+			wrapper.broadPhase->RayCastPacket(&wrapper, inputs, count);
+		}
+		else
+		{
+			wrapper.broadPhase->RayCast(&wrapper, inputs[0]);
+		}
+	}
+}
+
+void b2World::RayCastBatch(b2RayCastBatch* batch) const
+{
+	b2Assert(batch->maxHits > 0);
+
+	b2WorldBatchContext context;
+	context.world = this;
+	context.batch = batch;
+
+	if (m_threadPool)
+	{
+		m_threadPool->ParallelFor(batch->rayCount, b2_queryBatchRangeSize, RayCastBatchTask, &context);
+	}
+	else
+	{
+		RayCastBatchTask(&context, 0, batch->rayCount, 0);
+	}
+}
+
+void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color& color)
+{
+	switch (fixture->GetType())
+	{
+	case b2Shape::e_circle:
+		{
+			b2CircleShape* circle = (b2CircleShape*)fixture->GetShape();
+
+			b2Vec2 center = b2Mul(xf, circle->m_p);
+			float32 radius = circle->m_radius;
+			b2Vec2 axis = xf.R.col1;
+
+			m_debugDraw->DrawSolidCircle(center, radius, axis, color);
+		}
+		break;
+
+	case b2Shape::e_edge:
+		{
 			b2EdgeShape* edge = (b2EdgeShape*)fixture->GetShape();
 			b2Vec2 v1 = b2Mul(xf, edge->m_vertex1);
 			b2Vec2 v2 = b2Mul(xf, edge->m_vertex2);
@@ -1149,7 +2004,554 @@ void b2World::DrawDebugData()
 	}
 }
 
+void b2World::GetMemoryStats(b2WorldMemoryStats* stats) const
+{
+	stats->stackCapacity = m_stackAllocator.GetCapacity();
+	stats->stackPeakBytes = m_stackAllocator.GetMaxAllocation();
+	stats->stackFallbackCount = m_stackAllocator.GetFallbackCount();
+	stats->stackFallbackBytes = m_stackAllocator.GetFallbackBytes();
+
+	for (int32 i = 0; i < m_threadStackAllocatorCount; ++i)
+	{
+		const b2StackAllocator* allocator = m_threadStackAllocators + i;
+		stats->stackCapacity += allocator->GetCapacity();
+		stats->stackPeakBytes = b2Max(stats->stackPeakBytes, allocator->GetMaxAllocation());
+		stats->stackFallbackCount += allocator->GetFallbackCount();
+		stats->stackFallbackBytes += allocator->GetFallbackBytes();
+	}
+
+	stats->blockBytes = m_blockAllocator.GetAllocatedBytes();
+	stats->blockPeakBytes = m_blockAllocator.GetMaxAllocatedBytes();
+	stats->chunkBytes = m_blockAllocator.GetChunkBytes();
+	stats->chunkPeakBytes = m_blockAllocator.GetMaxChunkBytes();
+}
+
+void b2World::TrimMemory()
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	m_blockAllocator.Trim();
+	m_stackAllocator.Trim();
+	for (int32 i = 0; i < m_threadStackAllocatorCount; ++i)
+	{
+		m_threadStackAllocators[i].Trim();
+	}
+}
+
+// The first bytes of every snapshot, followed by the format version.
+const int32 b2_snapshotMagic = 0x62325353;
+const int32 b2_snapshotVersion = 3;
+
+// Maps a body or fixture to its position in the world lists, so snapshots can
+// refer to them without pointers.
+struct b2SnapshotIndex
+{
+	const void* pointer;
+	int32 index;
+};
+
+inline bool b2SnapshotIndexLessThan(const b2SnapshotIndex& index1, const b2SnapshotIndex& index2)
+{
+	return index1.pointer < index2.pointer;
+}
+
+static int32 b2FindSnapshotIndex(const b2SnapshotIndex* indices, int32 count, const void* pointer)
+{
+	int32 low = 0;
+	int32 high = count - 1;
+	while (low <= high)
+	{
+		int32 mid = (low + high) >> 1;
+		if (indices[mid].pointer < pointer)
+		{
+			low = mid + 1;
+		}
+		else if (indices[mid].pointer > pointer)
+		{
+			high = mid - 1;
+		}
+		else
+		{
+			return indices[mid].index;
+		}
+	}
+
+	b2Assert(false);
+	return -1;
+}
+
+// Only the points in use are written, field by field, so stale points and
+// padding don't make equal states compare different.
+static void b2WriteManifold(b2Snapshot* snapshot, const b2Manifold& manifold)
+{
+	snapshot->Write(manifold.pointCount);
+	if (manifold.pointCount == 0)
+	{
+		return;
+	}
+
+	snapshot->Write(manifold.type);
+	snapshot->Write(manifold.localNormal);
+	snapshot->Write(manifold.localPoint);
+	for (int32 i = 0; i < manifold.pointCount; ++i)
+	{
+		const b2ManifoldPoint* point = manifold.points + i;
+		snapshot->Write(point->localPoint);
+		snapshot->Write(point->normalImpulse);
+		snapshot->Write(point->tangentImpulse);
+		snapshot->Write(point->id.key);
+	}
+}
+
+static void b2ReadManifold(b2SnapshotReader* reader, b2Manifold* manifold)
+{
+	reader->Read(&manifold->pointCount);
+	if (manifold->pointCount <= 0 || manifold->pointCount > b2_maxManifoldPoints)
+	{
+		manifold->pointCount = 0;
+		return;
+	}
+
+	reader->Read(&manifold->type);
+	reader->Read(&manifold->localNormal);
+	reader->Read(&manifold->localPoint);
+	for (int32 i = 0; i < manifold->pointCount; ++i)
+	{
+		b2ManifoldPoint* point = manifold->points + i;
+		reader->Read(&point->localPoint);
+		reader->Read(&point->normalImpulse);
+		reader->Read(&point->tangentImpulse);
+		reader->Read(&point->id.key);
+	}
+}
+
+void b2World::SaveSnapshot(b2Snapshot* snapshot) const
+{
+	snapshot->Clear();
+	snapshot->Write(b2_snapshotMagic);
+	snapshot->Write(b2_snapshotVersion);
+
+	// Patched with the total size at the end.
+	snapshot->Write(int32(0));
+
+	// The structure of the world, checked by RestoreSnapshot before it changes anything.
+	snapshot->Write(m_bodyCount);
+	snapshot->Write(m_jointCount);
+
+	int32 fixtureCount = 0;
+	for (const b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		snapshot->Write(b->m_fixtureCount);
+		for (const b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			snapshot->Write(int32(f->GetType()));
+			snapshot->Write(f->m_shape->GetChildCount());
+		}
+		fixtureCount += b->m_fixtureCount;
+	}
+
+	int32 bodyIndicesSize = b2Max(m_bodyCount, 1) * sizeof(b2SnapshotIndex);
+	int32 fixtureIndicesSize = b2Max(fixtureCount, 1) * sizeof(b2SnapshotIndex);
+	b2SnapshotIndex* bodyIndices = (b2SnapshotIndex*)AllocateMemory(bodyIndicesSize);
+	b2SnapshotIndex* fixtureIndices = (b2SnapshotIndex*)AllocateMemory(fixtureIndicesSize);
+	int32 bodyIndex = 0;
+	int32 fixtureIndex = 0;
+	for (const b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		bodyIndices[bodyIndex].pointer = b;
+		bodyIndices[bodyIndex].index = bodyIndex;
+		++bodyIndex;
+
+		for (const b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			fixtureIndices[fixtureIndex].pointer = f;
+			fixtureIndices[fixtureIndex].index = fixtureIndex;
+			++fixtureIndex;
+		}
+	}
+	std::sort(bodyIndices, bodyIndices + m_bodyCount, b2SnapshotIndexLessThan);
+	std::sort(fixtureIndices, fixtureIndices + fixtureCount, b2SnapshotIndexLessThan);
+
+	for (const b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		snapshot->Write(int32(j->m_type));
+		snapshot->Write(b2FindSnapshotIndex(bodyIndices, m_bodyCount, j->m_bodyA));
+		snapshot->Write(b2FindSnapshotIndex(bodyIndices, m_bodyCount, j->m_bodyB));
+	}
+
+	// World state.
+	snapshot->Write(int32(m_flags & ~e_locked));
+	snapshot->Write(m_gravity);
+	snapshot->Write(m_allowSleep);
+	snapshot->Write(m_linearSleepTolerance);
+	snapshot->Write(m_angularSleepTolerance);
+	snapshot->Write(m_timeToSleep);
+	snapshot->Write(m_inv_dt0);
+	snapshot->Write(m_warmStarting);
+	snapshot->Write(m_continuousPhysics);
+	snapshot->Write(m_simdContactSolver);
+	snapshot->Write(m_subStepping);
+	snapshot->Write(m_stepComplete);
+	snapshot->Write(m_maxTOIEvents);
+
+	for (const b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		snapshot->Write(b->m_type);
+		snapshot->Write(b->m_flags);
+		snapshot->Write(b->m_xf);
+		snapshot->Write(b->m_sweep);
+		snapshot->Write(b->m_linearVelocity);
+		snapshot->Write(b->m_angularVelocity);
+		snapshot->Write(b->m_force);
+		snapshot->Write(b->m_torque);
+		snapshot->Write(b->m_mass);
+		snapshot->Write(b->m_invMass);
+		snapshot->Write(b->m_I);
+		snapshot->Write(b->m_invI);
+		snapshot->Write(b->m_linearDamping);
+		snapshot->Write(b->m_angularDamping);
+		snapshot->Write(b->m_sleepTime);
+		snapshot->Write(b->m_continuousSpeed);
+
+		for (const b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			snapshot->Write(f->m_density);
+			snapshot->Write(f->m_friction);
+			snapshot->Write(f->m_restitution);
+			snapshot->Write(f->m_filter);
+			snapshot->Write(f->m_isSensor);
+			snapshot->Write(f->m_proxyCount);
+			for (int32 i = 0; i < f->m_proxyCount; ++i)
+			{
+				snapshot->Write(f->m_proxies[i].aabb);
+				snapshot->Write(f->m_proxies[i].proxyId);
+			}
+		}
+	}
+
+	// The islands are seeded in awake list order.
+	snapshot->Write(m_awakeBodyCount);
+	for (int32 i = 0; i < m_awakeBodyCount; ++i)
+	{
+		snapshot->Write(b2FindSnapshotIndex(bodyIndices, m_bodyCount, m_awakeBodies[i]));
+	}
+
+	for (const b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		j->WriteSnapshot(snapshot);
+	}
+
+	// Contacts are written oldest first, so creating them in that order on
+	// restore rebuilds the same world and body contact lists.
+	snapshot->Write(m_contactManager.m_contactCount);
+	const b2Contact* c = m_contactManager.m_contactList;
+	while (c && c->m_next)
+	{
+		c = c->m_next;
+	}
+	for (; c; c = c->m_prev)
+	{
+		snapshot->Write(b2FindSnapshotIndex(fixtureIndices, fixtureCount, c->m_fixtureA));
+		snapshot->Write(c->m_indexA);
+		snapshot->Write(b2FindSnapshotIndex(fixtureIndices, fixtureCount, c->m_fixtureB));
+		snapshot->Write(c->m_indexB);
+		snapshot->Write(c->m_flags);
+		b2WriteManifold(snapshot, c->m_manifold);
+		snapshot->Write(c->m_toiCount);
+		if (c->m_flags & b2Contact::e_toiFlag)
+		{
+			snapshot->Write(c->m_toi);
+		}
+	}
+
+	m_contactManager.m_broadPhase.WriteSnapshot(snapshot);
+
+	FreeMemory(fixtureIndices, fixtureIndicesSize);
+	FreeMemory(bodyIndices, bodyIndicesSize);
+
+	snapshot->Patch(2 * sizeof(int32), snapshot->GetSize());
+}
+
+bool b2World::RestoreSnapshot(const b2Snapshot& snapshot)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return false;
+	}
+
+	b2SnapshotReader reader(snapshot);
+	reader.Expect(b2_snapshotMagic);
+	reader.Expect(b2_snapshotVersion);
+	reader.Expect(snapshot.GetSize());
+	reader.Expect(m_bodyCount);
+	reader.Expect(m_jointCount);
+
+	int32 fixtureCount = 0;
+	for (b2Body* b = m_bodyList; b && reader.IsValid(); b = b->m_next)
+	{
+		reader.Expect(b->m_fixtureCount);
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			reader.Expect(int32(f->GetType()));
+			reader.Expect(f->m_shape->GetChildCount());
+		}
+		fixtureCount += b->m_fixtureCount;
+	}
+
+	if (reader.IsValid() == false)
+	{
+		return false;
+	}
+
+	int32 bodiesSize = b2Max(m_bodyCount, 1) * sizeof(b2Body*);
+	int32 fixturesSize = b2Max(fixtureCount, 1) * sizeof(b2Fixture*);
+	b2Body** bodies = (b2Body**)AllocateMemory(bodiesSize);
+	b2Fixture** fixtures = (b2Fixture**)AllocateMemory(fixturesSize);
+	int32 bodyIndex = 0;
+	int32 fixtureIndex = 0;
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		bodies[bodyIndex++] = b;
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			fixtures[fixtureIndex++] = f;
+		}
+	}
+
+	bool valid = true;
+	for (b2Joint* j = m_jointList; j && valid; j = j->m_next)
+	{
+		int32 indexA, indexB;
+		reader.Expect(int32(j->m_type));
+		reader.Read(&indexA);
+		reader.Read(&indexB);
+		valid = reader.IsValid() &&
+			0 <= indexA && indexA < m_bodyCount && bodies[indexA] == j->m_bodyA &&
+			0 <= indexB && indexB < m_bodyCount && bodies[indexB] == j->m_bodyB;
+	}
+
+	if (valid == false)
+	{
+		FreeMemory(fixtures, fixturesSize);
+		FreeMemory(bodies, bodiesSize);
+		return false;
+	}
+
+	// From here on the world is changed. Contacts are rebuilt from the snapshot,
+	// so the current ones are destroyed without calling the listener. This may
+	// wake bodies, but their state is read afterwards.
+	b2Contact* c = m_contactManager.m_contactList;
+	while (c)
+	{
+		b2Contact* next = c->m_next;
+		b2Contact::Destroy(c, &m_blockAllocator);
+		c = next;
+	}
+	m_contactManager.m_contactList = NULL;
+	m_contactManager.m_contactCount = 0;
+
+	int32 flags;
+	reader.Read(&flags);
+	m_flags = flags;
+	reader.Read(&m_gravity);
+	reader.Read(&m_allowSleep);
+	reader.Read(&m_linearSleepTolerance);
+	reader.Read(&m_angularSleepTolerance);
+	reader.Read(&m_timeToSleep);
+	reader.Read(&m_inv_dt0);
+	reader.Read(&m_warmStarting);
+	reader.Read(&m_continuousPhysics);
+	reader.Read(&m_simdContactSolver);
+	reader.Read(&m_subStepping);
+	reader.Read(&m_stepComplete);
+	reader.Read(&m_maxTOIEvents);
+
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		reader.Read(&b->m_type);
+		reader.Read(&b->m_flags);
+		reader.Read(&b->m_xf);
+		reader.Read(&b->m_sweep);
+		reader.Read(&b->m_linearVelocity);
+		reader.Read(&b->m_angularVelocity);
+		reader.Read(&b->m_force);
+		reader.Read(&b->m_torque);
+		reader.Read(&b->m_mass);
+		reader.Read(&b->m_invMass);
+		reader.Read(&b->m_I);
+		reader.Read(&b->m_invI);
+		reader.Read(&b->m_linearDamping);
+		reader.Read(&b->m_angularDamping);
+		reader.Read(&b->m_sleepTime);
+		reader.Read(&b->m_continuousSpeed);
+		b->m_contactList = NULL;
+
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			reader.Read(&f->m_density);
+			reader.Read(&f->m_friction);
+			reader.Read(&f->m_restitution);
+			reader.Read(&f->m_filter);
+			reader.Read(&f->m_isSensor);
+
+			// The proxy array always has room for every child, so bodies that were
+			// made active or inactive since the save are restored as well.
+			int32 proxyCount;
+			reader.Read(&proxyCount);
+			f->m_proxyCount = b2Clamp(proxyCount, 0, f->m_shape->GetChildCount());
+			for (int32 i = 0; i < f->m_proxyCount; ++i)
+			{
+				b2FixtureProxy* proxy = f->m_proxies + i;
+				reader.Read(&proxy->aabb);
+				reader.Read(&proxy->proxyId);
+				proxy->fixture = f;
+				proxy->childIndex = i;
+			}
+		}
+	}
+
+	for (int32 i = 0; i < m_awakeBodyCount; ++i)
+	{
+		m_awakeBodies[i]->m_awakeIndex = -1;
+	}
+	m_awakeBodyCount = 0;
+
+	int32 awakeBodyCount;
+	reader.Read(&awakeBodyCount);
+	for (int32 i = 0; i < awakeBodyCount && reader.IsValid(); ++i)
+	{
+		int32 index;
+		reader.Read(&index);
+		if (index < 0 || index >= m_bodyCount || bodies[index]->m_awakeIndex != -1)
+		{
+			valid = false;
+			break;
+		}
+		AddAwakeBody(bodies[index]);
+	}
+
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		j->ReadSnapshot(&reader);
+	}
+
+	int32 contactCount;
+	reader.Read(&contactCount);
+	for (int32 i = 0; i < contactCount && reader.IsValid(); ++i)
+	{
+		int32 indexA, childIndexA, indexB, childIndexB;
+		reader.Read(&indexA);
+		reader.Read(&childIndexA);
+		reader.Read(&indexB);
+		reader.Read(&childIndexB);
+		if (indexA < 0 || indexA >= fixtureCount || indexB < 0 || indexB >= fixtureCount)
+		{
+			valid = false;
+			break;
+		}
+
+		// The fixtures were saved in the order the factory wants them, so they
+		// are not swapped.
+		c = b2Contact::Create(fixtures[indexA], childIndexA, fixtures[indexB], childIndexB, &m_blockAllocator);
+		b2Assert(c->m_fixtureA == fixtures[indexA]);
+		b2Body* bodyA = c->m_fixtureA->m_body;
+		b2Body* bodyB = c->m_fixtureB->m_body;
+
+		reader.Read(&c->m_flags);
+		b2ReadManifold(&reader, &c->m_manifold);
+		reader.Read(&c->m_toiCount);
+		if (c->m_flags & b2Contact::e_toiFlag)
+		{
+			reader.Read(&c->m_toi);
+		}
+
+		// Link it in the same way as b2ContactManager::AddPair.
+		c->m_prev = NULL;
+		c->m_next = m_contactManager.m_contactList;
+		if (m_contactManager.m_contactList != NULL)
+		{
+			m_contactManager.m_contactList->m_prev = c;
+		}
+		m_contactManager.m_contactList = c;
+
+		c->m_nodeA.contact = c;
+		c->m_nodeA.other = bodyB;
+		c->m_nodeA.prev = NULL;
+		c->m_nodeA.next = bodyA->m_contactList;
+		if (bodyA->m_contactList != NULL)
+		{
+			bodyA->m_contactList->prev = &c->m_nodeA;
+		}
+		bodyA->m_contactList = &c->m_nodeA;
+
+		c->m_nodeB.contact = c;
+		c->m_nodeB.other = bodyA;
+		c->m_nodeB.prev = NULL;
+		c->m_nodeB.next = bodyB->m_contactList;
+		if (bodyB->m_contactList != NULL)
+		{
+			bodyB->m_contactList->prev = &c->m_nodeB;
+		}
+		bodyB->m_contactList = &c->m_nodeB;
+
+		++m_contactManager.m_contactCount;
+	}
+
+	// The trees come back without user data. Point the leaves at the fixture proxies again.
+	b2BroadPhase* broadPhase = &m_contactManager.m_broadPhase;
+	valid = valid && broadPhase->ReadSnapshot(&reader);
+	for (int32 i = 0; i < fixtureCount && valid; ++i)
+	{
+		b2Fixture* f = fixtures[i];
+		for (int32 j = 0; j < f->m_proxyCount; ++j)
+		{
+			broadPhase->SetUserData(f->m_proxies[j].proxyId, f->m_proxies + j);
+		}
+	}
+
+	FreeMemory(fixtures, fixturesSize);
+	FreeMemory(bodies, bodiesSize);
+
+	return valid && reader.IsValid() && reader.GetRemaining() == 0;
+}
+
 int32 b2World::GetProxyCount() const
 {
 	return m_contactManager.m_broadPhase.GetProxyCount();
 }
+
+int32 b2World::GetTreeHeight() const
+{
+	return m_contactManager.m_broadPhase.GetTreeHeight();
+}
+
+int32 b2World::GetTreeBalance() const
+{
+	return m_contactManager.m_broadPhase.GetTreeBalance();
+}
+
+float32 b2World::GetTreeQuality() const
+{
+	return m_contactManager.m_broadPhase.GetTreeQuality();
+}
+
+void b2World::RebuildProxyTree()
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	m_contactManager.m_broadPhase.RebuildTree();
+}
+
+void b2World::SetAABBFattening(float32 extension, float32 multiplier)
+{
+	m_contactManager.m_broadPhase.SetFattening(extension, multiplier);
+}
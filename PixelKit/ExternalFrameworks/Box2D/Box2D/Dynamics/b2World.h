@@ -24,14 +24,159 @@
 #include "b2StackAllocator.h"
 #include "b2ContactManager.h"
 #include "b2WorldCallbacks.h"
+#include "b2TimeStep.h"
 
 struct b2AABB;
 struct b2BodyDef;
 struct b2JointDef;
-struct b2TimeStep;
 class b2Body;
 class b2Fixture;
 class b2Joint;
+class b2ThreadPool;
+class b2Snapshot;
+
+/// Memory settings for a world. See b2World::b2World.
+struct b2WorldMemoryDef
+{
+	b2WorldMemoryDef()
+	{
+		arena = NULL;
+		stackSize = b2_stackSize;
+		resizeStack = true;
+		chunkSize = b2_chunkSize;
+	}
+
+	/// If set, the world's block and stack allocators (including the stack
+	/// allocators of the thread pool's threads), broad-phase and contact
+	/// manager get their memory from here instead of b2Alloc. The thread pool
+	/// itself and snapshots still use b2Alloc. It is owned by you and must
+	/// outlive the world.
+	b2MemoryArena* arena;
+
+	/// The size in bytes of the stack allocator used during a step. Bigger
+	/// steps fall back to one heap allocation per array.
+	int32 stackSize;
+
+	/// Grow the stack allocator between steps to fit the peak of the last
+	/// step. Use b2World::TrimMemory to shrink it back.
+	bool resizeStack;
+
+	/// The size in bytes of the chunks that bodies, fixtures, contacts and
+	/// joints are carved from. It must be at least b2_maxBlockSize.
+	int32 chunkSize;
+};
+
+/// Memory counters of a world. See b2World::GetMemoryStats.
+struct b2WorldMemoryStats
+{
+	/// The current size of the stack allocators.
+	int32 stackCapacity;
+
+	/// The most memory used at once by any one of the stack allocators.
+	int32 stackPeakBytes;
+
+	/// The number and total size of the stack allocations that didn't fit.
+	int32 stackFallbackCount;
+	int32 stackFallbackBytes;
+
+	/// The memory handed out by the block allocator, now and at most.
+	int32 blockBytes;
+	int32 blockPeakBytes;
+
+	/// The memory held in block allocator chunks, now and at most.
+	int32 chunkBytes;
+	int32 chunkPeakBytes;
+};
+
+/// Continuous collision counters of the last time step. See b2World::GetTOIStats.
+struct b2TOIStats
+{
+	/// The number of times of impact computed.
+	int32 toiCount;
+
+	/// The number of TOI events found, including the ones that turned out not to
+	/// be touching.
+	int32 eventCount;
+
+	/// The number of TOI events solved, each one is a sub-step.
+	int32 subStepCount;
+
+	/// True if the step stopped at b2World::SetMaxTOIEvents with events left.
+	/// These are lost, so bodies may tunnel.
+	bool capped;
+};
+
+/// A fixture hit by a ray in b2World::RayCastBatch.
+struct b2RayCastHit
+{
+	b2Fixture* fixture;
+	b2Vec2 point;
+	b2Vec2 normal;
+	float32 fraction;
+};
+
+/// The rays of a b2World::RayCastBatch call and the arrays to put the hits in.
+/// The arrays are owned by you.
+struct b2RayCastBatch
+{
+	b2RayCastBatch()
+	{
+		points1 = NULL;
+		points2 = NULL;
+		rayCount = 0;
+		maxHits = 1;
+		hits = NULL;
+		hitCounts = NULL;
+		usePackets = false;
+	}
+
+	/// Ray i goes from points1[i] to points2[i].
+	const b2Vec2* points1;
+	const b2Vec2* points2;
+	int32 rayCount;
+
+	/// The most hits kept per ray. These are the closest ones, so use 1 to get
+	/// the first hit of each ray.
+	int32 maxHits;
+
+	/// The hits of ray i are stored from hits[i * maxHits], sorted by fraction,
+	/// and their number in hitCounts[i]. hits must have room for
+	/// rayCount * maxHits elements.
+	b2RayCastHit* hits;
+	int32* hitCounts;
+
+	/// Cast groups of b2_rayPacketSize consecutive rays through the broad-phase
+	/// together. Use this when neighbouring rays are close, e.g. a fan of rays
+	/// from one point.
+	bool usePackets;
+};
+
+/// The boxes of a b2World::QueryAABBBatch call and the arrays to put the
+/// fixtures in. The arrays are owned by you.
+struct b2AABBQueryBatch
+{
+	b2AABBQueryBatch()
+	{
+		aabbs = NULL;
+		aabbCount = 0;
+		maxFixtures = 1;
+		fixtures = NULL;
+		fixtureCounts = NULL;
+	}
+
+	const b2AABB* aabbs;
+	int32 aabbCount;
+
+	/// The most fixtures kept per box. Once this many are found the query for
+	/// that box stops.
+	int32 maxFixtures;
+
+	/// The fixtures found for box i are stored from fixtures[i * maxFixtures],
+	/// and their number in fixtureCounts[i]. fixtures must have room for
+	/// aabbCount * maxFixtures elements.
+	b2Fixture** fixtures;
+	int32* fixtureCounts;
+};
 
 /// The world class manages all physics entities, dynamic simulation,
 /// and asynchronous queries. The world also contains efficient memory
@@ -42,7 +187,8 @@ public:
 	/// Construct a world object.
 	/// @param gravity the world gravity vector.
 	/// @param doSleep improve performance by not simulating inactive bodies.
-	b2World(const b2Vec2& gravity, bool doSleep);
+	/// @param memoryDef optional memory settings, the defaults are used if NULL.
+	b2World(const b2Vec2& gravity, bool doSleep, const b2WorldMemoryDef* memoryDef = NULL);
 
 	/// Destruct the world. All physics entities are destroyed and all heap memory is released.
 	~b2World();
@@ -65,6 +211,18 @@ public:
 	/// by you and must remain in scope.
 	void SetDebugDraw(b2DebugDraw* debugDraw);
 
+	/// Register a thread pool used to compute contact manifolds and solve islands
+	/// concurrently. The pool is owned by you and must remain in scope. Pass NULL
+	/// to do everything on the calling thread (the default).
+	/// Contact listener and filter callbacks are still made from the calling
+	/// thread, in the same order as without a pool. PostSolve calls are deferred
+	/// until all the islands have been solved.
+	/// @warning This function is locked during callbacks.
+	void SetThreadPool(b2ThreadPool* threadPool);
+
+	/// Get the thread pool used to solve islands, if any.
+	b2ThreadPool* GetThreadPool() const;
+
 	/// Create a rigid body given a definition. No reference to the definition
 	/// is retained.
 	/// @warning This function is locked during callbacks.
@@ -117,6 +275,17 @@ public:
 	/// @param point2 the ray ending point
 	void RayCast(b2RayCastCallback* callback, const b2Vec2& point1, const b2Vec2& point2) const;
 
+	/// Query the world for the fixtures that potentially overlap each of many
+	/// AABBs. The boxes are spread across the thread pool, if one is set.
+	/// @param batch the boxes and the arrays to fill.
+	void QueryAABBBatch(b2AABBQueryBatch* batch) const;
+
+	/// Ray-cast the world for the closest fixtures in the path of each of many
+	/// rays. The rays are spread across the thread pool, if one is set. Like
+	/// RayCast, this ignores shapes that contain the starting point.
+	/// @param batch the rays and the arrays to fill.
+	void RayCastBatch(b2RayCastBatch* batch) const;
+
 	/// Get the world body list. With the returned body, use b2Body::GetNext to get
 	/// the next body in the world list. A NULL body indicates the end of the list.
 	/// @return the head of the world body list.
@@ -136,18 +305,81 @@ public:
 	/// Enable/disable warm starting. For testing.
 	void SetWarmStarting(bool flag) { m_warmStarting = flag; }
 
+	/// Enable/disable the SIMD contact solver, which solves several contacts at
+	/// once. It is off by default, in which case the scalar solver is used.
+	void SetSIMDContactSolver(bool flag) { m_simdContactSolver = flag; }
+
+	/// Is the SIMD contact solver enabled?
+	bool GetSIMDContactSolver() const { return m_simdContactSolver; }
+
 	/// Enable/disable continuous physics. For testing.
 	void SetContinuousPhysics(bool flag) { m_continuousPhysics = flag; }
 
 	/// Enable/disable single stepped continuous physics. For testing.
 	void SetSubStepping(bool flag) { m_subStepping = flag; }
 
+	/// Set the most TOI events handled in a time step. Each one costs a sweep of
+	/// the contacts and a sub-step, so this bounds the cost of continuous
+	/// collision when many fast bodies hit things at once. The default is
+	/// b2_maxTOIEvents.
+	void SetMaxTOIEvents(int32 count);
+
+	/// Get the most TOI events handled in a time step.
+	int32 GetMaxTOIEvents() const;
+
+	/// Get the continuous collision counters of the last time step.
+	const b2TOIStats& GetTOIStats() const;
+
+	/// Get the timings and counters of the last time step.
+	const b2Profile& GetProfile() const;
+
 	/// Get the number of broad-phase proxies.
 	int32 GetProxyCount() const;
 
+	/// Get the height of the dynamic tree.
+	int32 GetTreeHeight() const;
+
+	/// Get the balance of the dynamic tree.
+	int32 GetTreeBalance() const;
+
+	/// Get the quality metric of the dynamic tree. The smaller the better.
+	/// The minimum is 1.
+	float32 GetTreeQuality() const;
+
+	/// Rebuild the broad-phase tree from scratch. This is useful after
+	/// creating a lot of bodies at once, such as when loading a level.
+	/// @warning This function is locked during callbacks.
+	void RebuildProxyTree();
+
+	/// Set how much the broad-phase fattens shape AABBs. The extension is added
+	/// to every side and the multiplier scales the predicted displacement of
+	/// moving shapes. The defaults are b2_aabbExtension and b2_aabbMultiplier.
+	/// Proxies pick up the new values the next time they are re-inserted.
+	void SetAABBFattening(float32 extension, float32 multiplier);
+
 	/// Get the number of bodies.
 	int32 GetBodyCount() const;
 
+	/// Get the number of bodies in the awake list. These are the bodies a step
+	/// spends time on; sleeping and static bodies cost nothing until they are
+	/// woken. Bodies that went to sleep since the last step are still counted.
+	int32 GetAwakeBodyCount() const;
+
+	/// Set when bodies go to sleep. A body can sleep once its linear and angular
+	/// speeds have stayed below the tolerances for timeToSleep seconds, and its
+	/// island sleeps when all of its bodies can. The defaults are
+	/// b2_linearSleepTolerance, b2_angularSleepTolerance and b2_timeToSleep.
+	void SetSleepTolerances(float32 linearTolerance, float32 angularTolerance, float32 timeToSleep);
+
+	/// Get the linear sleep tolerance. See SetSleepTolerances.
+	float32 GetLinearSleepTolerance() const;
+
+	/// Get the angular sleep tolerance. See SetSleepTolerances.
+	float32 GetAngularSleepTolerance() const;
+
+	/// Get the time to sleep. See SetSleepTolerances.
+	float32 GetTimeToSleep() const;
+
 	/// Get the number of joints.
 	int32 GetJointCount() const;
 
@@ -172,6 +404,31 @@ public:
 	/// Get the contact manager for testing.
 	const b2ContactManager& GetContactManager() const;
 
+	/// Get the memory counters of the world's allocators. The stack counters
+	/// include the allocators of the thread pool's threads.
+	void GetMemoryStats(b2WorldMemoryStats* stats) const;
+
+	/// Give back unused memory: block allocator chunks that are completely
+	/// free, and stack space beyond b2WorldMemoryDef::stackSize.
+	/// @warning This function is locked during callbacks.
+	void TrimMemory();
+
+	/// Save the state of the world: bodies, fixtures, joints, contacts and the
+	/// broad-phase, enough for RestoreSnapshot to put the world back exactly as
+	/// it was, so that stepping it again gives bit for bit the same results.
+	/// Worlds in the same state give equal snapshots. This is cheap enough to do
+	/// every step. Shapes, user data and callbacks are not saved.
+	void SaveSnapshot(b2Snapshot* snapshot) const;
+
+	/// Put the world back in the state saved by SaveSnapshot. The world must
+	/// have the same bodies, fixtures and joints, created in the same order, as
+	/// when the snapshot was saved (for example the same world, or a copy built
+	/// by the same code). No contact callbacks are made.
+	/// @return false if the snapshot does not match the world, which is then
+	/// left unchanged.
+	/// @warning This function is locked during callbacks.
+	bool RestoreSnapshot(const b2Snapshot& snapshot);
+
 private:
 
 	// m_flags
@@ -186,8 +443,26 @@ private:
 	friend class b2ContactManager;
 	friend class b2Controller;
 
+	// The awake list holds the awake, active, non-static bodies, so that a step
+	// only visits those. Bodies are added as they wake up, and the ones that
+	// went to sleep, were deactivated or made static are dropped after solving.
+	void AddAwakeBody(b2Body* body);
+	void RemoveAwakeBody(b2Body* body);
+	void CompactAwakeBodies();
+
+	// Memory the world owns directly comes from the arena in m_memoryDef, like
+	// the memory of its allocators, or from b2Alloc if there is none.
+	void* AllocateMemory(int32 size) const;
+	void FreeMemory(void* p, int32 size) const;
+
 	void Solve(const b2TimeStep& step);
+	void SolveIslands(const b2TimeStep& step);
+	void SolveIslandsParallel(const b2TimeStep& step);
+	static void SolveIslandsTask(void* userData, int32 begin, int32 end, int32 threadIndex);
+	static void QueryAABBBatchTask(void* userData, int32 begin, int32 end, int32 threadIndex);
+	static void RayCastBatchTask(void* userData, int32 begin, int32 end, int32 threadIndex);
 	void SolveTOI(const b2TimeStep& step);
+	static void ComputeTOITask(void* userData, int32 begin, int32 end, int32 threadIndex);
 
 	void DrawJoint(b2Joint* joint);
 	void DrawShape(b2Fixture* shape, const b2Transform& xf, const b2Color& color);
@@ -205,14 +480,30 @@ private:
 	int32 m_bodyCount;
 	int32 m_jointCount;
 
+	b2Body** m_awakeBodies;
+	int32 m_awakeBodyCount;
+	int32 m_awakeBodyCapacity;
+
 	b2Vec2 m_gravity;
 	bool m_allowSleep;
 
+	float32 m_linearSleepTolerance;
+	float32 m_angularSleepTolerance;
+	float32 m_timeToSleep;
+
 	b2Body* m_groundBody;
 
 	b2DestructionListener* m_destructionListener;
 	b2DebugDraw* m_debugDraw;
 
+	// Islands are solved on these threads if set. Each one gets its own stack
+	// allocator, indexed by the pool's thread index.
+	b2ThreadPool* m_threadPool;
+	b2StackAllocator* m_threadStackAllocators;
+	int32 m_threadStackAllocatorCount;
+
+	b2WorldMemoryDef m_memoryDef;
+
 	// This is used to compute the time step ratio to
 	// support a variable time step.
 	float32 m_inv_dt0;
@@ -220,11 +511,22 @@ private:
 	// These are for debugging the solver.
 	bool m_warmStarting;
 	bool m_continuousPhysics;
+	bool m_simdContactSolver;
 	bool m_subStepping;
 
 	bool m_stepComplete;
+
+	int32 m_maxTOIEvents;
+	b2TOIStats m_toiStats;
+
+	b2Profile m_profile;
 };
 
+inline b2ThreadPool* b2World::GetThreadPool() const
+{
+	return m_threadPool;
+}
+
 inline b2Body* b2World::GetBodyList()
 {
 	return m_bodyList;
@@ -245,6 +547,54 @@ inline int32 b2World::GetBodyCount() const
 	return m_bodyCount;
 }
 
+inline int32 b2World::GetAwakeBodyCount() const
+{
+	return m_awakeBodyCount;
+}
+
+inline void b2World::SetSleepTolerances(float32 linearTolerance, float32 angularTolerance, float32 timeToSleep)
+{
+	m_linearSleepTolerance = linearTolerance;
+	m_angularSleepTolerance = angularTolerance;
+	m_timeToSleep = timeToSleep;
+}
+
+inline float32 b2World::GetLinearSleepTolerance() const
+{
+	return m_linearSleepTolerance;
+}
+
+inline float32 b2World::GetAngularSleepTolerance() const
+{
+	return m_angularSleepTolerance;
+}
+
+inline float32 b2World::GetTimeToSleep() const
+{
+	return m_timeToSleep;
+}
+
+inline void b2World::SetMaxTOIEvents(int32 count)
+{
+	b2Assert(count >= 0);
+	m_maxTOIEvents = count;
+}
+
+inline int32 b2World::GetMaxTOIEvents() const
+{
+	return m_maxTOIEvents;
+}
+
+inline const b2TOIStats& b2World::GetTOIStats() const
+{
+	return m_toiStats;
+}
+
+inline const b2Profile& b2World::GetProfile() const
+{
+	return m_profile;
+}
+
 inline int32 b2World::GetJointCount() const
 {
 	return m_jointCount;
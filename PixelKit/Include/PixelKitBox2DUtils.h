@@ -43,6 +43,7 @@
 #include "Box2D.h"
 
 #import "PKBox2DDebugLayer.h"
+#import "PKBox2DProfileLayer.h"
 #import "PKBox2DTouchPicker.h"
 #import "PKBox2DTouchPickerEvent.h"
 
@@ -44,6 +44,7 @@
 #include "PXTouchEngine.h"
 
 #import "PXLinkedList.h"
+#import "PXLoaderQueue.h"
 
 @interface PXEngine : NSObject
 {
@@ -962,6 +963,8 @@ void PXEngineRenderPhase()
 void PXEngineOnFrame()
 {
 	PXSoundEngineUpdate();
+	// Finish asynchronous loads before the frame's logic runs.
+	PXLoaderQueueUpdate();
 
 	PXEngineLogicPhase();
 	PXEngineRenderPhase();
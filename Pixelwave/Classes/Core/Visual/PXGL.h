@@ -65,6 +65,9 @@ void PXGLDisable(GLenum cap);
 void PXGLDisableClientState(GLenum array);
 void PXGLDrawArrays(GLenum mode, GLint first, GLsizei count);
 void PXGLDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid *indices);
+const PXGLMatrix *PXGLGetCurrentMatrix();
+PXGLColoredTextureVertex *PXGLAskForTransformedVertices(GLenum mode, GLsizei count);
+void PXGLUsedTransformedVertices(GLsizei count, PXGLAABB *aabb);
 void PXGLEnable(GLenum cap);
 void PXGLEnableClientState(GLenum array);
 void PXGLLineWidth(GLfloat width);
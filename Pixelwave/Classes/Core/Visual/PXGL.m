@@ -117,6 +117,10 @@ GLubyte pxGLGreen = 0xFF;
 GLubyte pxGLBlue  = 0xFF;
 GLubyte pxGLAlpha = 0xFF;
 
+PXGLColoredTextureVertex *pxGLTransformedVertices = NULL;
+unsigned pxGLTransformedOldVertexIndex = 0;
+unsigned pxGLTransformedLinkCount = 0;
+
 /*
  * This method initializes GL with the width and height given
  *
@@ -1595,6 +1599,122 @@ void PXGLDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid *ids
 	PXGLAABBUpdate(&pxGLAABB, &aabb);
 }
 
+/*
+ * PXGLGetCurrentMatrix returns the matrix at the top of the matrix stack, which
+ * is the matrix PXGLDrawArrays and PXGLDrawElements would multiply any
+ * vertices by. This is useful for renderers that wish to transform their own
+ * geometry and hand it off via PXGLAskForTransformedVertices.
+ *
+ * @return const PXGLMatrix * - The current matrix.
+ */
+const PXGLMatrix *PXGLGetCurrentMatrix()
+{
+	return pxGLCurrentMatrix;
+}
+
+/*
+ * PXGLAskForTransformedVertices returns a pointer directly into the batch's
+ * vertex buffer with room for count vertices. The caller is expected to write
+ * vertices that are already multiplied by the current matrix (see
+ * PXGLGetCurrentMatrix), and then call PXGLUsedTransformedVertices with the
+ * amount actually written. No PXGL calls may be made in between the two.
+ *
+ * Because this skips the per vertex transform that PXGLDrawArrays performs, it
+ * is substantially faster for geometry that is built every frame anyway (such
+ * as particles).
+ *
+ * When mode is GL_TRIANGLE_STRIP the caller must supply a self linking strip,
+ * meaning the first and last vertices are duplicated so that degenerate
+ * triangles join it to whatever is next to it in the batch.
+ *
+ * @param GLenum mode - Specifies what kind of primitives to render. Symbolic
+ * constants GL_POINTS, GL_LINES, GL_TRIANGLE_STRIP and GL_TRIANGLES are
+ * accepted.
+ * @param GLsizei count - The maximum number of vertices that will be written.
+ *
+ * @return PXGLColoredTextureVertex * - The first vertex to write to.
+ */
+PXGLColoredTextureVertex *PXGLAskForTransformedVertices(GLenum mode, GLsizei count)
+{
+	PX_DISABLE_BIT(pxGLState.state, PX_GL_DRAW_ELEMENTS);
+	PXGLSetupEnables();
+
+	PXGLSetDrawMode(mode);
+
+	pxGLTransformedOldVertexIndex = PXGLGetCurrentVertexIndex();
+
+	// If there is already a strip in the buffer, we need to repeat its last
+	// vertex to create the degenerate triangle between it and the new strip.
+	pxGLTransformedLinkCount = (mode == GL_TRIANGLE_STRIP && pxGLTransformedOldVertexIndex != 0) ? 1 : 0;
+
+	PXGLColoredTextureVertex *point = PXGLAskForVertices(count + pxGLTransformedLinkCount);
+
+	if (pxGLTransformedLinkCount != 0)
+	{
+		*point = *(point - 1);
+		++point;
+	}
+
+	pxGLTransformedVertices = point;
+
+	return point;
+}
+
+/*
+ * PXGLUsedTransformedVertices commits the vertices written after a call to
+ * PXGLAskForTransformedVertices. The current color transform is applied to the
+ * vertices, and if the bounding box given doesn't intersect the clip rect the
+ * vertices are discarded.
+ *
+ * @param GLsizei count - The number of vertices that were written.
+ * @param PXGLAABB * aabb - The bounding box of the vertices that were written.
+ */
+void PXGLUsedTransformedVertices(GLsizei count, PXGLAABB *aabb)
+{
+	if (count == 0)
+		return;
+
+	// If there is a color transform, then it needs to be applied the same way
+	// PXGLDrawArrays would have.
+	if (pxGLRed != 0xFF || pxGLGreen != 0xFF || pxGLBlue != 0xFF || pxGLAlpha != 0xFF)
+	{
+		PXGLColoredTextureVertex *point = pxGLTransformedVertices;
+
+		for (GLsizei index = 0; index < count; ++index, ++point)
+		{
+#if (!PX_ACCURATE_COLOR_TRANSFORMATION_MODE)
+			point->r = (point->r * pxGLRed)   >> 8;
+			point->g = (point->g * pxGLGreen) >> 8;
+			point->b = (point->b * pxGLBlue)  >> 8;
+			point->a = (point->a * pxGLAlpha) >> 8;
+#else
+			point->r = point->r * pxGLCurrentColor->redMultiplier;
+			point->g = point->g * pxGLCurrentColor->greenMultiplier;
+			point->b = point->b * pxGLCurrentColor->blueMultiplier;
+			point->a = point->a * pxGLCurrentColor->alphaMultiplier;
+#endif
+		}
+	}
+
+	// The vertices are written with a color each, so the color array has to be
+	// used when this buffer is flushed.
+	pxGLBufferVertexColorState = PX_GL_VERTEX_COLOR_MULTIPLE;
+
+	PXGLUsedVertices(count + pxGLTransformedLinkCount);
+
+	if (!_PXGLRectContainsAABB(&pxGLRectClip, aabb))
+	{
+		PXGLSetCurrentVertexIndex(pxGLTransformedOldVertexIndex);
+	}
+
+	// We are adding a 1 pixel buffer to the bounding box
+	PXGLAABBInflatev(aabb, 1, 1);
+
+	// then we are going to calculate the overall bounding box for the object
+	// that was drawn.
+	PXGLAABBUpdate(&pxGLAABB, aabb);
+}
+
 void PXGLBlendFunc(GLenum sfactor, GLenum dfactor)
 {
 	pxGLState.blendSource = sfactor;
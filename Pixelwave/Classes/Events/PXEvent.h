@@ -51,6 +51,9 @@ PXExtern NSString * const PXEvent_RemovedFromStage;
 PXExtern NSString * const PXEvent_Render;
 PXExtern NSString * const PXEvent_PostRender;
 PXExtern NSString * const PXEvent_SoundComplete;
+PXExtern NSString * const PXEvent_Complete;
+PXExtern NSString * const PXEvent_Cancel;
+PXExtern NSString * const PXEvent_Error;
 
 //@ Event Phases
 typedef enum
@@ -52,6 +52,9 @@ NSString * const PXEvent_RemovedFromStage = @"removedFromStage";
 NSString * const PXEvent_Render = @"render";
 NSString * const PXEvent_PostRender = @"postRender";
 NSString * const PXEvent_SoundComplete = @"soundComplete";
+NSString * const PXEvent_Complete = @"complete";
+NSString * const PXEvent_Cancel = @"cancel";
+NSString * const PXEvent_Error = @"error";
 
 @interface PXEvent(Private)
 - (void) setType:(NSString *)type;
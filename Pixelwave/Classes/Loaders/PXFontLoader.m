@@ -52,7 +52,10 @@
 - (id) initWithContentsOfFile:(NSString *)path
 						orURL:(NSURL *)url
 					  options:(PXFontOptions *)options;
-- (NSString *)updatePath:(NSString *)path;
+- (id) initWithResolvedPath:(NSString *)path
+					  orURL:(NSURL *)url
+					options:(PXFontOptions *)options
+		 contentScaleFactor:(float)contentScaleFactor;
 @end
 
 /**
@@ -185,24 +188,35 @@
 						orURL:(NSURL *)url
 					  options:(PXFontOptions *)_options
 {
-	self = [super _initWithContentsOfFile:path orURL:url];
+	float scaleFactor = 1.0f;
 
-	if (self)
+	if (path)
 	{
-		contentScaleFactor = 1.0f;
+		path = [PXFontLoader _resolvePath:path contentScaleFactor:&scaleFactor];
 
-		if (path)
+		if (!path)
 		{
-			path = [self updatePath:path];
+			[self release];
+			return nil;
+		}
+	}
 
-			if (!path)
-			{
-				[self release];
-				return nil;
-			}
+	return [self initWithResolvedPath:path orURL:url options:_options contentScaleFactor:scaleFactor];
+}
 
-			[self _setOrigin:path];
-		}
+/*
+ * The path must already be resolved by _resolvePath:contentScaleFactor:.
+ */
+- (id) initWithResolvedPath:(NSString *)path
+					  orURL:(NSURL *)url
+					options:(PXFontOptions *)_options
+		 contentScaleFactor:(float)_contentScaleFactor
+{
+	self = [super _initWithContentsOfFile:path orURL:url];
+
+	if (self)
+	{
+		contentScaleFactor = _contentScaleFactor;
 
 		[self _load];
 
@@ -261,14 +275,42 @@
 	return [fontParser newFont];
 }
 
++ (id) _newLoaderWithResolvedPath:(NSString *)path
+							orURL:(NSURL *)url
+						  options:(id)options
+			   contentScaleFactor:(float)_contentScaleFactor
+{
+	PXFontLoader *loader = [[self alloc] initWithResolvedPath:path
+														orURL:url
+													  options:options
+										   contentScaleFactor:_contentScaleFactor];
+
+	// Unlike the synchronous path, fail now rather than when the font is
+	// asked for.
+	if (loader && !loader->fontParser)
+	{
+		[loader release];
+		loader = nil;
+	}
+
+	return loader;
+}
+
+- (id) _newLoadedObject
+{
+	return [self newFont];
+}
+
 /*
  * Auto-completes the extension of the file if one wasn't provided.
  * This method also checks for a file with the @2x extension in it and returns
  * its name if it finds it. Otherwise it returns the original path.
  *
  */
-- (NSString *)updatePath:(NSString *)path
++ (NSString *)_resolvePath:(NSString *)path contentScaleFactor:(float *)_contentScaleFactor
 {
+	*_contentScaleFactor = 1.0f;
+
 	if (!path)
 		return nil;
 
@@ -276,7 +318,7 @@
 	path = [PXLoader pathForRetinaVersionOfFile:path retScale:&scaleFactor];
 	if (!PXMathIsOne(scaleFactor))
 	{
-		contentScaleFactor = PXEngineGetContentScaleFactor();
+		*_contentScaleFactor = PXEngineGetContentScaleFactor();
 	}
 
 	return path;
@@ -37,6 +37,8 @@
  * 3. This notice may not be removed or altered from any source distribution.
  */
 
+#import "PXLoaderRequest.h"
+
 typedef enum
 {
 	PXLoaderOriginType_File = 0,
@@ -77,6 +79,10 @@ typedef enum
 + (NSString *)pathForRetinaVersionOfFile:(NSString *)path retScale:(float *)outScale;
 + (NSString *)findFileAtPath:(NSString *)basePath withBaseName:(NSString *)baseName validExtensions:(NSArray *)extensions;
 
+// Asynchronous loading
++ (PXLoaderRequest *)loadAsyncWithContentsOfFile:(NSString *)path options:(id)options priority:(PXLoaderPriority)priority;
++ (PXLoaderRequest *)loadAsyncWithContentsOfURL:(NSURL *)url options:(id)options priority:(PXLoaderPriority)priority;
+
 @end
 
 @interface PXLoader(Protected)
@@ -85,4 +91,18 @@ typedef enum
 - (BOOL) _load;
 - (void) _setOrigin:(NSString *)origin;
 - (void) _log:(NSString *)message;
+
+// Used for asynchronous loads. The first two are called on the main thread
+// when the request is made, and resolve everything that reads shared state:
+// the full path of the file, its content scale factor and the default
+// options. The third is called on a worker thread with the resolved values
+// and only reads and parses the file. The last is called on the main thread
+// and does the GL or AL upload.
++ (NSString *)_resolvePath:(NSString *)path contentScaleFactor:(float *)contentScaleFactor;
++ (id) _resolveOptions:(id)options;
++ (id) _newLoaderWithResolvedPath:(NSString *)path
+							orURL:(NSURL *)url
+						  options:(id)options
+			   contentScaleFactor:(float)contentScaleFactor;
+- (id) _newLoadedObject;
 @end
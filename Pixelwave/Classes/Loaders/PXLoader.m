@@ -38,6 +38,7 @@
  */
 
 #import "PXLoader.h"
+#import "PXLoaderQueue.h"
 
 #import "PXEngine.h"
 
@@ -160,7 +161,9 @@
 			return NO;
 		}
 
-		data = [[NSData alloc] initWithContentsOfFile:absPath options:0 error:&error];
+		// Map the file rather than read it. Parsers which only need part of
+		// the data, or can hand it straight to gl, then never copy it all.
+		data = [[NSData alloc] initWithContentsOfFile:absPath options:NSMappedRead error:&error];
 	}
 	else if (originType == PXLoaderOriginType_URL)
 	{
@@ -178,6 +181,41 @@
 	return (data ? YES : NO);
 }
 
+// A plain loader takes the path as it is, and has no options.
++ (NSString *)_resolvePath:(NSString *)path contentScaleFactor:(float *)contentScaleFactor
+{
+	*contentScaleFactor = 1.0f;
+
+	return path;
+}
+
++ (id) _resolveOptions:(id)options
+{
+	return options;
+}
+
++ (id) _newLoaderWithResolvedPath:(NSString *)path
+							orURL:(NSURL *)url
+						  options:(id)options
+			   contentScaleFactor:(float)contentScaleFactor
+{
+	PXLoader *loader = [[self alloc] _initWithContentsOfFile:path orURL:url];
+
+	if (loader && ![loader _load])
+	{
+		[loader release];
+		loader = nil;
+	}
+
+	return loader;
+}
+
+// A plain loader's product is its data.
+- (id) _newLoadedObject
+{
+	return [data retain];
+}
+
 - (void) _log:(NSString *)message
 {
 	// We can do a useful log message that includes the origin.
@@ -331,4 +369,46 @@
 	return nil;
 }
 
+/**
+ * Loads a file in the background with the shared #PXLoaderQueue. The file is
+ * read and parsed on a worker thread, and only uploaded on the main thread.
+ *
+ * @param path The path of the file to load.
+ * @param options The modifier for a #PXTextureLoader or #PXSoundLoader
+ * (`nil` uses the default modifier), the #PXFontOptions for a
+ * #PXFontLoader.
+ * @param priority Requests with a higher priority are loaded and uploaded
+ * first.
+ *
+ * @return The request, which dispatches `PXEvent_Complete` when done.
+ *
+ * **Example:**
+ *	PXLoaderRequest *request = [PXTextureLoader loadAsyncWithContentsOfFile:@"image.png"
+ *	                                                                options:nil
+ *	                                                               priority:PXLoaderPriority_High];
+ *	[request addEventListenerOfType:PXEvent_Complete listener:PXListener(onImageLoaded:)];
+ */
++ (PXLoaderRequest *)loadAsyncWithContentsOfFile:(NSString *)path options:(id)options priority:(PXLoaderPriority)priority
+{
+	return [[PXLoaderQueue sharedQueue] loadContentsOfFile:path loaderClass:self options:options priority:priority];
+}
+
+/**
+ * Loads the contents of a url in the background with the shared
+ * #PXLoaderQueue.
+ *
+ * @param url The url to load.
+ * @param options The modifier for a #PXTextureLoader or #PXSoundLoader
+ * (`nil` uses the default modifier), the #PXFontOptions for a
+ * #PXFontLoader.
+ * @param priority Requests with a higher priority are loaded and uploaded
+ * first.
+ *
+ * @return The request, which dispatches `PXEvent_Complete` when done.
+ */
++ (PXLoaderRequest *)loadAsyncWithContentsOfURL:(NSURL *)url options:(id)options priority:(PXLoaderPriority)priority
+{
+	return [[PXLoaderQueue sharedQueue] loadContentsOfURL:url loaderClass:self options:options priority:priority];
+}
+
 @end
@@ -0,0 +1,93 @@
+/*
+ *  _____                       ___                                            
+ * /\  _ `\  __                /\_ \                                           
+ * \ \ \L\ \/\_\   __  _    ___\//\ \    __  __  __    ___     __  __    ___   
+ *  \ \  __/\/\ \ /\ \/ \  / __`\\ \ \  /\ \/\ \/\ \  / __`\  /\ \/\ \  / __`\ 
+ *   \ \ \/  \ \ \\/>  </ /\  __/ \_\ \_\ \ \_/ \_/ \/\ \L\ \_\ \ \_/ |/\  __/ 
+ *    \ \_\   \ \_\/\_/\_\\ \____\/\____\\ \___^___ /\ \__/|\_\\ \___/ \ \____\
+ *     \/_/    \/_/\//\/_/ \/____/\/____/ \/__//__ /  \/__/\/_/ \/__/   \/____/
+ *       
+ *           www.pixelwave.org + www.spiralstormgames.com
+ *                            ~;   
+ *                           ,/|\.           
+ *                         ,/  |\ \.                 Core Team: Oz Michaeli
+ *                       ,/    | |  \                           John Lattin
+ *                     ,/      | |   |
+ *                   ,/        |/    |
+ *                 ./__________|----'  .
+ *            ,(   ___.....-,~-''-----/   ,(            ,~            ,(        
+ * _.-~-.,.-'`  `_.\,.',.-'`  )_.-~-./.-'`  `_._,.',.-'`  )_.-~-.,.-'`  `_._._,.
+ * 
+ * Copyright (c) 2011 Spiralstorm Games http://www.spiralstormgames.com
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#import "PXLoaderRequest.h"
+
+@class PXLinkedList;
+
+@interface PXLoaderQueue : NSObject
+{
+@private
+	NSOperationQueue *operationQueue;
+
+	// Every request that hasn't finished, so they can be cancelled together.
+	PXLinkedList *requests;
+	// Parsed requests waiting for the main thread, highest priority first.
+	PXLinkedList *uploadRequests;
+
+	float uploadTimeBudget;
+}
+
+/**
+ * The number of worker threads that load and parse.
+ */
+@property (nonatomic, readonly) unsigned threadCount;
+/**
+ * How long, in seconds, uploads may take each frame. At least one upload is
+ * done every frame regardless, so large assets still get through.
+ *
+ * **Default:** 0.004
+ */
+@property (nonatomic) float uploadTimeBudget;
+
+- (id) initWithThreadCount:(unsigned)threadCount;
+
+- (PXLoaderRequest *)loadContentsOfFile:(NSString *)path
+							loaderClass:(Class)loaderClass
+								options:(id)options
+							   priority:(PXLoaderPriority)priority;
+- (PXLoaderRequest *)loadContentsOfURL:(NSURL *)url
+						   loaderClass:(Class)loaderClass
+							   options:(id)options
+							  priority:(PXLoaderPriority)priority;
+
+- (void) cancelAllRequests;
+
++ (PXLoaderQueue *)sharedQueue;
+
+@end
+
+@interface PXLoaderQueue(PrivateButPublic)
+- (void) _requestLoaded:(PXLoaderRequest *)request;
+- (void) _requestFinished:(PXLoaderRequest *)request;
+- (void) _requestPriorityChanged:(PXLoaderRequest *)request;
+@end
+
+// Called by the engine once a frame, uploads for every queue.
+void PXLoaderQueueUpdate();
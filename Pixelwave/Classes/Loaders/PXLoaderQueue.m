@@ -0,0 +1,360 @@
+/*
+ *  _____                       ___                                            
+ * /\  _ `\  __                /\_ \                                           
+ * \ \ \L\ \/\_\   __  _    ___\//\ \    __  __  __    ___     __  __    ___   
+ *  \ \  __/\/\ \ /\ \/ \  / __`\\ \ \  /\ \/\ \/\ \  / __`\  /\ \/\ \  / __`\ 
+ *   \ \ \/  \ \ \\/>  </ /\  __/ \_\ \_\ \ \_/ \_/ \/\ \L\ \_\ \ \_/ |/\  __/ 
+ *    \ \_\   \ \_\/\_/\_\\ \____\/\____\\ \___^___ /\ \__/|\_\\ \___/ \ \____\
+ *     \/_/    \/_/\//\/_/ \/____/\/____/ \/__//__ /  \/__/\/_/ \/__/   \/____/
+ *       
+ *           www.pixelwave.org + www.spiralstormgames.com
+ *                            ~;   
+ *                           ,/|\.           
+ *                         ,/  |\ \.                 Core Team: Oz Michaeli
+ *                       ,/    | |  \                           John Lattin
+ *                     ,/      | |   |
+ *                   ,/        |/    |
+ *                 ./__________|----'  .
+ *            ,(   ___.....-,~-''-----/   ,(            ,~            ,(        
+ * _.-~-.,.-'`  `_.\,.',.-'`  )_.-~-./.-'`  `_._,.',.-'`  )_.-~-.,.-'`  `_._._,.
+ * 
+ * Copyright (c) 2011 Spiralstorm Games http://www.spiralstormgames.com
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#import "PXLoaderQueue.h"
+
+#import "PXLoader.h"
+#import "PXLinkedList.h"
+
+#import "PXDebug.h"
+
+// Every live queue, weakly referenced, so the engine can update them.
+PXLinkedList *pxLoaderQueues = nil;
+PXLoaderQueue *pxLoaderQueueShared = nil;
+
+@interface PXLoaderQueue(Private)
+- (PXLoaderRequest *)loadContentsOfFile:(NSString *)path
+								  orURL:(NSURL *)url
+							loaderClass:(Class)loaderClass
+								options:(id)options
+							   priority:(PXLoaderPriority)priority;
+- (void) addUploadRequest:(PXLoaderRequest *)request;
+- (BOOL) hasUploads;
+- (void) upload;
+@end
+
+/**
+ * A PXLoaderQueue loads files in the background so that big loads don't
+ * freeze the application.
+ *
+ * Reading and parsing a file (decoding a png, walking a pvr header, decoding
+ * audio, rasterizing a font) is done on a pool of worker threads. Only the
+ * final GL or AL upload is done on the main thread. Uploads are done at the
+ * start of each frame, and only as many as fit in #uploadTimeBudget, so a
+ * level can load while the application keeps running.
+ *
+ * Any #PXLoader subclass can be loaded this way. Each load returns a
+ * #PXLoaderRequest that dispatches an event when it is done, and can be given
+ * a priority or cancelled while it is underway.
+ *
+ * The queue must only be used from the main thread. Modifiers and options
+ * given to a request are used on a worker thread.
+ *
+ * **Example:**
+ *	PXLoaderQueue *queue = [PXLoaderQueue sharedQueue];
+ *
+ *	PXLoaderRequest *request = [queue loadContentsOfFile:@"music.caf"
+ *	                                         loaderClass:[PXSoundLoader class]
+ *	                                             options:nil
+ *	                                            priority:PXLoaderPriority_Low];
+ *	[request addEventListenerOfType:PXEvent_Complete listener:PXListener(onMusicLoaded:)];
+ */
+@implementation PXLoaderQueue
+
+@synthesize uploadTimeBudget;
+
+- (id) init
+{
+	return [self initWithThreadCount:2];
+}
+
+/**
+ * Makes a new queue.
+ *
+ * @param threadCount The number of worker threads that load and parse.
+ */
+- (id) initWithThreadCount:(unsigned)threadCount
+{
+	self = [super init];
+
+	if (self)
+	{
+		operationQueue = [[NSOperationQueue alloc] init];
+		operationQueue.maxConcurrentOperationCount = MAX(threadCount, 1);
+
+		requests = [[PXLinkedList alloc] init];
+		uploadRequests = [[PXLinkedList alloc] init];
+
+		uploadTimeBudget = 0.004f;
+
+		if (!pxLoaderQueues)
+		{
+			pxLoaderQueues = [[PXLinkedList alloc] initWithWeakReferences:YES];
+		}
+
+		[pxLoaderQueues addObject:self];
+	}
+
+	return self;
+}
+
+- (void) dealloc
+{
+	[pxLoaderQueues removeObject:self];
+
+	[self cancelAllRequests];
+
+	[operationQueue release];
+	operationQueue = nil;
+
+	[requests release];
+	requests = nil;
+	[uploadRequests release];
+	uploadRequests = nil;
+
+	[super dealloc];
+}
+
+#pragma mark -
+#pragma mark Properties
+
+- (unsigned) threadCount
+{
+	return operationQueue.maxConcurrentOperationCount;
+}
+
+#pragma mark -
+#pragma mark Methods
+
+/**
+ * Loads a file in the background.
+ *
+ * @param path The path of the file to load, as given to the loader.
+ * @param loaderClass The #PXLoader subclass to load the file with.
+ * @param options The modifier for a #PXTextureLoader or #PXSoundLoader
+ * (`nil` uses the default modifier), the #PXFontOptions for a
+ * #PXFontLoader.
+ * @param priority Requests with a higher priority are loaded and uploaded
+ * first.
+ *
+ * @return The request, `autoreleased`. The queue keeps it until it finishes.
+ */
+- (PXLoaderRequest *)loadContentsOfFile:(NSString *)path
+							loaderClass:(Class)loaderClass
+								options:(id)options
+							   priority:(PXLoaderPriority)priority
+{
+	return [self loadContentsOfFile:path orURL:nil loaderClass:loaderClass options:options priority:priority];
+}
+
+/**
+ * Loads the contents of a url in the background.
+ *
+ * @param url The url to load.
+ * @param loaderClass The #PXLoader subclass to load the file with.
+ * @param options The modifier for a #PXTextureLoader or #PXSoundLoader
+ * (`nil` uses the default modifier), the #PXFontOptions for a
+ * #PXFontLoader.
+ * @param priority Requests with a higher priority are loaded and uploaded
+ * first.
+ *
+ * @return The request, `autoreleased`. The queue keeps it until it finishes.
+ */
+- (PXLoaderRequest *)loadContentsOfURL:(NSURL *)url
+						   loaderClass:(Class)loaderClass
+							   options:(id)options
+							  priority:(PXLoaderPriority)priority
+{
+	return [self loadContentsOfFile:nil orURL:url loaderClass:loaderClass options:options priority:priority];
+}
+
+/**
+ * Cancels every request that hasn't finished yet.
+ */
+- (void) cancelAllRequests
+{
+	// Cancelling removes the request from the list, and the cancel events can
+	// make new requests.
+	PXLinkedList *list = [[PXLinkedList alloc] initWithLinkedList:requests];
+
+	PXLoaderRequest *request = nil;
+	PXLinkedListForEach(list, request)
+	{
+		[request cancel];
+	}
+
+	[list release];
+}
+
+#pragma mark -
+#pragma mark Private Methods
+
+- (PXLoaderRequest *)loadContentsOfFile:(NSString *)path
+								  orURL:(NSURL *)url
+							loaderClass:(Class)loaderClass
+								options:(id)options
+							   priority:(PXLoaderPriority)priority
+{
+	if (!path && !url)
+		return nil;
+
+	if (![loaderClass isSubclassOfClass:[PXLoader class]])
+	{
+		PXDebugLog(@"PXLoaderQueue can only load with a PXLoader subclass\n");
+		return nil;
+	}
+
+	PXLoaderRequest *request = [[PXLoaderRequest alloc] _initWithQueue:self
+														   loaderClass:loaderClass
+																  path:path
+																   url:url
+															   options:options
+															  priority:priority];
+
+	[requests addObject:request];
+	[operationQueue addOperation:[request _operation]];
+
+	return [request autorelease];
+}
+
+- (void) _requestLoaded:(PXLoaderRequest *)request
+{
+	[self addUploadRequest:request];
+}
+
+- (void) _requestFinished:(PXLoaderRequest *)request
+{
+	[uploadRequests removeObject:request];
+	[requests removeObject:request];
+}
+
+- (void) _requestPriorityChanged:(PXLoaderRequest *)request
+{
+	[request retain];
+	[uploadRequests removeObject:request];
+	[self addUploadRequest:request];
+	[request release];
+}
+
+// Keeps the upload list sorted by priority. Requests of the same priority
+// are uploaded in the order they were loaded.
+- (void) addUploadRequest:(PXLoaderRequest *)request
+{
+	int index = 0;
+
+	PXLoaderRequest *other = nil;
+	PXLinkedListForEach(uploadRequests, other)
+	{
+		if (other.priority < request.priority)
+			break;
+
+		++index;
+	}
+
+	[uploadRequests insertObject:request atIndex:index];
+}
+
+- (BOOL) hasUploads
+{
+	return uploadRequests.count > 0;
+}
+
+- (void) upload
+{
+	if (uploadRequests.count == 0)
+		return;
+
+	// A complete event may release the queue.
+	[self retain];
+
+	NSTimeInterval start = [NSDate timeIntervalSinceReferenceDate];
+
+	// At least one upload is done every frame, however large.
+	do
+	{
+		PXLoaderRequest *request = uploadRequests.firstObject;
+
+		// This takes the request off of the list.
+		[request _upload];
+	} while (uploadRequests.count > 0 &&
+			 [NSDate timeIntervalSinceReferenceDate] - start < uploadTimeBudget);
+
+	[self release];
+}
+
+#pragma mark -
+#pragma mark Static Methods
+
+/**
+ * A queue with one worker thread per processor, made the first time it is
+ * asked for.
+ */
++ (PXLoaderQueue *)sharedQueue
+{
+	if (!pxLoaderQueueShared)
+	{
+		unsigned threadCount = [[NSProcessInfo processInfo] activeProcessorCount];
+		pxLoaderQueueShared = [[PXLoaderQueue alloc] initWithThreadCount:threadCount];
+	}
+
+	return pxLoaderQueueShared;
+}
+
+@end
+
+void PXLoaderQueueUpdate()
+{
+	// Most frames have nothing to upload, so don't copy the list for them.
+	BOOL hasUploads = NO;
+
+	PXLoaderQueue *queue = nil;
+	PXLinkedListForEach(pxLoaderQueues, queue)
+	{
+		if ([queue hasUploads])
+		{
+			hasUploads = YES;
+			break;
+		}
+	}
+
+	if (!hasUploads)
+		return;
+
+	// Events dispatched while uploading can make or release queues, so they
+	// are held onto for the loop.
+	PXLinkedList *queues = [[PXLinkedList alloc] init];
+	[queues addObjectsFromList:pxLoaderQueues];
+
+	PXLinkedListForEach(queues, queue)
+	{
+		[queue upload];
+	}
+
+	[queues release];
+}
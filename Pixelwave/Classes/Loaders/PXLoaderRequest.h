@@ -0,0 +1,123 @@
+/*
+ *  _____                       ___                                            
+ * /\  _ `\  __                /\_ \                                           
+ * \ \ \L\ \/\_\   __  _    ___\//\ \    __  __  __    ___     __  __    ___   
+ *  \ \  __/\/\ \ /\ \/ \  / __`\\ \ \  /\ \/\ \/\ \  / __`\  /\ \/\ \  / __`\ 
+ *   \ \ \/  \ \ \\/>  </ /\  __/ \_\ \_\ \ \_/ \_/ \/\ \L\ \_\ \ \_/ |/\  __/ 
+ *    \ \_\   \ \_\/\_/\_\\ \____\/\____\\ \___^___ /\ \__/|\_\\ \___/ \ \____\
+ *     \/_/    \/_/\//\/_/ \/____/\/____/ \/__//__ /  \/__/\/_/ \/__/   \/____/
+ *       
+ *           www.pixelwave.org + www.spiralstormgames.com
+ *                            ~;   
+ *                           ,/|\.           
+ *                         ,/  |\ \.                 Core Team: Oz Michaeli
+ *                       ,/    | |  \                           John Lattin
+ *                     ,/      | |   |
+ *                   ,/        |/    |
+ *                 ./__________|----'  .
+ *            ,(   ___.....-,~-''-----/   ,(            ,~            ,(        
+ * _.-~-.,.-'`  `_.\,.',.-'`  )_.-~-./.-'`  `_._,.',.-'`  )_.-~-.,.-'`  `_._._,.
+ * 
+ * Copyright (c) 2011 Spiralstorm Games http://www.spiralstormgames.com
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#import "PXEventDispatcher.h"
+
+@class PXLoader;
+@class PXLoaderQueue;
+
+typedef enum
+{
+	PXLoaderPriority_Low = -1,
+	PXLoaderPriority_Normal = 0,
+	PXLoaderPriority_High = 1
+} PXLoaderPriority;
+
+typedef enum
+{
+	// Waiting for, or being loaded and parsed on, a worker thread.
+	PXLoaderRequestState_Loading = 0,
+	// Parsed, waiting for its turn to be uploaded on the main thread.
+	PXLoaderRequestState_Uploading,
+	PXLoaderRequestState_Complete,
+	PXLoaderRequestState_Failed,
+	PXLoaderRequestState_Cancelled
+} PXLoaderRequestState;
+
+@interface PXLoaderRequest : PXEventDispatcher
+{
+@private
+	PXLoaderQueue *queue;
+	NSOperation *operation;
+
+	Class loaderClass;
+	NSString *path;
+	NSURL *url;
+
+	// Resolved on the main thread when the request is made, so the worker
+	// thread doesn't have to touch any shared state.
+	NSString *resolvedPath;
+	float contentScaleFactor;
+	id options;
+
+	PXLoaderPriority priority;
+	PXLoaderRequestState state;
+
+	PXLoader *loader;
+	id result;
+}
+
+/**
+ * The class of loader used, such as #PXTextureLoader.
+ */
+@property (nonatomic, readonly) Class loaderClass;
+/**
+ * The path or url being loaded.
+ */
+@property (nonatomic, readonly) NSString *origin;
+/**
+ * Requests with a higher priority are loaded and uploaded first. It can be
+ * changed until the request completes.
+ *
+ * **Default:** `PXLoaderPriority_Normal`
+ */
+@property (nonatomic) PXLoaderPriority priority;
+@property (nonatomic, readonly) PXLoaderRequestState state;
+/**
+ * The loaded object once the request is complete: a #PXTextureData for a
+ * #PXTextureLoader, a #PXSound for a #PXSoundLoader, a #PXFont for a
+ * #PXFontLoader, and the loaded NSData for a plain #PXLoader.
+ */
+@property (nonatomic, readonly) id result;
+
+- (void) cancel;
+
+@end
+
+@interface PXLoaderRequest(PrivateButPublic)
+- (id) _initWithQueue:(PXLoaderQueue *)queue
+		  loaderClass:(Class)loaderClass
+				 path:(NSString *)path
+				  url:(NSURL *)url
+			  options:(id)options
+			 priority:(PXLoaderPriority)priority;
+
+- (NSOperation *)_operation;
+- (void) _upload;
+@end
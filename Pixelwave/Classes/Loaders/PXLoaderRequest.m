@@ -0,0 +1,313 @@
+/*
+ *  _____                       ___                                            
+ * /\  _ `\  __                /\_ \                                           
+ * \ \ \L\ \/\_\   __  _    ___\//\ \    __  __  __    ___     __  __    ___   
+ *  \ \  __/\/\ \ /\ \/ \  / __`\\ \ \  /\ \/\ \/\ \  / __`\  /\ \/\ \  / __`\ 
+ *   \ \ \/  \ \ \\/>  </ /\  __/ \_\ \_\ \ \_/ \_/ \/\ \L\ \_\ \ \_/ |/\  __/ 
+ *    \ \_\   \ \_\/\_/\_\\ \____\/\____\\ \___^___ /\ \__/|\_\\ \___/ \ \____\
+ *     \/_/    \/_/\//\/_/ \/____/\/____/ \/__//__ /  \/__/\/_/ \/__/   \/____/
+ *       
+ *           www.pixelwave.org + www.spiralstormgames.com
+ *                            ~;   
+ *                           ,/|\.           
+ *                         ,/  |\ \.                 Core Team: Oz Michaeli
+ *                       ,/    | |  \                           John Lattin
+ *                     ,/      | |   |
+ *                   ,/        |/    |
+ *                 ./__________|----'  .
+ *            ,(   ___.....-,~-''-----/   ,(            ,~            ,(        
+ * _.-~-.,.-'`  `_.\,.',.-'`  )_.-~-./.-'`  `_._,.',.-'`  )_.-~-.,.-'`  `_._._,.
+ * 
+ * Copyright (c) 2011 Spiralstorm Games http://www.spiralstormgames.com
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#import "PXLoaderRequest.h"
+
+#import "PXLoader.h"
+#import "PXLoaderQueue.h"
+#import "PXEvent.h"
+
+#import "PXDebug.h"
+
+@interface PXLoaderRequest(Private)
+- (void) loadInBackground;
+- (void) loadedWithLoader:(PXLoader *)loader;
+- (void) finishWithState:(PXLoaderRequestState)state;
+@end
+
+/**
+ * A PXLoaderRequest follows a single asynchronous load made by a
+ * #PXLoaderQueue.
+ *
+ * The file is read and parsed on one of the queue's worker threads. The
+ * steps before and after it run on the main thread: finding the file and
+ * picking the default options when the request is made (which read the
+ * engine's shared state), and creating the texture, sound or font from the
+ * parsed data (which has to talk to GL or AL), a few each frame.
+ *
+ * Once that is done the request dispatches a `PXEvent_Complete` event and
+ * #result holds the loaded object. If the file couldn't be loaded or parsed
+ * a `PXEvent_Error` event is dispatched instead, and `PXEvent_Cancel` if the
+ * request was cancelled. Events are always dispatched on the main thread.
+ *
+ * **Example:**
+ *	PXLoaderRequest *request = [PXTextureLoader loadAsyncWithContentsOfFile:@"level2.png"
+ *	                                                                options:nil
+ *	                                                               priority:PXLoaderPriority_Normal];
+ *	[request addEventListenerOfType:PXEvent_Complete listener:PXListener(onTextureLoaded:)];
+ *
+ *	...
+ *
+ *	- (void) onTextureLoaded:(PXEvent *)event
+ *	{
+ *		PXLoaderRequest *request = event.target;
+ *
+ *		PXTexture *texture = [PXTexture textureWithTextureData:request.result];
+ *		[self addChild:texture];
+ *	}
+ */
+@implementation PXLoaderRequest
+
+@synthesize loaderClass;
+@synthesize priority;
+@synthesize state;
+@synthesize result;
+
+- (id) init
+{
+	PXDebugLog(@"PXLoaderRequest must be made by a PXLoaderQueue");
+	[self release];
+	return nil;
+}
+
+- (id) _initWithQueue:(PXLoaderQueue *)_queue
+		  loaderClass:(Class)_loaderClass
+				 path:(NSString *)_path
+				  url:(NSURL *)_url
+			  options:(id)_options
+			 priority:(PXLoaderPriority)_priority
+{
+	self = [super init];
+
+	if (self)
+	{
+		// The queue keeps its requests until they finish, not the other way
+		// around.
+		queue = _queue;
+
+		loaderClass = _loaderClass;
+		path = [_path copy];
+		url = [_url copy];
+
+		// A file that can't be found leaves no path or url for the worker
+		// thread, and the request fails once it runs.
+		contentScaleFactor = 1.0f;
+		if (path)
+		{
+			resolvedPath = [[loaderClass _resolvePath:path contentScaleFactor:&contentScaleFactor] copy];
+		}
+
+		options = [[loaderClass _resolveOptions:_options] retain];
+
+		state = PXLoaderRequestState_Loading;
+
+		loader = nil;
+		result = nil;
+
+		// The operation retains the request until it has run.
+		operation = [[NSInvocationOperation alloc] initWithTarget:self
+														 selector:@selector(loadInBackground)
+														   object:nil];
+
+		self.priority = _priority;
+	}
+
+	return self;
+}
+
+- (void) dealloc
+{
+	[operation release];
+	operation = nil;
+
+	[path release];
+	path = nil;
+	[url release];
+	url = nil;
+	[resolvedPath release];
+	resolvedPath = nil;
+	[options release];
+	options = nil;
+
+	[loader release];
+	loader = nil;
+	[result release];
+	result = nil;
+
+	[super dealloc];
+}
+
+#pragma mark -
+#pragma mark Properties
+
+- (NSString *)origin
+{
+	if (path)
+		return path;
+
+	return [url absoluteString];
+}
+
+- (void) setPriority:(PXLoaderPriority)val
+{
+	priority = val;
+
+	if (state == PXLoaderRequestState_Loading)
+	{
+		NSOperationQueuePriority queuePriority = NSOperationQueuePriorityNormal;
+
+		if (priority > PXLoaderPriority_Normal)
+			queuePriority = NSOperationQueuePriorityHigh;
+		else if (priority < PXLoaderPriority_Normal)
+			queuePriority = NSOperationQueuePriorityLow;
+
+		// This has no effect once the operation has started.
+		operation.queuePriority = queuePriority;
+	}
+	else if (state == PXLoaderRequestState_Uploading)
+	{
+		[queue _requestPriorityChanged:self];
+	}
+}
+
+#pragma mark -
+#pragma mark Methods
+
+/**
+ * Stops the request. Work already underway on a worker thread runs to the end
+ * but its result is thrown away. Has no effect once the request is complete or
+ * has failed.
+ */
+- (void) cancel
+{
+	if (state == PXLoaderRequestState_Loading)
+	{
+		[operation cancel];
+	}
+	else if (state != PXLoaderRequestState_Uploading)
+	{
+		return;
+	}
+
+	[self finishWithState:PXLoaderRequestState_Cancelled];
+}
+
+- (NSOperation *)_operation
+{
+	return operation;
+}
+
+// Called by the queue on the main thread, once the request's turn comes.
+- (void) _upload
+{
+	result = [loader _newLoadedObject];
+
+	[self finishWithState:(result ? PXLoaderRequestState_Complete : PXLoaderRequestState_Failed)];
+}
+
+#pragma mark -
+#pragma mark Private Methods
+
+// Runs on a worker thread. Only the immutable members may be touched here.
+- (void) loadInBackground
+{
+	NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+
+	PXLoader *newLoader = [loaderClass _newLoaderWithResolvedPath:resolvedPath
+															orURL:url
+														  options:options
+											   contentScaleFactor:contentScaleFactor];
+
+	[self performSelectorOnMainThread:@selector(loadedWithLoader:) withObject:newLoader waitUntilDone:NO];
+	[newLoader release];
+
+	[pool release];
+}
+
+- (void) loadedWithLoader:(PXLoader *)newLoader
+{
+	// The operation is done with us.
+	[operation release];
+	operation = nil;
+
+	// If the request was cancelled while it was loading, the work is thrown
+	// away.
+	if (state != PXLoaderRequestState_Loading)
+		return;
+
+	if (!newLoader)
+	{
+		[self finishWithState:PXLoaderRequestState_Failed];
+		return;
+	}
+
+	loader = [newLoader retain];
+	state = PXLoaderRequestState_Uploading;
+
+	[queue _requestLoaded:self];
+}
+
+- (void) finishWithState:(PXLoaderRequestState)newState
+{
+	// The queue lets go of the request below, but it has to live through the
+	// event.
+	[self retain];
+
+	state = newState;
+
+	[operation release];
+	operation = nil;
+
+	// The parsed data isn't needed anymore, and can be large.
+	[loader release];
+	loader = nil;
+
+	[queue _requestFinished:self];
+	queue = nil;
+
+	NSString *type = PXEvent_Complete;
+
+	if (state == PXLoaderRequestState_Failed)
+	{
+		PXDebugLog(@"[%@] asynchronous load failed.\n", self.origin);
+		type = PXEvent_Error;
+	}
+	else if (state == PXLoaderRequestState_Cancelled)
+	{
+		type = PXEvent_Cancel;
+	}
+
+	PXEvent *event = [[PXEvent alloc] initWithType:type bubbles:NO cancelable:NO];
+	[self dispatchEvent:event];
+	[event release];
+
+	[self release];
+}
+
+@end
@@ -245,6 +245,27 @@ id<PXSoundModifier> pxSoundLoaderDefaultModifier = nil;
 	return [soundParser newSound];
 }
 
++ (id) _resolveOptions:(id)options
+{
+	if (!options)
+		options = [PXSoundLoader defaultModifier];
+
+	return options;
+}
+
++ (id) _newLoaderWithResolvedPath:(NSString *)path
+							orURL:(NSURL *)url
+						  options:(id)options
+			   contentScaleFactor:(float)contentScaleFactor
+{
+	return [[self alloc] initWithContentsOfFile:path orURL:url modifier:options];
+}
+
+- (id) _newLoadedObject
+{
+	return [self newSound];
+}
+
 + (void) setDefaultModifier:(id<PXSoundModifier>)modifier
 {
 	id<PXSoundModifier> temp = [modifier retain];
@@ -0,0 +1,441 @@
+/*
+ *  _____                       ___                                            
+ * /\  _ `\  __                /\_ \                                           
+ * \ \ \L\ \/\_\   __  _    ___\//\ \    __  __  __    ___     __  __    ___   
+ *  \ \  __/\/\ \ /\ \/ \  / __`\\ \ \  /\ \/\ \/\ \  / __`\  /\ \/\ \  / __`\ 
+ *   \ \ \/  \ \ \\/>  </ /\  __/ \_\ \_\ \ \_/ \_/ \/\ \L\ \_\ \ \_/ |/\  __/ 
+ *    \ \_\   \ \_\/\_/\_\\ \____\/\____\\ \___^___ /\ \__/|\_\\ \___/ \ \____\
+ *     \/_/    \/_/\//\/_/ \/____/\/____/ \/__//__ /  \/__/\/_/ \/__/   \/____/
+ *       
+ *           www.pixelwave.org + www.spiralstormgames.com
+ *                            ~;   
+ *                           ,/|\.           
+ *                         ,/  |\ \.                 Core Team: Oz Michaeli
+ *                       ,/    | |  \                           John Lattin
+ *                     ,/      | |   |
+ *                   ,/        |/    |
+ *                 ./__________|----'  .
+ *            ,(   ___.....-,~-''-----/   ,(            ,~            ,(        
+ * _.-~-.,.-'`  `_.\,.',.-'`  )_.-~-./.-'`  `_._,.',.-'`  )_.-~-.,.-'`  `_._._,.
+ * 
+ * Copyright (c) 2011 Spiralstorm Games http://www.spiralstormgames.com
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#import "PXTextureCache.h"
+
+#import "PXDebug.h"
+
+#import "PXTextureData.h"
+#import "PXTextureParser.h"
+#import "PXTextureModifier.h"
+
+#include "PXPXTFormat.h"
+#include "PXPrivateUtils.h"
+
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+// Bump this whenever parsing or modifying changes what bytes come out, so
+// that nothing made by the old code gets used.
+#define PX_TEXTURE_CACHE_VERSION 1
+
+BOOL pxTextureCacheEnabled = NO;
+unsigned pxTextureCacheSizeLimit = 32 * 1024 * 1024;
+
+typedef struct
+{
+	char *path;
+	off_t byteCount;
+	time_t lastUsed;
+} PXTextureCacheEntry;
+
+PXInline uint64_t PXTextureCacheHash(uint64_t hash, const void *bytes, size_t byteCount);
+PXInline int PXTextureCacheEntryCompare(const void *entryA, const void *entryB);
+
+/**
+ * A PXTextureCache keeps the textures made by #PXTextureLoader on disk, after
+ * they have been parsed and modified, so that later loads of the same file
+ * (in this launch, or the next) skip decoding and converting it entirely. The
+ * cached copy is a .pxt file, which is uploaded straight out of memory mapped
+ * from disk.
+ *
+ * Entries are found by a hash of the contents of the source file, along with
+ * its path, the modifier (its class, and its `cacheKey` if it has
+ * one) and the content scale factor. A source file which changes gets a new
+ * entry, and the old one is removed. When the cache grows past its size
+ * limit, the entries which were used longest ago are removed.
+ *
+ * The cache lives in the application's Caches directory, which iOS may
+ * clear at any time; that only costs a slower load.
+ *
+ * **Example:**
+ *	// Somewhere before loading any textures.
+ *	[PXTextureCache setEnabled:YES];
+ *	[PXTextureCache setSizeLimit:16 * 1024 * 1024];
+ *
+ *	// The first launch parses the png and converts it to 565; every launch
+ *	// after that reads the 565 texture from the cache.
+ *	PXTextureLoader *textureLoader = [[PXTextureLoader alloc] initWithContentsOfFile:@"background.png"
+ *	                                                                        modifier:[PXTextureModifiers textureModifierToPixelFormat:PXTextureDataPixelFormat_RGB565]];
+ *	PXTextureData *textureData = [textureLoader newTextureData];
+ */
+@implementation PXTextureCache
+
+/**
+ * Sets whether #PXTextureLoader uses the cache.
+ *
+ * **Default:** `NO`
+ */
++ (void) setEnabled:(BOOL)enabled
+{
+	pxTextureCacheEnabled = enabled;
+}
++ (BOOL) enabled
+{
+	return pxTextureCacheEnabled;
+}
+
+/**
+ * Sets how many bytes the cache may take on disk.
+ *
+ * **Default:** 32MB
+ */
++ (void) setSizeLimit:(unsigned)sizeLimit
+{
+	pxTextureCacheSizeLimit = sizeLimit;
+}
++ (unsigned) sizeLimit
+{
+	return pxTextureCacheSizeLimit;
+}
+
+/**
+ * The directory the cached textures are kept in.
+ */
++ (NSString *)directory
+{
+	NSArray *paths = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES);
+
+	if ([paths count] == 0)
+	{
+		return nil;
+	}
+
+	return [[paths objectAtIndex:0] stringByAppendingPathComponent:@"Pixelwave/Textures"];
+}
+
+/**
+ * Removes every cached texture.
+ */
++ (void) removeAllEntries
+{
+	@synchronized(self)
+	{
+		NSString *directory = [PXTextureCache directory];
+
+		if (directory)
+		{
+			NSFileManager *manager = [[NSFileManager alloc] init];
+			[manager removeItemAtPath:directory error:nil];
+			[manager release];
+		}
+	}
+}
+
+@end
+
+@implementation PXTextureCache(PrivateButPublic)
+
+/*
+ * Where the texture made from the given data, with the given modifier, is (or
+ * would be) kept. The file is named by two hashes: the first of everything
+ * but the data, so all of the entries for a file can be found, and the second
+ * of the data.
+ */
++ (NSString *)_pathForData:(NSData *)data
+					origin:(NSString *)origin
+				  modifier:(id<PXTextureModifier>)modifier
+		contentScaleFactor:(float)contentScaleFactor
+{
+	NSString *directory = [PXTextureCache directory];
+
+	if (!data || !directory)
+	{
+		return nil;
+	}
+
+	NSString *modifierKey = @"";
+
+	if (modifier)
+	{
+		modifierKey = NSStringFromClass([modifier class]);
+
+		if ([modifier respondsToSelector:@selector(cacheKey)])
+		{
+			modifierKey = [modifierKey stringByAppendingFormat:@":%@", [modifier cacheKey]];
+		}
+	}
+
+	NSString *key = [NSString stringWithFormat:@"%d|%@|%@|%f", PX_TEXTURE_CACHE_VERSION, origin, modifierKey, contentScaleFactor];
+	const char *keyString = [key UTF8String];
+
+	// The FNV-1a offset basis.
+	const uint64_t seed = 0xCBF29CE484222325ULL;
+
+	uint64_t keyHash = PXTextureCacheHash(seed, keyString, strlen(keyString));
+
+	NSUInteger length = [data length];
+	uint64_t dataHash = PXTextureCacheHash(seed ^ length, [data bytes], length);
+
+	NSString *fileName = [NSString stringWithFormat:@"%016llx-%016llx.pxt", keyHash, dataHash];
+	return [directory stringByAppendingPathComponent:fileName];
+}
+
+/*
+ * Maps the cached texture at the given path into memory, and marks it as just
+ * used. Returns nil if there isn't one.
+ */
++ (NSData *)_newDataAtPath:(NSString *)path
+{
+	if (!path)
+	{
+		return nil;
+	}
+
+	NSData *data = [[NSData alloc] initWithContentsOfFile:path options:NSMappedRead error:nil];
+
+	if (data)
+	{
+		// The modification time is when the entry was last used.
+		utimes([path fileSystemRepresentation], NULL);
+	}
+
+	return data;
+}
+
+/*
+ * Writes what the parser would upload to the given path as a .pxt file, then
+ * removes any older entries for the same file, and as many of the least
+ * recently used entries as it takes to get back under the size limit.
+ */
++ (void) _storeTextureParser:(PXTextureParser *)textureParser atPath:(NSString *)path
+{
+	PXParsedTextureData *textureData = [textureParser _uploadedTextureData];
+
+	// PVR data isn't kept by its parser, and is fast to load anyhow.
+	if (!path || !textureData || !(textureData->bytes) || textureData->byteCount == 0)
+	{
+		return;
+	}
+
+	// Done now rather than on upload, as the cached copy can't be changed.
+	if ([PXTextureData expandEdges])
+	{
+		[textureParser _expandEdges:textureData];
+	}
+
+	CGSize contentSize = [textureParser _contentSize];
+
+	PXPXTHeader header;
+	memcpy(header.tag, PX_PXT_TAG, 4);
+	header.version       = CFSwapInt32HostToLittle(PX_PXT_VERSION);
+	header.headerLength  = CFSwapInt32HostToLittle(sizeof(PXPXTHeader));
+	header.pixelFormat   = CFSwapInt32HostToLittle(textureData->pixelFormat);
+	header.width         = CFSwapInt32HostToLittle(textureData->size.width);
+	header.height        = CFSwapInt32HostToLittle(textureData->size.height);
+	header.contentWidth  = CFSwapInt32HostToLittle(contentSize.width);
+	header.contentHeight = CFSwapInt32HostToLittle(contentSize.height);
+	header.flags         = CFSwapInt32HostToLittle(textureData->premultiplied ? PXPXTFlag_Premultiplied : 0);
+	header.mipmapCount   = CFSwapInt32HostToLittle(1);
+	header.dataLength    = CFSwapInt32HostToLittle(textureData->byteCount);
+
+	@synchronized(self)
+	{
+		NSString *directory = [path stringByDeletingLastPathComponent];
+
+		NSFileManager *manager = [[NSFileManager alloc] init];
+		[manager createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:nil];
+
+		// Written next to the entry and then renamed over it, so that a
+		// half written entry is never read.
+		NSString *tempPath = [path stringByAppendingPathExtension:@"tmp"];
+		FILE *file = fopen([tempPath fileSystemRepresentation], "wb");
+
+		if (file)
+		{
+			BOOL success = (fwrite(&header, sizeof(PXPXTHeader), 1, file) == 1 &&
+							fwrite(textureData->bytes, textureData->byteCount, 1, file) == 1);
+
+			if (fclose(file) == 0 && success)
+			{
+				rename([tempPath fileSystemRepresentation], [path fileSystemRepresentation]);
+			}
+			else
+			{
+				PXDebugLog(@"Couldn't write the texture cache entry [%@].\n", path);
+				remove([tempPath fileSystemRepresentation]);
+			}
+		}
+
+		NSArray *fileNames = [manager contentsOfDirectoryAtPath:directory error:nil];
+		[manager release];
+
+		// Everything before the '-' is the same for every entry of this file.
+		NSString *fileName = [path lastPathComponent];
+		NSString *keyPrefix = [fileName substringToIndex:[fileName rangeOfString:@"-"].location + 1];
+
+		PXTextureCacheEntry *entries = malloc(sizeof(PXTextureCacheEntry) * [fileNames count]);
+		unsigned entryCount = 0;
+		off_t byteCount = 0;
+
+		struct stat fileStat;
+
+		for (NSString *entryName in fileNames)
+		{
+			if (![[entryName pathExtension] isEqualToString:@"pxt"])
+			{
+				continue;
+			}
+
+			const char *entryPath = [[directory stringByAppendingPathComponent:entryName] fileSystemRepresentation];
+
+			// An entry made from an older version of the file.
+			if ([entryName hasPrefix:keyPrefix] && ![entryName isEqualToString:fileName])
+			{
+				remove(entryPath);
+				continue;
+			}
+
+			if (!entries || stat(entryPath, &fileStat) != 0)
+			{
+				continue;
+			}
+
+			entries[entryCount].path = strdup(entryPath);
+			entries[entryCount].byteCount = fileStat.st_size;
+			entries[entryCount].lastUsed = fileStat.st_mtime;
+			byteCount += fileStat.st_size;
+			++entryCount;
+		}
+
+		if (byteCount > pxTextureCacheSizeLimit)
+		{
+			qsort(entries, entryCount, sizeof(PXTextureCacheEntry), PXTextureCacheEntryCompare);
+
+			unsigned index;
+			for (index = 0; index < entryCount && byteCount > pxTextureCacheSizeLimit; ++index)
+			{
+				remove(entries[index].path);
+				byteCount -= entries[index].byteCount;
+			}
+		}
+
+		unsigned index;
+		for (index = 0; index < entryCount; ++index)
+		{
+			free(entries[index].path);
+		}
+
+		free(entries);
+	}
+}
+
+/*
+ * Parses the entry at the given path, and checks that it makes a texture with
+ * the same properties (size, content size, pixel format and whether it is
+ * premultiplied) as the parser it was stored from. A cached load has to look
+ * no different from an uncached one. If the entry doesn't match, it is
+ * removed and NO is returned.
+ */
++ (BOOL) _entryAtPath:(NSString *)path matchesTextureParser:(PXTextureParser *)textureParser
+{
+	NSData *data = [PXTextureCache _newDataAtPath:path];
+
+	if (!data)
+	{
+		// Nothing was stored, which is fine.
+		return YES;
+	}
+
+	PXTextureParser *cachedTextureParser = [[PXTextureParser alloc] initWithData:data modifier:nil origin:path];
+	[data release];
+
+	PXParsedTextureData *textureData = [textureParser _uploadedTextureData];
+	PXParsedTextureData *cachedTextureData = [cachedTextureParser _uploadedTextureData];
+
+	CGSize contentSize = [textureParser _contentSize];
+	CGSize cachedContentSize = [cachedTextureParser _contentSize];
+
+	BOOL matches = (cachedTextureData &&
+					CGSizeEqualToSize(textureData->size, cachedTextureData->size) &&
+					CGSizeEqualToSize(contentSize, cachedContentSize) &&
+					textureData->pixelFormat == cachedTextureData->pixelFormat &&
+					textureData->premultiplied == cachedTextureData->premultiplied);
+
+	if (!matches)
+	{
+		PXDebugLog(@"The texture cache entry [%@] doesn't match the texture it was made from, removing it.\n", path);
+
+		@synchronized(self)
+		{
+			remove([path fileSystemRepresentation]);
+		}
+	}
+
+	[cachedTextureParser release];
+
+	return matches;
+}
+
+@end
+
+/*
+ * FNV-1a, taken eight bytes at a time. It only has to tell files apart, not
+ * stand up to anyone trying to make two collide, and every source file goes
+ * through it on every load.
+ */
+PXInline uint64_t PXTextureCacheHash(uint64_t hash, const void *bytes, size_t byteCount)
+{
+	const uint64_t prime = 0x100000001B3ULL;
+	const uint8_t *byte = bytes;
+	uint64_t word;
+
+	for (; byteCount >= 8; byteCount -= 8, byte += 8)
+	{
+		memcpy(&word, byte, 8);
+		hash = (hash ^ word) * prime;
+	}
+
+	for (; byteCount > 0; --byteCount, ++byte)
+	{
+		hash = (hash ^ *byte) * prime;
+	}
+
+	return hash;
+}
+
+// Least recently used first.
+PXInline int PXTextureCacheEntryCompare(const void *entryA, const void *entryB)
+{
+	time_t lastUsedA = ((const PXTextureCacheEntry *)entryA)->lastUsed;
+	time_t lastUsedB = ((const PXTextureCacheEntry *)entryB)->lastUsed;
+
+	return (lastUsedA < lastUsedB) ? -1 : ((lastUsedA > lastUsedB) ? 1 : 0);
+}
@@ -51,6 +51,11 @@
 	PXTextureParser *textureParser;
 
 	float contentScaleFactor;
+
+	// Set when the parser was made from a #PXTextureCache entry, which has
+	// already been modified.
+	BOOL parsedFromCache;
+	id<PXTextureModifier> cachedModifier;
 }
 
 /**
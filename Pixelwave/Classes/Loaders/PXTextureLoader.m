@@ -46,6 +46,7 @@
 #import "PXTextureParser.h"
 
 #import "PXTextureModifier.h"
+#import "PXTextureCache.h"
 
 id<PXTextureModifier> pxTextureLoaderDefaultModifier = nil;
 
@@ -53,7 +54,11 @@ id<PXTextureModifier> pxTextureLoaderDefaultModifier = nil;
 - (id) initWithContentsOfFile:(NSString *)path
 						orURL:(NSURL *)url
 					modifier:(id<PXTextureModifier>)_modifier;
-- (NSString *)updatePath:(NSString *)path;
+- (id) initWithResolvedPath:(NSString *)path
+					  orURL:(NSURL *)url
+				   modifier:(id<PXTextureModifier>)modifier
+		 contentScaleFactor:(float)contentScaleFactor;
+- (NSString *)cachePathForModifier:(id<PXTextureModifier>)modifier;
 @end
 
 /**
@@ -85,6 +90,8 @@ id<PXTextureModifier> pxTextureLoaderDefaultModifier = nil;
  * - .png (uses libpng)
  * - .pvr
  * - .pvrtc
+ * - .pxt (made offline from a png by Tools/TextureConverter, and uploaded
+ * without being decoded)
  *
  * **Example**:
  * The following code sample loads a png file and renders it to the screen:
@@ -222,30 +229,41 @@ id<PXTextureModifier> pxTextureLoaderDefaultModifier = nil;
 	return [self initWithContentsOfFile:nil orURL:url modifier:_modifier];
 }
 
-#pragma mark Designated Initializer
-
 - (id) initWithContentsOfFile:(NSString *)path
 						orURL:(NSURL *)url
 					modifier:(id<PXTextureModifier>)modifier
 {
-	self = [super _initWithContentsOfFile:path orURL:url];
+	float scaleFactor = 1.0f;
 
-	if (self)
+	if (path)
 	{
-		// Initialize the content scale factor
-		contentScaleFactor = 1.0f;
-
-		if (path)
+		path = [PXTextureLoader _resolvePath:path contentScaleFactor:&scaleFactor];
+		if (!path)
 		{
-			path = [self updatePath:path];
-			if (!path)
-			{
-				[self release];
-				return nil;
-			}
-			
-			[self _setOrigin:path];
+			[self release];
+			return nil;
 		}
+	}
+
+	return [self initWithResolvedPath:path orURL:url modifier:modifier contentScaleFactor:scaleFactor];
+}
+
+#pragma mark Designated Initializer
+
+/*
+ * The path must already be resolved by _resolvePath:contentScaleFactor:,
+ * which is what lets an asynchronous load run this on a worker thread.
+ */
+- (id) initWithResolvedPath:(NSString *)path
+					  orURL:(NSURL *)url
+				   modifier:(id<PXTextureModifier>)modifier
+		 contentScaleFactor:(float)_contentScaleFactor
+{
+	self = [super _initWithContentsOfFile:path orURL:url];
+
+	if (self)
+	{
+		contentScaleFactor = _contentScaleFactor;
 
 		if (![self _load])
 		{
@@ -253,10 +271,42 @@ id<PXTextureModifier> pxTextureLoaderDefaultModifier = nil;
 			return nil;
 		}
 
+		// If this texture was parsed and modified before, use the result.
+		NSString *cachePath = [self cachePathForModifier:modifier];
+		NSData *cachedData = [PXTextureCache _newDataAtPath:cachePath];
+
+		if (cachedData)
+		{
+			textureParser = [[PXTextureParser alloc] initWithData:cachedData
+														 modifier:nil
+														   origin:origin];
+			[cachedData release];
+
+			if (textureParser)
+			{
+				parsedFromCache = YES;
+				cachedModifier = [modifier retain];
+			}
+		}
+
 		// Make a new texture parser
-		textureParser = [[PXTextureParser alloc] initWithData:data
-													 modifier:modifier
-													   origin:origin];
+		if (!textureParser)
+		{
+			textureParser = [[PXTextureParser alloc] initWithData:data
+														 modifier:modifier
+														   origin:origin];
+
+			if (cachePath && textureParser.isModifiable)
+			{
+				[PXTextureCache _storeTextureParser:textureParser atPath:cachePath];
+
+#ifdef PX_DEBUG_MODE
+				// The next launch has to get the same texture from the cache
+				// as this one got from the file.
+				[PXTextureCache _entryAtPath:cachePath matchesTextureParser:textureParser];
+#endif
+			}
+		}
 
 		// If this is nil, then we couldn't load the data
 		if (!textureParser)
@@ -279,7 +329,8 @@ id<PXTextureModifier> pxTextureLoaderDefaultModifier = nil;
 	textureParser = nil;
 
 	// Release the modifier
-	self.modifier = nil;
+	[cachedModifier release];
+	cachedModifier = nil;
 
 	[super dealloc];
 }
@@ -296,21 +347,94 @@ id<PXTextureModifier> pxTextureLoaderDefaultModifier = nil;
 
 - (void) setModifier:(id<PXTextureModifier>)_modifier
 {
-	textureParser.modifier = _modifier;
+	if (!parsedFromCache)
+	{
+		textureParser.modifier = _modifier;
+		return;
+	}
+
+	// The cached texture has already been modified, so the original data has
+	// to be parsed again.
+	PXTextureParser *newTextureParser = [[PXTextureParser alloc] initWithData:data
+																	 modifier:_modifier
+																	   origin:origin];
+
+	if (!newTextureParser)
+	{
+		return;
+	}
+
+	newTextureParser.contentScaleFactor = textureParser.contentScaleFactor;
+
+	[textureParser release];
+	textureParser = newTextureParser;
+
+	[cachedModifier release];
+	cachedModifier = nil;
+
+	parsedFromCache = NO;
 }
 
 - (id<PXTextureModifier>)modifier
 {
+	if (parsedFromCache)
+	{
+		return cachedModifier;
+	}
+
 	return textureParser.modifier;
 }
 
+/*
+ * Where the result of parsing the loaded data with the given modifier is kept
+ * in the texture cache, or nil if it shouldn't be cached. PVR and PXT files
+ * are already in the form they are uploaded in.
+ */
+- (NSString *)cachePathForModifier:(id<PXTextureModifier>)modifier
+{
+	if (![PXTextureCache enabled])
+	{
+		return nil;
+	}
+
+	NSString *extension = [[origin pathExtension] lowercaseString];
+
+	if ([extension isEqualToString:@"pvr"] ||
+		[extension isEqualToString:@"pvrtc"] ||
+		[extension isEqualToString:@"pxt"])
+	{
+		return nil;
+	}
+
+	return [PXTextureCache _pathForData:data
+								 origin:origin
+							   modifier:modifier
+					 contentScaleFactor:contentScaleFactor];
+}
+
+/**
+ * Creates a new PXTextureData object containing a copy of the loaded image
+ * data. Note that all returned copies must be released by the caller.
+ *
+ * @return The new texture data.
+ */
+- (PXTextureData *)newTextureData
+{
+	return [textureParser newTextureData];
+}
+
 /*
  * Auto-completes the extension of the file if one wasn't provided.
  * This method also checks for a file with the @2x extension in it and returns
  * its name if it finds it. Otherwise it returns the original path.
+ *
+ * The extension lookup goes through the parser registry, so this must be
+ * called on the main thread.
  */
-- (NSString *)updatePath:(NSString *)path
++ (NSString *)_resolvePath:(NSString *)path contentScaleFactor:(float *)_contentScaleFactor
 {
+	*_contentScaleFactor = 1.0f;
+
 	// If no file extension was provided, try to find one
 	NSString *resolvedPath = [PXTextureLoader resolvePathForImageFile:path];
 	
@@ -324,21 +448,31 @@ id<PXTextureModifier> pxTextureLoaderDefaultModifier = nil;
 		// View scale factor
 		// TODO: Why are we using PXEngineGetContentScaleFactor rather then
 		// scaleFactor?
-		contentScaleFactor = PXEngineGetContentScaleFactor();
+		*_contentScaleFactor = PXEngineGetContentScaleFactor();
 	}
 
 	return path;
 }
 
-/**
- * Creates a new PXTextureData object containing a copy of the loaded image
- * data. Note that all returned copies must be released by the caller.
- *
- * @return The new texture data.
- */
-- (PXTextureData *)newTextureData
++ (id) _resolveOptions:(id)options
 {
-	return [textureParser newTextureData];
+	if (!options)
+		options = [PXTextureLoader defaultModifier];
+
+	return options;
+}
+
++ (id) _newLoaderWithResolvedPath:(NSString *)path
+							orURL:(NSURL *)url
+						  options:(id)options
+			   contentScaleFactor:(float)_contentScaleFactor
+{
+	return [[self alloc] initWithResolvedPath:path orURL:url modifier:options contentScaleFactor:_contentScaleFactor];
+}
+
+- (id) _newLoadedObject
+{
+	return [self newTextureData];
 }
 
 #pragma mark Utility Methods
@@ -50,68 +50,49 @@
 		return NULL;
 	}
 
-	PXTextureDataPixelFormat oldPixelFormat = oldTextureInfo->pixelFormat;
+	PXTextureDataPixelFormat newPixelFormat;
+	PXParsedTextureDataRowFunction rowFunction = [self rowFunctionFromPixelFormat:oldTextureInfo->pixelFormat
+																	toPixelFormat:&newPixelFormat];
 
-	// NOT SUPPORTED
-	if (oldPixelFormat == PXTextureDataPixelFormat_RGB_PVRTC2  ||
-		oldPixelFormat == PXTextureDataPixelFormat_RGB_PVRTC4  ||
-		oldPixelFormat == PXTextureDataPixelFormat_RGBA_PVRTC2 ||
-		oldPixelFormat == PXTextureDataPixelFormat_RGBA_PVRTC4)
+	// Either it is not supported, or it is already done; no need to modify.
+	if (!rowFunction)
 	{
 		return NULL;
 	}
-	if (oldPixelFormat == PXTextureDataPixelFormat_RGBA4444)
-	{
-		// It is already done, no need to modify.
-		return NULL;
-	}
 
-	unsigned short width  = oldTextureInfo->size.width;
-	unsigned short height = oldTextureInfo->size.height;
-	unsigned pixelCount = width * height;
-	unsigned byteCount = pixelCount * sizeof(PXTF_RGBA_4444);
-
-	PXParsedTextureData *newTextureInfo = PXParsedTextureDataCreate(byteCount);
+	return PXParsedTextureDataCreateModified(oldTextureInfo, newPixelFormat, rowFunction);
+}
 
-	if (!newTextureInfo)
+- (PXParsedTextureDataRowFunction) rowFunctionFromPixelFormat:(PXTextureDataPixelFormat)pixelFormat
+												toPixelFormat:(PXTextureDataPixelFormat *)toPixelFormat
+{
+	if (toPixelFormat)
 	{
-		return NULL;
+		*toPixelFormat = PXTextureDataPixelFormat_RGBA4444;
 	}
 
-	newTextureInfo->size = CGSizeMake(width, height);
-	newTextureInfo->pixelFormat = PXTextureDataPixelFormat_RGBA4444;
-
-	PXTF_RGBA_4444 *writePixels = (PXTF_RGBA_4444 *)(newTextureInfo->bytes);
-
-	switch (oldPixelFormat)
+	// PVR formats are not supported, and RGBA4444 is already done.
+	switch (pixelFormat)
 	{
 		case PXTextureDataPixelFormat_RGBA8888:
-			_PXTextureFormatPixelsCopyWithFunc(oldTextureInfo->bytes, writePixels, pixelCount, PXTF_RGBA_8888, PXTF_RGBA_4444_From_RGBA_8888);
-			break;
+			return PXTextureFormatRowRGBA4444FromRGBA8888;
 		case PXTextureDataPixelFormat_RGBA5551:
-			_PXTextureFormatPixelsCopyWithFunc(oldTextureInfo->bytes, writePixels, pixelCount, PXTF_RGBA_5551, PXTF_RGBA_4444_From_RGBA_5551);
-			break;
+			return PXTextureFormatRowRGBA4444FromRGBA5551;
 		case PXTextureDataPixelFormat_RGB565:
-			_PXTextureFormatPixelsCopyWithFunc(oldTextureInfo->bytes, writePixels, pixelCount, PXTF_RGB_565, PXTF_RGBA_4444_From_RGB_565);
-			break;
+			return PXTextureFormatRowRGBA4444FromRGB565;
 		case PXTextureDataPixelFormat_RGB888:
-			_PXTextureFormatPixelsCopyWithFunc(oldTextureInfo->bytes, writePixels, pixelCount, PXTF_RGB_888, PXTF_RGBA_4444_From_RGB_888);
-			break;
+			return PXTextureFormatRowRGBA4444FromRGB888;
 		case PXTextureDataPixelFormat_LA88:
-			_PXTextureFormatPixelsCopyWithFunc(oldTextureInfo->bytes, writePixels, pixelCount, PXTF_LA_88, PXTF_RGBA_4444_From_LA_88);
-			break;
+			return PXTextureFormatRowRGBA4444FromLA88;
 		case PXTextureDataPixelFormat_L8:
-			_PXTextureFormatPixelsCopyWithFunc(oldTextureInfo->bytes, writePixels, pixelCount, PXTF_L_8, PXTF_RGBA_4444_From_L_8);
-			break;
+			return PXTextureFormatRowRGBA4444FromL8;
 		case PXTextureDataPixelFormat_A8:
-			_PXTextureFormatPixelsCopyWithFunc(oldTextureInfo->bytes, writePixels, pixelCount, PXTF_A_8, PXTF_RGBA_4444_From_A_8);
-			break;
+			return PXTextureFormatRowRGBA4444FromA8;
 		default:
-			PXParsedTextureDataFree(newTextureInfo);
-			newTextureInfo = NULL;
+			break;
 	}
 
-	return newTextureInfo;
+	return NULL;
 }
 
 @end
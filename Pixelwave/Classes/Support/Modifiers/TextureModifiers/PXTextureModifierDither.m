@@ -0,0 +1,171 @@
+/*
+ *  _____                       ___                                            
+ * /\  _ `\  __                /\_ \                                           
+ * \ \ \L\ \/\_\   __  _    ___\//\ \    __  __  __    ___     __  __    ___   
+ *  \ \  __/\/\ \ /\ \/ \  / __`\\ \ \  /\ \/\ \/\ \  / __`\  /\ \/\ \  / __`\ 
+ *   \ \ \/  \ \ \\/>  </ /\  __/ \_\ \_\ \ \_/ \_/ \/\ \L\ \_\ \ \_/ |/\  __/ 
+ *    \ \_\   \ \_\/\_/\_\\ \____\/\____\\ \___^___ /\ \__/|\_\\ \___/ \ \____\
+ *     \/_/    \/_/\//\/_/ \/____/\/____/ \/__//__ /  \/__/\/_/ \/__/   \/____/
+ *       
+ *           www.pixelwave.org + www.spiralstormgames.com
+ *                            ~;   
+ *                           ,/|\.           
+ *                         ,/  |\ \.                 Core Team: Oz Michaeli
+ *                       ,/    | |  \                           John Lattin
+ *                     ,/      | |   |
+ *                   ,/        |/    |
+ *                 ./__________|----'  .
+ *            ,(   ___.....-,~-''-----/   ,(            ,~            ,(        
+ * _.-~-.,.-'`  `_.\,.',.-'`  )_.-~-./.-'`  `_._,.',.-'`  )_.-~-.,.-'`  `_._._,.
+ * 
+ * Copyright (c) 2011 Spiralstorm Games http://www.spiralstormgames.com
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#import "PXTextureModifierDither.h"
+
+#include "PXTextureFormatUtils.h"
+
+@implementation PXTextureModifierDither
+
+- (id) init
+{
+	return [self initWithPixelFormat:PXTextureDataPixelFormat_RGBA4444 dither:PXTextureDither_Ordered];
+}
+
+/**
+ * Makes a modifier which converts the texture to the given pixel format,
+ * dithering it on the way if it has more bits per channel than the format.
+ *
+ * @param pixelFormat The format to convert to; RGBA4444, RGBA5551 or RGB565.
+ * @param dither How to dither the texture.
+ */
+- (id) initWithPixelFormat:(PXTextureDataPixelFormat)_pixelFormat dither:(PXTextureDither)_dither
+{
+	self = [super init];
+
+	if (self)
+	{
+		pixelFormat = _pixelFormat;
+		dither = _dither;
+	}
+
+	return self;
+}
+
+- (PXParsedTextureData *)newModifiedTextureDataFromData:(PXParsedTextureData *)oldTextureInfo
+{
+	if (!oldTextureInfo)
+	{
+		return NULL;
+	}
+
+	PXTextureDataPixelFormat newPixelFormat;
+	PXParsedTextureDataRowFunction rowFunction = [self rowFunctionFromPixelFormat:oldTextureInfo->pixelFormat
+																	toPixelFormat:&newPixelFormat];
+
+	if (rowFunction)
+	{
+		return PXParsedTextureDataCreateModified(oldTextureInfo, newPixelFormat, rowFunction);
+	}
+
+	if (dither == PXTextureDither_ErrorDiffusion && oldTextureInfo->bytes &&
+		(oldTextureInfo->pixelFormat == PXTextureDataPixelFormat_RGBA8888 ||
+		 oldTextureInfo->pixelFormat == PXTextureDataPixelFormat_RGB888))
+	{
+		unsigned width  = oldTextureInfo->size.width;
+		unsigned height = oldTextureInfo->size.height;
+
+		PXParsedTextureData *newTextureInfo = PXParsedTextureDataCreatev(width * height * PXParsedTextureDataBytesPerPixel(pixelFormat),
+																		 pixelFormat,
+																		 oldTextureInfo->size);
+
+		if (!newTextureInfo)
+		{
+			return NULL;
+		}
+
+		if (!PXTextureFormatDiffuse(oldTextureInfo->bytes, oldTextureInfo->pixelFormat,
+									newTextureInfo->bytes, pixelFormat,
+									width, height))
+		{
+			PXParsedTextureDataFree(newTextureInfo);
+			return NULL;
+		}
+
+		newTextureInfo->premultiplied = oldTextureInfo->premultiplied;
+
+		return newTextureInfo;
+	}
+
+	// Either it is not supported, or it is already done; no need to modify.
+	return NULL;
+}
+
+- (PXParsedTextureDataRowFunction) rowFunctionFromPixelFormat:(PXTextureDataPixelFormat)_pixelFormat
+												toPixelFormat:(PXTextureDataPixelFormat *)toPixelFormat
+{
+	if (toPixelFormat)
+	{
+		*toPixelFormat = pixelFormat;
+	}
+
+	if (_pixelFormat == PXTextureDataPixelFormat_RGBA8888 || _pixelFormat == PXTextureDataPixelFormat_RGB888)
+	{
+		// Error diffusion carries the error from one row into the next, so it
+		// can't be streamed a row at a time.
+		if (dither != PXTextureDither_Ordered)
+		{
+			return NULL;
+		}
+
+		BOOL hasAlpha = (_pixelFormat == PXTextureDataPixelFormat_RGBA8888);
+
+		switch (pixelFormat)
+		{
+			case PXTextureDataPixelFormat_RGBA4444:
+				return hasAlpha ? PXTextureFormatRowDitherRGBA4444FromRGBA8888 : PXTextureFormatRowDitherRGBA4444FromRGB888;
+			case PXTextureDataPixelFormat_RGBA5551:
+				return hasAlpha ? PXTextureFormatRowDitherRGBA5551FromRGBA8888 : PXTextureFormatRowDitherRGBA5551FromRGB888;
+			case PXTextureDataPixelFormat_RGB565:
+				return hasAlpha ? PXTextureFormatRowDitherRGB565FromRGBA8888 : PXTextureFormatRowDitherRGB565FromRGB888;
+			default:
+				break;
+		}
+
+		return NULL;
+	}
+
+	// The other formats have too few bits to gain anything from dithering, so
+	// they are converted as usual.
+	id<PXTextureModifier> formatModifier = [PXTextureModifiers textureModifierToPixelFormat:pixelFormat];
+
+	if ([formatModifier respondsToSelector:@selector(rowFunctionFromPixelFormat:toPixelFormat:)])
+	{
+		return [formatModifier rowFunctionFromPixelFormat:_pixelFormat toPixelFormat:toPixelFormat];
+	}
+
+	return NULL;
+}
+
+- (NSString *)cacheKey
+{
+	return [NSString stringWithFormat:@"%d-%d", pixelFormat, dither];
+}
+
+@end
@@ -7,9 +7,14 @@
 //
 
 #import "PXTextureModifier.h"
+#import "PXTextureDataPixelFormat.h"
 
 @interface PXTextureModifierPremultiplyAlpha : NSObject<PXTextureModifier>
 {
+@protected
+	PXTextureDataPixelFormat pixelFormat;
 }
 
+- (id) initWithPixelFormat:(PXTextureDataPixelFormat)pixelFormat;
+
 @end
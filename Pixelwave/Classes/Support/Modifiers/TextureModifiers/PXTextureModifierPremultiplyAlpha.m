@@ -11,26 +11,47 @@
 #include "PXTextureFormatUtils.h"
 #include "PXPrivateUtils.h"
 
-#define PXTextureModifierPremultiplyAlphaCopyWithFunc(_read_, _write_, _count_, _TYPE_, _FUNC_) \
-{ \
-	_TYPE_ *_curReadPixel_; \
-	_TYPE_ *_curWritePixel_; \
-	unsigned int _index_; \
-\
-	for (_index_ = 0, _curReadPixel_ = (_TYPE_ *)(_read_), _curWritePixel_ = (_TYPE_ *)(_write_); _index_ < _count_; ++_index_, ++_curReadPixel_, ++_curWritePixel_) \
-	{ \
-		*_curWritePixel_ = _FUNC_(*_curReadPixel_); \
-	} \
-}
+#import "PXTextureModifiers.h"
 
-PXInline PXTF_RGBA_8888 PXTextureModifierPremultiplyAlphaRGBA8888(PXTF_RGBA_8888 val);
 PXInline PXTF_RGBA_4444 PXTextureModifierPremultiplyAlphaRGBA4444(PXTF_RGBA_4444 val);
 PXInline PXTF_RGBA_5551 PXTextureModifierPremultiplyAlphaRGBA5551(PXTF_RGBA_5551 val);
-PXInline PXTF_LA_88 PXTextureModifierPremultiplyAlphaLA88(PXTF_LA_88 val);
 PXInline PXTF_A_8 PXTextureModifierPremultiplyAlphaA8(PXTF_A_8 val);
 
+_PXTextureFormatRowFunction(PXTextureModifierPremultiplyAlphaRowRGBA4444, PXTF_RGBA_4444, PXTF_RGBA_4444, PXTextureModifierPremultiplyAlphaRGBA4444)
+_PXTextureFormatRowFunction(PXTextureModifierPremultiplyAlphaRowRGBA5551, PXTF_RGBA_5551, PXTF_RGBA_5551, PXTextureModifierPremultiplyAlphaRGBA5551)
+_PXTextureFormatRowFunction(PXTextureModifierPremultiplyAlphaRowA8, PXTF_A_8, PXTF_A_8, PXTextureModifierPremultiplyAlphaA8)
+
+@interface PXTextureModifierPremultiplyAlpha(Private)
+- (PXParsedTextureDataRowFunction) premultiplyRowFunctionForPixelFormat:(PXTextureDataPixelFormat)pixelFormat;
+@end
+
 @implementation PXTextureModifierPremultiplyAlpha
 
+- (id) init
+{
+	return [self initWithPixelFormat:0];
+}
+
+/**
+ * Makes a modifier which premultiplies the alpha, and converts the texture to
+ * the given pixel format. Converting from RGBA8888 to RGBA4444 or RGBA5551
+ * is done in the same pass as premultiplying.
+ *
+ * @param pixelFormat The format to convert to, or 0 to keep the format of the
+ * texture.
+ */
+- (id) initWithPixelFormat:(PXTextureDataPixelFormat)_pixelFormat
+{
+	self = [super init];
+
+	if (self)
+	{
+		pixelFormat = _pixelFormat;
+	}
+
+	return self;
+}
+
 - (PXParsedTextureData *)newModifiedTextureDataFromData:(PXParsedTextureData *)oldTextureInfo
 {
 	if (!oldTextureInfo)
@@ -38,70 +59,113 @@ PXInline PXTF_A_8 PXTextureModifierPremultiplyAlphaA8(PXTF_A_8 val);
 		return NULL;
 	}
 
-	PXTextureDataPixelFormat pixelFormat = oldTextureInfo->pixelFormat;
+	PXTextureDataPixelFormat newPixelFormat;
+	PXParsedTextureDataRowFunction rowFunction = [self rowFunctionFromPixelFormat:oldTextureInfo->pixelFormat
+																	toPixelFormat:&newPixelFormat];
+
+	PXParsedTextureData *newTextureInfo = NULL;
 
-	// NOT SUPPORTED
-	if (pixelFormat == PXTextureDataPixelFormat_RGB_PVRTC2  ||
-		pixelFormat == PXTextureDataPixelFormat_RGB_PVRTC4  ||
-		pixelFormat == PXTextureDataPixelFormat_RGBA_PVRTC2 ||
-		pixelFormat == PXTextureDataPixelFormat_RGBA_PVRTC4)
+	if (rowFunction)
 	{
-		return NULL;
+		newTextureInfo = PXParsedTextureDataCreateModified(oldTextureInfo, newPixelFormat, rowFunction);
 	}
+	else if (pixelFormat != 0 && pixelFormat != oldTextureInfo->pixelFormat)
+	{
+		// Can't be done in one pass, so premultiply in the old format and
+		// then convert.
+		PXParsedTextureData *premultipliedTextureInfo = NULL;
+		rowFunction = [self premultiplyRowFunctionForPixelFormat:oldTextureInfo->pixelFormat];
 
-	unsigned short width  = oldTextureInfo->size.width;
-	unsigned short height = oldTextureInfo->size.height;
-	unsigned int pixelCount = width * height;
-	unsigned int byteCount = oldTextureInfo->byteCount;
+		if (rowFunction)
+		{
+			premultipliedTextureInfo = PXParsedTextureDataCreateModified(oldTextureInfo, oldTextureInfo->pixelFormat, rowFunction);
+		}
 
-	PXParsedTextureData *newTextureInfo = PXParsedTextureDataCreate(byteCount);
+		id<PXTextureModifier> formatModifier = [PXTextureModifiers textureModifierToPixelFormat:pixelFormat];
+		newTextureInfo = [formatModifier newModifiedTextureDataFromData:(premultipliedTextureInfo ? premultipliedTextureInfo : oldTextureInfo)];
 
-	if (newTextureInfo == nil)
+		PXParsedTextureDataFree(premultipliedTextureInfo);
+	}
+
+	if (newTextureInfo)
 	{
-		return NULL;
+		newTextureInfo->premultiplied = YES;
 	}
 
-	newTextureInfo->size = CGSizeMake(width, height);
-	newTextureInfo->pixelFormat = pixelFormat;
+	return newTextureInfo;
+}
+
+- (PXParsedTextureDataRowFunction) rowFunctionFromPixelFormat:(PXTextureDataPixelFormat)_pixelFormat
+												toPixelFormat:(PXTextureDataPixelFormat *)toPixelFormat
+{
+	PXTextureDataPixelFormat newPixelFormat = (pixelFormat != 0) ? pixelFormat : _pixelFormat;
+
+	if (toPixelFormat)
+	{
+		*toPixelFormat = newPixelFormat;
+	}
 
-	uint8_t *writePixels = (uint8_t *)(newTextureInfo->bytes);
+	if (newPixelFormat == _pixelFormat)
+	{
+		return [self premultiplyRowFunctionForPixelFormat:_pixelFormat];
+	}
 
-	switch (pixelFormat)
+	// Premultiply and convert in a single pass.
+	if (_pixelFormat == PXTextureDataPixelFormat_RGBA8888)
+	{
+		switch (newPixelFormat)
+		{
+			case PXTextureDataPixelFormat_RGBA4444:
+				return PXTextureFormatRowPremultiplyRGBA4444FromRGBA8888;
+			case PXTextureDataPixelFormat_RGBA5551:
+				return PXTextureFormatRowPremultiplyRGBA5551FromRGBA8888;
+			default:
+				break;
+		}
+	}
+
+	return NULL;
+}
+
+- (BOOL) rowFunctionPremultipliesAlpha
+{
+	return YES;
+}
+
+- (NSString *)cacheKey
+{
+	return [NSString stringWithFormat:@"%d", pixelFormat];
+}
+
+@end
+
+@implementation PXTextureModifierPremultiplyAlpha(Private)
+
+- (PXParsedTextureDataRowFunction) premultiplyRowFunctionForPixelFormat:(PXTextureDataPixelFormat)_pixelFormat
+{
+	// Formats without alpha (RGB565, RGB888 and L8) have nothing to
+	// premultiply, and PVR formats are not supported.
+	switch (_pixelFormat)
 	{
 		case PXTextureDataPixelFormat_RGBA8888:
-			PXTextureModifierPremultiplyAlphaCopyWithFunc(oldTextureInfo->bytes, writePixels, pixelCount, PXTF_RGBA_8888, PXTextureModifierPremultiplyAlphaRGBA8888);
-			break;
+			return PXTextureFormatRowPremultiplyRGBA8888;
 		case PXTextureDataPixelFormat_RGBA4444:
-			PXTextureModifierPremultiplyAlphaCopyWithFunc(oldTextureInfo->bytes, writePixels, pixelCount, PXTF_RGBA_4444, PXTextureModifierPremultiplyAlphaRGBA4444);
-			break;
+			return PXTextureModifierPremultiplyAlphaRowRGBA4444;
 		case PXTextureDataPixelFormat_RGBA5551:
-			PXTextureModifierPremultiplyAlphaCopyWithFunc(oldTextureInfo->bytes, writePixels, pixelCount, PXTF_RGBA_5551, PXTextureModifierPremultiplyAlphaRGBA5551);
-			break;
+			return PXTextureModifierPremultiplyAlphaRowRGBA5551;
 		case PXTextureDataPixelFormat_LA88:
-			PXTextureModifierPremultiplyAlphaCopyWithFunc(oldTextureInfo->bytes, writePixels, pixelCount, PXTF_LA_88, PXTextureModifierPremultiplyAlphaLA88);
-			break;
+			return PXTextureFormatRowPremultiplyLA88;
 		case PXTextureDataPixelFormat_A8:
-			PXTextureModifierPremultiplyAlphaCopyWithFunc(oldTextureInfo->bytes, writePixels, pixelCount, PXTF_A_8, PXTextureModifierPremultiplyAlphaA8);
-			break;
-		case PXTextureDataPixelFormat_RGB565:
-		case PXTextureDataPixelFormat_L8:
-		case PXTextureDataPixelFormat_RGB888:
+			return PXTextureModifierPremultiplyAlphaRowA8;
 		default:
-			PXParsedTextureDataFree(newTextureInfo);
-			newTextureInfo = NULL;
+			break;
 	}
 
-	return newTextureInfo;
+	return NULL;
 }
 
 @end
 
-PXInline PXTF_RGBA_8888 PXTextureModifierPremultiplyAlphaRGBA8888(PXTF_RGBA_8888 val)
-{
-	float percent = PX_COLOR_BYTE_TO_FLOAT(val.alpha);
-	return PXTF_RGBA_8888_Make(val.red * percent, val.green * percent, val.blue * percent, val.alpha);
-}
-
 PXInline PXTF_RGBA_4444 PXTextureModifierPremultiplyAlphaRGBA4444(PXTF_RGBA_4444 val)
 {
 	unsigned char r;
@@ -109,35 +173,22 @@ PXInline PXTF_RGBA_4444 PXTextureModifierPremultiplyAlphaRGBA4444(PXTF_RGBA_4444
 	unsigned char b;
 	unsigned char a = _PX4BitTo8Bit(_PXTF_4444_A(val));
 
-	float percent = PX_COLOR_BYTE_TO_FLOAT(a);
-
-	r = _PX4BitTo8Bit(_PXTF_4444_R(val)) * percent;
-	g = _PX4BitTo8Bit(_PXTF_4444_G(val)) * percent;
-	b = _PX4BitTo8Bit(_PXTF_4444_B(val)) * percent;
+	r = _PX8BitMultiply(_PX4BitTo8Bit(_PXTF_4444_R(val)), a);
+	g = _PX8BitMultiply(_PX4BitTo8Bit(_PXTF_4444_G(val)), a);
+	b = _PX8BitMultiply(_PX4BitTo8Bit(_PXTF_4444_B(val)), a);
 
-	return PXTF_RGBA_4444_Make(r, g, b, a);
+	return PXTF_RGBA_4444_Make(_PX8BitTo4Bit(r), _PX8BitTo4Bit(g), _PX8BitTo4Bit(b), _PXTF_4444_A(val));
 }
 
 PXInline PXTF_RGBA_5551 PXTextureModifierPremultiplyAlphaRGBA5551(PXTF_RGBA_5551 val)
 {
-	unsigned char r;
-	unsigned char g;
-	unsigned char b;
-	unsigned char a = _PX1BitTo8Bit(_PXTF_5551_A(val));
-
-	float percent = PX_COLOR_BYTE_TO_FLOAT(a);
-
-	r = _PX5BitTo8Bit(_PXTF_5551_R(val)) * percent;
-	g = _PX5BitTo8Bit(_PXTF_5551_G(val)) * percent;
-	b = _PX5BitTo8Bit(_PXTF_5551_B(val)) * percent;
-
-	return PXTF_RGBA_5551_Make(r, g, b, a);
-}
+	// The alpha is either all or nothing.
+	if (_PXTF_5551_A(val) & 0x01)
+	{
+		return val;
+	}
 
-PXInline PXTF_LA_88 PXTextureModifierPremultiplyAlphaLA88(PXTF_LA_88 val)
-{
-	float percent = PX_COLOR_BYTE_TO_FLOAT(val.alpha);
-	return PXTF_LA_88_Make(val.luminance * percent, val.alpha);
+	return PXTF_RGBA_5551_Make(0, 0, 0, 0);
 }
 
 PXInline PXTF_A_8 PXTextureModifierPremultiplyAlphaA8(PXTF_A_8 val)
@@ -59,12 +59,26 @@ typedef struct
 	CGSize size;
 } PXParsedTextureData;
 
+/**
+ * Converts `pixelCount` pixels from one row of a texture into another. `row`
+ * is the index of the row being converted, starting at 0 for the top row.
+ */
+typedef void (*PXParsedTextureDataRowFunction)(const void *fromPixels,
+											   void *toPixels,
+											   unsigned pixelCount,
+											   unsigned row);
+
 PXInline_h PXParsedTextureData *PXParsedTextureDataCreate(unsigned byteCount);
 PXInline_h PXParsedTextureData *PXParsedTextureDataCreatev(unsigned byteCount,
 														   PXTextureDataPixelFormat pixelFormat,
 														   CGSize size);
 PXInline_h void PXParsedTextureDataFree(PXParsedTextureData *textureData);
 
+PXInline_h unsigned PXParsedTextureDataBytesPerPixel(PXTextureDataPixelFormat pixelFormat);
+PXInline_h PXParsedTextureData *PXParsedTextureDataCreateModified(PXParsedTextureData *textureData,
+																  PXTextureDataPixelFormat pixelFormat,
+																  PXParsedTextureDataRowFunction rowFunction);
+
 #ifdef __cplusplus
 }
 #endif
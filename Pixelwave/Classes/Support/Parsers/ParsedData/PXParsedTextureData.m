@@ -83,3 +83,84 @@ PXInline_c void PXParsedTextureDataFree(PXParsedTextureData *textureData)
 		free(textureData);
 	}
 }
+
+PXInline_c unsigned PXParsedTextureDataBytesPerPixel(PXTextureDataPixelFormat pixelFormat)
+{
+	switch (pixelFormat)
+	{
+		case PXTextureDataPixelFormat_RGBA8888:
+			return 4;
+		case PXTextureDataPixelFormat_RGB888:
+			return 3;
+		case PXTextureDataPixelFormat_RGBA4444:
+		case PXTextureDataPixelFormat_RGBA5551:
+		case PXTextureDataPixelFormat_RGB565:
+		case PXTextureDataPixelFormat_LA88:
+			return 2;
+		case PXTextureDataPixelFormat_L8:
+		case PXTextureDataPixelFormat_A8:
+			return 1;
+		default:
+			break;
+	}
+
+	// PVR data isn't stored as whole pixels.
+	return 0;
+}
+
+/*
+ * Makes a copy of the given texture data in the given pixel format, by running
+ * the row function over each row of it.
+ */
+PXInline_c PXParsedTextureData *PXParsedTextureDataCreateModified(PXParsedTextureData *textureData,
+																  PXTextureDataPixelFormat pixelFormat,
+																  PXParsedTextureDataRowFunction rowFunction)
+{
+	if (!textureData || !(textureData->bytes) || !rowFunction)
+	{
+		return NULL;
+	}
+
+	unsigned fromBytesPerPixel = PXParsedTextureDataBytesPerPixel(textureData->pixelFormat);
+	unsigned toBytesPerPixel = PXParsedTextureDataBytesPerPixel(pixelFormat);
+
+	if (fromBytesPerPixel == 0 || toBytesPerPixel == 0)
+	{
+		return NULL;
+	}
+
+	unsigned width  = textureData->size.width;
+	unsigned height = textureData->size.height;
+
+	PXParsedTextureData *newTextureData = PXParsedTextureDataCreatev(width * height * toBytesPerPixel, pixelFormat, textureData->size);
+
+	if (!newTextureData)
+	{
+		return NULL;
+	}
+
+	if (!(newTextureData->bytes))
+	{
+		PXParsedTextureDataFree(newTextureData);
+		return NULL;
+	}
+
+	newTextureData->premultiplied = textureData->premultiplied;
+
+	const unsigned char *fromRow = textureData->bytes;
+	unsigned char *toRow = newTextureData->bytes;
+
+	unsigned fromRowByteCount = width * fromBytesPerPixel;
+	unsigned toRowByteCount = width * toBytesPerPixel;
+
+	unsigned row;
+	for (row = 0; row < height; ++row)
+	{
+		rowFunction(fromRow, toRow, width, row);
+
+		fromRow += fromRowByteCount;
+		toRow += toRowByteCount;
+	}
+
+	return newTextureData;
+}
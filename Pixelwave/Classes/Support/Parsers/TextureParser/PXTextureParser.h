@@ -95,5 +95,15 @@
 			  origin:(NSString *)origin;
 
 - (BOOL) _initializeTexture:(GLuint)texName;
+- (BOOL) _uploadLevel:(GLint)level
+		 pixelFormat:(PXTextureDataPixelFormat)pixelFormat
+			   width:(GLsizei)width
+			  height:(GLsizei)height
+			   bytes:(const GLvoid *)bytes
+		   byteCount:(GLsizei)byteCount;
 - (void) _expandEdges:(PXParsedTextureData *)data;
+
+// The data which gets uploaded, and the size of the image within it.
+- (PXParsedTextureData *)_uploadedTextureData;
+- (CGSize) _contentSize;
 @end
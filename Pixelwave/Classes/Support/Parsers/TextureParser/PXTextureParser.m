@@ -160,6 +160,14 @@
 		// Initialize the content scale factor to 1.0
 		contentScaleFactor = 1.0f;
 
+		// Hand the modifier over before parsing, so that parsers which decode
+		// row by row can write straight into the modified format (filling in
+		// modifiedTextureInfo themselves).
+		if (self.isModifiable)
+		{
+			modifier = [_modifier retain];
+		}
+
 		// Parse the data. If we fail at parsing, give up - there is nothing
 		// else we can do.
 		if (!textureInfo || ![self _parse])
@@ -168,8 +176,12 @@
 			return nil;
 		}
 
-		// Set the modifier to the given one.
-		self.modifier = _modifier;
+		// Set the modifier to the given one, unless the parser already
+		// applied it.
+		if (!modifiedTextureInfo)
+		{
+			self.modifier = _modifier;
+		}
 	}
 
 	return self;
@@ -177,7 +189,10 @@
 
 - (void) dealloc
 {
-	self.modifier = nil;
+	// Not set through the property, as that may decode the original pixels
+	// again.
+	[modifier release];
+	modifier = nil;
 
 	// Free the normal and modified info. If either are nil, this won't do
 	// anything.
@@ -200,12 +215,21 @@
 	// See if we are modifiable.
 	BOOL isModifiable = self.isModifiable;
 
+	// If the parser wrote straight into the modified format, then the
+	// original pixels were never kept; they have to be decoded again.
+	BOOL reparse = (modifiedTextureInfo && textureInfo && !(textureInfo->bytes));
+
 	// Free the previous info.
 	PXParsedTextureDataFree(modifiedTextureInfo);
 	modifiedTextureInfo = NULL;
 	[modifier release];
 	modifier = nil;
 
+	if (reparse)
+	{
+		[self _parse];
+	}
+
 	// If we can be modified and we hvae a legal modifier, lets use it!
 	if (isModifiable && _modifier)
 	{
@@ -247,15 +271,19 @@
 	PXGLBindTexture(GL_TEXTURE_2D, boundTex);
 
 	// If we succeeded, inform the texture data to set the correct properties.
+	// These are taken from what was uploaded, so a modified texture reports
+	// the same format whether it was just modified or read from the cache.
 	if (success)
 	{
-		[textureData _setInternalPropertiesWithWidth:textureInfo->size.width
-											  height:textureInfo->size.height
+		PXParsedTextureData *uploadedTextureInfo = [self _uploadedTextureData];
+
+		[textureData _setInternalPropertiesWithWidth:uploadedTextureInfo->size.width
+											  height:uploadedTextureInfo->size.height
 								   usingContentWidth:contentSize.width
 									   contentHeight:contentSize.height
 								  contentScaleFactor:contentScaleFactor
-											  format:textureInfo->pixelFormat
-									   premultiplied:textureInfo->premultiplied];
+											  format:uploadedTextureInfo->pixelFormat
+									   premultiplied:uploadedTextureInfo->premultiplied];
 	}
 	else
 	{
@@ -268,64 +296,104 @@
 	return textureData;
 }
 
-- (BOOL) _initializeTexture:(GLuint)texName
+- (PXParsedTextureData *)_uploadedTextureData
 {
-	PXParsedTextureData *curTextureInfo = textureInfo;
-
 	// If we have modified data, lets use that instead.
 	if (modifiedTextureInfo && modifiedTextureInfo->bytes)
 	{
-		curTextureInfo = modifiedTextureInfo;
+		return modifiedTextureInfo;
 	}
 
+	return textureInfo;
+}
+
+- (CGSize) _contentSize
+{
+	return contentSize;
+}
+
+- (BOOL) _initializeTexture:(GLuint)texName
+{
+	PXParsedTextureData *curTextureInfo = [self _uploadedTextureData];
+
 	if ([PXTextureData expandEdges])
 	{
 		[self _expandEdges:curTextureInfo];
 	}
 
-	GLsizei width = curTextureInfo->size.width;
-	GLsizei height = curTextureInfo->size.height;
-	const GLvoid *byteData = (GLvoid *)(curTextureInfo->bytes);
-	PXTextureDataPixelFormat pixelFormat = curTextureInfo->pixelFormat;
+	return [self _uploadLevel:0
+				  pixelFormat:curTextureInfo->pixelFormat
+						width:curTextureInfo->size.width
+					   height:curTextureInfo->size.height
+						bytes:curTextureInfo->bytes
+					byteCount:curTextureInfo->byteCount];
+}
 
+/*
+ * Uploads one mip level of the bound texture. The byte count is only needed
+ * by compressed formats.
+ */
+- (BOOL) _uploadLevel:(GLint)level
+		 pixelFormat:(PXTextureDataPixelFormat)pixelFormat
+			   width:(GLsizei)width
+			  height:(GLsizei)height
+			   bytes:(const GLvoid *)byteData
+		   byteCount:(GLsizei)byteCount
+{
+	// Rows are packed with no padding between them. The default alignment of
+	// 4 would read narrow rows (1 or 2 pixel wide levels, or 8 and 16 bit
+	// formats) with the wrong stride, and past the end of the bytes.
 	GLint align;
+	glGetIntegerv(GL_UNPACK_ALIGNMENT, &align);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
 	// Figure out the pixel format, and set the data in gl
 	switch (pixelFormat)
 	{
 		case PXTextureDataPixelFormat_RGBA8888:
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, byteData);
+			glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, byteData);
 			break;
 		case PXTextureDataPixelFormat_RGBA4444:
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4, byteData);
+			glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4, byteData);
 			break;
 		case PXTextureDataPixelFormat_RGBA5551:
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1, byteData);
+			glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1, byteData);
 			break;
 		case PXTextureDataPixelFormat_RGB565:
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, byteData);
+			glTexImage2D(GL_TEXTURE_2D, level, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, byteData);
 			break;
 		case PXTextureDataPixelFormat_RGB888:
-			// TODO: Figure out why 1 and 2 pixel wide images do not display properly without this.
-			glGetIntegerv(GL_UNPACK_ALIGNMENT, &align);
-			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, byteData);
-			glPixelStorei(GL_UNPACK_ALIGNMENT, align);
+			glTexImage2D(GL_TEXTURE_2D, level, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, byteData);
 			break;
 		case PXTextureDataPixelFormat_L8:
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, width, height, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, byteData);
+			glTexImage2D(GL_TEXTURE_2D, level, GL_LUMINANCE, width, height, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, byteData);
 			break;
 		case PXTextureDataPixelFormat_A8:
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, width, height, 0, GL_ALPHA, GL_UNSIGNED_BYTE, byteData);
+			glTexImage2D(GL_TEXTURE_2D, level, GL_ALPHA, width, height, 0, GL_ALPHA, GL_UNSIGNED_BYTE, byteData);
 			break;
 		case PXTextureDataPixelFormat_LA88:
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE_ALPHA, width, height, 0, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, byteData);
+			glTexImage2D(GL_TEXTURE_2D, level, GL_LUMINANCE_ALPHA, width, height, 0, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, byteData);
+			break;
+		case PXTextureDataPixelFormat_RGB_PVRTC2:
+			glCompressedTexImage2D(GL_TEXTURE_2D, level, GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG, width, height, 0, byteCount, byteData);
+			break;
+		case PXTextureDataPixelFormat_RGB_PVRTC4:
+			glCompressedTexImage2D(GL_TEXTURE_2D, level, GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG, width, height, 0, byteCount, byteData);
+			break;
+		case PXTextureDataPixelFormat_RGBA_PVRTC2:
+			glCompressedTexImage2D(GL_TEXTURE_2D, level, GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG, width, height, 0, byteCount, byteData);
+			break;
+		case PXTextureDataPixelFormat_RGBA_PVRTC4:
+			glCompressedTexImage2D(GL_TEXTURE_2D, level, GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG, width, height, 0, byteCount, byteData);
 			break;
 		default:
+			glPixelStorei(GL_UNPACK_ALIGNMENT, align);
 			[NSException raise:NSInternalInconsistencyException format:@""];
 			break;
 	}
 
+	glPixelStorei(GL_UNPACK_ALIGNMENT, align);
+
 	// If there was an error, inform the user
 	GLenum err = glGetError();
 	if (err != GL_NO_ERROR)
@@ -45,6 +45,7 @@
 #import <stdio.h>
 
 #import "PXTextureData.h"
+#import "PXTextureModifier.h"
 
 #import "PXExceptionUtils.h"
 
@@ -180,8 +181,6 @@ void PXPNGTextureParserLoadPNGFromBytes(png_structp pngPtr, png_bytep bytePtr, p
 //		  filter_type,
 //		  bit_depth);
 
-	BOOL forceOneChannel = NO;
-
 // This is not accurate, in fact, the color_type needs to be ALPHA for only
 // alpha, which is rare if at all.
 //	if (preChannels == 1 && preColorType == PNG_COLOR_TYPE_PALETTE)
@@ -211,28 +210,11 @@ void PXPNGTextureParserLoadPNGFromBytes(png_structp pngPtr, png_bytep bytePtr, p
 		png_set_expand(*pngPtr);
 	}
 
-	png_read_update_info(*pngPtr, *infoPtr);
-
-	if (setjmp(png_jmpbuf(*pngPtr)))
-	{
-		PXThrow(PXException, @"PNG - Error occured, PNG long jumped away!");
-		png_destroy_read_struct(pngPtr, infoPtr, (png_infopp)NULL);
-
-		return NO;
-	}
-
-	//Lets allocate enough memory to store the image into rows (scan lines)
-	//then grab the image data.
-	unsigned int row = 0;
-	png_bytep row_pointers[_height];
-	unsigned rowBytes = png_get_rowbytes(*pngPtr, *infoPtr);
+	// Let libpng combine the passes of interlaced images for us. This only
+	// works when whole images are read at once.
+	BOOL interlaced = (png_set_interlace_handling(*pngPtr) > 1);
 
-	for (row = 0; row < _height; row++)
-	{
-		row_pointers[row] = malloc(rowBytes);
-	}
-	
-	png_read_image(*pngPtr, row_pointers);
+	png_read_update_info(*pngPtr, *infoPtr);
 
 	//We need to convert the image to a power of 2 by power of 2 image, so
 	//lets increase the size until it fits.  We only need to do this if the
@@ -241,142 +223,141 @@ void PXPNGTextureParserLoadPNGFromBytes(png_structp pngPtr, png_bytep bytePtr, p
 	const unsigned texWidth  = PXMathNextPowerOfTwo(_width);
 	const unsigned texHeight = PXMathNextPowerOfTwo(_height);
 
-	//If the image used red, green, blue and alpha then we need to allocate
-	//4 bytes for each pixel, however if it only uses red, green and blue then
-	//we only need to allocate 3 bytes.
-	//Lets also grab the difference in width (bytes) so we can properly transfer
-	//the data later
 	// -------------------- Changed from info->color_type
-
 	const int readChannels = png_get_channels(*pngPtr, *infoPtr);
-	const int drawChannels = forceOneChannel ? 1 : readChannels;
+	const unsigned readWidthInBytes = png_get_rowbytes(*pngPtr, *infoPtr);
 
-	const unsigned drawWidthInBytes = drawChannels * texWidth;
-	const unsigned readWidthInBytes = readChannels * _width;
+//	NSLog (@"channel count = %d, color_type = %d\n", readChannels, color_type);
 
-//	NSLog (@"channel count = [said=%d, have=%d], color_type = %d\n", readChannels, drawChannels, color_type);
-
-//	unsigned glFormat;
-
-	switch (drawChannels)
+	switch (readChannels)
 	{
 		case 1:
 			if (color_type == PNG_COLOR_TYPE_GRAY)
 			{
-//				glFormat = GL_LUMINANCE;
 				textureInfo->pixelFormat = PXTextureDataPixelFormat_L8;
 			}
 			else
 			{
-//				glFormat = GL_ALPHA;
 				textureInfo->pixelFormat = PXTextureDataPixelFormat_A8;
 			}
 			break;
 		case 2:
-//			glFormat = GL_LUMINANCE_ALPHA;
 			textureInfo->pixelFormat = PXTextureDataPixelFormat_LA88;
 			break;
 		case 3:
-//			glFormat = GL_RGB;
 			textureInfo->pixelFormat = PXTextureDataPixelFormat_RGB888;
 			break;
 		case 4:
 		default:
-//			glFormat = GL_RGBA;
 			textureInfo->pixelFormat = PXTextureDataPixelFormat_RGBA8888;
 			break;
 	}
 
-	textureInfo->byteCount = sizeof(GLubyte) * drawWidthInBytes * texHeight;
-	textureInfo->bytes = malloc(textureInfo->byteCount);
+	textureInfo->size = CGSizeMake(texWidth, texHeight);
+	contentSize = CGSizeMake(_width, _height);
+
+	// If the modifier can work a row at a time, each row is decoded into a
+	// single scratch row and converted straight into the modified texture.
+	// This way the original pixels never need to be held in memory. Interlaced
+	// images need the whole image to combine their passes, so they are read
+	// normally and modified afterwards.
+	PXParsedTextureDataRowFunction rowFunction = NULL;
+	PXTextureDataPixelFormat drawPixelFormat = textureInfo->pixelFormat;
 
-	// If we couldn't allocate enough memory then lets free what we have used
-	// and return unsuccessful
-	if (!textureInfo->bytes)
+	if (!interlaced && [modifier respondsToSelector:@selector(rowFunctionFromPixelFormat:toPixelFormat:)])
 	{
-		png_read_end(*pngPtr, *infoPtr);
-		png_destroy_read_struct(pngPtr, infoPtr, (png_infopp)NULL);
+		rowFunction = [modifier rowFunctionFromPixelFormat:textureInfo->pixelFormat toPixelFormat:&drawPixelFormat];
+	}
+
+	PXParsedTextureData *drawTextureInfo = textureInfo;
+	png_bytep scratchRow = NULL;
+
+	if (rowFunction)
+	{
+		modifiedTextureInfo = PXParsedTextureDataCreatev(0, drawPixelFormat, textureInfo->size);
+		drawTextureInfo = modifiedTextureInfo;
 
-		for (row = 0; row < _height; ++row)
+		// Flagged the same way newModifiedTextureDataFromData: would have.
+		if (modifiedTextureInfo)
 		{
-			free(row_pointers[row]);
+			modifiedTextureInfo->premultiplied = textureInfo->premultiplied;
+
+			if ([modifier respondsToSelector:@selector(rowFunctionPremultipliesAlpha)] &&
+				[modifier rowFunctionPremultipliesAlpha])
+			{
+				modifiedTextureInfo->premultiplied = YES;
+			}
 		}
 
+		scratchRow = malloc(readWidthInBytes);
+	}
+
+	const unsigned drawWidthInBytes = PXParsedTextureDataBytesPerPixel(drawPixelFormat) * texWidth;
+
+	if (drawTextureInfo)
+	{
+		drawTextureInfo->byteCount = sizeof(GLubyte) * drawWidthInBytes * texHeight;
+		drawTextureInfo->bytes = malloc(drawTextureInfo->byteCount);
+	}
+
+	// If we couldn't allocate enough memory then lets free what we have used
+	// and return unsuccessful
+	if (!drawTextureInfo || !(drawTextureInfo->bytes) || (rowFunction && !scratchRow))
+	{
+		free(scratchRow);
+		png_destroy_read_struct(pngPtr, infoPtr, (png_infopp)NULL);
+
 		PXThrow(PXException, @"PNG - Couldn't allocate enough memory for the picture");
 
 		return NO;
 	}
 
+	if (setjmp(png_jmpbuf(*pngPtr)))
+	{
+		free(scratchRow);
+		png_destroy_read_struct(pngPtr, infoPtr, (png_infopp)NULL);
+
+		PXThrow(PXException, @"PNG - Error occured, PNG long jumped away!");
+
+		return NO;
+	}
+
 	// Loop through each of the rows and grab each pixel for the image
 	// Should we 0 out the excess width and height?
 
-	GLubyte *drawBytePtr = (GLubyte *)(textureInfo->bytes);
-	png_byte *readBytePtr = NULL;
-
-	int rowIndex = 0;
+	GLubyte *drawBytePtr = (GLubyte *)(drawTextureInfo->bytes);
+	unsigned rowIndex;
 
-	// This was a big change, instead of iterating through each byte ourselves
-	// and coping it, we now let memcpy copy a row at a time for us!
-	if (drawChannels == readChannels)
+	if (rowFunction)
 	{
 		for (rowIndex = 0; rowIndex < _height; ++rowIndex)
 		{
-			// Double pointer, so can't quite increment.
-			readBytePtr = row_pointers[rowIndex];
+			png_read_row(*pngPtr, scratchRow, NULL);
+			rowFunction(scratchRow, drawBytePtr, _width, rowIndex);
 
-			// Copy the row into the larger texture.
-			memcpy(drawBytePtr, readBytePtr, readWidthInBytes);
-
-			// This could be done at the end of the for loop; I put it here for
-			// clarification.  The draw pointer is incremented by it's width, so
-			// that it goes down to the next row for copying.
 			drawBytePtr += drawWidthInBytes;
 		}
 	}
 	else
 	{
-		const int memCpyChannels = MIN(readChannels, drawChannels);
-		const float readDiv = readWidthInBytes / readChannels;
-		const float drawDiv = drawWidthInBytes / drawChannels;
-		const int memCpyCount = MIN(readDiv, drawDiv);
-		void *drawBytePtrBefore;
-		int colIndex;
+		// libpng can decode straight into the larger texture, all it needs is
+		// to know where each of the rows start.
+		png_bytep row_pointers[_height];
 
 		for (rowIndex = 0; rowIndex < _height; ++rowIndex)
 		{
-			// Double pointer, so can't quite increment.
-			readBytePtr = row_pointers[rowIndex];
-			drawBytePtrBefore = drawBytePtr;
-
-			for (colIndex = 0; colIndex < memCpyCount; ++colIndex)
-			{
-				memcpy(drawBytePtr, readBytePtr, memCpyChannels);
-				readBytePtr += readChannels;
-				drawBytePtr += drawChannels;
-			}
-
-			drawBytePtr = drawBytePtrBefore;
-			// This could be done at the end of the for loop; I put it here for
-			// clarification.  The draw pointer is incremented by it's width, so
-			// that it goes down to the next row for copying.
+			row_pointers[rowIndex] = drawBytePtr;
 			drawBytePtr += drawWidthInBytes;
 		}
-	}
-
-	textureInfo->size = CGSizeMake(texWidth, texHeight);
-	contentSize = CGSizeMake(_width, _height);
 
-	//Lets make it into an opengl texture, and store it to video memory.
+		png_read_image(*pngPtr, row_pointers);
+	}
 
 	//Lets free the memory libpng used.
 	png_read_end(*pngPtr, *infoPtr);
 	png_destroy_read_struct(pngPtr, infoPtr, (png_infopp)NULL);
 
-	//Lets free the memory we used for the rows
-	for (row = 0; row < _height; ++row)
-	{
-		free(row_pointers[row]);
-	}
+	free(scratchRow);
 
 	//Lets return successful
 	return YES;
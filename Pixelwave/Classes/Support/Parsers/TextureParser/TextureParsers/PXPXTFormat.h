@@ -0,0 +1,137 @@
+/*
+ *  _____                       ___                                            
+ * /\  _ `\  __                /\_ \                                           
+ * \ \ \L\ \/\_\   __  _    ___\//\ \    __  __  __    ___     __  __    ___   
+ *  \ \  __/\/\ \ /\ \/ \  / __`\\ \ \  /\ \/\ \/\ \  / __`\  /\ \/\ \  / __`\ 
+ *   \ \ \/  \ \ \\/>  </ /\  __/ \_\ \_\ \ \_/ \_/ \/\ \L\ \_\ \ \_/ |/\  __/ 
+ *    \ \_\   \ \_\/\_/\_\\ \____\/\____\\ \___^___ /\ \__/|\_\\ \___/ \ \____\
+ *     \/_/    \/_/\//\/_/ \/____/\/____/ \/__//__ /  \/__/\/_/ \/__/   \/____/
+ *       
+ *           www.pixelwave.org + www.spiralstormgames.com
+ *                            ~;   
+ *                           ,/|\.           
+ *                         ,/  |\ \.                 Core Team: Oz Michaeli
+ *                       ,/    | |  \                           John Lattin
+ *                     ,/      | |   |
+ *                   ,/        |/    |
+ *                 ./__________|----'  .
+ *            ,(   ___.....-,~-''-----/   ,(            ,~            ,(        
+ * _.-~-.,.-'`  `_.\,.',.-'`  )_.-~-./.-'`  `_._,.',.-'`  )_.-~-.,.-'`  `_._._,.
+ * 
+ * Copyright (c) 2011 Spiralstorm Games http://www.spiralstormgames.com
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef _PX_PXT_FORMAT_H_
+#define _PX_PXT_FORMAT_H_
+
+// The layout of a .pxt (Pixelwave texture) file. This header is plain C so
+// that the offline converter in Tools/TextureConverter can share it.
+//
+// A .pxt file is a PXPXTHeader, followed by every mip level of the texture
+// (the largest first, each half the size of the one before it), stored one
+// after another exactly as glTexImage2D or glCompressedTexImage2D take them.
+// The texture is already a power of two in size, with its edges expanded and
+// its alpha premultiplied if the flag says so; nothing has to be done to it
+// but upload it. All fields are little endian.
+
+#include <stdint.h>
+
+#import "PXHeaderUtils.h"
+#include "PXTextureDataPixelFormat.h"
+
+#define PX_PXT_TAG "PXT!"
+#define PX_PXT_VERSION 1
+
+typedef enum
+{
+	PXPXTFlag_Premultiplied = 1 << 0
+} PXPXTFlag;
+
+typedef struct
+{
+	// PX_PXT_TAG
+	uint8_t tag[4];
+	// PX_PXT_VERSION
+	uint32_t version;
+	// Where the first level starts, from the start of the file.
+	uint32_t headerLength;
+	// A PXTextureDataPixelFormat.
+	uint32_t pixelFormat;
+	// The size of the first level, always a power of two.
+	uint32_t width;
+	uint32_t height;
+	// The size of the image within the first level.
+	uint32_t contentWidth;
+	uint32_t contentHeight;
+	// PXPXTFlag values.
+	uint32_t flags;
+	// At least 1.
+	uint32_t mipmapCount;
+	// The byte count of all of the levels together.
+	uint32_t dataLength;
+} PXPXTHeader;
+
+/*
+ * The number of bytes a level of the given size takes. Returns 0 for an
+ * unknown format.
+ */
+PXInline uint32_t PXPXTLevelByteCount(PXTextureDataPixelFormat pixelFormat, uint32_t width, uint32_t height)
+{
+	uint32_t blockWidth;
+
+	switch (pixelFormat)
+	{
+		case PXTextureDataPixelFormat_RGBA8888:
+			return width * height * 4;
+		case PXTextureDataPixelFormat_RGB888:
+			return width * height * 3;
+		case PXTextureDataPixelFormat_RGBA4444:
+		case PXTextureDataPixelFormat_RGBA5551:
+		case PXTextureDataPixelFormat_RGB565:
+		case PXTextureDataPixelFormat_LA88:
+			return width * height * 2;
+		case PXTextureDataPixelFormat_L8:
+		case PXTextureDataPixelFormat_A8:
+			return width * height;
+		// PVRTC is stored in blocks of 8 bytes, 8x4 pixels for 2 bits per
+		// pixel and 4x4 for 4; no level has fewer than 2x2 blocks.
+		case PXTextureDataPixelFormat_RGB_PVRTC2:
+		case PXTextureDataPixelFormat_RGBA_PVRTC2:
+			blockWidth = 8;
+			break;
+		case PXTextureDataPixelFormat_RGB_PVRTC4:
+		case PXTextureDataPixelFormat_RGBA_PVRTC4:
+			blockWidth = 4;
+			break;
+		default:
+			return 0;
+	}
+
+	uint32_t widthBlocks  = width / blockWidth;
+	uint32_t heightBlocks = height >> 2;
+
+	if (widthBlocks < 2)
+		widthBlocks = 2;
+	if (heightBlocks < 2)
+		heightBlocks = 2;
+
+	return widthBlocks * heightBlocks * 8;
+}
+
+#endif
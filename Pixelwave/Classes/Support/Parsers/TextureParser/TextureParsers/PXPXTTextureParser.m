@@ -0,0 +1,200 @@
+/*
+ *  _____                       ___                                            
+ * /\  _ `\  __                /\_ \                                           
+ * \ \ \L\ \/\_\   __  _    ___\//\ \    __  __  __    ___     __  __    ___   
+ *  \ \  __/\/\ \ /\ \/ \  / __`\\ \ \  /\ \/\ \/\ \  / __`\  /\ \/\ \  / __`\ 
+ *   \ \ \/  \ \ \\/>  </ /\  __/ \_\ \_\ \ \_/ \_/ \/\ \L\ \_\ \ \_/ |/\  __/ 
+ *    \ \_\   \ \_\/\_/\_\\ \____\/\____\\ \___^___ /\ \__/|\_\\ \___/ \ \____\
+ *     \/_/    \/_/\//\/_/ \/____/\/____/ \/__//__ /  \/__/\/_/ \/__/   \/____/
+ *       
+ *           www.pixelwave.org + www.spiralstormgames.com
+ *                            ~;   
+ *                           ,/|\.           
+ *                         ,/  |\ \.                 Core Team: Oz Michaeli
+ *                       ,/    | |  \                           John Lattin
+ *                     ,/      | |   |
+ *                   ,/        |/    |
+ *                 ./__________|----'  .
+ *            ,(   ___.....-,~-''-----/   ,(            ,~            ,(        
+ * _.-~-.,.-'`  `_.\,.',.-'`  )_.-~-./.-'`  `_._,.',.-'`  )_.-~-.,.-'`  `_._._,.
+ * 
+ * Copyright (c) 2011 Spiralstorm Games http://www.spiralstormgames.com
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#import "PXPXTTextureParser.h"
+
+#import "PXGL.h"
+#import "PXLinkedList.h"
+
+#include "PXPXTFormat.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+PXInline BOOL PXPXTTextureParserReadHeader(NSData *data, PXPXTHeader *header);
+
+/*
+ * Loads .pxt files, made offline by the converter in Tools/TextureConverter.
+ * The file holds the texture exactly as it goes to gl, so nothing is decoded
+ * or copied: the levels are uploaded straight out of the loaded data, which
+ * PXLoader maps into memory rather than reads.
+ *
+ * The data is already final, so .pxt textures can't be modified.
+ */
+@implementation PXPXTTextureParser
+
+- (BOOL) isModifiable
+{
+	return NO;
+}
+
++ (BOOL) isApplicableForData:(NSData *)data origin:(NSString *)origin
+{
+	PXPXTHeader header;
+	return PXPXTTextureParserReadHeader(data, &header);
+}
++ (void) appendSupportedFileExtensions:(PXLinkedList *)extensions
+{
+	[extensions addObject:@"pxt"];
+}
+
+#pragma mark Protected Methods
+
+- (BOOL) _parse
+{
+	PXPXTHeader header;
+
+	if (!PXPXTTextureParserReadHeader(data, &header))
+	{
+		return NO;
+	}
+
+	// Make sure that every level is really there.
+	uint32_t width  = header.width;
+	uint32_t height = header.height;
+	uint32_t byteCount = 0;
+	unsigned level;
+
+	for (level = 0; level < header.mipmapCount; ++level)
+	{
+		uint32_t levelByteCount = PXPXTLevelByteCount(header.pixelFormat, width, height);
+
+		if (levelByteCount == 0 || levelByteCount > header.dataLength - byteCount)
+		{
+			[self _log:@"the mip levels don't fit in the file."];
+			return NO;
+		}
+
+		byteCount += levelByteCount;
+
+		width  = MAX(width  >> 1, 1);
+		height = MAX(height >> 1, 1);
+	}
+
+	levelBytes = ((const uint8_t *)[data bytes]) + header.headerLength;
+	mipmapCount = header.mipmapCount;
+
+	textureInfo->pixelFormat = header.pixelFormat;
+	textureInfo->size = CGSizeMake(header.width, header.height);
+	textureInfo->premultiplied = (header.flags & PXPXTFlag_Premultiplied) ? YES : NO;
+	contentSize = CGSizeMake(header.contentWidth, header.contentHeight);
+
+	// Start reading the levels in now, rather than a page at a time while
+	// they are uploaded (on the main thread, when loading asynchronously).
+	uintptr_t pageSize = getpagesize();
+	uintptr_t start = ((uintptr_t)levelBytes) & ~(pageSize - 1);
+	madvise((void *)start, ((uintptr_t)levelBytes - start) + byteCount, MADV_WILLNEED);
+
+	return YES;
+}
+
+- (BOOL) _initializeTexture:(GLuint)texName
+{
+	PXTextureDataPixelFormat pixelFormat = textureInfo->pixelFormat;
+	GLsizei width  = textureInfo->size.width;
+	GLsizei height = textureInfo->size.height;
+	const uint8_t *bytes = levelBytes;
+
+	unsigned level;
+	for (level = 0; level < mipmapCount; ++level)
+	{
+		GLsizei byteCount = PXPXTLevelByteCount(pixelFormat, width, height);
+
+		if (![self _uploadLevel:level
+					pixelFormat:pixelFormat
+						  width:width
+						 height:height
+						  bytes:bytes
+					  byteCount:byteCount])
+		{
+			return NO;
+		}
+
+		bytes += byteCount;
+
+		width  = MAX(width  >> 1, 1);
+		height = MAX(height >> 1, 1);
+	}
+
+	return YES;
+}
+
+@end
+
+/*
+ * Reads the header, checking that it is one we understand and that the data
+ * is long enough to hold what it says it does.
+ */
+PXInline BOOL PXPXTTextureParserReadHeader(NSData *data, PXPXTHeader *header)
+{
+	if (!data || [data length] < sizeof(PXPXTHeader))
+	{
+		return NO;
+	}
+
+	memcpy(header, [data bytes], sizeof(PXPXTHeader));
+
+	if (memcmp(header->tag, PX_PXT_TAG, 4) != 0)
+	{
+		return NO;
+	}
+
+	header->version       = CFSwapInt32LittleToHost(header->version);
+	header->headerLength  = CFSwapInt32LittleToHost(header->headerLength);
+	header->pixelFormat   = CFSwapInt32LittleToHost(header->pixelFormat);
+	header->width         = CFSwapInt32LittleToHost(header->width);
+	header->height        = CFSwapInt32LittleToHost(header->height);
+	header->contentWidth  = CFSwapInt32LittleToHost(header->contentWidth);
+	header->contentHeight = CFSwapInt32LittleToHost(header->contentHeight);
+	header->flags         = CFSwapInt32LittleToHost(header->flags);
+	header->mipmapCount   = CFSwapInt32LittleToHost(header->mipmapCount);
+	header->dataLength    = CFSwapInt32LittleToHost(header->dataLength);
+
+	if (header->version != PX_PXT_VERSION ||
+		header->headerLength < sizeof(PXPXTHeader) ||
+		header->width == 0 || header->height == 0 ||
+		header->mipmapCount == 0 ||
+		header->headerLength > [data length] ||
+		header->dataLength > [data length] - header->headerLength)
+	{
+		return NO;
+	}
+
+	return YES;
+}
@@ -41,6 +41,7 @@
 #define _PX_TEXTURE_FORMAT_UTILS_H_
 
 #import "PXHeaderUtils.h"
+#include "PXTextureDataPixelFormat.h"
 
 #define _PXTextureFormatPixelsCopyWithFunc(_read_, _write_, _count_, _TYPE_, _FUNC_) \
 { \
@@ -54,6 +55,15 @@
 	} \
 }
 
+// Defines a PXParsedTextureDataRowFunction named _NAME_ which converts each
+// pixel with _FUNC_.
+#define _PXTextureFormatRowFunction(_NAME_, _FROM_TYPE_, _TO_TYPE_, _FUNC_) \
+static void _NAME_(const void *_fromPixels_, void *_toPixels_, unsigned _count_, unsigned _row_) \
+{ \
+	_TO_TYPE_ *_writePixels_ = (_TO_TYPE_ *)(_toPixels_); \
+	_PXTextureFormatPixelsCopyWithFunc(_fromPixels_, _writePixels_, _count_, _FROM_TYPE_, _FUNC_); \
+}
+
 #define _PXTF_ONE_6BIT 0.01587301f
 #define _PXTF_ONE_5BIT 0.03225806f
 #define _PXTF_ONE_4BIT 0.06666667f
@@ -220,6 +230,104 @@ PXInline_h PXTF_L_8 PXTF_L_8_From_RGB_565(PXTF_RGB_565 val);
 PXInline_h PXTF_L_8 PXTF_L_8_From_LA_88(PXTF_LA_88 val);
 PXInline_h PXTF_L_8 PXTF_L_8_From_A_8(PXTF_A_8 val);
 
+#pragma mark -
+#pragma mark - Rows
+#pragma mark -
+
+// Each of these converts a row of pixelCount pixels; their arguments match
+// PXParsedTextureDataRowFunction. The results are identical to converting each
+// pixel with the functions above.
+
+void PXTextureFormatRowRGBA8888FromRGB888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGBA8888FromRGBA4444(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGBA8888FromRGBA5551(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGBA8888FromRGB565(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGBA8888FromLA88(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGBA8888FromA8(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGBA8888FromL8(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+
+void PXTextureFormatRowRGB888FromRGBA8888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGB888FromRGBA4444(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGB888FromRGBA5551(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGB888FromRGB565(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGB888FromLA88(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGB888FromA8(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGB888FromL8(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+
+void PXTextureFormatRowRGBA4444FromRGBA8888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGBA4444FromRGB888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGBA4444FromRGBA5551(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGBA4444FromRGB565(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGBA4444FromLA88(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGBA4444FromA8(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGBA4444FromL8(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+
+void PXTextureFormatRowRGBA5551FromRGBA8888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGBA5551FromRGB888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGBA5551FromRGBA4444(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGBA5551FromRGB565(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGBA5551FromLA88(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGBA5551FromA8(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGBA5551FromL8(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+
+void PXTextureFormatRowRGB565FromRGBA8888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGB565FromRGB888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGB565FromRGBA4444(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGB565FromRGBA5551(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGB565FromLA88(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGB565FromA8(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowRGB565FromL8(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+
+void PXTextureFormatRowLA88FromRGBA8888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowLA88FromRGB888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowLA88FromRGBA4444(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowLA88FromRGBA5551(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowLA88FromRGB565(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowLA88FromA8(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowLA88FromL8(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+
+void PXTextureFormatRowA8FromRGBA8888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowA8FromRGB888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowA8FromRGBA4444(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowA8FromRGBA5551(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowA8FromRGB565(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowA8FromLA88(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowA8FromL8(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+
+void PXTextureFormatRowL8FromRGBA8888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowL8FromRGB888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowL8FromRGBA4444(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowL8FromRGBA5551(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowL8FromRGB565(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowL8FromLA88(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowL8FromA8(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+
+// Premultiplies the color by the alpha of each pixel, rounding to the nearest
+// value. fromPixels and toPixels may be the same.
+void PXTextureFormatRowPremultiplyRGBA8888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowPremultiplyLA88(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+
+// Premultiplies and converts in one pass.
+void PXTextureFormatRowPremultiplyRGBA4444FromRGBA8888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowPremultiplyRGBA5551FromRGBA8888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+
+// Convert with ordered (4x4 Bayer) dithering, so that gradients don't band.
+// The pattern is picked by the pixel's column and the given row.
+void PXTextureFormatRowDitherRGBA4444FromRGBA8888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowDitherRGBA5551FromRGBA8888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowDitherRGB565FromRGBA8888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowDitherRGBA4444FromRGB888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowDitherRGBA5551FromRGB888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+void PXTextureFormatRowDitherRGB565FromRGB888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+
+// Converts a whole image with (Floyd-Steinberg) error diffusion. As the error
+// of each pixel spreads to the next row, this can't be done a row at a time.
+// fromFormat must be RGBA8888 or RGB888, and toFormat RGBA4444, RGBA5551 or
+// RGB565. Returns NO if the formats aren't supported, or memory runs out.
+BOOL PXTextureFormatDiffuse(const void *fromPixels, PXTextureDataPixelFormat fromFormat,
+							void *toPixels, PXTextureDataPixelFormat toFormat,
+							unsigned width, unsigned height);
+
 #pragma mark -
 #pragma mark - Bit Changers
 #pragma mark -
@@ -314,6 +422,14 @@ PXInline uint8_t _PX1BitTo4Bit(uint8_t val)
 	return ((val & 0x01) * 0x0F);
 }
 
+// Multiply
+PXInline uint8_t _PX8BitMultiply(uint8_t val, uint8_t alpha)
+{
+	// Same as (val * alpha + 127) / 255, without the division.
+	unsigned int product = val * alpha + 128;
+	return (product + (product >> 8)) >> 8;
+}
+
 // Color Bits
 PXInline uint8_t _PX888BitsTo8Bit(uint8_t r, uint8_t g, uint8_t b)
 {
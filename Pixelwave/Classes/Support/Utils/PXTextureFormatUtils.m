@@ -39,6 +39,17 @@
 
 #import "PXTextureFormatUtils.h"
 
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+	#include <arm_neon.h>
+	#define PX_TF_SIMD_NEON
+#elif defined(__SSE2__)
+	#include <emmintrin.h>
+	#define PX_TF_SIMD_SSE
+#endif
+
 #pragma mark -
 #pragma mark - Make
 #pragma mark -
@@ -421,3 +432,871 @@ PXInline_c PXTF_L_8 PXTF_L_8_From_A_8(PXTF_A_8 val)
 {
 	return val;
 }
+
+#pragma mark -
+#pragma mark - Rows
+#pragma mark -
+
+// Unlike _PXTextureFormatRowFunction, these are visible outside of this file.
+// As the pixel functions live in this file too, they get inlined.
+#define _PXTextureFormatRowFunctionDefine(_NAME_, _FROM_TYPE_, _TO_TYPE_, _FUNC_) \
+void _NAME_(const void *_fromPixels_, void *_toPixels_, unsigned _count_, unsigned _row_) \
+{ \
+	_TO_TYPE_ *_writePixels_ = (_TO_TYPE_ *)(_toPixels_); \
+	_PXTextureFormatPixelsCopyWithFunc(_fromPixels_, _writePixels_, _count_, _FROM_TYPE_, _FUNC_); \
+}
+
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGBA8888FromRGB888, PXTF_RGB_888, PXTF_RGBA_8888, PXTF_RGBA_8888_From_RGB_888)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGBA8888FromRGBA4444, PXTF_RGBA_4444, PXTF_RGBA_8888, PXTF_RGBA_8888_From_RGBA_4444)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGBA8888FromRGBA5551, PXTF_RGBA_5551, PXTF_RGBA_8888, PXTF_RGBA_8888_From_RGBA_5551)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGBA8888FromRGB565, PXTF_RGB_565, PXTF_RGBA_8888, PXTF_RGBA_8888_From_RGB_565)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGBA8888FromLA88, PXTF_LA_88, PXTF_RGBA_8888, PXTF_RGBA_8888_From_LA_88)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGBA8888FromA8, PXTF_A_8, PXTF_RGBA_8888, PXTF_RGBA_8888_From_A_8)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGBA8888FromL8, PXTF_L_8, PXTF_RGBA_8888, PXTF_RGBA_8888_From_L_8)
+
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGB888FromRGBA4444, PXTF_RGBA_4444, PXTF_RGB_888, PXTF_RGB_888_From_RGBA_4444)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGB888FromRGBA5551, PXTF_RGBA_5551, PXTF_RGB_888, PXTF_RGB_888_From_RGBA_5551)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGB888FromRGB565, PXTF_RGB_565, PXTF_RGB_888, PXTF_RGB_888_From_RGB_565)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGB888FromLA88, PXTF_LA_88, PXTF_RGB_888, PXTF_RGB_888_From_LA_88)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGB888FromA8, PXTF_A_8, PXTF_RGB_888, PXTF_RGB_888_From_A_8)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGB888FromL8, PXTF_L_8, PXTF_RGB_888, PXTF_RGB_888_From_L_8)
+
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGBA4444FromRGB888, PXTF_RGB_888, PXTF_RGBA_4444, PXTF_RGBA_4444_From_RGB_888)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGBA4444FromRGBA5551, PXTF_RGBA_5551, PXTF_RGBA_4444, PXTF_RGBA_4444_From_RGBA_5551)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGBA4444FromRGB565, PXTF_RGB_565, PXTF_RGBA_4444, PXTF_RGBA_4444_From_RGB_565)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGBA4444FromLA88, PXTF_LA_88, PXTF_RGBA_4444, PXTF_RGBA_4444_From_LA_88)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGBA4444FromA8, PXTF_A_8, PXTF_RGBA_4444, PXTF_RGBA_4444_From_A_8)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGBA4444FromL8, PXTF_L_8, PXTF_RGBA_4444, PXTF_RGBA_4444_From_L_8)
+
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGBA5551FromRGB888, PXTF_RGB_888, PXTF_RGBA_5551, PXTF_RGBA_5551_From_RGB_888)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGBA5551FromRGBA4444, PXTF_RGBA_4444, PXTF_RGBA_5551, PXTF_RGBA_5551_From_RGBA_4444)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGBA5551FromRGB565, PXTF_RGB_565, PXTF_RGBA_5551, PXTF_RGBA_5551_From_RGB_565)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGBA5551FromLA88, PXTF_LA_88, PXTF_RGBA_5551, PXTF_RGBA_5551_From_LA_88)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGBA5551FromA8, PXTF_A_8, PXTF_RGBA_5551, PXTF_RGBA_5551_From_A_8)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGBA5551FromL8, PXTF_L_8, PXTF_RGBA_5551, PXTF_RGBA_5551_From_L_8)
+
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGB565FromRGBA4444, PXTF_RGBA_4444, PXTF_RGB_565, PXTF_RGB_565_From_RGBA_4444)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGB565FromRGBA5551, PXTF_RGBA_5551, PXTF_RGB_565, PXTF_RGB_565_From_RGBA_5551)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGB565FromLA88, PXTF_LA_88, PXTF_RGB_565, PXTF_RGB_565_From_LA_88)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGB565FromA8, PXTF_A_8, PXTF_RGB_565, PXTF_RGB_565_From_A_8)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowRGB565FromL8, PXTF_L_8, PXTF_RGB_565, PXTF_RGB_565_From_L_8)
+
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowLA88FromRGBA8888, PXTF_RGBA_8888, PXTF_LA_88, PXTF_LA_88_From_RGBA_8888)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowLA88FromRGB888, PXTF_RGB_888, PXTF_LA_88, PXTF_LA_88_From_RGB_888)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowLA88FromRGBA4444, PXTF_RGBA_4444, PXTF_LA_88, PXTF_LA_88_From_RGBA_4444)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowLA88FromRGBA5551, PXTF_RGBA_5551, PXTF_LA_88, PXTF_LA_88_From_RGBA_5551)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowLA88FromRGB565, PXTF_RGB_565, PXTF_LA_88, PXTF_LA_88_From_RGB_565)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowLA88FromA8, PXTF_A_8, PXTF_LA_88, PXTF_LA_88_From_A_8)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowLA88FromL8, PXTF_L_8, PXTF_LA_88, PXTF_LA_88_From_L_8)
+
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowA8FromRGB888, PXTF_RGB_888, PXTF_A_8, PXTF_A_8_From_RGB_888)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowA8FromRGBA4444, PXTF_RGBA_4444, PXTF_A_8, PXTF_A_8_From_RGBA_4444)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowA8FromRGBA5551, PXTF_RGBA_5551, PXTF_A_8, PXTF_A_8_From_RGBA_5551)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowA8FromRGB565, PXTF_RGB_565, PXTF_A_8, PXTF_A_8_From_RGB_565)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowA8FromLA88, PXTF_LA_88, PXTF_A_8, PXTF_A_8_From_LA_88)
+
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowL8FromRGBA8888, PXTF_RGBA_8888, PXTF_L_8, PXTF_L_8_From_RGBA_8888)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowL8FromRGB888, PXTF_RGB_888, PXTF_L_8, PXTF_L_8_From_RGB_888)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowL8FromRGBA4444, PXTF_RGBA_4444, PXTF_L_8, PXTF_L_8_From_RGBA_4444)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowL8FromRGBA5551, PXTF_RGBA_5551, PXTF_L_8, PXTF_L_8_From_RGBA_5551)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowL8FromRGB565, PXTF_RGB_565, PXTF_L_8, PXTF_L_8_From_RGB_565)
+_PXTextureFormatRowFunctionDefine(PXTextureFormatRowL8FromLA88, PXTF_LA_88, PXTF_L_8, PXTF_L_8_From_LA_88)
+
+// Alpha and luminance are stored the same way, so the row can be copied as is.
+void PXTextureFormatRowA8FromL8(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row)
+{
+	memcpy(toPixels, fromPixels, pixelCount * sizeof(PXTF_A_8));
+}
+void PXTextureFormatRowL8FromA8(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row)
+{
+	memcpy(toPixels, fromPixels, pixelCount * sizeof(PXTF_L_8));
+}
+
+#pragma mark -
+#pragma mark - Vector Rows
+#pragma mark -
+
+// The most common conversions are the ones from what the parsers produce
+// (RGBA8888 and RGB888) down to the 16 bit formats; these are vectorized. The
+// vector loops only do whole groups of pixels, the remainder of each row goes
+// through the pixel functions, which the vector code matches exactly.
+
+PXInline PXTF_RGBA_8888 _PXTFPremultiplyRGBA8888(PXTF_RGBA_8888 val)
+{
+	return PXTF_RGBA_8888_Make(_PX8BitMultiply(val.red, val.alpha),
+							   _PX8BitMultiply(val.green, val.alpha),
+							   _PX8BitMultiply(val.blue, val.alpha),
+							   val.alpha);
+}
+
+#if defined(PX_TF_SIMD_NEON)
+
+// (val * alpha + 127) / 255, the same as _PX8BitMultiply.
+PXInline uint8x8_t _PXTFMultiply8x8(uint8x8_t val, uint8x8_t alpha)
+{
+	uint16x8_t product = vmull_u8(val, alpha);
+	return vraddhn_u16(product, vrshrq_n_u16(product, 8));
+}
+PXInline uint16x8_t _PXTFPack4444x8(uint8x8_t r, uint8x8_t g, uint8x8_t b, uint8x8_t a)
+{
+	const uint8x8_t mask = vdup_n_u8(0xF0);
+
+	uint16x8_t val = vshll_n_u8(vand_u8(r, mask), 8);
+	val = vorrq_u16(val, vshll_n_u8(vand_u8(g, mask), 4));
+	val = vorrq_u16(val, vmovl_u8(vand_u8(b, mask)));
+	val = vorrq_u16(val, vmovl_u8(vshr_n_u8(a, 4)));
+
+	return val;
+}
+PXInline uint16x8_t _PXTFPack5551x8(uint8x8_t r, uint8x8_t g, uint8x8_t b, uint8x8_t a)
+{
+	const uint8x8_t mask = vdup_n_u8(0xF8);
+
+	uint16x8_t val = vshll_n_u8(vand_u8(r, mask), 8);
+	val = vorrq_u16(val, vshll_n_u8(vand_u8(g, mask), 3));
+	val = vorrq_u16(val, vshll_n_u8(vshr_n_u8(b, 3), 1));
+	val = vorrq_u16(val, vmovl_u8(vshr_n_u8(a, 7)));
+
+	return val;
+}
+PXInline uint16x8_t _PXTFPack565x8(uint8x8_t r, uint8x8_t g, uint8x8_t b)
+{
+	uint16x8_t val = vshll_n_u8(vand_u8(r, vdup_n_u8(0xF8)), 8);
+	val = vorrq_u16(val, vshll_n_u8(vand_u8(g, vdup_n_u8(0xFC)), 3));
+	val = vorrq_u16(val, vmovl_u8(vshr_n_u8(b, 3)));
+
+	return val;
+}
+
+#elif defined(PX_TF_SIMD_SSE)
+
+// Each 32 bit lane holds an RGBA8888 pixel, red in the lowest byte.
+PXInline __m128i _PXTFPack4444x4(__m128i val)
+{
+	__m128i r = _mm_slli_epi32(_mm_and_si128(val, _mm_set1_epi32(0xF0)), 8);
+	__m128i g = _mm_and_si128(_mm_srli_epi32(val, 4), _mm_set1_epi32(0xF00));
+	__m128i b = _mm_and_si128(_mm_srli_epi32(val, 16), _mm_set1_epi32(0xF0));
+	__m128i a = _mm_srli_epi32(val, 28);
+
+	return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+}
+PXInline __m128i _PXTFPack5551x4(__m128i val)
+{
+	__m128i r = _mm_slli_epi32(_mm_and_si128(val, _mm_set1_epi32(0xF8)), 8);
+	__m128i g = _mm_and_si128(_mm_srli_epi32(val, 5), _mm_set1_epi32(0x7C0));
+	__m128i b = _mm_and_si128(_mm_srli_epi32(val, 18), _mm_set1_epi32(0x3E));
+	__m128i a = _mm_srli_epi32(val, 31);
+
+	return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+}
+PXInline __m128i _PXTFPack565x4(__m128i val)
+{
+	__m128i r = _mm_slli_epi32(_mm_and_si128(val, _mm_set1_epi32(0xF8)), 8);
+	__m128i g = _mm_and_si128(_mm_srli_epi32(val, 5), _mm_set1_epi32(0x7E0));
+	__m128i b = _mm_and_si128(_mm_srli_epi32(val, 19), _mm_set1_epi32(0x1F));
+
+	return _mm_or_si128(r, _mm_or_si128(g, b));
+}
+// Narrows two vectors of 16 bit values held in 32 bit lanes. The pack
+// instruction saturates signed values, so the values are sign extended first
+// to make it keep their bits as they are.
+PXInline __m128i _PXTFNarrow32x8(__m128i lo, __m128i hi)
+{
+	lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+	hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+
+	return _mm_packs_epi32(lo, hi);
+}
+// (val * alpha + 127) / 255 for each 16 bit lane, the same as _PX8BitMultiply.
+PXInline __m128i _PXTFMultiply16x8(__m128i val, __m128i alpha)
+{
+	__m128i product = _mm_add_epi16(_mm_mullo_epi16(val, alpha), _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+}
+PXInline __m128i _PXTFPremultiplyx4(__m128i val)
+{
+	const __m128i zero = _mm_setzero_si128();
+	// The alpha lanes get multiplied by 255, leaving them as they were.
+	const __m128i alphaLanes = _mm_set_epi16(0xFF, 0, 0, 0, 0xFF, 0, 0, 0);
+
+	__m128i lo = _mm_unpacklo_epi8(val, zero);
+	__m128i hi = _mm_unpackhi_epi8(val, zero);
+
+	__m128i loAlpha = _mm_or_si128(_mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, 0xFF), 0xFF), alphaLanes);
+	__m128i hiAlpha = _mm_or_si128(_mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, 0xFF), 0xFF), alphaLanes);
+
+	return _mm_packus_epi16(_PXTFMultiply16x8(lo, loAlpha), _PXTFMultiply16x8(hi, hiAlpha));
+}
+
+#endif
+
+void PXTextureFormatRowRGBA4444FromRGBA8888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row)
+{
+	const PXTF_RGBA_8888 *readPixel = fromPixels;
+	PXTF_RGBA_4444 *writePixel = toPixels;
+	unsigned index = 0;
+
+#if defined(PX_TF_SIMD_NEON)
+	for (; index + 8 <= pixelCount; index += 8, readPixel += 8, writePixel += 8)
+	{
+		uint8x8x4_t val = vld4_u8((const uint8_t *)readPixel);
+		vst1q_u16(writePixel, _PXTFPack4444x8(val.val[0], val.val[1], val.val[2], val.val[3]));
+	}
+#elif defined(PX_TF_SIMD_SSE)
+	for (; index + 8 <= pixelCount; index += 8, readPixel += 8, writePixel += 8)
+	{
+		__m128i lo = _PXTFPack4444x4(_mm_loadu_si128((const __m128i *)readPixel));
+		__m128i hi = _PXTFPack4444x4(_mm_loadu_si128((const __m128i *)(readPixel + 4)));
+		_mm_storeu_si128((__m128i *)writePixel, _PXTFNarrow32x8(lo, hi));
+	}
+#endif
+
+	for (; index < pixelCount; ++index, ++readPixel, ++writePixel)
+	{
+		*writePixel = PXTF_RGBA_4444_From_RGBA_8888(*readPixel);
+	}
+}
+void PXTextureFormatRowRGBA5551FromRGBA8888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row)
+{
+	const PXTF_RGBA_8888 *readPixel = fromPixels;
+	PXTF_RGBA_5551 *writePixel = toPixels;
+	unsigned index = 0;
+
+#if defined(PX_TF_SIMD_NEON)
+	for (; index + 8 <= pixelCount; index += 8, readPixel += 8, writePixel += 8)
+	{
+		uint8x8x4_t val = vld4_u8((const uint8_t *)readPixel);
+		vst1q_u16(writePixel, _PXTFPack5551x8(val.val[0], val.val[1], val.val[2], val.val[3]));
+	}
+#elif defined(PX_TF_SIMD_SSE)
+	for (; index + 8 <= pixelCount; index += 8, readPixel += 8, writePixel += 8)
+	{
+		__m128i lo = _PXTFPack5551x4(_mm_loadu_si128((const __m128i *)readPixel));
+		__m128i hi = _PXTFPack5551x4(_mm_loadu_si128((const __m128i *)(readPixel + 4)));
+		_mm_storeu_si128((__m128i *)writePixel, _PXTFNarrow32x8(lo, hi));
+	}
+#endif
+
+	for (; index < pixelCount; ++index, ++readPixel, ++writePixel)
+	{
+		*writePixel = PXTF_RGBA_5551_From_RGBA_8888(*readPixel);
+	}
+}
+void PXTextureFormatRowRGB565FromRGBA8888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row)
+{
+	const PXTF_RGBA_8888 *readPixel = fromPixels;
+	PXTF_RGB_565 *writePixel = toPixels;
+	unsigned index = 0;
+
+#if defined(PX_TF_SIMD_NEON)
+	for (; index + 8 <= pixelCount; index += 8, readPixel += 8, writePixel += 8)
+	{
+		uint8x8x4_t val = vld4_u8((const uint8_t *)readPixel);
+		vst1q_u16(writePixel, _PXTFPack565x8(val.val[0], val.val[1], val.val[2]));
+	}
+#elif defined(PX_TF_SIMD_SSE)
+	for (; index + 8 <= pixelCount; index += 8, readPixel += 8, writePixel += 8)
+	{
+		__m128i lo = _PXTFPack565x4(_mm_loadu_si128((const __m128i *)readPixel));
+		__m128i hi = _PXTFPack565x4(_mm_loadu_si128((const __m128i *)(readPixel + 4)));
+		_mm_storeu_si128((__m128i *)writePixel, _PXTFNarrow32x8(lo, hi));
+	}
+#endif
+
+	for (; index < pixelCount; ++index, ++readPixel, ++writePixel)
+	{
+		*writePixel = PXTF_RGB_565_From_RGBA_8888(*readPixel);
+	}
+}
+void PXTextureFormatRowRGB565FromRGB888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row)
+{
+	const PXTF_RGB_888 *readPixel = fromPixels;
+	PXTF_RGB_565 *writePixel = toPixels;
+	unsigned index = 0;
+
+#if defined(PX_TF_SIMD_NEON)
+	for (; index + 8 <= pixelCount; index += 8, readPixel += 8, writePixel += 8)
+	{
+		uint8x8x3_t val = vld3_u8((const uint8_t *)readPixel);
+		vst1q_u16(writePixel, _PXTFPack565x8(val.val[0], val.val[1], val.val[2]));
+	}
+#endif
+
+	for (; index < pixelCount; ++index, ++readPixel, ++writePixel)
+	{
+		*writePixel = PXTF_RGB_565_From_RGB_888(*readPixel);
+	}
+}
+void PXTextureFormatRowRGB888FromRGBA8888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row)
+{
+	const PXTF_RGBA_8888 *readPixel = fromPixels;
+	PXTF_RGB_888 *writePixel = toPixels;
+	unsigned index = 0;
+
+#if defined(PX_TF_SIMD_NEON)
+	for (; index + 8 <= pixelCount; index += 8, readPixel += 8, writePixel += 8)
+	{
+		uint8x8x4_t val = vld4_u8((const uint8_t *)readPixel);
+		uint8x8x3_t rgb = {{val.val[0], val.val[1], val.val[2]}};
+		vst3_u8((uint8_t *)writePixel, rgb);
+	}
+#endif
+
+	for (; index < pixelCount; ++index, ++readPixel, ++writePixel)
+	{
+		*writePixel = PXTF_RGB_888_From_RGBA_8888(*readPixel);
+	}
+}
+void PXTextureFormatRowA8FromRGBA8888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row)
+{
+	const PXTF_RGBA_8888 *readPixel = fromPixels;
+	PXTF_A_8 *writePixel = toPixels;
+	unsigned index = 0;
+
+#if defined(PX_TF_SIMD_NEON)
+	for (; index + 8 <= pixelCount; index += 8, readPixel += 8, writePixel += 8)
+	{
+		uint8x8x4_t val = vld4_u8((const uint8_t *)readPixel);
+		vst1_u8(writePixel, val.val[3]);
+	}
+#elif defined(PX_TF_SIMD_SSE)
+	for (; index + 16 <= pixelCount; index += 16, readPixel += 16, writePixel += 16)
+	{
+		__m128i a0 = _mm_srli_epi32(_mm_loadu_si128((const __m128i *)readPixel), 24);
+		__m128i a1 = _mm_srli_epi32(_mm_loadu_si128((const __m128i *)(readPixel + 4)), 24);
+		__m128i a2 = _mm_srli_epi32(_mm_loadu_si128((const __m128i *)(readPixel + 8)), 24);
+		__m128i a3 = _mm_srli_epi32(_mm_loadu_si128((const __m128i *)(readPixel + 12)), 24);
+		_mm_storeu_si128((__m128i *)writePixel, _mm_packus_epi16(_mm_packs_epi32(a0, a1), _mm_packs_epi32(a2, a3)));
+	}
+#endif
+
+	for (; index < pixelCount; ++index, ++readPixel, ++writePixel)
+	{
+		*writePixel = PXTF_A_8_From_RGBA_8888(*readPixel);
+	}
+}
+
+void PXTextureFormatRowPremultiplyRGBA8888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row)
+{
+	const PXTF_RGBA_8888 *readPixel = fromPixels;
+	PXTF_RGBA_8888 *writePixel = toPixels;
+	unsigned index = 0;
+
+#if defined(PX_TF_SIMD_NEON)
+	for (; index + 8 <= pixelCount; index += 8, readPixel += 8, writePixel += 8)
+	{
+		uint8x8x4_t val = vld4_u8((const uint8_t *)readPixel);
+		val.val[0] = _PXTFMultiply8x8(val.val[0], val.val[3]);
+		val.val[1] = _PXTFMultiply8x8(val.val[1], val.val[3]);
+		val.val[2] = _PXTFMultiply8x8(val.val[2], val.val[3]);
+		vst4_u8((uint8_t *)writePixel, val);
+	}
+#elif defined(PX_TF_SIMD_SSE)
+	for (; index + 4 <= pixelCount; index += 4, readPixel += 4, writePixel += 4)
+	{
+		__m128i val = _mm_loadu_si128((const __m128i *)readPixel);
+		_mm_storeu_si128((__m128i *)writePixel, _PXTFPremultiplyx4(val));
+	}
+#endif
+
+	for (; index < pixelCount; ++index, ++readPixel, ++writePixel)
+	{
+		*writePixel = _PXTFPremultiplyRGBA8888(*readPixel);
+	}
+}
+void PXTextureFormatRowPremultiplyLA88(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row)
+{
+	const PXTF_LA_88 *readPixel = fromPixels;
+	PXTF_LA_88 *writePixel = toPixels;
+	unsigned index = 0;
+
+#if defined(PX_TF_SIMD_NEON)
+	for (; index + 8 <= pixelCount; index += 8, readPixel += 8, writePixel += 8)
+	{
+		uint8x8x2_t val = vld2_u8((const uint8_t *)readPixel);
+		val.val[0] = _PXTFMultiply8x8(val.val[0], val.val[1]);
+		vst2_u8((uint8_t *)writePixel, val);
+	}
+#elif defined(PX_TF_SIMD_SSE)
+	for (; index + 8 <= pixelCount; index += 8, readPixel += 8, writePixel += 8)
+	{
+		// Each 16 bit lane holds a pixel, luminance in the lower byte.
+		__m128i val = _mm_loadu_si128((const __m128i *)readPixel);
+		__m128i luminance = _mm_and_si128(val, _mm_set1_epi16(0xFF));
+		__m128i alpha = _mm_srli_epi16(val, 8);
+
+		luminance = _PXTFMultiply16x8(luminance, alpha);
+		_mm_storeu_si128((__m128i *)writePixel, _mm_or_si128(luminance, _mm_slli_epi16(alpha, 8)));
+	}
+#endif
+
+	for (; index < pixelCount; ++index, ++readPixel, ++writePixel)
+	{
+		*writePixel = PXTF_LA_88_Make(_PX8BitMultiply(readPixel->luminance, readPixel->alpha), readPixel->alpha);
+	}
+}
+
+void PXTextureFormatRowPremultiplyRGBA4444FromRGBA8888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row)
+{
+	const PXTF_RGBA_8888 *readPixel = fromPixels;
+	PXTF_RGBA_4444 *writePixel = toPixels;
+	unsigned index = 0;
+
+#if defined(PX_TF_SIMD_NEON)
+	for (; index + 8 <= pixelCount; index += 8, readPixel += 8, writePixel += 8)
+	{
+		uint8x8x4_t val = vld4_u8((const uint8_t *)readPixel);
+		vst1q_u16(writePixel, _PXTFPack4444x8(_PXTFMultiply8x8(val.val[0], val.val[3]),
+											  _PXTFMultiply8x8(val.val[1], val.val[3]),
+											  _PXTFMultiply8x8(val.val[2], val.val[3]),
+											  val.val[3]));
+	}
+#elif defined(PX_TF_SIMD_SSE)
+	for (; index + 8 <= pixelCount; index += 8, readPixel += 8, writePixel += 8)
+	{
+		__m128i lo = _PXTFPack4444x4(_PXTFPremultiplyx4(_mm_loadu_si128((const __m128i *)readPixel)));
+		__m128i hi = _PXTFPack4444x4(_PXTFPremultiplyx4(_mm_loadu_si128((const __m128i *)(readPixel + 4))));
+		_mm_storeu_si128((__m128i *)writePixel, _PXTFNarrow32x8(lo, hi));
+	}
+#endif
+
+	for (; index < pixelCount; ++index, ++readPixel, ++writePixel)
+	{
+		*writePixel = PXTF_RGBA_4444_From_RGBA_8888(_PXTFPremultiplyRGBA8888(*readPixel));
+	}
+}
+void PXTextureFormatRowPremultiplyRGBA5551FromRGBA8888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row)
+{
+	const PXTF_RGBA_8888 *readPixel = fromPixels;
+	PXTF_RGBA_5551 *writePixel = toPixels;
+	unsigned index = 0;
+
+#if defined(PX_TF_SIMD_NEON)
+	for (; index + 8 <= pixelCount; index += 8, readPixel += 8, writePixel += 8)
+	{
+		uint8x8x4_t val = vld4_u8((const uint8_t *)readPixel);
+		vst1q_u16(writePixel, _PXTFPack5551x8(_PXTFMultiply8x8(val.val[0], val.val[3]),
+											  _PXTFMultiply8x8(val.val[1], val.val[3]),
+											  _PXTFMultiply8x8(val.val[2], val.val[3]),
+											  val.val[3]));
+	}
+#elif defined(PX_TF_SIMD_SSE)
+	for (; index + 8 <= pixelCount; index += 8, readPixel += 8, writePixel += 8)
+	{
+		__m128i lo = _PXTFPack5551x4(_PXTFPremultiplyx4(_mm_loadu_si128((const __m128i *)readPixel)));
+		__m128i hi = _PXTFPack5551x4(_PXTFPremultiplyx4(_mm_loadu_si128((const __m128i *)(readPixel + 4))));
+		_mm_storeu_si128((__m128i *)writePixel, _PXTFNarrow32x8(lo, hi));
+	}
+#endif
+
+	for (; index < pixelCount; ++index, ++readPixel, ++writePixel)
+	{
+		*writePixel = PXTF_RGBA_5551_From_RGBA_8888(_PXTFPremultiplyRGBA8888(*readPixel));
+	}
+}
+
+#pragma mark -
+#pragma mark - Dither
+#pragma mark -
+
+// Ordered dithering adds a threshold from a 4x4 Bayer matrix to each channel
+// before the bits get truncated, scaled to the size of one step of the
+// smaller format. The vector loops start on a multiple of 8 pixels, so the
+// columns of the matrix line up with their lanes.
+
+static const uint8_t _PXTFBayer4x4[4][4] =
+{
+	{ 0,  8,  2, 10},
+	{12,  4, 14,  6},
+	{ 3, 11,  1,  9},
+	{15,  7, 13,  5}
+};
+
+// The threshold (0 to 15) scaled to one step of a channel losing the given
+// number of bits.
+#define _PXTFDitherOffset(_threshold_, _droppedBits_) (((_threshold_) << (_droppedBits_)) >> 4)
+
+PXInline uint8_t _PXTFDitherAdd(uint8_t val, uint8_t offset)
+{
+	unsigned sum = val + offset;
+	return (sum > 0xFF) ? 0xFF : sum;
+}
+PXInline PXTF_RGBA_4444 _PXTFDitherRGBA4444(PXTF_RGBA_8888 val, uint8_t threshold)
+{
+	return PXTF_RGBA_4444_From_RGBA_8888(PXTF_RGBA_8888_Make(_PXTFDitherAdd(val.red, threshold),
+															 _PXTFDitherAdd(val.green, threshold),
+															 _PXTFDitherAdd(val.blue, threshold),
+															 _PXTFDitherAdd(val.alpha, threshold)));
+}
+PXInline PXTF_RGBA_5551 _PXTFDitherRGBA5551(PXTF_RGBA_8888 val, uint8_t threshold)
+{
+	// A single bit of alpha is left as a plain cut off.
+	uint8_t offset = _PXTFDitherOffset(threshold, 3);
+	return PXTF_RGBA_5551_From_RGBA_8888(PXTF_RGBA_8888_Make(_PXTFDitherAdd(val.red, offset),
+															 _PXTFDitherAdd(val.green, offset),
+															 _PXTFDitherAdd(val.blue, offset),
+															 val.alpha));
+}
+PXInline PXTF_RGB_565 _PXTFDitherRGB565(PXTF_RGBA_8888 val, uint8_t threshold)
+{
+	uint8_t offset = _PXTFDitherOffset(threshold, 3);
+	return PXTF_RGB_565_From_RGBA_8888(PXTF_RGBA_8888_Make(_PXTFDitherAdd(val.red, offset),
+														   _PXTFDitherAdd(val.green, _PXTFDitherOffset(threshold, 2)),
+														   _PXTFDitherAdd(val.blue, offset),
+														   val.alpha));
+}
+
+#if defined(PX_TF_SIMD_NEON)
+
+// The thresholds of the row for 8 pixels.
+PXInline uint8x8_t _PXTFDitherThresholdsx8(unsigned row)
+{
+	uint32_t pattern;
+	memcpy(&pattern, _PXTFBayer4x4[row & 3], sizeof(pattern));
+
+	return vreinterpret_u8_u32(vdup_n_u32(pattern));
+}
+
+#elif defined(PX_TF_SIMD_SSE)
+
+// The offsets of the row for 4 RGBA8888 pixels, with the bits each channel
+// loses (0 to leave it alone).
+PXInline __m128i _PXTFDitherOffsetsx4(unsigned row, int redBits, int greenBits, int blueBits, int alphaBits)
+{
+	const uint8_t *thresholds = _PXTFBayer4x4[row & 3];
+	uint8_t offsets[16];
+
+	unsigned index;
+	for (index = 0; index < 4; ++index)
+	{
+		offsets[(index << 2)    ] = redBits   ? _PXTFDitherOffset(thresholds[index], redBits)   : 0;
+		offsets[(index << 2) + 1] = greenBits ? _PXTFDitherOffset(thresholds[index], greenBits) : 0;
+		offsets[(index << 2) + 2] = blueBits  ? _PXTFDitherOffset(thresholds[index], blueBits)  : 0;
+		offsets[(index << 2) + 3] = alphaBits ? _PXTFDitherOffset(thresholds[index], alphaBits) : 0;
+	}
+
+	return _mm_loadu_si128((const __m128i *)offsets);
+}
+
+#endif
+
+void PXTextureFormatRowDitherRGBA4444FromRGBA8888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row)
+{
+	const PXTF_RGBA_8888 *readPixel = fromPixels;
+	PXTF_RGBA_4444 *writePixel = toPixels;
+	const uint8_t *thresholds = _PXTFBayer4x4[row & 3];
+	unsigned index = 0;
+
+#if defined(PX_TF_SIMD_NEON)
+	uint8x8_t offset = _PXTFDitherThresholdsx8(row);
+
+	for (; index + 8 <= pixelCount; index += 8, readPixel += 8, writePixel += 8)
+	{
+		uint8x8x4_t val = vld4_u8((const uint8_t *)readPixel);
+		vst1q_u16(writePixel, _PXTFPack4444x8(vqadd_u8(val.val[0], offset),
+											  vqadd_u8(val.val[1], offset),
+											  vqadd_u8(val.val[2], offset),
+											  vqadd_u8(val.val[3], offset)));
+	}
+#elif defined(PX_TF_SIMD_SSE)
+	__m128i offsets = _PXTFDitherOffsetsx4(row, 4, 4, 4, 4);
+
+	for (; index + 8 <= pixelCount; index += 8, readPixel += 8, writePixel += 8)
+	{
+		__m128i lo = _PXTFPack4444x4(_mm_adds_epu8(_mm_loadu_si128((const __m128i *)readPixel), offsets));
+		__m128i hi = _PXTFPack4444x4(_mm_adds_epu8(_mm_loadu_si128((const __m128i *)(readPixel + 4)), offsets));
+		_mm_storeu_si128((__m128i *)writePixel, _PXTFNarrow32x8(lo, hi));
+	}
+#endif
+
+	for (; index < pixelCount; ++index, ++readPixel, ++writePixel)
+	{
+		*writePixel = _PXTFDitherRGBA4444(*readPixel, thresholds[index & 3]);
+	}
+}
+void PXTextureFormatRowDitherRGBA5551FromRGBA8888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row)
+{
+	const PXTF_RGBA_8888 *readPixel = fromPixels;
+	PXTF_RGBA_5551 *writePixel = toPixels;
+	const uint8_t *thresholds = _PXTFBayer4x4[row & 3];
+	unsigned index = 0;
+
+#if defined(PX_TF_SIMD_NEON)
+	uint8x8_t offset = vshr_n_u8(_PXTFDitherThresholdsx8(row), 1);
+
+	for (; index + 8 <= pixelCount; index += 8, readPixel += 8, writePixel += 8)
+	{
+		uint8x8x4_t val = vld4_u8((const uint8_t *)readPixel);
+		vst1q_u16(writePixel, _PXTFPack5551x8(vqadd_u8(val.val[0], offset),
+											  vqadd_u8(val.val[1], offset),
+											  vqadd_u8(val.val[2], offset),
+											  val.val[3]));
+	}
+#elif defined(PX_TF_SIMD_SSE)
+	__m128i offsets = _PXTFDitherOffsetsx4(row, 3, 3, 3, 0);
+
+	for (; index + 8 <= pixelCount; index += 8, readPixel += 8, writePixel += 8)
+	{
+		__m128i lo = _PXTFPack5551x4(_mm_adds_epu8(_mm_loadu_si128((const __m128i *)readPixel), offsets));
+		__m128i hi = _PXTFPack5551x4(_mm_adds_epu8(_mm_loadu_si128((const __m128i *)(readPixel + 4)), offsets));
+		_mm_storeu_si128((__m128i *)writePixel, _PXTFNarrow32x8(lo, hi));
+	}
+#endif
+
+	for (; index < pixelCount; ++index, ++readPixel, ++writePixel)
+	{
+		*writePixel = _PXTFDitherRGBA5551(*readPixel, thresholds[index & 3]);
+	}
+}
+void PXTextureFormatRowDitherRGB565FromRGBA8888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row)
+{
+	const PXTF_RGBA_8888 *readPixel = fromPixels;
+	PXTF_RGB_565 *writePixel = toPixels;
+	const uint8_t *thresholds = _PXTFBayer4x4[row & 3];
+	unsigned index = 0;
+
+#if defined(PX_TF_SIMD_NEON)
+	uint8x8_t offset5 = vshr_n_u8(_PXTFDitherThresholdsx8(row), 1);
+	uint8x8_t offset6 = vshr_n_u8(_PXTFDitherThresholdsx8(row), 2);
+
+	for (; index + 8 <= pixelCount; index += 8, readPixel += 8, writePixel += 8)
+	{
+		uint8x8x4_t val = vld4_u8((const uint8_t *)readPixel);
+		vst1q_u16(writePixel, _PXTFPack565x8(vqadd_u8(val.val[0], offset5),
+											 vqadd_u8(val.val[1], offset6),
+											 vqadd_u8(val.val[2], offset5)));
+	}
+#elif defined(PX_TF_SIMD_SSE)
+	__m128i offsets = _PXTFDitherOffsetsx4(row, 3, 2, 3, 0);
+
+	for (; index + 8 <= pixelCount; index += 8, readPixel += 8, writePixel += 8)
+	{
+		__m128i lo = _PXTFPack565x4(_mm_adds_epu8(_mm_loadu_si128((const __m128i *)readPixel), offsets));
+		__m128i hi = _PXTFPack565x4(_mm_adds_epu8(_mm_loadu_si128((const __m128i *)(readPixel + 4)), offsets));
+		_mm_storeu_si128((__m128i *)writePixel, _PXTFNarrow32x8(lo, hi));
+	}
+#endif
+
+	for (; index < pixelCount; ++index, ++readPixel, ++writePixel)
+	{
+		*writePixel = _PXTFDitherRGB565(*readPixel, thresholds[index & 3]);
+	}
+}
+void PXTextureFormatRowDitherRGBA4444FromRGB888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row)
+{
+	const PXTF_RGB_888 *readPixel = fromPixels;
+	PXTF_RGBA_4444 *writePixel = toPixels;
+	const uint8_t *thresholds = _PXTFBayer4x4[row & 3];
+	unsigned index = 0;
+
+#if defined(PX_TF_SIMD_NEON)
+	uint8x8_t offset = _PXTFDitherThresholdsx8(row);
+
+	for (; index + 8 <= pixelCount; index += 8, readPixel += 8, writePixel += 8)
+	{
+		uint8x8x3_t val = vld3_u8((const uint8_t *)readPixel);
+		vst1q_u16(writePixel, _PXTFPack4444x8(vqadd_u8(val.val[0], offset),
+											  vqadd_u8(val.val[1], offset),
+											  vqadd_u8(val.val[2], offset),
+											  vdup_n_u8(0xFF)));
+	}
+#endif
+
+	for (; index < pixelCount; ++index, ++readPixel, ++writePixel)
+	{
+		*writePixel = _PXTFDitherRGBA4444(PXTF_RGBA_8888_From_RGB_888(*readPixel), thresholds[index & 3]);
+	}
+}
+void PXTextureFormatRowDitherRGBA5551FromRGB888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row)
+{
+	const PXTF_RGB_888 *readPixel = fromPixels;
+	PXTF_RGBA_5551 *writePixel = toPixels;
+	const uint8_t *thresholds = _PXTFBayer4x4[row & 3];
+	unsigned index = 0;
+
+#if defined(PX_TF_SIMD_NEON)
+	uint8x8_t offset = vshr_n_u8(_PXTFDitherThresholdsx8(row), 1);
+
+	for (; index + 8 <= pixelCount; index += 8, readPixel += 8, writePixel += 8)
+	{
+		uint8x8x3_t val = vld3_u8((const uint8_t *)readPixel);
+		vst1q_u16(writePixel, _PXTFPack5551x8(vqadd_u8(val.val[0], offset),
+											  vqadd_u8(val.val[1], offset),
+											  vqadd_u8(val.val[2], offset),
+											  vdup_n_u8(0xFF)));
+	}
+#endif
+
+	for (; index < pixelCount; ++index, ++readPixel, ++writePixel)
+	{
+		*writePixel = _PXTFDitherRGBA5551(PXTF_RGBA_8888_From_RGB_888(*readPixel), thresholds[index & 3]);
+	}
+}
+void PXTextureFormatRowDitherRGB565FromRGB888(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row)
+{
+	const PXTF_RGB_888 *readPixel = fromPixels;
+	PXTF_RGB_565 *writePixel = toPixels;
+	const uint8_t *thresholds = _PXTFBayer4x4[row & 3];
+	unsigned index = 0;
+
+#if defined(PX_TF_SIMD_NEON)
+	uint8x8_t offset5 = vshr_n_u8(_PXTFDitherThresholdsx8(row), 1);
+	uint8x8_t offset6 = vshr_n_u8(_PXTFDitherThresholdsx8(row), 2);
+
+	for (; index + 8 <= pixelCount; index += 8, readPixel += 8, writePixel += 8)
+	{
+		uint8x8x3_t val = vld3_u8((const uint8_t *)readPixel);
+		vst1q_u16(writePixel, _PXTFPack565x8(vqadd_u8(val.val[0], offset5),
+											 vqadd_u8(val.val[1], offset6),
+											 vqadd_u8(val.val[2], offset5)));
+	}
+#endif
+
+	for (; index < pixelCount; ++index, ++readPixel, ++writePixel)
+	{
+		*writePixel = _PXTFDitherRGB565(PXTF_RGBA_8888_From_RGB_888(*readPixel), thresholds[index & 3]);
+	}
+}
+
+// Floyd-Steinberg error diffusion. The error of each channel is kept in
+// sixteenths, for this row and the next, with a pixel of padding on each side
+// so the edges need no special cases.
+BOOL PXTextureFormatDiffuse(const void *fromPixels, PXTextureDataPixelFormat fromFormat,
+							void *toPixels, PXTextureDataPixelFormat toFormat,
+							unsigned width, unsigned height)
+{
+	if (!fromPixels || !toPixels)
+	{
+		return NO;
+	}
+
+	unsigned fromBytesPerPixel;
+
+	switch (fromFormat)
+	{
+		case PXTextureDataPixelFormat_RGBA8888:
+			fromBytesPerPixel = 4;
+			break;
+		case PXTextureDataPixelFormat_RGB888:
+			fromBytesPerPixel = 3;
+			break;
+		default:
+			return NO;
+	}
+
+	// Bits kept per channel, alpha last. 5551 alpha is only a cut off, and 565
+	// has none; those aren't diffused.
+	unsigned bits[4];
+	unsigned channelCount = 3;
+
+	switch (toFormat)
+	{
+		case PXTextureDataPixelFormat_RGBA4444:
+			bits[0] = bits[1] = bits[2] = bits[3] = 4;
+			channelCount = (fromBytesPerPixel == 4) ? 4 : 3;
+			break;
+		case PXTextureDataPixelFormat_RGBA5551:
+			bits[0] = bits[1] = bits[2] = 5;
+			break;
+		case PXTextureDataPixelFormat_RGB565:
+			bits[0] = bits[2] = 5;
+			bits[1] = 6;
+			break;
+		default:
+			return NO;
+	}
+
+	unsigned errorRowLength = (width + 2) << 2;
+	int *errors = calloc(errorRowLength << 1, sizeof(int));
+
+	if (!errors)
+	{
+		return NO;
+	}
+
+	int *currentErrors = errors;
+	int *nextErrors = errors + errorRowLength;
+
+	unsigned x;
+	unsigned y;
+	unsigned channel;
+
+	// The nearest step to each 8 bit value, and how far that step is from it
+	// once the GPU widens it back to 8 bits.
+	uint8_t steps[4][256];
+	int8_t misses[4][256];
+
+	for (channel = 0; channel < channelCount; ++channel)
+	{
+		int maxStep = (1 << bits[channel]) - 1;
+
+		for (x = 0; x < 256; ++x)
+		{
+			int step = (x * maxStep + 127) / 0xFF;
+
+			steps[channel][x] = step;
+			misses[channel][x] = x - (step * 0xFF + (maxStep >> 1)) / maxStep;
+		}
+	}
+
+	const uint8_t *readPixel = fromPixels;
+	PXTF_RGBA_4444 *writePixel = toPixels;
+
+	for (y = 0; y < height; ++y)
+	{
+		for (x = 0; x < width; ++x, readPixel += fromBytesPerPixel, ++writePixel)
+		{
+			// The error of this pixel, and of the pixels below it starting
+			// from the one down and to the left.
+			int *error = currentErrors + ((x + 1) << 2);
+			int *belowError = nextErrors + (x << 2);
+
+			uint8_t pixelSteps[4];
+
+			for (channel = 0; channel < channelCount; ++channel)
+			{
+				int value = (readPixel[channel] << 4) + error[channel];
+
+				if (value < 0)
+					value = 0;
+				else if (value > (0xFF << 4))
+					value = 0xFF << 4;
+
+				value = (value + 8) >> 4;
+
+				int delta = misses[channel][value];
+				pixelSteps[channel] = steps[channel][value];
+
+				error[channel + 4]      += delta * 7;
+				belowError[channel]     += delta * 3;
+				belowError[channel + 4] += delta * 5;
+				belowError[channel + 8] += delta;
+			}
+
+			switch (toFormat)
+			{
+				case PXTextureDataPixelFormat_RGBA4444:
+					*writePixel = PXTF_RGBA_4444_Make(pixelSteps[0], pixelSteps[1], pixelSteps[2],
+													  (channelCount == 4) ? pixelSteps[3] : 0x0F);
+					break;
+				case PXTextureDataPixelFormat_RGBA5551:
+					*writePixel = PXTF_RGBA_5551_Make(pixelSteps[0], pixelSteps[1], pixelSteps[2],
+													  (fromBytesPerPixel == 4) ? _PX8BitTo1Bit(readPixel[3]) : 0x01);
+					break;
+				default:
+					*writePixel = PXTF_RGB_565_Make(pixelSteps[0], pixelSteps[1], pixelSteps[2]);
+					break;
+			}
+		}
+
+		int *swap = currentErrors;
+		currentErrors = nextErrors;
+		nextErrors = swap;
+
+		memset(nextErrors, 0, errorRowLength * sizeof(int));
+	}
+
+	free(errors);
+
+	return YES;
+}
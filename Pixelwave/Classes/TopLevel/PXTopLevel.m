@@ -48,6 +48,7 @@
 // PXParser - Texture
 #import "PXCGTextureParser.h"
 #import "PXPVRTextureParser.h"
+#import "PXPXTTextureParser.h"
 
 #if(PX_TEXTURE_PARSER_USE_LIBPNG)
 #import "PXPNGTextureParser.h"
@@ -93,6 +94,7 @@ void _PXTopLevelInitialize( )
 
 	[PXParser registerParser:[PXCGTextureParser class]		forBaseClass:[PXTextureParser class]];
 	[PXParser registerParser:[PXPVRTextureParser class]		forBaseClass:[PXTextureParser class]];
+	[PXParser registerParser:[PXPXTTextureParser class]		forBaseClass:[PXTextureParser class]];
 #if(PX_TEXTURE_PARSER_USE_LIBPNG)
 	[PXParser registerParser:[PXPNGTextureParser class]		forBaseClass:[PXTextureParser class]];
 #endif
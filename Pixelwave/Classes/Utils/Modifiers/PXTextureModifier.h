@@ -46,4 +46,32 @@
 @required
 /// Return a new textureInfo, do not modify the given one.
 - (PXParsedTextureData *)newModifiedTextureDataFromData:(PXParsedTextureData *)textureInfo;
+@optional
+/**
+ * Returns a function which applies this modifier to a single row of pixels in
+ * the given format, and sets `toPixelFormat` to the format it writes.
+ * Return `NULL` if rows of that format can not, or need not, be modified.
+ *
+ * Parsers which decode an image row by row use this to write straight into
+ * the modified format, instead of keeping a full copy of the original pixels.
+ * As parsers may run on any thread, the function must not rely on any state
+ * other than its arguments.
+ */
+- (PXParsedTextureDataRowFunction) rowFunctionFromPixelFormat:(PXTextureDataPixelFormat)pixelFormat
+												toPixelFormat:(PXTextureDataPixelFormat *)toPixelFormat;
+/**
+ * Returns `YES` if the rows written by the function from
+ * #rowFunctionFromPixelFormat:toPixelFormat: have their color premultiplied
+ * by their alpha. Parsers use this to flag a streamed texture the same way
+ * #newModifiedTextureDataFromData: would have. Modifiers which don't
+ * implement this keep the texture's premultiplied state.
+ */
+- (BOOL) rowFunctionPremultipliesAlpha;
+/**
+ * Returns a string which tells this modifier apart from others of the same
+ * class, for modifiers which take settings. #PXTextureCache keeps modified
+ * textures by the modifier's class and this key, so two modifiers with the
+ * same class and key must make the same bytes from the same texture.
+ */
+- (NSString *)cacheKey;
 @end
@@ -41,10 +41,28 @@
 
 @protocol PXTextureModifier;
 
+/**
+ * The ways of dithering a texture when converting it to a format with fewer
+ * bits per channel, so that smooth gradients don't turn into bands.
+ */
+typedef enum
+{
+	/// The extra bits are cut off
+	PXTextureDither_None = 0,
+	/// A 4x4 Bayer pattern is added before cutting; fast, and can be done as
+	/// the texture is read
+	PXTextureDither_Ordered,
+	/// The error of each pixel is spread to its neighbors (Floyd-Steinberg);
+	/// smoother, but needs the whole texture in memory
+	PXTextureDither_ErrorDiffusion
+} PXTextureDither;
+
 @interface PXTextureModifiers : NSObject
 
 //-- ScriptName: modifierToFormat
 + (id<PXTextureModifier>) textureModifierToPixelFormat:(PXTextureDataPixelFormat)format;
 + (id<PXTextureModifier>) textureModifierToPremultiplyAlpha;
++ (id<PXTextureModifier>) textureModifierToPixelFormat:(PXTextureDataPixelFormat)format premultiplyAlpha:(BOOL)premultiplyAlpha;
++ (id<PXTextureModifier>) textureModifierToPixelFormat:(PXTextureDataPixelFormat)format dither:(PXTextureDither)dither;
 
 @end
@@ -53,6 +53,7 @@
 #import "PXTextureModifierLA88.h"
 
 #import "PXTextureModifierPremultiplyAlpha.h"
+#import "PXTextureModifierDither.h"
 
 /**
  * PXTextureModifiers creates a texture modifier from a premade list of
@@ -108,4 +109,64 @@
 	return [[[PXTextureModifierPremultiplyAlpha alloc] init] autorelease];
 }
 
+/**
+ * Makes a texture modifier that will convert your texture to the desired
+ * format, and optionally premultiply its alpha. When converting from RGBA8888
+ * to RGBA4444 or RGBA5551 both are done in a single pass.
+ *
+ * @param format The desired texture format.
+ * @param premultiplyAlpha Whether the color should be premultiplied by the
+ * alpha.
+ *
+ * @return A texture modifier that will convert your texture to the desired format.
+ */
++ (id<PXTextureModifier>) textureModifierToPixelFormat:(PXTextureDataPixelFormat)format premultiplyAlpha:(BOOL)premultiplyAlpha
+{
+	if (!premultiplyAlpha)
+	{
+		return [PXTextureModifiers textureModifierToPixelFormat:format];
+	}
+
+	return [[[PXTextureModifierPremultiplyAlpha alloc] initWithPixelFormat:format] autorelease];
+}
+
+/**
+ * Makes a texture modifier that will convert your texture to the desired
+ * format, dithering it so that gradients don't band. Only RGBA4444, RGBA5551
+ * and RGB565 textures made from RGBA8888 or RGB888 ones get dithered; any
+ * other conversion is done as usual.
+ *
+ * @param format The desired texture format.
+ * @param dither How to dither the texture.
+ *
+ * @return A texture modifier that will convert your texture to the desired format.
+ *
+ * **Example:**
+ *	id<PXTextureModifier> modifier = [PXTextureModifiers textureModifierToPixelFormat:PXTextureDataPixelFormat_RGB565
+ *	                                                                           dither:PXTextureDither_Ordered];
+ *	PXTextureLoader *textureLoader = [[PXTextureLoader alloc] initWithContentsOfFile:@"sky.png" modifier:modifier];
+ *	// The sky gradient is stored in half the memory, without banding.
+ *	PXTextureData *textureData = [textureLoader newTextureData];
+ */
++ (id<PXTextureModifier>) textureModifierToPixelFormat:(PXTextureDataPixelFormat)format dither:(PXTextureDither)dither
+{
+	if (dither == PXTextureDither_None)
+	{
+		return [PXTextureModifiers textureModifierToPixelFormat:format];
+	}
+
+	switch (format)
+	{
+		case PXTextureDataPixelFormat_RGBA4444:
+		case PXTextureDataPixelFormat_RGBA5551:
+		case PXTextureDataPixelFormat_RGB565:
+			return [[[PXTextureModifierDither alloc] initWithPixelFormat:format dither:dither] autorelease];
+		default:
+			break;
+	}
+
+	// Nothing is lost going to the other formats that dithering could help.
+	return [PXTextureModifiers textureModifierToPixelFormat:format];
+}
+
 @end
@@ -124,6 +124,8 @@ extern "C" {
 #import "PXTextureLoader.h"
 #import "PXSoundLoader.h"
 #import "PXFontLoader.h"
+#import "PXLoaderQueue.h"
+#import "PXTextureCache.h"
 
 // Utils
 
@@ -0,0 +1,679 @@
+/*
+ *  _____                       ___                                            
+ * /\  _ `\  __                /\_ \                                           
+ * \ \ \L\ \/\_\   __  _    ___\//\ \    __  __  __    ___     __  __    ___   
+ *  \ \  __/\/\ \ /\ \/ \  / __`\\ \ \  /\ \/\ \/\ \  / __`\  /\ \/\ \  / __`\ 
+ *   \ \ \/  \ \ \\/>  </ /\  __/ \_\ \_\ \ \_/ \_/ \/\ \L\ \_\ \ \_/ |/\  __/ 
+ *    \ \_\   \ \_\/\_/\_\\ \____\/\____\\ \___^___ /\ \__/|\_\\ \___/ \ \____\
+ *     \/_/    \/_/\//\/_/ \/____/\/____/ \/__//__ /  \/__/\/_/ \/__/   \/____/
+ *       
+ *           www.pixelwave.org + www.spiralstormgames.com
+ *                            ~;   
+ *                           ,/|\.           
+ *                         ,/  |\ \.                 Core Team: Oz Michaeli
+ *                       ,/    | |  \                           John Lattin
+ *                     ,/      | |   |
+ *                   ,/        |/    |
+ *                 ./__________|----'  .
+ *            ,(   ___.....-,~-''-----/   ,(            ,~            ,(        
+ * _.-~-.,.-'`  `_.\,.',.-'`  )_.-~-./.-'`  `_._,.',.-'`  )_.-~-.,.-'`  `_._._,.
+ * 
+ * Copyright (c) 2011 Spiralstorm Games http://www.spiralstormgames.com
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+// Converts png (or pvr) files to .pxt files, which Pixelwave uploads to gl
+// without decoding or converting anything; see PXPXTFormat.h. The pixel
+// format conversions are the engine's own, so a texture comes out the same as
+// it would from a PXTextureModifier at load time.
+//
+// Build from this directory, on Linux or Mac OS X, with libpng installed:
+//
+//   cc -O2 -Wno-deprecated -Wno-unknown-pragmas -I../../Classes/Support/Utils
+//      -I../../Classes/Display
+//      -I../../Classes/Support/Parsers/TextureParser/TextureParsers
+//      PXTextureConverter.c -lpng -lz -o pxtexconv
+//
+// (on one line).
+//   ./pxtexconv [-format f] [-dither d] [-premultiply] in.png out.pxt
+//
+// -format f     rgba8888 (the default), rgb888, rgba4444, rgba5551, rgb565,
+//               la88, l8 or a8
+// -dither d     none (the default), ordered or diffusion; only used for
+//               rgba4444, rgba5551 and rgb565
+// -premultiply  premultiply the color by the alpha
+//
+// The texture is padded to a power of two, with the edges of the image
+// copied into the padding. A .pvr input is stored as it is, less its mip
+// levels; -premultiply then only marks it as already premultiplied. Mip
+// levels aren't stored, as the engine only ever samples the first level.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <png.h>
+
+// PXTextureFormatUtils is built here as plain C, outside of the engine, so it
+// needs the few Mac types that it uses.
+#ifdef __APPLE__
+#include <MacTypes.h>
+#include <objc/objc.h>
+#else
+typedef uint8_t UInt8;
+typedef uint16_t UInt16;
+typedef signed char BOOL;
+#define YES 1
+#define NO 0
+#endif
+
+#include "PXTextureFormatUtils.m"
+#include "PXPXTFormat.h"
+
+typedef void (*PXTextureConverterRowFunction)(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+
+typedef struct
+{
+	PXTextureDataPixelFormat pixelFormat;
+	uint32_t width;
+	uint32_t height;
+	uint32_t contentWidth;
+	uint32_t contentHeight;
+	uint32_t flags;
+	uint32_t mipmapCount;
+
+	uint8_t *bytes;
+	uint32_t byteCount;
+} PXTextureConverterTexture;
+
+typedef enum
+{
+	PXTextureConverterDither_None = 0,
+	PXTextureConverterDither_Ordered,
+	PXTextureConverterDither_ErrorDiffusion
+} PXTextureConverterDither;
+
+static const struct
+{
+	const char *name;
+	PXTextureDataPixelFormat pixelFormat;
+} pxTextureConverterFormats[] =
+{
+	{"rgba8888", PXTextureDataPixelFormat_RGBA8888},
+	{"rgb888",   PXTextureDataPixelFormat_RGB888},
+	{"rgba4444", PXTextureDataPixelFormat_RGBA4444},
+	{"rgba5551", PXTextureDataPixelFormat_RGBA5551},
+	{"rgb565",   PXTextureDataPixelFormat_RGB565},
+	{"la88",     PXTextureDataPixelFormat_LA88},
+	{"l8",       PXTextureDataPixelFormat_L8},
+	{"a8",       PXTextureDataPixelFormat_A8}
+};
+
+#define PX_TEXTURE_CONVERTER_FORMAT_COUNT (sizeof(pxTextureConverterFormats) / sizeof(pxTextureConverterFormats[0]))
+
+static uint32_t PXTextureConverterNextPowerOfTwo(uint32_t val)
+{
+	uint32_t powerOfTwo = 1;
+
+	while (powerOfTwo < val)
+	{
+		powerOfTwo <<= 1;
+	}
+
+	return powerOfTwo;
+}
+
+static const char *PXTextureConverterFormatName(PXTextureDataPixelFormat pixelFormat)
+{
+	unsigned index;
+
+	for (index = 0; index < PX_TEXTURE_CONVERTER_FORMAT_COUNT; ++index)
+	{
+		if (pxTextureConverterFormats[index].pixelFormat == pixelFormat)
+		{
+			return pxTextureConverterFormats[index].name;
+		}
+	}
+
+	return "pvrtc";
+}
+
+static uint8_t *PXTextureConverterReadFile(const char *path, uint32_t *outByteCount)
+{
+	FILE *file = fopen(path, "rb");
+
+	if (!file)
+	{
+		return NULL;
+	}
+
+	uint8_t *bytes = NULL;
+	long byteCount = 0;
+
+	if (fseek(file, 0, SEEK_END) == 0 && (byteCount = ftell(file)) > 0 && fseek(file, 0, SEEK_SET) == 0)
+	{
+		bytes = malloc(byteCount);
+
+		if (bytes && fread(bytes, 1, byteCount, file) != (size_t)byteCount)
+		{
+			free(bytes);
+			bytes = NULL;
+		}
+	}
+
+	fclose(file);
+
+	*outByteCount = (uint32_t)byteCount;
+	return bytes;
+}
+
+#pragma mark -
+#pragma mark PNG
+#pragma mark -
+
+/*
+ * Decodes the png to RGBA8888, padded to a power of two with the edges of the
+ * image copied into the padding.
+ */
+static BOOL PXTextureConverterReadPNG(const char *path, PXTextureConverterTexture *texture)
+{
+	FILE *file = fopen(path, "rb");
+
+	if (!file)
+	{
+		fprintf(stderr, "%s: can't be opened.\n", path);
+		return NO;
+	}
+
+	png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+	png_infop info = png ? png_create_info_struct(png) : NULL;
+
+	// Set after setjmp, so they have to be volatile to be freed after a
+	// longjmp.
+	uint8_t *volatile bytes = NULL;
+	png_bytep *volatile rows = NULL;
+
+	if (!info || setjmp(png_jmpbuf(png)))
+	{
+		fprintf(stderr, "%s: isn't a valid png.\n", path);
+
+		png_destroy_read_struct(&png, info ? &info : NULL, NULL);
+		free(bytes);
+		free(rows);
+		fclose(file);
+
+		return NO;
+	}
+
+	png_init_io(png, file);
+	png_read_info(png, info);
+
+	png_uint_32 width;
+	png_uint_32 height;
+	int bitDepth;
+	int colorType;
+
+	png_get_IHDR(png, info, &width, &height, &bitDepth, &colorType, NULL, NULL, NULL);
+
+	// Whatever it is, make it RGBA8888.
+	if (colorType == PNG_COLOR_TYPE_PALETTE)
+		png_set_palette_to_rgb(png);
+	if (colorType == PNG_COLOR_TYPE_GRAY && bitDepth < 8)
+		png_set_expand_gray_1_2_4_to_8(png);
+	if (png_get_valid(png, info, PNG_INFO_tRNS))
+		png_set_tRNS_to_alpha(png);
+	if (bitDepth == 16)
+		png_set_strip_16(png);
+	if (colorType == PNG_COLOR_TYPE_GRAY || colorType == PNG_COLOR_TYPE_GRAY_ALPHA)
+		png_set_gray_to_rgb(png);
+	if (!(colorType & PNG_COLOR_MASK_ALPHA) && !png_get_valid(png, info, PNG_INFO_tRNS))
+		png_set_filler(png, 0xFF, PNG_FILLER_AFTER);
+
+	png_set_interlace_handling(png);
+	png_read_update_info(png, info);
+
+	uint32_t textureWidth  = PXTextureConverterNextPowerOfTwo(width);
+	uint32_t textureHeight = PXTextureConverterNextPowerOfTwo(height);
+	uint32_t rowByteCount = textureWidth * 4;
+
+	bytes = malloc(rowByteCount * textureHeight);
+	rows = malloc(sizeof(png_bytep) * height);
+
+	if (!bytes || !rows)
+	{
+		png_error(png, "out of memory");
+	}
+
+	uint32_t y;
+	for (y = 0; y < height; ++y)
+	{
+		rows[y] = bytes + y * rowByteCount;
+	}
+
+	png_read_image(png, rows);
+	png_read_end(png, NULL);
+
+	png_destroy_read_struct(&png, &info, NULL);
+	free(rows);
+	fclose(file);
+
+	// Copy the last column across the padding on the right, then the last
+	// row down the padding at the bottom.
+	uint32_t x;
+	for (y = 0; y < height; ++y)
+	{
+		uint32_t *row = (uint32_t *)(bytes + y * rowByteCount);
+
+		for (x = width; x < textureWidth; ++x)
+		{
+			row[x] = row[width - 1];
+		}
+	}
+	for (y = height; y < textureHeight; ++y)
+	{
+		memcpy(bytes + y * rowByteCount, bytes + (height - 1) * rowByteCount, rowByteCount);
+	}
+
+	texture->pixelFormat = PXTextureDataPixelFormat_RGBA8888;
+	texture->width  = textureWidth;
+	texture->height = textureHeight;
+	texture->contentWidth  = width;
+	texture->contentHeight = height;
+	texture->flags = 0;
+	texture->mipmapCount = 1;
+	texture->bytes = bytes;
+	texture->byteCount = rowByteCount * textureHeight;
+
+	return YES;
+}
+
+#pragma mark -
+#pragma mark PVR
+#pragma mark -
+
+// The same header PXPVRTextureParser reads.
+#define PX_TEXTURE_CONVERTER_PVR_HEADER_LENGTH 52
+#define PX_TEXTURE_CONVERTER_PVR_TYPE_2 24
+#define PX_TEXTURE_CONVERTER_PVR_TYPE_4 25
+
+static uint32_t PXTextureConverterReadUInt32(const uint8_t *bytes)
+{
+	return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+static BOOL PXTextureConverterIsPVR(const uint8_t *bytes, uint32_t byteCount)
+{
+	return byteCount >= PX_TEXTURE_CONVERTER_PVR_HEADER_LENGTH && memcmp(bytes + 44, "PVR!", 4) == 0;
+}
+
+/*
+ * Takes the first PVRTC level out of a pvr file as it is.
+ */
+static BOOL PXTextureConverterReadPVR(const char *path, uint8_t *fileBytes, uint32_t fileByteCount, PXTextureConverterTexture *texture)
+{
+	uint32_t height     = PXTextureConverterReadUInt32(fileBytes + 4);
+	uint32_t width      = PXTextureConverterReadUInt32(fileBytes + 8);
+	uint32_t flags      = PXTextureConverterReadUInt32(fileBytes + 16);
+	uint32_t dataLength = PXTextureConverterReadUInt32(fileBytes + 20);
+	uint32_t alphaMask  = PXTextureConverterReadUInt32(fileBytes + 40);
+
+	switch (flags & 0xFF)
+	{
+		case PX_TEXTURE_CONVERTER_PVR_TYPE_2:
+			texture->pixelFormat = alphaMask ? PXTextureDataPixelFormat_RGBA_PVRTC2 : PXTextureDataPixelFormat_RGB_PVRTC2;
+			break;
+		case PX_TEXTURE_CONVERTER_PVR_TYPE_4:
+			texture->pixelFormat = alphaMask ? PXTextureDataPixelFormat_RGBA_PVRTC4 : PXTextureDataPixelFormat_RGB_PVRTC4;
+			break;
+		default:
+			fprintf(stderr, "%s: only PVRTC pvr files are supported.\n", path);
+			return NO;
+	}
+
+	if (width == 0 || height == 0 || dataLength > fileByteCount - PX_TEXTURE_CONVERTER_PVR_HEADER_LENGTH)
+	{
+		fprintf(stderr, "%s: isn't a valid pvr.\n", path);
+		return NO;
+	}
+
+	uint32_t byteCount = PXPXTLevelByteCount(texture->pixelFormat, width, height);
+
+	if (byteCount > dataLength)
+	{
+		fprintf(stderr, "%s: has no levels.\n", path);
+		return NO;
+	}
+
+	texture->width  = texture->contentWidth  = width;
+	texture->height = texture->contentHeight = height;
+	texture->flags = 0;
+	texture->mipmapCount = 1;
+	texture->bytes = malloc(byteCount);
+	texture->byteCount = byteCount;
+
+	if (!texture->bytes)
+	{
+		return NO;
+	}
+
+	memcpy(texture->bytes, fileBytes + PX_TEXTURE_CONVERTER_PVR_HEADER_LENGTH, byteCount);
+
+	return YES;
+}
+
+#pragma mark -
+#pragma mark Conversion
+#pragma mark -
+
+static PXTextureConverterRowFunction PXTextureConverterRowFunctionForFormat(PXTextureDataPixelFormat pixelFormat, PXTextureConverterDither dither)
+{
+	BOOL ordered = (dither == PXTextureConverterDither_Ordered);
+
+	switch (pixelFormat)
+	{
+		case PXTextureDataPixelFormat_RGB888:
+			return PXTextureFormatRowRGB888FromRGBA8888;
+		case PXTextureDataPixelFormat_RGBA4444:
+			return ordered ? PXTextureFormatRowDitherRGBA4444FromRGBA8888 : PXTextureFormatRowRGBA4444FromRGBA8888;
+		case PXTextureDataPixelFormat_RGBA5551:
+			return ordered ? PXTextureFormatRowDitherRGBA5551FromRGBA8888 : PXTextureFormatRowRGBA5551FromRGBA8888;
+		case PXTextureDataPixelFormat_RGB565:
+			return ordered ? PXTextureFormatRowDitherRGB565FromRGBA8888 : PXTextureFormatRowRGB565FromRGBA8888;
+		case PXTextureDataPixelFormat_LA88:
+			return PXTextureFormatRowLA88FromRGBA8888;
+		case PXTextureDataPixelFormat_L8:
+			return PXTextureFormatRowL8FromRGBA8888;
+		case PXTextureDataPixelFormat_A8:
+			return PXTextureFormatRowA8FromRGBA8888;
+		default:
+			break;
+	}
+
+	return NULL;
+}
+
+/*
+ * Converts the RGBA8888 pixels to the given format.
+ */
+static BOOL PXTextureConverterConvertLevel(const uint8_t *fromBytes, uint32_t width, uint32_t height,
+										   PXTextureDataPixelFormat pixelFormat, PXTextureConverterDither dither,
+										   uint8_t *toBytes)
+{
+	if (pixelFormat == PXTextureDataPixelFormat_RGBA8888)
+	{
+		memcpy(toBytes, fromBytes, width * height * 4);
+		return YES;
+	}
+
+	if (dither == PXTextureConverterDither_ErrorDiffusion &&
+		(pixelFormat == PXTextureDataPixelFormat_RGBA4444 ||
+		 pixelFormat == PXTextureDataPixelFormat_RGBA5551 ||
+		 pixelFormat == PXTextureDataPixelFormat_RGB565))
+	{
+		return PXTextureFormatDiffuse(fromBytes, PXTextureDataPixelFormat_RGBA8888, toBytes, pixelFormat, width, height);
+	}
+
+	PXTextureConverterRowFunction rowFunction = PXTextureConverterRowFunctionForFormat(pixelFormat, dither);
+
+	if (!rowFunction)
+	{
+		return NO;
+	}
+
+	uint32_t toRowByteCount = PXPXTLevelByteCount(pixelFormat, width, 1);
+
+	uint32_t y;
+	for (y = 0; y < height; ++y)
+	{
+		rowFunction(fromBytes + y * width * 4, toBytes + y * toRowByteCount, width, y);
+	}
+
+	return YES;
+}
+
+/*
+ * Premultiplies the RGBA8888 texture if asked to, and converts it to the
+ * given format.
+ */
+static BOOL PXTextureConverterConvert(PXTextureConverterTexture *texture,
+									  PXTextureDataPixelFormat pixelFormat,
+									  PXTextureConverterDither dither,
+									  BOOL premultiply)
+{
+	uint32_t y;
+
+	if (premultiply)
+	{
+		for (y = 0; y < texture->height; ++y)
+		{
+			uint8_t *row = texture->bytes + y * texture->width * 4;
+			PXTextureFormatRowPremultiplyRGBA8888(row, row, texture->width, y);
+		}
+
+		texture->flags |= PXPXTFlag_Premultiplied;
+	}
+
+	uint32_t byteCount = PXPXTLevelByteCount(pixelFormat, texture->width, texture->height);
+	uint8_t *bytes = malloc(byteCount);
+
+	if (!bytes)
+	{
+		return NO;
+	}
+
+	if (!PXTextureConverterConvertLevel(texture->bytes, texture->width, texture->height, pixelFormat, dither, bytes))
+	{
+		free(bytes);
+		return NO;
+	}
+
+	free(texture->bytes);
+
+	texture->pixelFormat = pixelFormat;
+	texture->mipmapCount = 1;
+	texture->bytes = bytes;
+	texture->byteCount = byteCount;
+
+	return YES;
+}
+
+#pragma mark -
+#pragma mark PXT
+#pragma mark -
+
+static void PXTextureConverterWriteUInt32(uint8_t *bytes, uint32_t val)
+{
+	bytes[0] = val;
+	bytes[1] = val >> 8;
+	bytes[2] = val >> 16;
+	bytes[3] = val >> 24;
+}
+
+static BOOL PXTextureConverterWritePXT(const char *path, const PXTextureConverterTexture *texture)
+{
+	// Written field by field, as the file is little endian whatever this
+	// machine is.
+	uint8_t header[sizeof(PXPXTHeader)];
+	memset(header, 0, sizeof(header));
+
+	memcpy(header + offsetof(PXPXTHeader, tag), PX_PXT_TAG, 4);
+	PXTextureConverterWriteUInt32(header + offsetof(PXPXTHeader, version), PX_PXT_VERSION);
+	PXTextureConverterWriteUInt32(header + offsetof(PXPXTHeader, headerLength), sizeof(PXPXTHeader));
+	PXTextureConverterWriteUInt32(header + offsetof(PXPXTHeader, pixelFormat), texture->pixelFormat);
+	PXTextureConverterWriteUInt32(header + offsetof(PXPXTHeader, width), texture->width);
+	PXTextureConverterWriteUInt32(header + offsetof(PXPXTHeader, height), texture->height);
+	PXTextureConverterWriteUInt32(header + offsetof(PXPXTHeader, contentWidth), texture->contentWidth);
+	PXTextureConverterWriteUInt32(header + offsetof(PXPXTHeader, contentHeight), texture->contentHeight);
+	PXTextureConverterWriteUInt32(header + offsetof(PXPXTHeader, flags), texture->flags);
+	PXTextureConverterWriteUInt32(header + offsetof(PXPXTHeader, mipmapCount), texture->mipmapCount);
+	PXTextureConverterWriteUInt32(header + offsetof(PXPXTHeader, dataLength), texture->byteCount);
+
+	FILE *file = fopen(path, "wb");
+
+	if (!file)
+	{
+		fprintf(stderr, "%s: can't be written.\n", path);
+		return NO;
+	}
+
+	BOOL success = (fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+					fwrite(texture->bytes, 1, texture->byteCount, file) == texture->byteCount);
+
+	if (fclose(file) != 0 || !success)
+	{
+		fprintf(stderr, "%s: can't be written.\n", path);
+		remove(path);
+
+		return NO;
+	}
+
+	return YES;
+}
+
+#pragma mark -
+#pragma mark Main
+#pragma mark -
+
+static int PXTextureConverterUsage(const char *name)
+{
+	fprintf(stderr, "usage: %s [-format f] [-dither d] [-premultiply] in.png out.pxt\n", name);
+	fprintf(stderr, "  -format f     rgba8888 (default), rgb888, rgba4444, rgba5551, rgb565, la88, l8, a8\n");
+	fprintf(stderr, "  -dither d     none (default), ordered, diffusion\n");
+	fprintf(stderr, "  -premultiply  premultiply the color by the alpha\n");
+
+	return 1;
+}
+
+int main(int argc, char *argv[])
+{
+	PXTextureDataPixelFormat pixelFormat = PXTextureDataPixelFormat_RGBA8888;
+	PXTextureConverterDither dither = PXTextureConverterDither_None;
+	BOOL premultiply = NO;
+
+	int argIndex;
+	for (argIndex = 1; argIndex < argc && argv[argIndex][0] == '-'; ++argIndex)
+	{
+		const char *arg = argv[argIndex];
+
+		if (strcmp(arg, "-format") == 0 && argIndex + 1 < argc)
+		{
+			const char *name = argv[++argIndex];
+			unsigned index;
+
+			for (index = 0; index < PX_TEXTURE_CONVERTER_FORMAT_COUNT; ++index)
+			{
+				if (strcmp(name, pxTextureConverterFormats[index].name) == 0)
+				{
+					break;
+				}
+			}
+
+			if (index == PX_TEXTURE_CONVERTER_FORMAT_COUNT)
+			{
+				fprintf(stderr, "unknown format: %s\n", name);
+				return PXTextureConverterUsage(argv[0]);
+			}
+
+			pixelFormat = pxTextureConverterFormats[index].pixelFormat;
+		}
+		else if (strcmp(arg, "-dither") == 0 && argIndex + 1 < argc)
+		{
+			const char *name = argv[++argIndex];
+
+			if (strcmp(name, "none") == 0)
+				dither = PXTextureConverterDither_None;
+			else if (strcmp(name, "ordered") == 0)
+				dither = PXTextureConverterDither_Ordered;
+			else if (strcmp(name, "diffusion") == 0)
+				dither = PXTextureConverterDither_ErrorDiffusion;
+			else
+			{
+				fprintf(stderr, "unknown dither: %s\n", name);
+				return PXTextureConverterUsage(argv[0]);
+			}
+		}
+		else if (strcmp(arg, "-premultiply") == 0)
+		{
+			premultiply = YES;
+		}
+		else
+		{
+			return PXTextureConverterUsage(argv[0]);
+		}
+	}
+
+	if (argc - argIndex != 2)
+	{
+		return PXTextureConverterUsage(argv[0]);
+	}
+
+	const char *inPath = argv[argIndex];
+	const char *outPath = argv[argIndex + 1];
+
+	uint32_t fileByteCount = 0;
+	uint8_t *fileBytes = PXTextureConverterReadFile(inPath, &fileByteCount);
+
+	if (!fileBytes)
+	{
+		fprintf(stderr, "%s: can't be read.\n", inPath);
+		return 1;
+	}
+
+	PXTextureConverterTexture texture;
+	memset(&texture, 0, sizeof(texture));
+
+	BOOL success;
+
+	if (PXTextureConverterIsPVR(fileBytes, fileByteCount))
+	{
+		success = PXTextureConverterReadPVR(inPath, fileBytes, fileByteCount, &texture);
+
+		if (success && premultiply)
+		{
+			texture.flags |= PXPXTFlag_Premultiplied;
+		}
+	}
+	else
+	{
+		success = PXTextureConverterReadPNG(inPath, &texture) &&
+				  PXTextureConverterConvert(&texture, pixelFormat, dither, premultiply);
+	}
+
+	free(fileBytes);
+
+	if (success)
+	{
+		success = PXTextureConverterWritePXT(outPath, &texture);
+	}
+
+	if (success)
+	{
+		printf("%s: %ux%u (%ux%u) %s, %u level%s, %u bytes\n",
+			   outPath,
+			   texture.width, texture.height,
+			   texture.contentWidth, texture.contentHeight,
+			   PXTextureConverterFormatName(texture.pixelFormat),
+			   texture.mipmapCount, (texture.mipmapCount == 1) ? "" : "s",
+			   texture.byteCount);
+	}
+
+	free(texture.bytes);
+
+	return success ? 0 : 1;
+}
@@ -0,0 +1,433 @@
+/*
+ *  _____                       ___                                            
+ * /\  _ `\  __                /\_ \                                           
+ * \ \ \L\ \/\_\   __  _    ___\//\ \    __  __  __    ___     __  __    ___   
+ *  \ \  __/\/\ \ /\ \/ \  / __`\\ \ \  /\ \/\ \/\ \  / __`\  /\ \/\ \  / __`\ 
+ *   \ \ \/  \ \ \\/>  </ /\  __/ \_\ \_\ \ \_/ \_/ \/\ \L\ \_\ \ \_/ |/\  __/ 
+ *    \ \_\   \ \_\/\_/\_\\ \____\/\____\\ \___^___ /\ \__/|\_\\ \___/ \ \____\
+ *     \/_/    \/_/\//\/_/ \/____/\/____/ \/__//__ /  \/__/\/_/ \/__/   \/____/
+ *       
+ *           www.pixelwave.org + www.spiralstormgames.com
+ *                            ~;   
+ *                           ,/|\.           
+ *                         ,/  |\ \.                 Core Team: Oz Michaeli
+ *                       ,/    | |  \                           John Lattin
+ *                     ,/      | |   |
+ *                   ,/        |/    |
+ *                 ./__________|----'  .
+ *            ,(   ___.....-,~-''-----/   ,(            ,~            ,(        
+ * _.-~-.,.-'`  `_.\,.',.-'`  )_.-~-./.-'`  `_._,.',.-'`  )_.-~-.,.-'`  `_._._,.
+ * 
+ * Copyright (c) 2011 Spiralstorm Games http://www.spiralstormgames.com
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+// Tests the vectorized (SSE2 or NEON) row functions of PXTextureFormatUtils
+// against its pixel functions, which they have to match bit for bit, and then
+// measures how many pixels each row function converts per second.
+//
+// Each row function is run on random pixels, for every width up to 100 and a
+// few larger ones, with the source and destination starting at different
+// offsets, so the vector loops and the remainders are both covered, aligned
+// or not. The bytes around the destination must be left alone, and the
+// premultiply functions are also run in place.
+//
+// Build and run from this directory, on Linux or Mac OS X:
+//
+//   cc -O2 -Wno-deprecated -Wno-unknown-pragmas -I../../Classes/Support/Utils
+//      -I../../Classes/Display PXTextureFormatTest.c -o pxtexformattest
+//
+// (on one line).
+//   ./pxtexformattest [-nobench]
+//
+// -nobench  only run the tests
+//
+// On x86 the SSE2 code is used whenever the compiler targets SSE2; add
+// -U__SSE2__ to build the plain C row functions, to compare their speed. On
+// ARM the NEON code is used if the compiler targets NEON (-mfpu=neon).
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// PXTextureFormatUtils is built here as plain C, outside of the engine, so it
+// needs the few Mac types that it uses.
+#ifdef __APPLE__
+#include <MacTypes.h>
+#include <objc/objc.h>
+#else
+typedef uint8_t UInt8;
+typedef uint16_t UInt16;
+typedef signed char BOOL;
+#define YES 1
+#define NO 0
+#endif
+
+#include "PXTextureFormatUtils.m"
+
+typedef void (*PXTextureFormatTestRowFunction)(const void *fromPixels, void *toPixels, unsigned pixelCount, unsigned row);
+typedef void (*PXTextureFormatTestPixelFunction)(const void *fromPixel, void *toPixel, unsigned column, unsigned row);
+
+// Defines a PXTextureFormatTestPixelFunction named _NAME_ which converts a
+// pixel named val with _EXPR_. The pixels are copied in and out, as they may
+// not be aligned.
+#define _PXTextureFormatTestPixelFunction(_NAME_, _FROM_TYPE_, _TO_TYPE_, _EXPR_) \
+static void _NAME_(const void *fromPixel, void *toPixel, unsigned column, unsigned row) \
+{ \
+	_FROM_TYPE_ val; \
+	_TO_TYPE_ result; \
+	const uint8_t threshold = _PXTFBayer4x4[row & 3][column & 3]; \
+\
+	(void)threshold; \
+	memcpy(&val, fromPixel, sizeof(val)); \
+	result = _EXPR_; \
+	memcpy(toPixel, &result, sizeof(result)); \
+}
+
+_PXTextureFormatTestPixelFunction(PXTextureFormatTestRGBA4444FromRGBA8888, PXTF_RGBA_8888, PXTF_RGBA_4444, PXTF_RGBA_4444_From_RGBA_8888(val))
+_PXTextureFormatTestPixelFunction(PXTextureFormatTestRGBA5551FromRGBA8888, PXTF_RGBA_8888, PXTF_RGBA_5551, PXTF_RGBA_5551_From_RGBA_8888(val))
+_PXTextureFormatTestPixelFunction(PXTextureFormatTestRGB565FromRGBA8888, PXTF_RGBA_8888, PXTF_RGB_565, PXTF_RGB_565_From_RGBA_8888(val))
+_PXTextureFormatTestPixelFunction(PXTextureFormatTestRGB565FromRGB888, PXTF_RGB_888, PXTF_RGB_565, PXTF_RGB_565_From_RGB_888(val))
+_PXTextureFormatTestPixelFunction(PXTextureFormatTestRGB888FromRGBA8888, PXTF_RGBA_8888, PXTF_RGB_888, PXTF_RGB_888_From_RGBA_8888(val))
+_PXTextureFormatTestPixelFunction(PXTextureFormatTestA8FromRGBA8888, PXTF_RGBA_8888, PXTF_A_8, PXTF_A_8_From_RGBA_8888(val))
+
+_PXTextureFormatTestPixelFunction(PXTextureFormatTestPremultiplyRGBA8888, PXTF_RGBA_8888, PXTF_RGBA_8888, _PXTFPremultiplyRGBA8888(val))
+_PXTextureFormatTestPixelFunction(PXTextureFormatTestPremultiplyLA88, PXTF_LA_88, PXTF_LA_88, PXTF_LA_88_Make(_PX8BitMultiply(val.luminance, val.alpha), val.alpha))
+_PXTextureFormatTestPixelFunction(PXTextureFormatTestPremultiplyRGBA4444FromRGBA8888, PXTF_RGBA_8888, PXTF_RGBA_4444, PXTF_RGBA_4444_From_RGBA_8888(_PXTFPremultiplyRGBA8888(val)))
+_PXTextureFormatTestPixelFunction(PXTextureFormatTestPremultiplyRGBA5551FromRGBA8888, PXTF_RGBA_8888, PXTF_RGBA_5551, PXTF_RGBA_5551_From_RGBA_8888(_PXTFPremultiplyRGBA8888(val)))
+
+_PXTextureFormatTestPixelFunction(PXTextureFormatTestDitherRGBA4444FromRGBA8888, PXTF_RGBA_8888, PXTF_RGBA_4444, _PXTFDitherRGBA4444(val, threshold))
+_PXTextureFormatTestPixelFunction(PXTextureFormatTestDitherRGBA5551FromRGBA8888, PXTF_RGBA_8888, PXTF_RGBA_5551, _PXTFDitherRGBA5551(val, threshold))
+_PXTextureFormatTestPixelFunction(PXTextureFormatTestDitherRGB565FromRGBA8888, PXTF_RGBA_8888, PXTF_RGB_565, _PXTFDitherRGB565(val, threshold))
+_PXTextureFormatTestPixelFunction(PXTextureFormatTestDitherRGBA4444FromRGB888, PXTF_RGB_888, PXTF_RGBA_4444, _PXTFDitherRGBA4444(PXTF_RGBA_8888_From_RGB_888(val), threshold))
+_PXTextureFormatTestPixelFunction(PXTextureFormatTestDitherRGBA5551FromRGB888, PXTF_RGB_888, PXTF_RGBA_5551, _PXTFDitherRGBA5551(PXTF_RGBA_8888_From_RGB_888(val), threshold))
+_PXTextureFormatTestPixelFunction(PXTextureFormatTestDitherRGB565FromRGB888, PXTF_RGB_888, PXTF_RGB_565, _PXTFDitherRGB565(PXTF_RGBA_8888_From_RGB_888(val), threshold))
+
+typedef struct
+{
+	const char *name;
+	PXTextureFormatTestRowFunction rowFunction;
+	PXTextureFormatTestPixelFunction pixelFunction;
+	unsigned fromSize;
+	unsigned toSize;
+	// The row function may be given the same buffer to read and write.
+	BOOL inPlace;
+} PXTextureFormatTestCase;
+
+#define _PXTextureFormatTestCase(_NAME_, _FROM_TYPE_, _TO_TYPE_, _IN_PLACE_) \
+	{#_NAME_, PXTextureFormatRow##_NAME_, PXTextureFormatTest##_NAME_, sizeof(_FROM_TYPE_), sizeof(_TO_TYPE_), _IN_PLACE_}
+
+// Every row function that has a vector loop.
+static const PXTextureFormatTestCase pxTextureFormatTestCases[] =
+{
+	_PXTextureFormatTestCase(RGBA4444FromRGBA8888, PXTF_RGBA_8888, PXTF_RGBA_4444, NO),
+	_PXTextureFormatTestCase(RGBA5551FromRGBA8888, PXTF_RGBA_8888, PXTF_RGBA_5551, NO),
+	_PXTextureFormatTestCase(RGB565FromRGBA8888, PXTF_RGBA_8888, PXTF_RGB_565, NO),
+	_PXTextureFormatTestCase(RGB565FromRGB888, PXTF_RGB_888, PXTF_RGB_565, NO),
+	_PXTextureFormatTestCase(RGB888FromRGBA8888, PXTF_RGBA_8888, PXTF_RGB_888, NO),
+	_PXTextureFormatTestCase(A8FromRGBA8888, PXTF_RGBA_8888, PXTF_A_8, NO),
+	_PXTextureFormatTestCase(PremultiplyRGBA8888, PXTF_RGBA_8888, PXTF_RGBA_8888, YES),
+	_PXTextureFormatTestCase(PremultiplyLA88, PXTF_LA_88, PXTF_LA_88, YES),
+	_PXTextureFormatTestCase(PremultiplyRGBA4444FromRGBA8888, PXTF_RGBA_8888, PXTF_RGBA_4444, NO),
+	_PXTextureFormatTestCase(PremultiplyRGBA5551FromRGBA8888, PXTF_RGBA_8888, PXTF_RGBA_5551, NO),
+	_PXTextureFormatTestCase(DitherRGBA4444FromRGBA8888, PXTF_RGBA_8888, PXTF_RGBA_4444, NO),
+	_PXTextureFormatTestCase(DitherRGBA5551FromRGBA8888, PXTF_RGBA_8888, PXTF_RGBA_5551, NO),
+	_PXTextureFormatTestCase(DitherRGB565FromRGBA8888, PXTF_RGBA_8888, PXTF_RGB_565, NO),
+	_PXTextureFormatTestCase(DitherRGBA4444FromRGB888, PXTF_RGB_888, PXTF_RGBA_4444, NO),
+	_PXTextureFormatTestCase(DitherRGBA5551FromRGB888, PXTF_RGB_888, PXTF_RGBA_5551, NO),
+	_PXTextureFormatTestCase(DitherRGB565FromRGB888, PXTF_RGB_888, PXTF_RGB_565, NO)
+};
+
+#define PX_TEXTURE_FORMAT_TEST_CASE_COUNT (sizeof(pxTextureFormatTestCases) / sizeof(pxTextureFormatTestCases[0]))
+
+// Widths past 100 which are tested too.
+static const unsigned pxTextureFormatTestLargeWidths[] = {127, 128, 129, 255, 256, 257, 1023, 1024, 1025};
+
+#define PX_TEXTURE_FORMAT_TEST_MAX_WIDTH 1025
+#define PX_TEXTURE_FORMAT_TEST_MAX_OFFSET 16
+// Bytes checked after the end of each destination row.
+#define PX_TEXTURE_FORMAT_TEST_GUARD 32
+#define PX_TEXTURE_FORMAT_TEST_BUFFER_SIZE (PX_TEXTURE_FORMAT_TEST_MAX_WIDTH * 4 + PX_TEXTURE_FORMAT_TEST_MAX_OFFSET * 4 + PX_TEXTURE_FORMAT_TEST_GUARD)
+
+// xorshift32, so that every run tests the same pixels.
+static uint32_t pxTextureFormatTestSeed = 2463534242U;
+
+static uint32_t PXTextureFormatTestRandom()
+{
+	pxTextureFormatTestSeed ^= pxTextureFormatTestSeed << 13;
+	pxTextureFormatTestSeed ^= pxTextureFormatTestSeed >> 17;
+	pxTextureFormatTestSeed ^= pxTextureFormatTestSeed << 5;
+
+	return pxTextureFormatTestSeed;
+}
+
+static void PXTextureFormatTestFillRandom(uint8_t *bytes, unsigned byteCount)
+{
+	unsigned index;
+
+	for (index = 0; index < byteCount; ++index)
+	{
+		uint32_t val = PXTextureFormatTestRandom();
+
+		// Make sure the extremes, which the rounding cares most about, come
+		// up often.
+		switch (val & 7)
+		{
+			case 0:
+				bytes[index] = 0x00;
+				break;
+			case 1:
+				bytes[index] = 0xFF;
+				break;
+			default:
+				bytes[index] = val >> 24;
+				break;
+		}
+	}
+}
+
+// Runs the row function and the pixel function over the same row, and
+// compares everything from the start of the buffers to past the end of the
+// row. Returns NO and prints the first difference if they don't match.
+static BOOL PXTextureFormatTestRow(const PXTextureFormatTestCase *testCase,
+								   const uint8_t *source,
+								   uint8_t *expected,
+								   uint8_t *actual,
+								   unsigned width,
+								   unsigned row,
+								   unsigned fromOffset,
+								   unsigned toOffset,
+								   BOOL inPlace)
+{
+	unsigned column;
+	unsigned toByteCount = toOffset + width * testCase->toSize + PX_TEXTURE_FORMAT_TEST_GUARD;
+
+	memset(expected, 0xCD, PX_TEXTURE_FORMAT_TEST_BUFFER_SIZE);
+	memset(actual, 0xCD, PX_TEXTURE_FORMAT_TEST_BUFFER_SIZE);
+
+	for (column = 0; column < width; ++column)
+	{
+		testCase->pixelFunction(source + fromOffset + column * testCase->fromSize,
+								expected + toOffset + column * testCase->toSize,
+								column,
+								row);
+	}
+
+	if (inPlace)
+	{
+		memcpy(actual + toOffset, source + fromOffset, width * testCase->fromSize);
+		testCase->rowFunction(actual + toOffset, actual + toOffset, width, row);
+	}
+	else
+	{
+		testCase->rowFunction(source + fromOffset, actual + toOffset, width, row);
+	}
+
+	if (memcmp(expected, actual, toByteCount) == 0)
+	{
+		return YES;
+	}
+
+	unsigned index = 0;
+	while (expected[index] == actual[index])
+	{
+		++index;
+	}
+
+	printf("%s%s: width %u, row %u, offsets %u and %u: byte %u (pixel %d) is 0x%02X, expected 0x%02X\n",
+		   testCase->name, inPlace ? " (in place)" : "",
+		   width, row, fromOffset, toOffset,
+		   index, ((int)index - (int)toOffset) / (int)testCase->toSize,
+		   actual[index], expected[index]);
+
+	return NO;
+}
+
+static BOOL PXTextureFormatTestCaseRun(const PXTextureFormatTestCase *testCase, uint8_t *source, uint8_t *expected, uint8_t *actual)
+{
+	unsigned widths[101 + sizeof(pxTextureFormatTestLargeWidths) / sizeof(pxTextureFormatTestLargeWidths[0])];
+	unsigned widthCount = 0;
+	unsigned index;
+
+	for (index = 0; index <= 100; ++index)
+	{
+		widths[widthCount++] = index;
+	}
+	for (index = 0; index < sizeof(pxTextureFormatTestLargeWidths) / sizeof(pxTextureFormatTestLargeWidths[0]); ++index)
+	{
+		widths[widthCount++] = pxTextureFormatTestLargeWidths[index];
+	}
+
+	for (index = 0; index < widthCount; ++index)
+	{
+		unsigned width = widths[index];
+		unsigned row;
+
+		// All four rows of the dither pattern.
+		for (row = 0; row < 4; ++row)
+		{
+			unsigned fromOffset;
+
+			PXTextureFormatTestFillRandom(source, PX_TEXTURE_FORMAT_TEST_BUFFER_SIZE);
+
+			for (fromOffset = 0; fromOffset < PX_TEXTURE_FORMAT_TEST_MAX_OFFSET; ++fromOffset)
+			{
+				// The destination pixels keep their own alignment, at
+				// different distances from a 16 byte boundary.
+				unsigned toOffset = ((fromOffset * 5) % PX_TEXTURE_FORMAT_TEST_MAX_OFFSET) * testCase->toSize;
+
+				if (!PXTextureFormatTestRow(testCase, source, expected, actual, width, row, fromOffset, toOffset, NO))
+				{
+					return NO;
+				}
+
+				if (testCase->inPlace &&
+					!PXTextureFormatTestRow(testCase, source, expected, actual, width, row, fromOffset, fromOffset, YES))
+				{
+					return NO;
+				}
+			}
+		}
+	}
+
+	return YES;
+}
+
+// Converts an image of width x height pixels until at least a fifth of a
+// second has gone by, and returns the millions of pixels per second.
+static double PXTextureFormatTestBenchmark(const PXTextureFormatTestCase *testCase, unsigned width, unsigned height)
+{
+	uint8_t *fromPixels = malloc(width * height * testCase->fromSize);
+	uint8_t *toPixels = malloc(width * height * testCase->toSize);
+
+	if (!fromPixels || !toPixels)
+	{
+		free(fromPixels);
+		free(toPixels);
+		return 0.0;
+	}
+
+	PXTextureFormatTestFillRandom(fromPixels, width * height * testCase->fromSize);
+
+	unsigned passCount = 0;
+	clock_t start = clock();
+	clock_t elapsed;
+
+	do
+	{
+		unsigned row;
+
+		for (row = 0; row < height; ++row)
+		{
+			testCase->rowFunction(fromPixels + row * width * testCase->fromSize,
+								  toPixels + row * width * testCase->toSize,
+								  width,
+								  row);
+		}
+
+		++passCount;
+		elapsed = clock() - start;
+	} while (elapsed < CLOCKS_PER_SEC / 5);
+
+	free(fromPixels);
+	free(toPixels);
+
+	double seconds = (double)elapsed / CLOCKS_PER_SEC;
+	return ((double)passCount * width * height) / (seconds * 1000000.0);
+}
+
+int main(int argc, char **argv)
+{
+	BOOL bench = YES;
+	int argIndex;
+
+	for (argIndex = 1; argIndex < argc; ++argIndex)
+	{
+		if (strcmp(argv[argIndex], "-nobench") == 0)
+		{
+			bench = NO;
+		}
+		else
+		{
+			printf("usage: pxtexformattest [-nobench]\n");
+			return 1;
+		}
+	}
+
+#if defined(PX_TF_SIMD_NEON)
+	const char *simdName = "NEON";
+#elif defined(PX_TF_SIMD_SSE)
+	const char *simdName = "SSE2";
+#else
+	const char *simdName = "none, plain C";
+#endif
+
+	printf("Vector code: %s\n\n", simdName);
+
+	uint8_t *source = malloc(PX_TEXTURE_FORMAT_TEST_BUFFER_SIZE);
+	uint8_t *expected = malloc(PX_TEXTURE_FORMAT_TEST_BUFFER_SIZE);
+	uint8_t *actual = malloc(PX_TEXTURE_FORMAT_TEST_BUFFER_SIZE);
+
+	if (!source || !expected || !actual)
+	{
+		printf("Out of memory\n");
+		return 1;
+	}
+
+	unsigned failureCount = 0;
+	unsigned index;
+
+	for (index = 0; index < PX_TEXTURE_FORMAT_TEST_CASE_COUNT; ++index)
+	{
+		const PXTextureFormatTestCase *testCase = &pxTextureFormatTestCases[index];
+		BOOL passed = PXTextureFormatTestCaseRun(testCase, source, expected, actual);
+
+		if (!bench || !passed)
+		{
+			printf("%-32s %s\n", testCase->name, passed ? "ok" : "FAILED");
+		}
+		else
+		{
+			// A texture sized row, and a row that leaves a remainder.
+			printf("%-32s ok  %8.1f MPix/s (1024 wide)  %8.1f MPix/s (1021 wide)\n",
+				   testCase->name,
+				   PXTextureFormatTestBenchmark(testCase, 1024, 256),
+				   PXTextureFormatTestBenchmark(testCase, 1021, 256));
+		}
+
+		if (!passed)
+		{
+			++failureCount;
+		}
+	}
+
+	free(source);
+	free(expected);
+	free(actual);
+
+	if (failureCount > 0)
+	{
+		printf("\n%u of %u row functions FAILED\n", failureCount, (unsigned)PX_TEXTURE_FORMAT_TEST_CASE_COUNT);
+		return 1;
+	}
+
+	printf("\nAll %u row functions match the pixel functions\n", (unsigned)PX_TEXTURE_FORMAT_TEST_CASE_COUNT);
+	return 0;
+}
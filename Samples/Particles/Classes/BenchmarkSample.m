@@ -0,0 +1,306 @@
+/*
+ *  _____                       ___                                            
+ * /\  _ `\  __                /\_ \                                           
+ * \ \ \L\ \/\_\   __  _    ___\//\ \    __  __  __    ___     __  __    ___   
+ *  \ \  __/\/\ \ /\ \/ \  / __`\\ \ \  /\ \/\ \/\ \  / __`\  /\ \/\ \  / __`\ 
+ *   \ \ \/  \ \ \\/>  </ /\  __/ \_\ \_\ \ \_/ \_/ \/\ \L\ \_\ \ \_/ |/\  __/ 
+ *    \ \_\   \ \_\/\_/\_\\ \____\/\____\\ \___^___ /\ \__/|\_\\ \___/ \ \____\
+ *     \/_/    \/_/\//\/_/ \/____/\/____/ \/__//__ /  \/__/\/_/ \/__/   \/____/
+ *       
+ *           www.pixelwave.org + www.spiralstormgames.com
+ *                            ~;   
+ *                           ,/|\.           
+ *                         ,/  |\ \.                 Core Team: Oz Michaeli
+ *                       ,/    | |  \                           John Lattin
+ *                     ,/      | |   |
+ *                   ,/        |/    |
+ *                 ./__________|----'  .
+ *            ,(   ___.....-,~-''-----/   ,(            ,~            ,(        
+ * _.-~-.,.-'`  `_.\,.',.-'`  )_.-~-./.-'`  `_._,.',.-'`  )_.-~-.,.-'`  `_._._,.
+ * 
+ * Copyright (c) 2011 Spiralstorm Games http://www.spiralstormgames.com
+ * 
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#import "BenchmarkSample.h"
+
+#import "PXGLRenderer.h"
+
+#include <mach/mach_time.h>
+
+// The amount of simulated time each scenario runs for, in seconds.
+#define BENCHMARK_SAMPLE_DURATION 10.0f
+#define BENCHMARK_SAMPLE_FRAME_RATE 60.0f
+// The per action and render timings are taken once every this many frames.
+#define BENCHMARK_SAMPLE_PROBE_INTERVAL 10
+
+// Counts the particles which had to be allocated because the pool was empty.
+@interface BenchmarkParticleCreator : PKParticleCreator
+{
+@public
+	unsigned int allocationCount;
+}
+@end
+
+@implementation BenchmarkParticleCreator
+
+- (PKParticle *)newParticle
+{
+	if (PXArrayBufferCount(particles) == 0)
+		++allocationCount;
+
+	return [super newParticle];
+}
+
+@end
+
+static double benchmarkSampleNanoSecondsPerTick = 0.0;
+
+@interface BenchmarkSample(Private)
+- (NSString *)runScenario:(NSString *)scenario withFlow:(id<PKParticleFlow>)flow summary:(NSMutableString *)summary;
+@end
+
+@implementation BenchmarkSample
+
+- (id) init
+{
+	self = [super init];
+
+	if (self)
+	{
+		mach_timebase_info_data_t info;
+		mach_timebase_info(&info);
+
+		benchmarkSampleNanoSecondsPerTick = (double)(info.numer) / (double)(info.denom);
+	}
+
+	return self;
+}
+
+- (NSString *)description
+{
+	return @"Benchmark";
+}
+
+- (void) setup
+{
+	NSMutableArray *scenarios = [[NSMutableArray alloc] init];
+	NSMutableString *summary = [[NSMutableString alloc] init];
+
+	[scenarios addObject:[self runScenario:@"steady" withFlow:[PKSteadyFlow steadyFlowWithRate:2000.0f] summary:summary]];
+	[scenarios addObject:[self runScenario:@"blast" withFlow:[PKBlastFlow blastFlowWithCount:5000] summary:summary]];
+	[scenarios addObject:[self runScenario:@"pulse" withFlow:[PKPulseFlow pulseFlowWithCount:1000 period:0.5f] summary:summary]];
+
+	NSString *json = [NSString stringWithFormat:@"{\"build\":\"%s %s\",\"duration\":%f,\"frameRate\":%f,\"scenarios\":[%@]}",
+					  __DATE__, __TIME__,
+					  BENCHMARK_SAMPLE_DURATION,
+					  BENCHMARK_SAMPLE_FRAME_RATE,
+					  [scenarios componentsJoinedByString:@","]];
+
+	NSLog(@"%@", json);
+
+	NSString *documentsPath = [NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES) objectAtIndex:0];
+	[json writeToFile:[documentsPath stringByAppendingPathComponent:@"ParticleBenchmark.json"]
+		   atomically:YES
+			 encoding:NSUTF8StringEncoding
+				error:nil];
+
+	resultsField = [[PXTextField alloc] initWithFont:@"defaultFont"];
+	resultsField.textColor = 0xFFFFFF;
+	resultsField.fontSize = 12.0f;
+	resultsField.smoothing = YES;
+	resultsField.touchEnabled = NO;
+	resultsField.text = summary;
+	resultsField.x = 16.0f;
+	resultsField.y = halfStageSize.height;
+	[self addChild:resultsField];
+
+	[summary release];
+	[scenarios release];
+}
+
+- (void) teardown
+{
+	if (resultsField)
+	{
+		[self removeChild:resultsField];
+		[resultsField release];
+		resultsField = nil;
+	}
+
+	[super teardown];
+}
+
+- (NSString *)runScenario:(NSString *)scenario withFlow:(id<PKParticleFlow>)flow summary:(NSMutableString *)summary
+{
+	NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+
+	BenchmarkParticleCreator *factory = [[BenchmarkParticleCreator alloc] init];
+	PKParticleEmitter *emitter = [[PKParticleEmitter alloc] init];
+
+	emitter.particleFactory = factory;
+	emitter.flow = flow;
+
+	emitter.x = halfStageSize.width;
+	emitter.y = halfStageSize.height;
+
+	[emitter addInitializer:[PKSharedGraphicInitializer sharedGraphicInitializerWithGraphic:[PXTextureData textureDataWithContentsOfFile:@"dot.png"]]];
+	[emitter addInitializer:[PKLifetimeInitializer lifetimeInitializerWithRange:PKRangeMake(1.0f, 3.0f)]];
+	[emitter addInitializer:[PKPositionInitializer positionInitializerWithZone:[PKDiscZone discZoneWithOuterRadius:8.0f]]];
+	[emitter addInitializer:[PKVelocityInitializer velocityInitializerWithZone:[PKDiscZone discZoneWithOuterRadius:128.0f innerRadius:48.0f]]];
+	[emitter addInitializer:[PKColorInitializer colorInitializerWithMinColor:0x000000 maxColor:0xFFFFFF]];
+	[emitter addInitializer:[PKScaleInitializer scaleInitializerWithRange:PKRangeMake(0.1f, 0.6f)]];
+	[emitter addInitializer:[PKRotationInitializer rotationInitializerWithRange:PKRangeMake(0.0f, 360.0f)]];
+	[emitter addInitializer:[PKBlendInitializer additiveBlendInitializer]];
+
+	[emitter addAction:[PKAgeAction ageAction]];
+	[emitter addAction:[PKMoveAction moveAction]];
+	[emitter addAction:[PKAccelerateAction accelerateActionWithX:0.0f y:100.0f]];
+	[emitter addAction:[PKRotateAction rotateAction]];
+	[emitter addAction:[PKScaleAction scaleActionWithStartScale:1.0f endScale:0.0f]];
+	[emitter addAction:[PKFadeAction fadeAction]];
+
+	PKQuadRenderer *renderer = [[PKQuadRenderer alloc] initWithSmoothing:YES];
+	[renderer addEmitter:emitter];
+
+	PXLinkedList *actions = emitter->_actions;
+	unsigned int actionCount = actions.count;
+	uint64_t *actionTicks = calloc(actionCount, sizeof(uint64_t));
+
+	float dt = 1.0f / BENCHMARK_SAMPLE_FRAME_RATE;
+	unsigned int frameCount = ceilf(BENCHMARK_SAMPLE_DURATION * BENCHMARK_SAMPLE_FRAME_RATE);
+
+	uint64_t updateTicks = 0;
+	uint64_t renderTicks = 0;
+	uint64_t startTicks;
+
+	unsigned long long particleUpdateCount = 0;
+	unsigned long long probedParticleCount = 0;
+	unsigned int peakParticleCount = 0;
+
+	// Start the flow, but keep the emitter off the frame timer so that it's
+	// only updated from here.
+	[emitter start];
+	[emitter pause];
+
+	for (unsigned int frameIndex = 0; frameIndex < frameCount; ++frameIndex)
+	{
+		startTicks = mach_absolute_time();
+		[emitter updateWithDeltaTime:dt];
+		updateTicks += mach_absolute_time() - startTicks;
+
+		unsigned int particleCount = emitter.numParticles;
+
+		particleUpdateCount += particleCount;
+		peakParticleCount = MAX(peakParticleCount, particleCount);
+
+		if (particleCount == 0 || (frameIndex % BENCHMARK_SAMPLE_PROBE_INTERVAL) != 0)
+			continue;
+
+		probedParticleCount += particleCount;
+
+		// Time each action on its own, with the same delta time the emitter
+		// uses; some actions divide by it. The particles are put back
+		// afterwards.
+		PKParticle **particlePtr = (PKParticle **)(emitter.particles->array);
+		unsigned int actionIndex = 0;
+		id<PKParticleAction> action;
+
+		NSData *snapshot = [emitter particleSnapshot];
+
+		PXLinkedListForEach(actions, action)
+		{
+			startTicks = mach_absolute_time();
+
+			for (unsigned int index = 0; index < particleCount; ++index)
+			{
+				[action updateParticle:particlePtr[index] emitter:emitter deltaTime:dt];
+			}
+
+			actionTicks[actionIndex++] += mach_absolute_time() - startTicks;
+		}
+
+		[emitter restoreParticleSnapshot:snapshot];
+
+		// Time the renderer writing its vertices into the batch, then throw
+		// them away so nothing gets drawn.
+		unsigned int vertexIndex = PXGLGetCurrentVertexIndex();
+		unsigned int elementIndex = PXGLGetCurrentIndex();
+		unsigned int pointSizeIndex = PXGLGetCurrentPointSizeIndex();
+
+		PXGLPushMatrix();
+		PXGLLoadIdentity();
+
+		startTicks = mach_absolute_time();
+		[renderer _renderGL];
+		renderTicks += mach_absolute_time() - startTicks;
+
+		PXGLPopMatrix();
+
+		PXGLSetCurrentVertexIndex(vertexIndex);
+		PXGLSetCurrentIndex(elementIndex);
+		PXGLSetCurrentPointSizeIndex(pointSizeIndex);
+	}
+
+	double updateSeconds = (updateTicks * benchmarkSampleNanoSecondsPerTick) * 1e-9;
+	double particlesPerSecond = (updateSeconds > 0.0) ? (particleUpdateCount / updateSeconds) : 0.0;
+	double nsPerParticle = (particleUpdateCount > 0) ? ((updateTicks * benchmarkSampleNanoSecondsPerTick) / particleUpdateCount) : 0.0;
+	double renderNSPerParticle = (probedParticleCount > 0) ? ((renderTicks * benchmarkSampleNanoSecondsPerTick) / probedParticleCount) : 0.0;
+
+	NSMutableArray *actionResults = [NSMutableArray arrayWithCapacity:actionCount];
+	unsigned int actionIndex = 0;
+	id<PKParticleAction> action;
+
+	PXLinkedListForEach(actions, action)
+	{
+		double actionNS = (probedParticleCount > 0) ? ((actionTicks[actionIndex] * benchmarkSampleNanoSecondsPerTick) / probedParticleCount) : 0.0;
+		[actionResults addObject:[NSString stringWithFormat:@"\"%@\":%f", NSStringFromClass([(id)action class]), actionNS]];
+
+		++actionIndex;
+	}
+
+	NSString *result = [[NSString alloc] initWithFormat:@"{\"name\":\"%@\",\"frames\":%u,\"updateSeconds\":%f,\"particleUpdates\":%llu,\"particlesPerSecond\":%f,\"nsPerParticle\":%f,\"peakParticles\":%u,\"allocations\":%u,\"actionNSPerParticle\":{%@},\"renderNSPerParticle\":%f}",
+						scenario,
+						frameCount,
+						updateSeconds,
+						particleUpdateCount,
+						particlesPerSecond,
+						nsPerParticle,
+						peakParticleCount,
+						factory->allocationCount,
+						[actionResults componentsJoinedByString:@","],
+						renderNSPerParticle];
+
+	[summary appendFormat:@"%@: %.0f particles/s\n", scenario, particlesPerSecond];
+
+	free(actionTicks);
+
+	[renderer removeAllEmitters];
+	[renderer release];
+
+	[emitter stop];
+	[emitter release];
+
+	[factory release];
+
+	[pool release];
+
+	return [result autorelease];
+}
+
+@end
@@ -48,6 +48,7 @@
 #import "FireSample.h"
 #import "DesignerSample.h"
 #import "PointRendererSample.h"
+#import "BenchmarkSample.h"
 
 @interface ParticlesRoot (Private)
 - (void) setCurrentSample:(uint)index;
@@ -152,6 +153,7 @@ static const BOOL particlesRenderToTexture = NO;
 				[[[DesignerSample alloc] init] autorelease],
 				[[[PointRendererSample alloc] init] autorelease],
 				[[[FireSample alloc] init] autorelease],
+				[[[BenchmarkSample alloc] init] autorelease],
 			   nil] retain];
 
 	[self setCurrentSample:0];